@@ -0,0 +1,262 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rscodec.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Reentrant Reed Solomon codec over GF(256) for the radio link.
+ *
+ *             The algorithms are those of rs.c and berlekamp.c (Berlekamp-Massey
+ *             with erasures, Chien search, Forney), with the state moved to the
+ *             stack and the encoder driven by a table per generator coefficient.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "rscodec.h"
+#include "ecc.h"
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    return (a && b) ? gexp[glog[a] + glog[b]] : 0;
+}
+
+/* As ginv(), the inverse of 0 comes out as 1 */
+static inline uint8_t gf_inv(uint8_t a)
+{
+    return gexp[255 - glog[a]];
+}
+
+void rs_codec_init(struct rs_codec *codec)
+{
+    uint8_t *g = codec->genpoly;
+
+    /* multiply (x + a^i) for i = 1 to RS_ECC_NPARITY */
+    memset(g, 0, sizeof(codec->genpoly));
+    g[0] = 1;
+    for (int i = 1; i <= RS_ECC_NPARITY; i++) {
+        for (int j = i; j > 0; j--) {
+            g[j] = g[j - 1] ^ gf_mul(gexp[i], g[j]);
+        }
+        g[0] = gf_mul(gexp[i], g[0]);
+    }
+
+    for (int d = 0; d < 256; d++) {
+        for (int j = 0; j < RS_ECC_NPARITY; j++) {
+            codec->lfsr[d][j] = gf_mul(g[j], d);
+        }
+    }
+}
+
+/* The remainder of msg divided by the generator, highest coefficient last */
+static void rs_parity(const struct rs_codec *codec, const uint8_t *msg, uint16_t nbytes, uint8_t parity[RS_ECC_NPARITY])
+{
+    memset(parity, 0, RS_ECC_NPARITY);
+    for (uint16_t i = 0; i < nbytes; i++) {
+        const uint8_t *feedback = codec->lfsr[msg[i] ^ parity[RS_ECC_NPARITY - 1]];
+        for (int j = RS_ECC_NPARITY - 1; j > 0; j--) {
+            parity[j] = parity[j - 1] ^ feedback[j];
+        }
+        parity[0] = feedback[0];
+    }
+}
+
+void rs_encode(const struct rs_codec *codec, const uint8_t *msg, uint16_t nbytes, uint8_t *dst)
+{
+    uint8_t parity[RS_ECC_NPARITY];
+
+    rs_parity(codec, msg, nbytes, parity);
+    if (dst != msg) {
+        memmove(dst, msg, nbytes);
+    }
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        dst[nbytes + i] = parity[RS_ECC_NPARITY - 1 - i];
+    }
+}
+
+/*
+ * A codeword is clean exactly when its syndromes are all zero, that is when
+ * its parity is what the encoder makes of its message. Checking that costs
+ * one table lookup per byte, the syndromes are only needed for correcting.
+ */
+bool rs_check(const struct rs_codec *codec, const uint8_t *codeword, uint16_t csize)
+{
+    uint8_t parity[RS_ECC_NPARITY];
+
+    if (csize < RS_ECC_NPARITY) {
+        return false;
+    }
+    uint16_t nbytes = csize - RS_ECC_NPARITY;
+    rs_parity(codec, codeword, nbytes, parity);
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        if (codeword[nbytes + i] != parity[RS_ECC_NPARITY - 1 - i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Syndromes as decode_data() computes them, returns false if all are zero */
+static bool rs_syndromes(const uint8_t *codeword, uint16_t csize, uint8_t syn[RS_MAXDEG])
+{
+    bool nonzero = false;
+
+    memset(syn, 0, RS_MAXDEG);
+    for (int j = 0; j < RS_ECC_NPARITY; j++) {
+        uint8_t sum = 0;
+        for (uint16_t i = 0; i < csize; i++) {
+            /* sum * a^(j+1) */
+            sum = codeword[i] ^ (sum ? gexp[glog[sum] + j + 1] : 0);
+        }
+        syn[j]   = sum;
+        nonzero |= (sum != 0);
+    }
+    return nonzero;
+}
+
+/* multiply by z, i.e., shift right by 1 */
+static void mul_z(uint8_t poly[RS_MAXDEG])
+{
+    memmove(poly + 1, poly, RS_MAXDEG - 1);
+    poly[0] = 0;
+}
+
+/*
+ * Modified Berlekamp-Massey, see berlekamp.c. Fills in the error locator
+ * lambda and the evaluator omega = lambda * syn mod z^RS_ECC_NPARITY.
+ */
+static void rs_locator(const uint8_t syn[RS_MAXDEG], uint8_t nerasures, const uint8_t erasures[],
+                       uint8_t lambda[RS_MAXDEG], uint8_t omega[RS_MAXDEG])
+{
+    uint8_t psi[RS_MAXDEG], D[RS_MAXDEG], tmp[RS_MAXDEG];
+    int k = -1;
+    int L = nerasures;
+
+    /* gamma = product (1 - z * a^Ij) for the erasure locations Ij, into psi */
+    memset(psi, 0, RS_MAXDEG);
+    psi[0] = 1;
+    for (int e = 0; e < nerasures; e++) {
+        for (int i = 0; i < RS_MAXDEG; i++) {
+            tmp[i] = gf_mul(gexp[erasures[e]], psi[i]);
+        }
+        mul_z(tmp);
+        for (int i = 0; i < RS_MAXDEG; i++) {
+            psi[i] ^= tmp[i];
+        }
+    }
+    memcpy(D, psi, RS_MAXDEG);
+    mul_z(D);
+
+    for (int n = nerasures; n < RS_ECC_NPARITY; n++) {
+        uint8_t d = 0;
+        for (int i = 0; i <= L; i++) {
+            d ^= gf_mul(psi[i], syn[n - i]);
+        }
+
+        if (d != 0) {
+            /* tmp = psi - d*D */
+            for (int i = 0; i < RS_MAXDEG; i++) {
+                tmp[i] = psi[i] ^ gf_mul(d, D[i]);
+            }
+            if (L < (n - k)) {
+                int L2 = n - k;
+                k = n - L;
+                uint8_t dinv = gf_inv(d);
+                for (int i = 0; i < RS_MAXDEG; i++) {
+                    D[i] = gf_mul(psi[i], dinv);
+                }
+                L = L2;
+            }
+            memcpy(psi, tmp, RS_MAXDEG);
+        }
+        mul_z(D);
+    }
+
+    memcpy(lambda, psi, RS_MAXDEG);
+    memset(omega, 0, RS_MAXDEG);
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        for (int j = 0; j <= i; j++) {
+            omega[i] ^= gf_mul(lambda[j], syn[i - j]);
+        }
+    }
+}
+
+bool rs_correct(uint8_t *codeword, uint16_t csize, uint8_t nerasures, const uint8_t erasures[])
+{
+    uint8_t syn[RS_MAXDEG], lambda[RS_MAXDEG], omega[RS_MAXDEG];
+    uint8_t locs[RS_ECC_NPARITY];
+    int nerrors = 0;
+
+    if (!rs_syndromes(codeword, csize, syn)) {
+        return false;
+    }
+    rs_locator(syn, nerasures, erasures, lambda, omega);
+
+    /*
+     * Chien search, the roots of lambda among a^r. Term k is a^(log lambda[k] + k*r),
+     * its exponent steps by k with r.
+     */
+    int exponent[RS_ECC_NPARITY + 1];
+    for (int k = 0; k <= RS_ECC_NPARITY; k++) {
+        exponent[k] = glog[lambda[k]];
+    }
+    for (int r = 1; r < 256; r++) {
+        uint8_t sum = 0;
+        for (int k = 0; k <= RS_ECC_NPARITY; k++) {
+            exponent[k] += k;
+            if (exponent[k] >= 255) {
+                exponent[k] -= 255;
+            }
+            if (lambda[k]) {
+                sum ^= gexp[exponent[k]];
+            }
+        }
+        if (sum == 0) {
+            if (nerrors < RS_ECC_NPARITY) {
+                locs[nerrors] = 255 - r;
+            }
+            nerrors++;
+        }
+    }
+
+    if (nerrors == 0 || nerrors > RS_ECC_NPARITY) {
+        return false;
+    }
+    for (int r = 0; r < nerrors; r++) {
+        if (locs[r] >= csize) {
+            return false;
+        }
+    }
+
+    /* Forney, omega / lambda' at a^(-i) for error location i */
+    for (int r = 0; r < nerrors; r++) {
+        int i         = locs[r];
+        uint8_t num   = 0;
+        uint8_t denom = 0;
+
+        for (int j = 0; j < RS_MAXDEG; j++) {
+            num ^= gf_mul(omega[j], gexp[((255 - i) * j) % 255]);
+        }
+        /* all odd powers disappear from the derivative */
+        for (int j = 1; j < RS_MAXDEG; j += 2) {
+            denom ^= gf_mul(lambda[j], gexp[((255 - i) * (j - 1)) % 255]);
+        }
+        codeword[csize - i - 1] ^= gf_mul(num, gf_inv(denom));
+    }
+    return true;
+}
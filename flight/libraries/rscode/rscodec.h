@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rscodec.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Reentrant Reed Solomon codec over GF(256) for the radio link.
+ *             Produces the same codewords and corrections as the rscode
+ *             encode_data()/decode_data()/correct_errors_erasures() calls.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RSCODEC_H
+#define RSCODEC_H
+
+#include <openpilot.h>
+
+/* Maximum degree of the decoder polynomials */
+#define RS_MAXDEG (RS_ECC_NPARITY * 2)
+
+/*
+ * The codec only holds tables, it is not written after rs_codec_init() and
+ * can be shared by any number of encoders and decoders. The decoder keeps
+ * its state on the stack.
+ */
+struct rs_codec {
+    /* Generator polynomial, product of (x + a^i) for i = 1..RS_ECC_NPARITY */
+    uint8_t genpoly[RS_ECC_NPARITY + 1];
+    /* lfsr[d][j] = genpoly[j] * d, what the encoder feeds back for byte d */
+    uint8_t lfsr[256][RS_ECC_NPARITY];
+};
+
+void rs_codec_init(struct rs_codec *codec);
+
+/* Writes msg followed by RS_ECC_NPARITY parity bytes to dst, dst may be msg */
+void rs_encode(const struct rs_codec *codec, const uint8_t *msg, uint16_t nbytes, uint8_t *dst);
+
+/* True when the codeword, parity included, holds no errors */
+bool rs_check(const struct rs_codec *codec, const uint8_t *codeword, uint16_t csize);
+
+/*
+ * Corrects up to RS_ECC_NPARITY / 2 errors, or more with known erasures,
+ * given as positions counted back from the end of the codeword. Returns
+ * true if the codeword was corrected, false when it had no errors or
+ * could not be corrected.
+ */
+bool rs_correct(uint8_t *codeword, uint16_t csize, uint8_t nerasures, const uint8_t erasures[]);
+
+#endif /* RSCODEC_H */
@@ -42,6 +42,7 @@
 #include "flightstatus.h"
 #include "mixersettings.h"
 #include "mixerstatus.h"
+#include "mixermatrix.h"
 #include "cameradesired.h"
 #include "manualcontrolcommand.h"
 #include "taskinfo.h"
@@ -80,25 +81,18 @@ static float filterAccumulator[MAX_MIX_ACTUATORS] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 static volatile bool actuator_settings_updated;
 // used to inform the actuator thread that mixer settings are changed
 static volatile bool mixer_settings_updated;
+// MixerSettings compiled for the control loop, rebuilt whenever they change
+static MixerMatrix_t mixerMatrix;
 
 // Private functions
 static void actuatorTask(void *parameters);
 static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
 static void setFailsafe(const ActuatorSettingsData *actuatorSettings, const MixerSettingsData *mixerSettings);
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements);
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData *actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuatorSettings, bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired,
-                   const float period);
-
-// this structure is equivalent to the UAVObjects for one mixer.
-typedef struct {
-    uint8_t type;
-    int8_t  matrix[5];
-} __attribute__((packed)) Mixer_t;
+static float ProcessMotorMixer(const int index, float result, const MixerSettingsData *mixerSettings, const float period);
 
 /**
  * @brief Module initialization
@@ -191,6 +185,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     MixerSettingsData mixerSettings;
     mixer_settings_updated = false;
     MixerSettingsGet(&mixerSettings);
+    MixerMatrixCompile(&mixerMatrix, &mixerSettings);
 
     /* Force an initial configuration of the actuator update rates */
     actuator_update_rate_if_changed(&actuatorSettings, true);
@@ -219,6 +214,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         if (mixer_settings_updated) {
             mixer_settings_updated = false;
             MixerSettingsGet(&mixerSettings);
+            MixerMatrixCompile(&mixerMatrix, &mixerSettings);
         }
 
         if (rc != pdTRUE) {
@@ -275,14 +271,8 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_MIXERSTATUS
         MixerStatusGet(&mixerStatus);
 #endif
-        int nMixers     = 0;
-        Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                nMixers++;
-            }
-        }
-        if ((nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+        const uint8_t *mixerType = mixerMatrix.type;
+        if ((mixerMatrix.nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
             setFailsafe(&actuatorSettings, &mixerSettings); // So that channels like PWM buzzer keep working
             continue;
         }
@@ -293,28 +283,26 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         bool positiveThrottle = (throttleDesired > 0.00f);
         bool spinWhileArmed   = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
 
-        float curve1 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+        float curve1 = MixerMatrixCurve(&mixerMatrix.curve1, throttleDesired);
 
         // The source for the secondary curve is selectable
         float curve2 = 0;
         AccessoryDesiredData accessory;
         switch (mixerSettings.Curve2Source) {
         case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-            curve2 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerMatrixCurve(&mixerMatrix.curve2, throttleDesired);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-            curve2 = MixerCurve(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerMatrixCurve(&mixerMatrix.curve2, desired.Roll);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-            curve2 = MixerCurve(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerMatrixCurve(&mixerMatrix.curve2, desired.Pitch);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_YAW:
-            curve2 = MixerCurve(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerMatrixCurve(&mixerMatrix.curve2, desired.Yaw);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
-            curve2 = MixerCurve(collectiveDesired, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerMatrixCurve(&mixerMatrix.curve2, collectiveDesired);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
@@ -323,7 +311,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
             if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
-                curve2 = MixerCurve(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+                curve2 = MixerMatrixCurve(&mixerMatrix.curve2, accessory.AccessoryVal);
             } else {
                 curve2 = 0;
             }
@@ -332,6 +320,15 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
         float *status = (float *)&mixerStatus; // access status objects as an array of floats
 
+        // Mix all motor and servo channels at once
+        float mixerInput[MIXERMATRIX_INPUTS];
+        mixerInput[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1;
+        mixerInput[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2;
+        mixerInput[MIXERSETTINGS_MIXER1VECTOR_ROLL]  = desired.Roll;
+        mixerInput[MIXERSETTINGS_MIXER1VECTOR_PITCH] = desired.Pitch;
+        mixerInput[MIXERSETTINGS_MIXER1VECTOR_YAW]   = desired.Yaw;
+        MixerMatrixApply(&mixerMatrix, mixerInput, status);
+
         for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
             // During boot all camera actuators should be completely disabled (PWM pulse = 0).
             // command.Channel[i] is reused below as a channel PWM activity flag:
@@ -339,20 +336,20 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // Setting it to 1 by default means "Rescale this channel and enable PWM on its output".
             command.Channel[ct] = 1;
 
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            if (mixerType[ct] == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
                 // Set to minimum if disabled.  This is not the same as saying PWM pulse = 0 us
                 status[ct] = -1;
                 continue;
             }
 
-            if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &mixerSettings, &desired, dTSeconds);
-            } else {
+            if (mixerType[ct] == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+                status[ct] = ProcessMotorMixer(ct, status[ct], &mixerSettings, dTSeconds);
+            } else if (!(mixerMatrix.mixed & (1 << ct))) {
                 status[ct] = -1;
             }
 
             // Motors have additional protection for when to be on
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+            if (mixerType[ct] == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
                 // If not armed or motors aren't meant to spin all the time
                 if (!armed ||
                     (!spinWhileArmed && !positiveThrottle)) {
@@ -368,7 +365,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             }
 
             // Reversable Motors are like Motors but go to neutral instead of minimum
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
+            if (mixerType[ct] == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
                 // If not armed or motor is inactive - no "spinwhilearmed" for this engine type
                 if (!armed || !activeThrottle) {
                     filterAccumulator[ct] = 0;
@@ -383,20 +380,20 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // these also will not be updated in failsafe mode.  I'm not sure what
             // the correct behavior is since it seems domain specific.  I don't love
             // this code
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
-                if (AccessoryDesiredInstGet(mixers[ct].type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
+            if ((mixerType[ct] >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
+                (mixerType[ct] <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
+                if (AccessoryDesiredInstGet(mixerType[ct] - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
                     status[ct] = accessory.AccessoryVal;
                 } else {
                     status[ct] = -1;
                 }
             }
 
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
+            if ((mixerType[ct] >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
+                (mixerType[ct] <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
                 CameraDesiredData cameraDesired;
                 if (CameraDesiredGet(&cameraDesired) == 0) {
-                    switch (mixers[ct].type) {
+                    switch (mixerType[ct]) {
                     case MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1:
                         status[ct] = cameraDesired.RollOrServo1;
                         break;
@@ -467,91 +464,53 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
 
 /**
- * Process mixing for one actuator
+ * Apply idle throttle, feed forward and acceleration limit to the mixed
+ * output of one motor.
+ * note: no feedforward for reversable motors yet for safety reasons
  */
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired, const float period)
+static float ProcessMotorMixer(const int index, float result, const MixerSettingsData *mixerSettings, const float period)
 {
     static float lastFilteredResult[MAX_MIX_ACTUATORS];
-    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
-    const Mixer_t *mixer  = &mixers[index];
-
-    float result = (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] / 128.0f) * curve1) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] / 128.0f) * curve2) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL] / 128.0f) * desired->Roll) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH] / 128.0f) * desired->Pitch) +
-                   (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW] / 128.0f) * desired->Yaw);
-
-    // note: no feedforward for reversable motors yet for safety reasons
-    if (mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
-        if (result < 0.0f) { // idle throttle
-            result = 0.0f;
-        }
 
-        // feed forward
-        float accumulator = filterAccumulator[index];
-        accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
-        lastResult[index] = result;
-        result += accumulator;
-        if (period > 0.0f) {
-            if (accumulator > 0.0f) {
-                float invFilter = period / mixerSettings->AccelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
-            } else {
-                float invFilter = period / mixerSettings->DecelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
+    if (result < 0.0f) { // idle throttle
+        result = 0.0f;
+    }
+
+    // feed forward
+    float accumulator = filterAccumulator[index];
+    accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
+    lastResult[index] = result;
+    result += accumulator;
+    if (period > 0.0f) {
+        if (accumulator > 0.0f) {
+            float invFilter = period / mixerSettings->AccelTime;
+            if (invFilter > 1) {
+                invFilter = 1;
             }
+            accumulator -= accumulator * invFilter;
+        } else {
+            float invFilter = period / mixerSettings->DecelTime;
+            if (invFilter > 1) {
+                invFilter = 1;
+            }
+            accumulator -= accumulator * invFilter;
         }
-        filterAccumulator[index] = accumulator;
-        result += accumulator;
-
-        // acceleration limit
-        float dt    = result - lastFilteredResult[index];
-        float maxDt = mixerSettings->MaxAccel * period;
-        if (dt > maxDt) { // we are accelerating too hard
-            result = lastFilteredResult[index] + maxDt;
-        }
-        lastFilteredResult[index] = result;
     }
+    filterAccumulator[index] = accumulator;
+    result += accumulator;
+
+    // acceleration limit
+    float dt    = result - lastFilteredResult[index];
+    float maxDt = mixerSettings->MaxAccel * period;
+    if (dt > maxDt) { // we are accelerating too hard
+        result = lastFilteredResult[index] + maxDt;
+    }
+    lastFilteredResult[index] = result;
 
     return result;
 }
 
 
-/**
- * Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
- * Output is in the range 0 to 1.
- */
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements)
-{
-    float scale = throttle * (float)(elements - 1);
-    int idx1    = scale;
-
-    scale -= (float)idx1; // remainder
-    if (curve[0] < -1) {
-        return throttle;
-    }
-    if (idx1 < 0) {
-        idx1  = 0; // clamp to lowest entry in table
-        scale = 0;
-    }
-    int idx2 = idx1 + 1;
-    if (idx2 >= elements) {
-        idx2 = elements - 1; // clamp to highest entry in table
-        if (idx1 >= elements) {
-            idx1 = elements - 1;
-        }
-    }
-    return curve[idx1] * (1.0f - scale) + curve[idx2] * scale;
-}
-
-
 /**
  * Convert channel from -1/+1 to servo pulse duration in microseconds
  */
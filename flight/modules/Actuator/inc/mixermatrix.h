@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup ActuatorModule Actuator Module
+ * @{
+ *
+ * @file       mixermatrix.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Precomputed mixer matrix used by the actuator module.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MIXERMATRIX_H
+#define MIXERMATRIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mixersettings.h"
+#include "actuatorcommand.h"
+
+#define MIXERMATRIX_MIXERS       ACTUATORCOMMAND_CHANNEL_NUMELEM
+#define MIXERMATRIX_INPUTS       MIXERSETTINGS_MIXER1VECTOR_NUMELEM
+#define MIXERMATRIX_CURVE_POINTS MIXERSETTINGS_THROTTLECURVE1_NUMELEM
+
+// this structure is equivalent to the UAVObjects for one mixer.
+typedef struct {
+    uint8_t type;
+    int8_t  matrix[MIXERMATRIX_INPUTS];
+} __attribute__((packed)) Mixer_t;
+
+// a throttle curve, ready to be interpolated
+typedef struct {
+    float points[MIXERMATRIX_CURVE_POINTS];
+    bool  passthrough; // curve disabled, output follows the input
+} MixerCurve_t;
+
+/*
+ * MixerSettings compiled into the form used every control cycle.
+ * Rows of matrix are indexed by mixer, columns by the
+ * MIXERSETTINGS_MIXER1VECTOR_* inputs, already scaled from int8 to float.
+ */
+typedef struct {
+    float    matrix[MIXERMATRIX_MIXERS][MIXERMATRIX_INPUTS];
+    uint8_t  type[MIXERMATRIX_MIXERS];
+    uint16_t mixed;   // bitmask of mixers whose output comes from the matrix
+    uint8_t  nMixers; // number of mixers that are not disabled
+    MixerCurve_t curve1;
+    MixerCurve_t curve2;
+} MixerMatrix_t;
+
+void MixerMatrixCompile(MixerMatrix_t *mixerMatrix, const MixerSettingsData *mixerSettings);
+float MixerMatrixCurve(const MixerCurve_t *curve, const float input);
+void MixerMatrixApply(const MixerMatrix_t *mixerMatrix, const float input[MIXERMATRIX_INPUTS], float output[MIXERMATRIX_MIXERS]);
+
+#endif // MIXERMATRIX_H
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup ActuatorModule Actuator Module
+ * @{
+ *
+ * @file       mixermatrix.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Precomputed mixer matrix used by the actuator module.
+ *             MixerSettings are compiled once when they change, each control
+ *             cycle then only interpolates the curves and does one small
+ *             matrix-vector multiply.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+
+#include "mixermatrix.h"
+
+static void compileCurve(MixerCurve_t *curve);
+
+/**
+ * Compile MixerSettings into a mixer matrix
+ * \param[out] mixerMatrix the compiled mixer
+ * \param[in] mixerSettings the settings to compile
+ */
+void MixerMatrixCompile(MixerMatrix_t *mixerMatrix, const MixerSettingsData *mixerSettings)
+{
+    // Note this code depends on the UAVObjects for the mixers being all being the same
+    // and in sequence. If you change the object definition, make sure you check the code!
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type;
+
+    mixerMatrix->mixed   = 0;
+    mixerMatrix->nMixers = 0;
+
+    for (int ct = 0; ct < MIXERMATRIX_MIXERS; ct++) {
+        mixerMatrix->type[ct] = mixers[ct].type;
+
+        if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            mixerMatrix->nMixers++;
+        }
+
+        if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) ||
+            (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) ||
+            (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
+            mixerMatrix->mixed |= (1 << ct);
+        }
+
+        // dividing by a power of two is exact, so this is bit identical to scaling every cycle
+        for (int in = 0; in < MIXERMATRIX_INPUTS; in++) {
+            mixerMatrix->matrix[ct][in] = (float)mixers[ct].matrix[in] / 128.0f;
+        }
+    }
+
+    memcpy(mixerMatrix->curve1.points, mixerSettings->ThrottleCurve1, sizeof(mixerMatrix->curve1.points));
+    compileCurve(&mixerMatrix->curve1);
+    memcpy(mixerMatrix->curve2.points, mixerSettings->ThrottleCurve2, sizeof(mixerMatrix->curve2.points));
+    compileCurve(&mixerMatrix->curve2);
+}
+
+/**
+ * Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
+ * Output is in the range 0 to 1.
+ */
+float MixerMatrixCurve(const MixerCurve_t *curve, const float input)
+{
+    if (curve->passthrough) {
+        return input;
+    }
+
+    float scale = input * (float)(MIXERMATRIX_CURVE_POINTS - 1);
+    int idx1    = scale;
+
+    scale -= (float)idx1; // remainder
+    if (idx1 < 0) {
+        idx1  = 0; // clamp to lowest entry in table
+        scale = 0;
+    }
+    int idx2 = idx1 + 1;
+    if (idx2 >= MIXERMATRIX_CURVE_POINTS) {
+        idx2 = MIXERMATRIX_CURVE_POINTS - 1; // clamp to highest entry in table
+        if (idx1 >= MIXERMATRIX_CURVE_POINTS) {
+            idx1 = MIXERMATRIX_CURVE_POINTS - 1;
+        }
+    }
+    return curve->points[idx1] * (1.0f - scale) + curve->points[idx2] * scale;
+}
+
+/**
+ * Evaluate the mixer matrix. Only the outputs of mixers flagged in
+ * mixerMatrix->mixed are written.
+ * \param[in] input the MIXERSETTINGS_MIXER1VECTOR_* inputs
+ * \param[out] output one value per mixer
+ */
+void MixerMatrixApply(const MixerMatrix_t *mixerMatrix, const float input[MIXERMATRIX_INPUTS], float output[MIXERMATRIX_MIXERS])
+{
+    for (int ct = 0; ct < MIXERMATRIX_MIXERS; ct++) {
+        if (!(mixerMatrix->mixed & (1 << ct))) {
+            continue;
+        }
+
+        const float *row = mixerMatrix->matrix[ct];
+
+        // sum in input order, which keeps the result bit identical to the per-channel mixing
+        float result = row[0] * input[0];
+        for (int in = 1; in < MIXERMATRIX_INPUTS; in++) {
+            result += row[in] * input[in];
+        }
+        output[ct] = result;
+    }
+}
+
+static void compileCurve(MixerCurve_t *curve)
+{
+    // a first point below -1 disables the curve
+    curve->passthrough = curve->points[0] < -1;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -82,6 +82,8 @@ static float GravityAccel(float latitude, float longitude, float altitude);
 
 #define TASK_PRIORITY              (tskIDLE_PRIORITY + 1)
 
+#define GPS_RX_CHUNK_SIZE          32
+
 // ****************
 // Private variables
 
@@ -91,6 +93,8 @@ static bool gpsEnabled = false;
 static xTaskHandle gpsTaskHandle;
 
 static char *gps_rx_buffer;
+// bytes are drained from the COM fifo in chunks rather than one call per byte
+static uint8_t gps_rx_chunk[GPS_RX_CHUNK_SIZE];
 
 static uint32_t timeOfLastCommandMs;
 static uint32_t timeOfLastUpdateMs;
@@ -217,31 +221,34 @@ static void gpsTask(__attribute__((unused)) void *parameters)
     GPSPositionSensorGet(&gpspositionsensor);
     // Loop forever
     while (1) {
-        uint8_t c;
+        uint16_t cnt;
 
         // This blocks the task until there is something on the buffer
-        while (PIOS_COM_ReceiveBuffer(gpsPort, &c, 1, xDelay) > 0) {
-            int res;
-            switch (gpsSettings.DataProtocol) {
+        while ((cnt = PIOS_COM_ReceiveBuffer(gpsPort, gps_rx_chunk, sizeof(gps_rx_chunk), xDelay)) > 0) {
+            for (uint16_t i = 0; i < cnt; i++) {
+                uint8_t c = gps_rx_chunk[i];
+                int res;
+                switch (gpsSettings.DataProtocol) {
 #if defined(PIOS_INCLUDE_GPS_NMEA_PARSER)
-            case GPSSETTINGS_DATAPROTOCOL_NMEA:
-                res = parse_nmea_stream(c, gps_rx_buffer, &gpspositionsensor, &gpsRxStats);
-                break;
+                case GPSSETTINGS_DATAPROTOCOL_NMEA:
+                    res = parse_nmea_stream(c, gps_rx_buffer, &gpspositionsensor, &gpsRxStats);
+                    break;
 #endif
 #if defined(PIOS_INCLUDE_GPS_UBX_PARSER)
-            case GPSSETTINGS_DATAPROTOCOL_UBX:
-                res = parse_ubx_stream(c, gps_rx_buffer, &gpspositionsensor, &gpsRxStats);
-                break;
+                case GPSSETTINGS_DATAPROTOCOL_UBX:
+                    res = parse_ubx_stream(c, gps_rx_buffer, &gpspositionsensor, &gpsRxStats);
+                    break;
 #endif
-            default:
-                res = NO_PARSER; // this should not happen
-                break;
-            }
+                default:
+                    res = NO_PARSER; // this should not happen
+                    break;
+                }
 
-            if (res == PARSER_COMPLETE) {
-                timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
-                timeOfLastUpdateMs = timeNowMs;
-                timeOfLastCommandMs = timeNowMs;
+                if (res == PARSER_COMPLETE) {
+                    timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
+                    timeOfLastUpdateMs  = timeNowMs;
+                    timeOfLastCommandMs = timeNowMs;
+                }
             }
         }
 
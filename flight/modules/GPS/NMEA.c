@@ -77,104 +77,204 @@ static bool nmeaProcessGPZDA(GPSPositionSensorData *GpsData, bool *gpsDataUpdate
 static bool nmeaProcessGPGSV(GPSPositionSensorData *GpsData, bool *gpsDataUpdated, char *param[], uint8_t nbParam);
 #endif // PIOS_GPS_MINIMAL
 
-static const struct nmea_parser nmea_parsers[] = {
-    {
+/*
+ * The parser table is indexed by a perfect hash over the three sentence
+ * type characters following the talker id (see NMEA_prefix_hash()), so a
+ * sentence is dispatched with a single table lookup and one compare.
+ */
+#define NMEA_PREFIX_LENGTH 5
+#define NMEA_PARSER_SLOTS  8
+
+static const struct nmea_parser nmea_parsers[NMEA_PARSER_SLOTS] = {
+    [4] = {
         .prefix  = "GPGGA",
         .handler = nmeaProcessGPGGA,
     },
-    {
+    [7] = {
         .prefix  = "GPVTG",
         .handler = nmeaProcessGPVTG,
     },
-    {
+    [0] = {
         .prefix  = "GPGSA",
         .handler = nmeaProcessGPGSA,
     },
-    {
+    [6] = {
         .prefix  = "GPRMC",
         .handler = nmeaProcessGPRMC,
     },
 #if !defined(PIOS_GPS_MINIMAL)
-    {
+    [1] = {
         .prefix  = "GPZDA",
         .handler = nmeaProcessGPZDA,
     },
-    {
+    [5] = {
         .prefix  = "GPGSV",
         .handler = nmeaProcessGPGSV,
     },
 #endif // PIOS_GPS_MINIMAL
 };
 
+/* Tokenizer states */
+enum nmea_rx_state {
+    NMEA_RX_SYNC,     // waiting for '$'
+    NMEA_RX_PAYLOAD,  // collecting fields up to '*'
+    NMEA_RX_SKIP,     // past MAX_NB_PARAMS fields, only checksumming up to '*'
+    NMEA_RX_CHK1,     // first checksum digit
+    NMEA_RX_CHK2,     // second checksum digit
+    NMEA_RX_CR,       // waiting for '\r'
+    NMEA_RX_LF,       // waiting for '\n'
+};
+
+/*
+ * Sentence tokenizer state. The sentence is split into zero-terminated
+ * fields and its checksum is accumulated while the bytes arrive, so a
+ * complete sentence is handed to its parser without any further pass
+ * over the buffer.
+ */
+static struct {
+    char    *params[MAX_NB_PARAMS];
+    uint8_t nbParams;
+    uint8_t rx_count;
+    uint8_t checksum_computed;
+    uint8_t checksum_received;
+    enum nmea_rx_state state;
+} nmea_rx;
+
+static bool NMEA_dispatch(char *param[], uint8_t nbParam, GPSPositionSensorData *GpsData);
+
+static inline int8_t NMEA_hex_digit(uint8_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
 int parse_nmea_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
-    static uint8_t rx_count = 0;
-    static bool start_flag  = false;
-    static bool found_cr    = false;
-
-    // detect start while acquiring stream
-    if (!start_flag && (c == '$')) { // NMEA identifier found
-        start_flag = true;
-        found_cr   = false;
-        rx_count   = 0;
-    } else if (!start_flag) {
-        return PARSER_ERROR;
+    int8_t digit;
+
+    // '$' always (re)starts a sentence, it can't occur anywhere else
+    if (c == '$') {
+        nmea_rx.state     = NMEA_RX_PAYLOAD;
+        nmea_rx.rx_count  = 0;
+        nmea_rx.checksum_computed = 0;
+        nmea_rx.params[0] = gps_rx_buffer;
+        nmea_rx.nbParams  = 1;
+        return PARSER_INCOMPLETE;
     }
 
-    if (rx_count >= NMEA_MAX_PACKET_LENGTH) {
-        // The buffer is already full and we haven't found a valid NMEA sentence.
-        // Flush the buffer and note the overflow event.
-        gpsRxStats->gpsRxOverflow++;
-        start_flag = false;
-        found_cr   = false;
-        rx_count   = 0;
-        return PARSER_OVERRUN;
-    } else {
-        gps_rx_buffer[rx_count] = c;
-        rx_count++;
-    }
-
-    // look for ending '\r\n' sequence
-    if (!found_cr && (c == '\r')) {
-        found_cr = true;
-    } else if (found_cr && (c != '\n')) {
-        found_cr = false; // false end flag
-    } else if (found_cr && (c == '\n')) {
-        // The NMEA functions require a zero-terminated string
-        // As we detected \r\n, the string as for sure 2 bytes long, we will also strip the \r\n
-        gps_rx_buffer[rx_count - 2] = 0;
-
-        // prepare to parse next sentence
-        start_flag = false;
-        found_cr   = false;
-        rx_count   = 0;
-        // Our rxBuffer must look like this now:
-        // [0]           = '$'
-        // ...           = zero or more bytes of sentence payload
-        // [end_pos - 1] = '\r'
-        // [end_pos]     = '\n'
-        //
-        // Prepare to consume the sentence from the buffer
+    switch (nmea_rx.state) {
+    case NMEA_RX_SYNC:
+        return PARSER_ERROR;
+
+    case NMEA_RX_PAYLOAD:
+        // keep room for the terminating zero of the last field
+        if (nmea_rx.rx_count >= NMEA_MAX_PACKET_LENGTH - 1) {
+            // The buffer is already full and we haven't found a valid NMEA sentence.
+            // Flush the buffer and note the overflow event.
+            gpsRxStats->gpsRxOverflow++;
+            nmea_rx.state = NMEA_RX_SYNC;
+            return PARSER_OVERRUN;
+        }
+        if (c == '*') {
+            gps_rx_buffer[nmea_rx.rx_count++] = 0;
+            nmea_rx.state = NMEA_RX_CHK1;
+            break;
+        }
+        nmea_rx.checksum_computed ^= c;
+        if (c == ',') {
+            // Zero-terminate this parameter and start the next one
+            gps_rx_buffer[nmea_rx.rx_count++] = 0;
+            if (nmea_rx.nbParams == MAX_NB_PARAMS) {
+                // No room for more parameters, the rest of the sentence is ignored
+                nmea_rx.state = NMEA_RX_SKIP;
+                break;
+            }
+            nmea_rx.params[nmea_rx.nbParams++] = &gps_rx_buffer[nmea_rx.rx_count];
+        } else if (c == '\r' || c == '\n') {
+            // Sentence ended without a checksum
+            gpsRxStats->gpsRxChkSumError++;
+            nmea_rx.state = NMEA_RX_SYNC;
+            return PARSER_ERROR;
+        } else {
+            gps_rx_buffer[nmea_rx.rx_count++] = c;
+        }
+        break;
+
+    case NMEA_RX_SKIP:
+        if (c == '*') {
+            nmea_rx.state = NMEA_RX_CHK1;
+        } else if (c == '\r' || c == '\n') {
+            // Sentence ended without a checksum
+            gpsRxStats->gpsRxChkSumError++;
+            nmea_rx.state = NMEA_RX_SYNC;
+            return PARSER_ERROR;
+        } else {
+            nmea_rx.checksum_computed ^= c;
+        }
+        break;
+
+    case NMEA_RX_CHK1:
+    case NMEA_RX_CHK2:
+        digit = NMEA_hex_digit(c);
+        if (digit < 0) {
+            gpsRxStats->gpsRxChkSumError++;
+            nmea_rx.state = NMEA_RX_SYNC;
+            return PARSER_ERROR;
+        }
+        if (nmea_rx.state == NMEA_RX_CHK1) {
+            nmea_rx.checksum_received = digit << 4;
+            nmea_rx.state = NMEA_RX_CHK2;
+        } else {
+            nmea_rx.checksum_received |= digit;
+            nmea_rx.state = NMEA_RX_CR;
+        }
+        break;
+
+    case NMEA_RX_CR:
+        nmea_rx.state = (c == '\r') ? NMEA_RX_LF : NMEA_RX_SYNC;
+        break;
+
+    case NMEA_RX_LF:
+        nmea_rx.state = NMEA_RX_SYNC;
+        if (c != '\n') {
+            break;
+        }
 
+#ifdef DEBUG_MSG_IN
+        DEBUG_MSG("\"%s\"\n", nmea_rx.params[0]);
+#endif
         // Validate the checksum over the sentence
-        if (!NMEA_checksum(&gps_rx_buffer[1])) { // Invalid checksum.  May indicate dropped characters on Rx.
-                                                 // PIOS_DEBUG_PinHigh(2);
+        if (nmea_rx.checksum_computed != nmea_rx.checksum_received) {
+            // Invalid checksum.  May indicate dropped characters on Rx.
             gpsRxStats->gpsRxChkSumError++;
-            // PIOS_DEBUG_PinLow(2);
             return PARSER_ERROR;
-        } else { // Valid checksum, use this packet to update the GPS position
-            if (!NMEA_update_position(&gps_rx_buffer[1], GpsData)) {
-                // PIOS_DEBUG_PinHigh(2);
-                gpsRxStats->gpsRxParserError++;
-                // PIOS_DEBUG_PinLow(2);
-            } else {
-                gpsRxStats->gpsRxReceived++;
-            };
-
-            return PARSER_COMPLETE;
         }
+
+        // Valid checksum, use this packet to update the GPS position
+        if (!NMEA_dispatch(nmea_rx.params, nmea_rx.nbParams, GpsData)) {
+            gpsRxStats->gpsRxParserError++;
+        } else {
+            gpsRxStats->gpsRxReceived++;
+        }
+        return PARSER_COMPLETE;
     }
-    return PARSER_INCOMPLETE;
+
+    return (nmea_rx.state == NMEA_RX_SYNC) ? PARSER_ERROR : PARSER_INCOMPLETE;
+}
+
+/*
+ * Perfect hash over the sentence type, valid for the sentences we parse.
+ * Anything else either lands on an empty slot or fails the prefix compare.
+ */
+static inline uint8_t NMEA_prefix_hash(const char *prefix)
+{
+    return (2 * prefix[2] + 3 * prefix[3] + prefix[4]) & (NMEA_PARSER_SLOTS - 1);
 }
 
 static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
@@ -183,18 +283,24 @@ static const struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
         return NULL;
     }
 
-    for (uint8_t i = 0; i < NELEMENTS(nmea_parsers); i++) {
-        const struct nmea_parser *parser = &nmea_parsers[i];
-
-        /* Use strcmp to check for exact equality over the entire prefix */
-        if (!strcmp(prefix, parser->prefix)) {
-            /* Found an appropriate parser */
-            return parser;
+    /* Every supported prefix is exactly NMEA_PREFIX_LENGTH characters long */
+    for (uint8_t i = 0; i < NMEA_PREFIX_LENGTH; i++) {
+        if (prefix[i] == '\0') {
+            return NULL;
         }
     }
+    if (prefix[NMEA_PREFIX_LENGTH] != '\0') {
+        return NULL;
+    }
+
+    const struct nmea_parser *parser = &nmea_parsers[NMEA_prefix_hash(prefix)];
+
+    if (!parser->handler || memcmp(prefix, parser->prefix, NMEA_PREFIX_LENGTH)) {
+        /* No matching parser for this prefix */
+        return NULL;
+    }
 
-    /* No matching parser for this prefix */
-    return NULL;
+    return parser;
 }
 
 /**
@@ -227,6 +333,13 @@ bool NMEA_checksum(char *nmea_sentence)
     return checksum_computed == checksum_received;
 }
 
+/* Maximum number of fractional digits taken into account */
+#define NMEA_MAX_FRACT_DIGITS 9
+
+static const float nmea_pow10_neg[NMEA_MAX_FRACT_DIGITS + 1] = {
+    1.0f, 1e-1f, 1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f, 1e-9f
+};
+
 /*
  * This function only exists to deal with a linking
  * failure in the stdlib function strtof().  This
@@ -236,104 +349,113 @@ bool NMEA_checksum(char *nmea_sentence)
 
 /* Parse a number encoded in a string of the format:
  *   [-]NN.nnnnn
- * into a signed whole part and an unsigned fractional part.
+ * into an unsigned whole part, an unsigned fractional part and a sign.
  * The fract_units field indicates the units of the fractional part as
  *   1 whole = 10^fract_units fract
+ * Fractional digits beyond NMEA_MAX_FRACT_DIGITS are ignored.
  */
-static bool NMEA_parse_real(int32_t *whole, uint32_t *fract, uint8_t *fract_units, char *field)
+static bool NMEA_parse_real(uint32_t *whole, uint32_t *fract, uint8_t *fract_units, bool *negative, const char *field)
 {
-    char *s = field;
-    char *field_w;
-    char *field_f;
+    const char *s = field;
 
     PIOS_DEBUG_Assert(whole);
     PIOS_DEBUG_Assert(fract);
     PIOS_DEBUG_Assert(fract_units);
+    PIOS_DEBUG_Assert(negative);
     PIOS_DEBUG_Assert(field);
 
-    field_w = strsep(&s, ".");
-    field_f = s;
+    *whole       = 0;
+    *fract       = 0;
+    *fract_units = 0;
+    *negative    = (*s == '-');
+
+    if (*s == '-' || *s == '+') {
+        s++;
+    }
 
-    *whole  = strtol(field_w, NULL, 10);
+    while (*s >= '0' && *s <= '9') {
+        *whole = *whole * 10 + (*s++ - '0');
+    }
 
-    if (field_w) {
+    if (*s == '.') {
         /* decimal was found so we may have a fractional part */
-        *fract = strtoul(field_f, NULL, 10);
-        *fract_units = strlen(field_f);
-    } else {
-        /* no decimal was found, fractional part is zero */
-        *fract = 0;
-        *fract_units = 0;
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            if (*fract_units < NMEA_MAX_FRACT_DIGITS) {
+                *fract = *fract * 10 + (*s - '0');
+                (*fract_units)++;
+            }
+            s++;
+        }
     }
 
-    return true;
+    /* anything left over means this was not a number */
+    return *s == '\0';
 }
 
-static float NMEA_real_to_float(char *nmea_real)
+static float NMEA_real_to_float(const char *nmea_real)
 {
-    int32_t whole;
+    uint32_t whole;
     uint32_t fract;
     uint8_t fract_units;
+    bool negative;
 
-    if (!NMEA_parse_real(&whole, &fract, &fract_units, nmea_real)) {
-        return false;
-    }
+    /* Like strtof(), use whatever leading part of the field is numeric */
+    NMEA_parse_real(&whole, &fract, &fract_units, &negative, nmea_real);
 
     /* Convert to float */
-    return ((float)whole) + fract * powf(10.0f, -fract_units);
+    float value = ((float)whole) + fract * nmea_pow10_neg[fract_units];
+
+    return negative ? -value : value;
 }
 
 /*
  * Parse a field in the format:
  *    DD[D]MM.mmmm[mm]
  * into a fixed-point representation in units of (degrees * 1e-7)
+ * using integer arithmetic only.
  */
-static bool NMEA_latlon_to_fixed_point(int32_t *latlon, char *nmea_latlon, bool negative)
+static bool NMEA_latlon_to_fixed_point(int32_t *latlon, const char *nmea_latlon, bool negative)
 {
-    int32_t num_DDDMM;
-    uint32_t num_m;
-    uint8_t units;
+    uint32_t num_DDDMM = 0;
+    uint32_t num_m     = 0;
+    uint8_t units = 0;
+    const char *s = nmea_latlon;
 
     /* Sanity checks */
     PIOS_DEBUG_Assert(nmea_latlon);
     PIOS_DEBUG_Assert(latlon);
 
-    if (*nmea_latlon == '\0') { /* empty lat/lon field */
+    if (*s == '\0') { /* empty lat/lon field */
         return false;
     }
 
-    if (!NMEA_parse_real(&num_DDDMM, &num_m, &units, nmea_latlon)) {
+    while (*s >= '0' && *s <= '9') {
+        num_DDDMM = num_DDDMM * 10 + (*s++ - '0');
+    }
+
+    /* collect the mmmm[mm] field scaled to exactly six digits */
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            if (units < 6) {
+                num_m = num_m * 10 + (*s - '0');
+                units++;
+            }
+            s++;
+        }
+    }
+
+    if (*s != '\0') {
         return false;
     }
 
-    /* scale up the mmmm[mm] field apropriately depending on # of digits */
-    /* not using 1eN notation because that forces fixed point and lost precision */
-    switch (units) {
-    case 0:
-        /* no digits, value is zero so no scaling */
-        break;
-    case 1: /* m       */
-        num_m *= 1000000; /* m000000 */
-        break;
-    case 2: /* mm      */
-        num_m *= 100000; /* mm00000 */
-        break;
-    case 3: /* mmm     */
-        num_m *= 10000; /* mmm0000 */
-        break;
-    case 4: /* mmmm    */
-        num_m *= 1000; /* mmmm000 */
-        break;
-    case 5: /* mmmmm   */
-        num_m *= 100; /* mmmmm00 */
-        break;
-    case 6: /* mmmmmm  */
+    if (units > 0) {
+        while (units < 6) {
+            num_m *= 10;
+            units++;
+        }
         num_m *= 10; /* mmmmmm0 */
-        break;
-    default:
-        /* unhandled format */
-        num_m = 0.0f;
-        break;
     }
 
     *latlon  = (num_DDDMM / 100) * 10000000;        /* scale the whole degrees */
@@ -388,7 +510,17 @@ bool NMEA_update_position(char *nmea_sentence, GPSPositionSensorData *GpsData)
         p++;
     }
 
+    return NMEA_dispatch(params, nbParams, GpsData);
+}
 
+/**
+ * Hands an already tokenized sentence to its parser
+ * \param[in] The sentence split into zero-terminated parameters
+ * \return true if the sentence was successfully parsed
+ * \return false if any errors were encountered with the parsing
+ */
+static bool NMEA_dispatch(char *params[], uint8_t nbParams, GPSPositionSensorData *GpsData)
+{
 #ifdef DEBUG_PARAMS
     int i;
     for (i = 0; i < nbParams; i++) {
@@ -37,6 +37,9 @@
 #include "GPS.h"
 
 // parse incoming character stream for messages in UBX binary format
+// The message is assembled in place in gps_rx_buffer and its Fletcher checksum
+// is accumulated while the bytes arrive, so a complete message is parsed
+// straight from the receive buffer without another pass over it.
 
 int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
@@ -54,8 +57,15 @@ int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsD
     };
 
     static enum proto_states proto_state = START;
-    static uint8_t rx_count = 0;
-    struct UBXPacket *ubx   = (struct UBXPacket *)gps_rx_buffer;
+    static uint16_t rx_count = 0;
+    static uint8_t ck_a, ck_b;
+    struct UBXPacket *ubx    = (struct UBXPacket *)gps_rx_buffer;
+
+    // the checksum covers everything from the class byte up to the end of the payload
+    if (proto_state >= UBX_CLASS && proto_state <= UBX_PAYLOAD) {
+        ck_a += c;
+        ck_b += ck_a;
+    }
 
     switch (proto_state) {
     case START: // detect protocol
@@ -66,6 +76,8 @@ int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsD
     case UBX_SY2:
         if (c == UBX_SYNC2) { // second UBX sync char found
             proto_state = UBX_CLASS;
+            ck_a = 0;
+            ck_b = 0;
         } else {
             proto_state = START; // reset state
         }
@@ -87,20 +99,17 @@ int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsD
         if (ubx->header.len > sizeof(UBXPayload)) {
             gpsRxStats->gpsRxOverflow++;
             proto_state = START;
+        } else if (ubx->header.len == 0) {
+            proto_state = UBX_CHK1;
         } else {
             rx_count    = 0;
             proto_state = UBX_PAYLOAD;
         }
         break;
     case UBX_PAYLOAD:
-        if (rx_count < ubx->header.len) {
-            ubx->payload.payload[rx_count] = c;
-            if (++rx_count == ubx->header.len) {
-                proto_state = UBX_CHK1;
-            }
-        } else {
-            gpsRxStats->gpsRxOverflow++;
-            proto_state = START;
+        ubx->payload.payload[rx_count] = c;
+        if (++rx_count == ubx->header.len) {
+            proto_state = UBX_CHK1;
         }
         break;
     case UBX_CHK1:
@@ -109,7 +118,7 @@ int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsD
         break;
     case UBX_CHK2:
         ubx->header.ck_b = c;
-        if (checksum_ubx_message(ubx)) { // message complete and valid
+        if (ubx->header.ck_a == ck_a && ubx->header.ck_b == ck_b) { // message complete and valid
             parse_ubx_message(ubx, GpsData);
             proto_state = FINISHED;
         } else {
@@ -131,7 +140,6 @@ int parse_ubx_stream(uint8_t c, char *gps_rx_buffer, GPSPositionSensorData *GpsD
     return PARSER_INCOMPLETE; // message not (yet) complete
 }
 
-
 // Keep track of various GPS messages needed to make up a single UAVO update
 // time-of-week timestamp is used to correlate matching messages
 
@@ -163,36 +171,6 @@ bool check_msgtracker(uint32_t tow, uint8_t msg_flag)
     return true;
 }
 
-bool checksum_ubx_message(struct UBXPacket *ubx)
-{
-    int i;
-    uint8_t ck_a, ck_b;
-
-    ck_a  = ubx->header.class;
-    ck_b  = ck_a;
-
-    ck_a += ubx->header.id;
-    ck_b += ck_a;
-
-    ck_a += ubx->header.len & 0xff;
-    ck_b += ck_a;
-
-    ck_a += ubx->header.len >> 8;
-    ck_b += ck_a;
-
-    for (i = 0; i < ubx->header.len; i++) {
-        ck_a += ubx->payload.payload[i];
-        ck_b += ck_a;
-    }
-
-    if (ubx->header.ck_a == ck_a &&
-        ubx->header.ck_b == ck_b) {
-        return true;
-    } else {
-        return false;
-    }
-}
-
 void parse_ubx_nav_posllh(struct UBX_NAV_POSLLH *posllh, GPSPositionSensorData *GpsPosition)
 {
     if (check_msgtracker(posllh->iTOW, POSLLH_RECEIVED)) {
@@ -53,6 +53,7 @@
 #include <taskinfo.h>
 #include <watchdogstatus.h>
 #include <callbackinfo.h>
+#include <callbacklatency.h>
 #include <hwsettings.h>
 #include <pios_flashfs.h>
 
@@ -79,6 +80,8 @@
 
 // Private constants
 #define SYSTEM_UPDATE_PERIOD_MS 250
+// Window the CallbackLatency histograms cover, the object is sent once per window
+#define CALLBACK_LATENCY_PERIOD_MS 10000
 
 #if defined(PIOS_SYSTEM_STACK_SIZE)
 #define STACK_SIZE_BYTES        PIOS_SYSTEM_STACK_SIZE
@@ -98,6 +101,10 @@ static bool mallocFailed;
 static HwSettingsData bootHwSettings;
 static FrameType_t bootFrameType;
 static struct PIOS_FLASHFS_Stats fsStats;
+#ifdef DIAG_TASKS
+static CallbackLatencyData callbackLatency[CALLBACKINFO_RUNNING_NUMELEM];
+static portTickType callbackLatencyStart;
+#endif
 
 // Private functions
 static void objectUpdatedCb(UAVObjEvent *ev);
@@ -105,6 +112,7 @@ static void checkSettingsUpdatedCb(UAVObjEvent *ev);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
+static void updateCallbackLatency();
 #endif
 static void updateStats();
 static void updateSystemAlarms();
@@ -148,6 +156,11 @@ int32_t SystemModInitialize(void)
 #ifdef DIAG_TASKS
     TaskInfoInitialize();
     CallbackInfoInitialize();
+    CallbackLatencyInitialize();
+    // one CallbackLatency instance per CallbackInfo element
+    for (uint16_t instance = 1; instance < CALLBACKINFO_RUNNING_NUMELEM; instance++) {
+        CallbackLatencyCreateInstance();
+    }
 #endif
 #ifdef DIAG_I2C_WDG_STATS
     I2CStatsInitialize();
@@ -229,6 +242,7 @@ static void systemTask(__attribute__((unused)) void *parameters)
 // if(FALSE){
         PIOS_CALLBACKSCHEDULER_ForEachCallback(callbackSchedulerForEachCallback, &callbackInfoData);
         CallbackInfoSet(&callbackInfoData);
+        updateCallbackLatency();
 // }
 #endif
 // }
@@ -442,6 +456,40 @@ static void callbackSchedulerForEachCallback(int16_t callback_id, const struct p
     ((uint8_t *)&callbackData->Running)[callback_id] = callback_info->is_running;
     ((uint32_t *)&callbackData->RunningTime)[callback_id]   = callback_info->running_time_count;
     ((int16_t *)&callbackData->StackRemaining)[callback_id] = callback_info->stack_remaining;
+
+    // latency histograms, the scheduler restarts them with every report, they
+    // are added up until the window of the CallbackLatency object is over
+    CallbackLatencyData *latencyData = &callbackLatency[callback_id];
+    for (uint8_t i = 0; i < PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS; i++) {
+        uint32_t dispatch  = ((uint16_t *)&latencyData->DispatchLatency)[i] + callback_info->dispatch_latency[i];
+        uint32_t execution = ((uint16_t *)&latencyData->ExecutionTime)[i] + callback_info->execution_time[i];
+        ((uint16_t *)&latencyData->DispatchLatency)[i] = (dispatch > UINT16_MAX) ? UINT16_MAX : dispatch;
+        ((uint16_t *)&latencyData->ExecutionTime)[i]   = (execution > UINT16_MAX) ? UINT16_MAX : execution;
+    }
+    if (callback_info->max_dispatch_latency > latencyData->MaxDispatchLatency) {
+        latencyData->MaxDispatchLatency = callback_info->max_dispatch_latency;
+    }
+    if (callback_info->max_execution_time > latencyData->MaxExecutionTime) {
+        latencyData->MaxExecutionTime = callback_info->max_execution_time;
+    }
+}
+
+/**
+ * Publishes the latency histograms once every CALLBACK_LATENCY_PERIOD_MS and starts
+ * the next window, every sample ends up in exactly one update of the object
+ */
+static void updateCallbackLatency()
+{
+    portTickType now = xTaskGetTickCount();
+
+    if (now - callbackLatencyStart < CALLBACK_LATENCY_PERIOD_MS / portTICK_RATE_MS) {
+        return;
+    }
+    for (uint16_t instance = 0; instance < CALLBACKINFO_RUNNING_NUMELEM; instance++) {
+        CallbackLatencyInstSet(instance, &callbackLatency[instance]);
+    }
+    memset(callbackLatency, 0, sizeof(callbackLatency));
+    callbackLatencyStart = now;
 }
 #endif /* ifdef DIAG_TASKS */
 
@@ -136,6 +136,7 @@ typedef struct THREAD_SUSPENSIONS
 	unsigned portBASE_TYPE uxCriticalNesting;
 	pthread_mutex_t threadSleepMutex;
 	pthread_cond_t threadSleepCond;
+	unsigned long long ullCpuTimeUS;
     volatile enum {THREAD_SLEEPING,THREAD_RUNNING,THREAD_STARTING,THREAD_YIELDING,THREAD_PREEMPTING,THREAD_WAKING} threadStatus;
 } xThreadState;
 /*-----------------------------------------------------------*/
@@ -158,6 +159,14 @@ static volatile portBASE_TYPE xInterruptsEnabled = pdFALSE;
 static volatile portBASE_TYPE xSchedulerNesting = 0;
 static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
+static volatile portBASE_TYPE xVirtualClock = pdFALSE;
+static volatile unsigned long long ullVirtualTimeUS = 0;
+static volatile unsigned long ulVirtualClockStalls = 0;
+static volatile portBASE_TYPE xVirtualClockIdle = pdFALSE;
+static volatile portBASE_TYPE xVirtualTickPending = pdFALSE;
+static volatile portBASE_TYPE xVirtualTickRetry = pdFALSE;
+static pthread_mutex_t xVirtualClockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xVirtualClockCond = PTHREAD_COND_INITIALIZER;
 /*-----------------------------------------------------------*/
 
 /*
@@ -172,6 +181,12 @@ static xThreadState* prvGetThreadHandleByThread( pthread_t hThread );
 static portLONG prvGetFreeThreadState( void );
 static void prvDeleteThread( void *xThreadId );
 static void prvPortYield();
+static void prvRunVirtualClock( void );
+static void prvVirtualClockSwitched( void );
+static void prvVirtualClockDeadline( struct timespec *pxDeadline, portLONG lTimeoutUS );
+static portBASE_TYPE prvTakeVirtualTick( void );
+static void prvVirtualClockResumed( void );
+static portBASE_TYPE prvSystemTick( void );
 /*-----------------------------------------------------------*/
 
 /*
@@ -235,6 +250,7 @@ portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE
 
 	pxThreads[ lIndexOfLastAddedTask ].threadStatus = THREAD_STARTING;
 	pxThreads[ lIndexOfLastAddedTask ].uxCriticalNesting = 0;
+	pxThreads[ lIndexOfLastAddedTask ].ullCpuTimeUS = 0;
 
 	/* create the thead */
 	PORT_ASSERT( 0 == pthread_create( &( pxThreads[ lIndexOfLastAddedTask ].hThread ), &xThreadAttributes, prvWaitForStart, (void *)pxThisThreadParams ) );
@@ -259,6 +275,7 @@ void vPortStartFirstTask( void )
 {
 	/* Mark scheduler as started */
 	xSchedulerStarted = pdTRUE;
+	prvVirtualClockSwitched();
 
 	/* Start the first task. */
 	prvResumeThread( prvGetThreadHandle( xTaskGetCurrentTaskHandle() ) );
@@ -291,6 +308,11 @@ portBASE_TYPE xPortStartScheduler( void )
 	/* Start the first task. This gives up the RunningThreadMutex*/
 	vPortStartFirstTask();
 
+	if ( pdTRUE == xVirtualClock )
+	{
+		prvRunVirtualClock();
+	}
+
 	/**
 	 * Main scheduling loop. Call the tick handler every
 	 * portTICK_RATE_MICROSECONDS
@@ -406,8 +428,14 @@ void vPortExitCritical( void )
 	/* If we have reached 0 then re-enable the interrupts. */
 	if( prvGetThreadHandleByThread(pthread_self())->uxCriticalNesting == 0 )
 	{
+		/* A virtual clock tick that could not interrupt us is taken here. */
+		if ( pdTRUE == prvTakeVirtualTick() )
+		{
+			xPendYield = pdFALSE;
+			prvPortYield();
+		}
 		/* Have we missed ticks? This is the equivalent of pending an interrupt. */
-		if ( pdTRUE == xPendYield )
+		else if ( pdTRUE == xPendYield )
 		{
 			xPendYield = pdFALSE;
 			prvPortYield();
@@ -445,6 +473,7 @@ void prvPortYield()
 	 * FreeRTOS switch context
 	 */
 	vTaskSwitchContext();
+	prvVirtualClockSwitched();
 
 	/**
 	 * find out which task to resume
@@ -493,6 +522,10 @@ void vPortYield( void )
 {
 	PORT_ENTER();
 
+	if ( prvGetThreadHandleByThread(pthread_self())->uxCriticalNesting == 0 )
+	{
+		(void)prvTakeVirtualTick();
+	}
 	prvPortYield();
 
 	PORT_LEAVE();
@@ -585,6 +618,16 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
  * the tick handler is just an ordinary function, called by the supervisor thread periodically
  */
 void vPortSystemTickHandler()
+{
+	(void)prvSystemTick();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * the tick itself, returns pdFALSE if the running task could not be
+ * interrupted and the tick was turned into a pending yield
+ */
+portBASE_TYPE prvSystemTick( void )
 {
 	/**
 	 * the problem with the tick handler is, that it runs outside of the schedulers domain - worse,
@@ -596,15 +639,17 @@ void vPortSystemTickHandler()
 	/* thread MUST be running */
 	if ( prvGetThreadHandle(xTaskGetCurrentTaskHandle())->threadStatus!=THREAD_RUNNING ) {
 		xPendYield = pdTRUE;
+		xVirtualTickPending = xVirtualClock;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* interrupts MUST be enabled */
 	if ( xInterruptsEnabled != pdTRUE ) {
 		xPendYield = pdTRUE;
+		xVirtualTickPending = xVirtualClock;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* this should always be true, but it can't harm to check */
@@ -647,6 +692,10 @@ void vPortSystemTickHandler()
 	 * call tick handler
 	 */
 	xTaskIncrementTick();
+	if ( pdTRUE == xVirtualClock )
+	{
+		ullVirtualTimeUS += portTICK_RATE_MICROSECONDS;
+	}
 
 	
 #if ( configUSE_PREEMPTION == 1 )
@@ -654,6 +703,7 @@ void vPortSystemTickHandler()
 	 * while we are here we can as well switch the running thread
 	 */
 	vTaskSwitchContext();
+	prvVirtualClockSwitched();
 
 	xTaskToSuspend = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
 #endif
@@ -670,6 +720,7 @@ void vPortSystemTickHandler()
 
 	/* finish up */
 	PORT_UNLOCK( xGuardMutex );
+	return pdTRUE;
 }
 /*-----------------------------------------------------------*/
 
@@ -694,6 +745,7 @@ xThreadState* xTaskToResume;
 	{
 		/* This is a suicidal thread, need to select a different task to run. */
 		vTaskSwitchContext();
+		prvVirtualClockSwitched();
 		xTaskToResume = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
 	}
 
@@ -856,6 +908,7 @@ void prvSuspendSignalHandler(int sig)
 	}
 
 	myself->threadStatus = THREAD_RUNNING;
+	prvVirtualClockResumed();
 
 	/**
 	 * if we jump back to user code, we are done with important stuff,
@@ -924,6 +977,7 @@ portLONG lIndex;
 		pxThreads[ lIndex ].uxCriticalNesting = 0;
 		pxThreads[ lIndex ].threadSleepMutex = minit;
 		pxThreads[ lIndex ].threadSleepCond = cinit;
+		pxThreads[ lIndex ].ullCpuTimeUS = 0;
 	}
 
 	sigsuspendself.sa_flags = 0;
@@ -1074,16 +1128,233 @@ void vPortFindTicksPerSecond( void )
  */
 unsigned long ulPortGetTimerValue( void )
 {
-struct tms xTimes;
-	unsigned long ulTotalTime = times( &xTimes );
-	/* Return the application code times.
-	 * The timer only increases when the application code is actually running
-	 * which means that the total execution times should add up to 100%.
+static unsigned long long ullRunTimeUS = 0;
+xThreadState *pxThread;
+clockid_t xClock;
+struct timespec xNow;
+sigset_t xSignals, xOldSignals;
+
+	/**
+	 * Microseconds of CPU time the task threads have used. The running task
+	 * is charged the CPU time its thread used since it was last sampled, the
+	 * host time it spends suspended or waiting for the supervisor is not
+	 * counted. This holds with the virtual clock too, where a task does not
+	 * see the clock advance while it runs. The tick handler calls this from
+	 * the supervisor thread, so the task's clock is read by its thread id.
+	 * A task must not be preempted in between, it would be charged twice.
 	 */
-	return ( unsigned long ) xTimes.tms_utime;
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, SIG_SUSPEND );
+	(void)pthread_sigmask( SIG_BLOCK, &xSignals, &xOldSignals );
+
+	pxThread = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
+	if ( pxThread && ( pthread_t )NULL != pxThread->hThread
+		&& 0 == pthread_getcpuclockid( pxThread->hThread, &xClock )
+		&& 0 == clock_gettime( xClock, &xNow ) )
+	{
+		unsigned long long ullCpuTimeUS = xNow.tv_sec * 1000000ULL + xNow.tv_nsec / 1000;
+		if ( ullCpuTimeUS > pxThread->ullCpuTimeUS )
+		{
+			ullRunTimeUS += ullCpuTimeUS - pxThread->ullCpuTimeUS;
+		}
+		pxThread->ullCpuTimeUS = ullCpuTimeUS;
+	}
+
+	(void)pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+	return ( unsigned long ) ullRunTimeUS;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Virtual clock. Instead of following the host clock, a tick is only
+ * generated once every task has blocked and the scheduler has switched to the
+ * idle task. The port records every context switch (see
+ * prvVirtualClockSwitched), so the supervisor thread sleeps until the idle
+ * task is selected and never samples the scheduler state in host time.
+ * Simulated time then no longer depends on host load, which makes runs
+ * repeatable, within these limits:
+ *  - a task that never blocks would stop the clock, a tick is forced after
+ *    portVIRTUAL_CLOCK_STALL_US of host time and counted as a stall, a run
+ *    with stalls is not repeatable
+ *  - host threads outside the scheduler (the UDP receivers) can make a task
+ *    ready at any point of host time, only runs without external input are
+ *    repeatable
+ *  - the run time statistics (ulPortGetTimerValue) count host CPU time, the
+ *    load they show depends on the host
+ */
+void vPortEnableVirtualClock( void )
+{
+	/* only before the scheduler is started */
+	PORT_ASSERT( pdFALSE == xSchedulerStarted );
+	xVirtualClock = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortVirtualClockEnabled( void )
+{
+	return xVirtualClock;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullPortGetVirtualTimeUS( void )
+{
+	return ullVirtualTimeUS;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortGetVirtualClockStalls( void )
+{
+	return ulVirtualClockStalls;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * called after every vTaskSwitchContext, tells the virtual clock whether
+ * the idle task has been selected, i.e. every other task is blocked
+ */
+void prvVirtualClockSwitched( void )
+{
+	if ( pdTRUE != xVirtualClock )
+	{
+		return;
+	}
+
+	PORT_LOCK( xVirtualClockMutex );
+	xVirtualClockIdle = ( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle() ) ? pdTRUE : pdFALSE;
+	if ( pdTRUE == xVirtualClockIdle )
+	{
+		pthread_cond_signal( &xVirtualClockCond );
+	}
+	PORT_UNLOCK( xVirtualClockMutex );
+}
+/*-----------------------------------------------------------*/
 
-	/* Should check ulTotalTime for being clock_t max minus 1. */
-	(void)ulTotalTime;
+/**
+ * takes the virtual clock tick the supervisor left pending, called by the
+ * running task with the guard mutex held and outside critical sections,
+ * returns pdTRUE if the tick was taken and the task has to yield. The tick
+ * handler sets the pending tick with the guard mutex held as well.
+ */
+portBASE_TYPE prvTakeVirtualTick( void )
+{
+	portBASE_TYPE xTaken;
+
+	if ( pdTRUE != xVirtualClock || pdTRUE != xVirtualTickPending )
+	{
+		return pdFALSE;
+	}
+
+	PORT_LOCK( xVirtualClockMutex );
+	xTaken = xVirtualTickPending;
+	xVirtualTickPending = pdFALSE;
+	if ( pdTRUE == xTaken )
+	{
+		pthread_cond_signal( &xVirtualClockCond );
+	}
+	PORT_UNLOCK( xVirtualClockMutex );
+
+	if ( pdTRUE == xTaken )
+	{
+		xInterruptsEnabled = pdFALSE;
+		xTaskIncrementTick();
+		ullVirtualTimeUS += portTICK_RATE_MICROSECONDS;
+	}
+	return xTaken;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * called when a task has woken up, a tick the supervisor could not deliver
+ * while the task was waking can be delivered now
+ */
+void prvVirtualClockResumed( void )
+{
+	if ( pdTRUE != xVirtualClock || pdTRUE != xVirtualTickPending )
+	{
+		return;
+	}
+
+	PORT_LOCK( xVirtualClockMutex );
+	xVirtualTickRetry = pdTRUE;
+	pthread_cond_signal( &xVirtualClockCond );
+	PORT_UNLOCK( xVirtualClockMutex );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * absolute host time for pthread_cond_timedwait
+ */
+void prvVirtualClockDeadline( struct timespec *pxDeadline, portLONG lTimeoutUS )
+{
+	clock_gettime( CLOCK_REALTIME, pxDeadline );
+	pxDeadline->tv_nsec += 1000L * ( lTimeoutUS % 1000000 );
+	pxDeadline->tv_sec += lTimeoutUS / 1000000 + pxDeadline->tv_nsec / 1000000000L;
+	pxDeadline->tv_nsec %= 1000000000L;
+}
+/*-----------------------------------------------------------*/
+
+void prvRunVirtualClock( void )
+{
+	struct timespec xDeadline;
+	portBASE_TYPE xStalled;
+	portBASE_TYPE xTaken;
+
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		prvVirtualClockDeadline( &xDeadline, portVIRTUAL_CLOCK_STALL_US );
+
+		/* wait until the scheduler has nothing left to run but the idle task */
+		xStalled = pdFALSE;
+		PORT_LOCK( xVirtualClockMutex );
+		while ( pdTRUE != xVirtualClockIdle && pdTRUE != xSchedulerEnd )
+		{
+			if ( pthread_cond_timedwait( &xVirtualClockCond, &xVirtualClockMutex, &xDeadline ) == ETIMEDOUT )
+			{
+				xStalled = pdTRUE;
+				break;
+			}
+		}
+		PORT_UNLOCK( xVirtualClockMutex );
+
+		if ( pdTRUE == xStalled )
+		{
+			ulVirtualClockStalls++;
+		}
+
+		/**
+		 * the idle task may still be waking up or inside a critical section,
+		 * then the tick is left pending like an interrupt. The task takes it
+		 * itself when it leaves the critical section or yields, a task that
+		 * finishes waking up signals us to deliver it (see
+		 * prvVirtualClockResumed). No host timer is involved, only a task
+		 * that does none of these for portVIRTUAL_CLOCK_STALL_US of host
+		 * time counts as a stall.
+		 */
+		prvVirtualClockDeadline( &xDeadline, portVIRTUAL_CLOCK_STALL_US );
+		while ( pdTRUE != xSchedulerEnd && pdTRUE != prvSystemTick() )
+		{
+			xStalled = pdFALSE;
+			PORT_LOCK( xVirtualClockMutex );
+			if ( pdTRUE == xVirtualTickPending && pdTRUE != xVirtualTickRetry )
+			{
+				xStalled = ( pthread_cond_timedwait( &xVirtualClockCond, &xVirtualClockMutex, &xDeadline ) == ETIMEDOUT ) ? pdTRUE : pdFALSE;
+			}
+			xTaken = ( pdTRUE != xVirtualTickPending ) ? pdTRUE : pdFALSE;
+			xVirtualTickPending = pdFALSE;
+			xVirtualTickRetry = pdFALSE;
+			PORT_UNLOCK( xVirtualClockMutex );
+
+			if ( pdTRUE == xTaken )
+			{
+				break;
+			}
+			if ( pdTRUE == xStalled )
+			{
+				ulVirtualClockStalls++;
+				prvVirtualClockDeadline( &xDeadline, portVIRTUAL_CLOCK_STALL_US );
+			}
+		}
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -169,6 +169,13 @@ extern unsigned long ulPortGetTimerValue( void );
 #undef portGET_RUN_TIME_COUNTER_VALUE
 #define portGET_RUN_TIME_COUNTER_VALUE()			ulPortGetTimerValue()			/* Query the System time stats for this process. */
 
+/* Virtual clock, ticks advance when only the idle task is ready instead of with host time. */
+#define portVIRTUAL_CLOCK_STALL_US	100000
+extern void vPortEnableVirtualClock( void );
+extern portBASE_TYPE xPortVirtualClockEnabled( void );
+extern unsigned long long ullPortGetVirtualTimeUS( void );
+extern unsigned long ulPortGetVirtualClockStalls( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,14 +36,25 @@
 #define STACK_SIZE        (190 + STACK_SAFETYSIZE)
 #define STACK_SAFETYSIZE  8
 #define MAX_SLEEP         1000
+#define MAX_CALLBACKS     32 // per task and priority, one bit each in the ready mask
+#define TABLE_GROWTH      4
 
 // Private types
 /**
  * task information
+ * Callbacks that want to run are flagged in a ready bit mask per priority, so
+ * the next one is found with a bit scan instead of walking the callbacks.
+ * Scheduled callbacks are kept in a binary min-heap ordered by schedule time.
  */
 struct DelayedCallbackTaskStruct {
-    DelayedCallbackInfo *callbackQueue[CALLBACK_PRIORITY_LOW + 1];
-    DelayedCallbackInfo *queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    DelayedCallbackInfo **callbacks[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t numCallbacks[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t maxCallbacks[CALLBACK_PRIORITY_LOW + 1];
+    uint8_t queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    volatile uint32_t ready[CALLBACK_PRIORITY_LOW + 1];
+    DelayedCallbackInfo **timers;
+    uint16_t    numTimers;
+    uint16_t    maxTimers;
     xTaskHandle callbackSchedulerTaskHandle;
     char name[3];
     uint32_t    stackSize;
@@ -58,7 +69,9 @@ struct DelayedCallbackTaskStruct {
 struct DelayedCallbackInfoStruct {
     DelayedCallback   cb;
     int16_t callbackID;
-    bool volatile     waiting;
+    DelayedCallbackPriority priority;
+    uint8_t  slot; // bit in the ready mask
+    int16_t  timerIndex; // position in the timer heap, -1 if not scheduled
     uint32_t volatile scheduletime;
     uint32_t stackSize;
     int32_t  stackFree;
@@ -66,8 +79,14 @@ struct DelayedCallbackInfoStruct {
     uint16_t stackSafetyCount;
     uint16_t currentSafetyCount;
     uint32_t runCount;
+#ifdef DIAG_TASKS
+    uint32_t volatile dispatchTime;
+    uint16_t dispatchLatency[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    uint16_t executionTime[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    uint32_t maxDispatchLatency;
+    uint32_t maxExecutionTime;
+#endif
     struct DelayedCallbackTaskStruct *task;
-    struct DelayedCallbackInfoStruct *next;
 };
 
 
@@ -78,7 +97,14 @@ static bool schedulerStarted;
 
 // Private functions
 static void CallbackSchedulerTask(void *task);
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task);
+static DelayedCallbackInfo *selectNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static void markReady(DelayedCallbackInfo *cbinfo);
+static bool timerBefore(const DelayedCallbackInfo *a, const DelayedCallbackInfo *b);
+static void timerSiftUp(struct DelayedCallbackTaskStruct *task, uint16_t index);
+static void timerSiftDown(struct DelayedCallbackTaskStruct *task, uint16_t index);
+static void timerRemove(DelayedCallbackInfo *cbinfo);
+static bool growTable(DelayedCallbackInfo ***table, uint16_t used, uint16_t *size);
 
 /**
  * Initialize the scheduler
@@ -188,6 +214,18 @@ int32_t PIOS_CALLBACKSCHEDULER_Schedule(
         }
         cbinfo->scheduletime = new;
 
+        // move the callback to its place in the timer heap
+        struct DelayedCallbackTaskStruct *task = cbinfo->task;
+        if (cbinfo->timerIndex < 0) {
+            cbinfo->timerIndex = task->numTimers;
+            task->timers[task->numTimers++] = cbinfo;
+            timerSiftUp(task, cbinfo->timerIndex);
+        } else if (diff < 0) {
+            timerSiftUp(task, cbinfo->timerIndex);
+        } else {
+            timerSiftDown(task, cbinfo->timerIndex);
+        }
+
         // scheduler needs to be notified to adapt sleep times
         xSemaphoreGive(cbinfo->task->signal);
     }
@@ -208,7 +246,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    markReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
 }
@@ -232,7 +270,7 @@ int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    markReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
@@ -281,9 +319,15 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
 
         // initialize structure
         for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
-            task->callbackQueue[p] = NULL;
-            task->queueCursor[p]   = NULL;
+            task->callbacks[p]    = NULL;
+            task->numCallbacks[p] = 0;
+            task->maxCallbacks[p] = 0;
+            task->queueCursor[p]  = 0;
+            task->ready[p] = 0;
         }
+        task->timers       = NULL;
+        task->numTimers    = 0;
+        task->maxTimers    = 0;
         task->name[0]      = 'C';
         task->name[1]      = 'a' + t;
         task->name[2]      = 0;
@@ -328,14 +372,32 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
         return NULL; // error - not enough memory
     }
 
+    // make room in the ready table and the timer heap
+    uint16_t numCallbacks = task->numCallbacks[priority];
+    if (numCallbacks >= MAX_CALLBACKS) {
+        xSemaphoreGiveRecursive(mutex);
+        return NULL; // error - no bit left in the ready mask
+    }
+    uint16_t taskCallbacks = 0;
+    for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
+        taskCallbacks += task->numCallbacks[p];
+    }
+    if (!growTable(&task->callbacks[priority], numCallbacks, &task->maxCallbacks[priority]) ||
+        !growTable(&task->timers, taskCallbacks, &task->maxTimers)) {
+        xSemaphoreGiveRecursive(mutex);
+        return NULL; // error - not enough memory
+    }
+
     // initialize callback scheduling info
     DelayedCallbackInfo *info = (DelayedCallbackInfo *)pios_malloc(sizeof(DelayedCallbackInfo));
     if (!info) {
         xSemaphoreGiveRecursive(mutex);
         return NULL; // error - not enough memory
     }
-    info->next               = NULL;
-    info->waiting            = false;
+    memset(info, 0, sizeof(DelayedCallbackInfo));
+    info->priority           = priority;
+    info->slot               = numCallbacks;
+    info->timerIndex         = -1;
     info->scheduletime       = 0;
     info->task               = task;
     info->cb = cb;
@@ -347,8 +409,9 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     info->stackSafetyCount   = STACK_SAFETYCOUNT;
     info->currentSafetyCount = 0;
 
-    // add to scheduling queue
-    LL_APPEND(task->callbackQueue[priority], info);
+    // add to scheduling table
+    task->callbacks[priority][numCallbacks] = info;
+    task->numCallbacks[priority] = numCallbacks + 1;
 
     xSemaphoreGiveRecursive(mutex);
 
@@ -374,12 +437,28 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
         int prio;
 
         for (prio = 0; prio < (CALLBACK_PRIORITY_LOW + 1); prio++) {
-            struct DelayedCallbackInfoStruct *cbinfo;
-            LL_FOREACH(task->callbackQueue[prio], cbinfo) {
+            for (uint16_t slot = 0; slot < task->numCallbacks[prio]; slot++) {
+                struct DelayedCallbackInfoStruct *cbinfo = task->callbacks[prio][slot];
                 xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
                 info.is_running = true;
                 info.stack_remaining    = cbinfo->stackNotFree;
                 info.running_time_count = cbinfo->runCount;
+#ifdef DIAG_TASKS
+                // report the histograms of this period and start the next one
+                memcpy(info.dispatch_latency, cbinfo->dispatchLatency, sizeof(info.dispatch_latency));
+                memcpy(info.execution_time, cbinfo->executionTime, sizeof(info.execution_time));
+                info.max_dispatch_latency = cbinfo->maxDispatchLatency;
+                info.max_execution_time   = cbinfo->maxExecutionTime;
+                memset(cbinfo->dispatchLatency, 0, sizeof(cbinfo->dispatchLatency));
+                memset(cbinfo->executionTime, 0, sizeof(cbinfo->executionTime));
+                cbinfo->maxDispatchLatency = 0;
+                cbinfo->maxExecutionTime   = 0;
+#else
+                memset(info.dispatch_latency, 0, sizeof(info.dispatch_latency));
+                memset(info.execution_time, 0, sizeof(info.execution_time));
+                info.max_dispatch_latency = 0;
+                info.max_execution_time   = 0;
+#endif
                 xSemaphoreGiveRecursive(mutex);
                 callback(cbinfo->callbackID, &info, context);
             }
@@ -458,75 +537,249 @@ static void checkStack(DelayedCallbackInfo *current)
 }
 
 /**
- * Scheduler subtask
+ * Flag a callback as waiting for execution. Safe to call from an ISR.
+ */
+static void markReady(DelayedCallbackInfo *cbinfo)
+{
+    uint32_t bit = 1u << cbinfo->slot;
+    volatile uint32_t *ready = &cbinfo->task->ready[cbinfo->priority];
+
+#ifdef DIAG_TASKS
+    // latency is measured from the first dispatch, repeated dispatches before execution are merged
+    if (!(*ready & bit)) {
+        cbinfo->dispatchTime = PIOS_DELAY_GetRaw();
+    }
+#endif
+    __atomic_fetch_or(ready, bit, __ATOMIC_SEQ_CST);
+}
+
+#ifdef DIAG_TASKS
+/**
+ * Add a sample to a histogram, bucket n counts samples below 16 << (2 * n) microseconds
+ */
+static void histogramAdd(uint16_t *histogram, uint32_t *max, uint32_t us)
+{
+    uint8_t bucket = 0;
+
+    if (us > *max) {
+        *max = us;
+    }
+    for (uint32_t v = us >> 4; v && bucket < PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS - 1; v >>= 2) {
+        bucket++;
+    }
+    if (histogram[bucket] < 0xffff) {
+        histogram[bucket]++;
+    }
+}
+#endif
+
+/**
+ * Timer heap ordering, wraparound safe
+ */
+static bool timerBefore(const DelayedCallbackInfo *a, const DelayedCallbackInfo *b)
+{
+    return (int32_t)(a->scheduletime - b->scheduletime) < 0;
+}
+
+static void timerSwap(struct DelayedCallbackTaskStruct *task, uint16_t i, uint16_t j)
+{
+    DelayedCallbackInfo *tmp = task->timers[i];
+
+    task->timers[i] = task->timers[j];
+    task->timers[j] = tmp;
+    task->timers[i]->timerIndex = i;
+    task->timers[j]->timerIndex = j;
+}
+
+static void timerSiftUp(struct DelayedCallbackTaskStruct *task, uint16_t index)
+{
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (!timerBefore(task->timers[index], task->timers[parent])) {
+            break;
+        }
+        timerSwap(task, index, parent);
+        index = parent;
+    }
+}
+
+static void timerSiftDown(struct DelayedCallbackTaskStruct *task, uint16_t index)
+{
+    while (1) {
+        uint16_t child = 2 * index + 1;
+        if (child >= task->numTimers) {
+            break;
+        }
+        if (child + 1 < task->numTimers && timerBefore(task->timers[child + 1], task->timers[child])) {
+            child++;
+        }
+        if (!timerBefore(task->timers[child], task->timers[index])) {
+            break;
+        }
+        timerSwap(task, index, child);
+        index = child;
+    }
+}
+
+/**
+ * Take a callback out of the timer heap, must be called with the mutex held
+ */
+static void timerRemove(DelayedCallbackInfo *cbinfo)
+{
+    struct DelayedCallbackTaskStruct *task = cbinfo->task;
+    int16_t index = cbinfo->timerIndex;
+
+    if (index < 0) {
+        return;
+    }
+    cbinfo->timerIndex = -1;
+    task->numTimers--;
+    if (index < task->numTimers) {
+        task->timers[index] = task->timers[task->numTimers];
+        task->timers[index]->timerIndex = index;
+        timerSiftUp(task, index);
+        timerSiftDown(task, task->timers[index]->timerIndex);
+    }
+}
+
+/**
+ * Make sure a pointer table has room for one more entry
+ * \param[in,out] table The table, reallocated if needed
+ * \param[in] used Number of entries in use
+ * \param[in,out] size Allocated number of entries
+ * \return true on success, false if out of memory
+ */
+static bool growTable(DelayedCallbackInfo ***table, uint16_t used, uint16_t *size)
+{
+    if (used < *size) {
+        return true;
+    }
+    DelayedCallbackInfo **grown = (DelayedCallbackInfo **)pios_malloc((*size + TABLE_GROWTH) * sizeof(DelayedCallbackInfo *));
+    if (!grown) {
+        return false;
+    }
+    if (*table) {
+        memcpy(grown, *table, used * sizeof(DelayedCallbackInfo *));
+        vPortFree(*table);
+    }
+    *table = grown;
+    *size += TABLE_GROWTH;
+    return true;
+}
+
+/**
+ * Find the next waiting callback, keeping the round robin order documented in
+ * pios_callbackscheduler.h: callbacks of one priority take turns, and every
+ * time the end of the table is reached one callback of the next lower
+ * priority gets a turn. Must be called with the mutex held.
  * \param[in] task The scheduler task in question
  * \param[in] priority The scheduling priority of the callback to search for
- * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ * \return the callback to run, NULL if none is waiting
  */
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+static DelayedCallbackInfo *selectNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
 {
-    int32_t result = MAX_SLEEP;
-    int32_t diff   = 0;
-
     // no such queue
     if (priority > CALLBACK_PRIORITY_LOW) {
-        return result;
+        return NULL;
     }
 
     // queue is empty, search a lower priority queue
-    if (task->callbackQueue[priority] == NULL) {
-        return runNextCallback(task, priority + 1);
-    }
-
-    DelayedCallbackInfo *current = task->queueCursor[priority];
-    DelayedCallbackInfo *next;
-    do {
-        if (current == NULL) {
-            next = task->callbackQueue[priority]; // loop around the end of the list
-            // also attempt to run a callback that has lower priority
-            // every time the queue is completely traversed
-            diff = runNextCallback(task, priority + 1);
-            if (!diff) {
-                task->queueCursor[priority] = next; // the recursive call has executed a callback
-                return 0;
-            }
+    if (task->numCallbacks[priority] == 0) {
+        return selectNextCallback(task, priority + 1);
+    }
+
+    uint32_t ready  = task->ready[priority];
+    uint8_t cursor  = task->queueCursor[priority];
+    uint32_t before = (cursor >= MAX_CALLBACKS) ? 0xffffffff : ((1u << cursor) - 1);
+
+    // waiting callbacks from the cursor to the end of the table
+    if (ready & ~before) {
+        uint8_t slot = __builtin_ctz(ready & ~before);
+        task->queueCursor[priority] = slot + 1;
+        return task->callbacks[priority][slot];
+    }
+
+    // end of the table, attempt to run a callback that has lower priority
+    DelayedCallbackInfo *lower = selectNextCallback(task, priority + 1);
+    if (lower) {
+        task->queueCursor[priority] = 0;
+        return lower;
+    }
+
+    // loop around to the start of the table
+    if (ready & before) {
+        uint8_t slot = __builtin_ctz(ready & before);
+        task->queueCursor[priority] = slot + 1;
+        return task->callbacks[priority][slot];
+    }
+
+    return NULL;
+}
+
+/**
+ * Scheduler subtask
+ * \param[in] task The scheduler task in question
+ * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ */
+static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task)
+{
+    int32_t result = MAX_SLEEP;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    // callbacks whose schedule has come up are waiting now
+    uint32_t now = xTaskGetTickCount();
+    while (task->numTimers > 0) {
+        DelayedCallbackInfo *due = task->timers[0];
+        int32_t diff = due->scheduletime - now;
+        if (diff > 0) {
             if (diff < result) {
                 result = diff; // adjust sleep time
             }
-        } else {
-            next = current->next;
-            xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
-            if (current->scheduletime) {
-                diff = current->scheduletime - xTaskGetTickCount();
-                if (diff <= 0) {
-                    current->waiting = true;
-                } else if (diff < result) {
-                    result = diff; // adjust sleep time
-                }
-            }
-            if (current->waiting) {
-                task->queueCursor[priority] = next;
-                current->scheduletime = 0; // any schedules are reset
-                current->waiting = false; // the flag is reset just before execution.
-                xSemaphoreGiveRecursive(mutex);
+            break;
+        }
+        timerRemove(due);
+        due->scheduletime = 0;
+        markReady(due);
+    }
+
+    DelayedCallbackInfo *current = selectNextCallback(task, CALLBACK_PRIORITY_CRITICAL);
+    if (!current) {
+        // nothing to be executed
+        xSemaphoreGiveRecursive(mutex);
+        return result;
+    }
 
-                /* callback gets invoked here - check stack sizes */
-                markStack(current);
+    // any schedules are reset
+    timerRemove(current);
+    current->scheduletime = 0;
+    // the flag is reset just before execution.
+    __atomic_fetch_and(&task->ready[current->priority], ~(1u << current->slot), __ATOMIC_SEQ_CST);
+    xSemaphoreGiveRecursive(mutex);
 
-                current->cb(); // call the callback
+#ifdef DIAG_TASKS
+    uint32_t latency = PIOS_DELAY_DiffuS(current->dispatchTime);
+    uint32_t start   = PIOS_DELAY_GetRaw();
+#endif
 
-                checkStack(current);
+    /* callback gets invoked here - check stack sizes */
+    markStack(current);
 
-                current->runCount++;
+    current->cb(); // call the callback
 
-                return 0;
-            }
-            xSemaphoreGiveRecursive(mutex);
-        }
-        current = next;
-    } while (current != task->queueCursor[priority]);
-    // once the list has been traversed entirely without finding any to be executed task, abort (nothing to do)
-    return result;
+    checkStack(current);
+
+    current->runCount++;
+
+#ifdef DIAG_TASKS
+    uint32_t execution = PIOS_DELAY_DiffuS(start);
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    histogramAdd(current->dispatchLatency, &current->maxDispatchLatency, latency);
+    histogramAdd(current->executionTime, &current->maxExecutionTime, execution);
+    xSemaphoreGiveRecursive(mutex);
+#endif
+
+    return 0;
 }
 
 /**
@@ -538,7 +791,7 @@ static void CallbackSchedulerTask(void *task)
     uint32_t delay = 0;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
+        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task);
         if (delay) {
             // nothing to do but sleep
             xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
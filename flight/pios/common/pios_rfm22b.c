@@ -60,7 +60,7 @@
 #include <pios_spi_priv.h>
 #include <pios_rfm22b_priv.h>
 #include <pios_ppm_out.h>
-#include <ecc.h>
+#include <rscodec.h>
 
 /* Local Defines */
 #define STACK_SIZE_BYTES                 200
@@ -170,6 +170,9 @@ static const uint8_t channel_list[] = {
     136, 86,  70,  234, 66,  185, 10,  164, 177, 116, 50,  107, 183, 215, 212, 60,  227, 133, 120, 14
 };
 
+// The Reed Solomon encoder tables, they are only read after the first init.
+static struct rs_codec ecc_codec;
+
 /* Local function forwared declarations */
 static void pios_rfm22_task(void *parameters);
 static bool pios_rfm22_readStatus(struct pios_rfm22b_dev *rfm22b_dev);
@@ -455,8 +458,8 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
     PIOS_WDG_RegisterFlag(PIOS_WDG_RFM22B);
 #endif /* PIOS_WDG_RFM22B */
 
-    // Initialize the ECC library.
-    initialize_ecc();
+    // Initialize the ECC tables.
+    rs_codec_init(&ecc_codec);
 
     // Set the state to initializing.
     rfm22b_dev->state = RADIO_STATE_UNINITIALIZED;
@@ -1811,7 +1814,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
     // Add the error correcting code.
     if (!radio_dev->ppm_only_mode) {
         if (len != 0) {
-            encode_data((unsigned char *)p, len, (unsigned char *)p);
+            rs_encode(&ecc_codec, p, len, p);
         }
         len += RS_ECC_NPARITY;
     }
@@ -1889,11 +1892,10 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
 
         // Attempt to correct any errors in the packet.
         if (data_len > 0) {
-            decode_data((unsigned char *)p, rx_len);
-            good_packet = check_syndrome() == 0;
+            good_packet = rs_check(&ecc_codec, p, rx_len);
 
             // We have an error.  Try to correct it.
-            if (!good_packet && (correct_errors_erasures((unsigned char *)p, rx_len, 0, 0) != 0)) {
+            if (!good_packet && rs_correct(p, rx_len, 0, NULL)) {
                 // We corrected it
                 corrected_packet = true;
             }
@@ -136,7 +136,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Start();
  * \param[in] priorityTask Task priority of the scheduler task. One scheduler task will be spawned for each distinct value specified, further callbacks created  with the same priorityTask will all be handled by the same delayed callback scheduler task and scheduled according to their individual callback priorities
  * \param[in] stacksize The stack requirements of the callback when called by the scheduler.
  * \param[in] callbackID - CallbackInfoRunningElem from CallbackInfo UAVObject, unique identified to collect stats for the callback, -1 to ignore!
- * \return CallbackInfo Pointer on success, NULL if failed.
+ * \return CallbackInfo Pointer on success, NULL if failed. A scheduler task holds at most 32 callbacks of each priority.
  */
 DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     DelayedCallback cb,
@@ -186,6 +186,9 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo);
  */
 int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigherPriorityTaskWoken);
 
+// Number of buckets of the latency histograms
+#define PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS 8
+
 /**
  * Information about a running callback that has been registered
  * via a call to PIOS_CALLBACKSCHEDULER_Create().
@@ -197,6 +200,17 @@ struct pios_callback_info {
     bool     is_running;
     /** Count of executions of the callback since system start */
     uint32_t running_time_count;
+    /**
+     * Histograms since the previous call of PIOS_CALLBACKSCHEDULER_ForEachCallback(),
+     * bucket n counts samples below 16 << (2 * n) microseconds, the last bucket counts
+     * everything above. Only collected when built with DIAG_TASKS, zero otherwise.
+     */
+    uint16_t dispatch_latency[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    uint16_t execution_time[PIOS_CALLBACKSCHEDULER_HISTOGRAM_BUCKETS];
+    /** Worst dispatch to execution latency since the previous call, in microseconds */
+    uint32_t max_dispatch_latency;
+    /** Worst execution time since the previous call, in microseconds */
+    uint32_t max_execution_time;
 };
 
 /**
@@ -210,6 +224,7 @@ typedef void (*CallbackSchedulerCallbackInfoCallback)(int16_t task_id, const str
 
 /**
  * Iterator. Iterates over all callbacks and all scheduler tasks and retrieves information
+ * The latency and execution time histograms are reset after they have been reported.
  *
  * @param[in] callback  Callback function to receive the data - will be called in same task context as the callerThe id of the task the task_info refers to.
  * @param     context   Context information optionally provided to the callback.
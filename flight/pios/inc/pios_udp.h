@@ -31,5 +31,6 @@
 /* Global Types */
 
 /* Public Functions */
+extern void PIOS_UDP_GetTotals(uint32_t *tx_bytes, uint32_t *rx_bytes);
 
 #endif /* PIOS_UDP_H */
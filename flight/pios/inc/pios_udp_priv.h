@@ -64,6 +64,9 @@ typedef struct {
     pios_com_callback  rx_in_cb;
     uint32_t rx_in_context;
 
+    uint32_t tx_bytes; // totals since start up
+    uint32_t rx_bytes;
+
     uint8_t  rx_buffer[PIOS_UDP_RX_BUFFER_SIZE];
     uint8_t  tx_buffer[PIOS_UDP_RX_BUFFER_SIZE];
 } pios_udp_dev;
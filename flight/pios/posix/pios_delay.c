@@ -63,6 +63,11 @@ int32_t PIOS_DELAY_WaituS(uint32_t uS)
 {
     static struct timespec wait, rest;
 
+    if (xPortVirtualClockEnabled()) {
+        // simulated time only advances while idle, the wait takes no time at all
+        return 0;
+    }
+
     wait.tv_sec  = 0;
     wait.tv_nsec = 1000 * uS;
     while (nanosleep(&wait, &rest) != 0) {
@@ -90,6 +95,10 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
     // PIOS_DELAY_WaituS(1000);
     static struct timespec wait, rest;
 
+    if (xPortVirtualClockEnabled()) {
+        return 0;
+    }
+
     wait.tv_sec  = mS / 1000;
     wait.tv_nsec = (mS % 1000) * 1000000;
     while (nanosleep(&wait, &rest) != 0) {
@@ -109,6 +118,10 @@ uint32_t PIOS_DELAY_GetuS()
 {
     static struct timespec current;
 
+    if (xPortVirtualClockEnabled()) {
+        return (uint32_t)ullPortGetVirtualTimeUS();
+    }
+
     clock_gettime(CLOCK_REALTIME, &current);
     return (current.tv_sec * 1000000) + (current.tv_nsec / 1000);
 }
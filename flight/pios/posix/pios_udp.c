@@ -82,6 +82,15 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
      * com devices never get closed except by application "reboot"
      * we also never give up our mutex except for waiting
      */
+    int flags = 0;
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    /* a task blocked in recvfrom() never lets the virtual clock see the system idle, poll once per tick instead */
+    if (xPortVirtualClockEnabled()) {
+        flags = MSG_DONTWAIT;
+    }
+#endif
+
     while (1) {
         /**
          * receive
@@ -91,9 +100,10 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
         if ((received = recvfrom(udp_dev->socket,
                                  &udp_dev->rx_buffer,
                                  PIOS_UDP_RX_BUFFER_SIZE,
-                                 0,
+                                 flags,
                                  (struct sockaddr *)&udp_dev->client,
                                  (socklen_t *)&udp_dev->clientLength)) >= 0) {
+            udp_dev->rx_bytes += received;
             /* copy received data to buffer if possible */
             /* we do NOT buffer data locally. If the com buffer can't receive, data is discarded! */
             /* (thats what the USART driver does too!) */
@@ -106,6 +116,8 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
             if (rx_need_yield) {
                 vPortYieldFromISR();
             }
+        } else if (flags & MSG_DONTWAIT) {
+            vTaskDelay(1);
 #endif /* PIOS_INCLUDE_FREERTOS */
         }
     }
@@ -126,6 +138,8 @@ int32_t PIOS_UDP_Init(uint32_t *udp_id, const struct pios_udp_cfg *cfg)
     udp_dev->rx_in_cb  = NULL;
     udp_dev->tx_out_cb = NULL;
     udp_dev->cfg    = cfg;
+    udp_dev->tx_bytes  = 0;
+    udp_dev->rx_bytes  = 0;
 
     /* assign socket */
     udp_dev->socket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
@@ -185,6 +199,7 @@ static void PIOS_UDP_TxStart(uint32_t udp_id, uint16_t tx_bytes_avail)
             bool tx_need_yield = false;
             length = (udp_dev->tx_out_cb)(udp_dev->tx_out_context, udp_dev->tx_buffer, PIOS_UDP_RX_BUFFER_SIZE, NULL, &tx_need_yield);
             rem    = length;
+            udp_dev->tx_bytes += length;
             while (rem > 0) {
                 len = sendto(udp_dev->socket, udp_dev->tx_buffer + length - rem, rem, 0,
                              (struct sockaddr *)&udp_dev->client,
@@ -228,5 +243,18 @@ static void PIOS_UDP_RegisterTxCallback(uint32_t udp_id, pios_com_callback tx_ou
     udp_dev->tx_out_cb = tx_out_cb;
 }
 
+/**
+ * Bytes sent and received over all UDP ports since start up
+ */
+void PIOS_UDP_GetTotals(uint32_t *tx_bytes, uint32_t *rx_bytes)
+{
+    *tx_bytes = 0;
+    *rx_bytes = 0;
+    for (int8_t i = 0; i < pios_udp_num_devices; i++) {
+        *tx_bytes += pios_udp_devices[i].tx_bytes;
+        *rx_bytes += pios_udp_devices[i].rx_bytes;
+    }
+}
+
 
 #endif /* if defined(PIOS_INCLUDE_UDP) */
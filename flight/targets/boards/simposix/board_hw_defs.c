@@ -73,3 +73,11 @@ const struct pios_udp_cfg pios_udp_aux_cfg = {
 #if defined(PIOS_INCLUDE_FLASH)
 #include "pios_flashfs_logfs_priv.h"
 #endif
+
+#if defined(PIOS_INCLUDE_GCSRCVR)
+#include "pios_gcsrcvr_priv.h"
+#endif /* PIOS_INCLUDE_GCSRCVR */
+
+#if defined(PIOS_INCLUDE_RCVR)
+#include "pios_rcvr_priv.h"
+#endif /* PIOS_INCLUDE_RCVR */
@@ -86,6 +86,11 @@
 #define INCLUDE_xTaskGetSchedulerState               1
 #define INCLUDE_xTaskGetCurrentTaskHandle            1
 #define INCLUDE_uxTaskGetStackHighWaterMark          0
+#define INCLUDE_xTaskGetIdleTaskHandle               1
+
+/* Enable run time stats collection, the posix port counts the CPU time of the task threads */
+#define configGENERATE_RUN_TIME_STATS                1
+#define INCLUDE_uxTaskGetRunTime                     1
 
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
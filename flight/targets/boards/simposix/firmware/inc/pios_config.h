@@ -86,7 +86,7 @@
 // #define PIOS_INCLUDE_SBUS
 #define PIOS_INCLUDE_PPM
 #define PIOS_INCLUDE_PWM
-/* #define PIOS_INCLUDE_GCSRCVR */
+#define PIOS_INCLUDE_GCSRCVR
 /* #define PIOS_INCLUDE_OPLINKRCVR */
 #define PIOS_INCLUDE_IAP
 #define PIOS_INCLUDE_BL_HELPER
@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotCore OpenPilot Core
+ * @{
+ * @file       simharness.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Scripted input and performance report for the simulated firmware
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SIMHARNESS_H
+#define SIMHARNESS_H
+
+/**
+ * Parse the harness options from the command line, must be called before
+ * the scheduler is started.
+ *   --virtual-clock     run on the virtual clock of the posix port
+ *   --script <file>     replay a compiled input script
+ *   --duration <ms>     stop after this much simulated time and write the report
+ *   --report <file>     where to write the report, stdout if not given
+ * \return 0 on success, -1 on a usage error
+ */
+int32_t SimHarnessParseArgs(int argc, char *argv[]);
+
+/**
+ * Start the harness task, if any harness option was given. Called once the
+ * modules are initialized.
+ * \return 0 on success, -1 on failure
+ */
+int32_t SimHarnessStart(void);
+
+#endif /* SIMHARNESS_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -199,6 +199,17 @@ void PIOS_Board_Init(void)
         break;
         break;
     } /* hwsettings_rv_auxport */
+
+#if defined(PIOS_INCLUDE_GCSRCVR)
+    GCSReceiverInitialize();
+    uint32_t pios_gcsrcvr_id;
+    PIOS_GCSRCVR_Init(&pios_gcsrcvr_id);
+    uint32_t pios_gcsrcvr_rcvr_id;
+    if (PIOS_RCVR_Init(&pios_gcsrcvr_rcvr_id, &pios_gcsrcvr_rcvr_driver, pios_gcsrcvr_id)) {
+        PIOS_Assert(0);
+    }
+    pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_GCS] = pios_gcsrcvr_rcvr_id;
+#endif /* PIOS_INCLUDE_GCSRCVR */
 }
 
 /**
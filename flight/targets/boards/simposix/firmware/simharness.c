@@ -0,0 +1,400 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotCore OpenPilot Core
+ * @{
+ * @file       simharness.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Scripted input and performance report for the simulated firmware
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * The harness replays a compiled input script into the UAVObjects and, after
+ * a fixed amount of simulated time, writes a plain "key value" report of the
+ * event system, telemetry and scheduler load and exits. The script and the
+ * report are produced and consumed by make/scripts/simharness.py, which knows
+ * the object layout, the firmware only applies raw values at byte offsets.
+ *
+ * Script lines: <time_ms> <object id> <instance> <offset> <type> <value>
+ */
+
+#include "inc/openpilot.h"
+#include <uavobjectsinit.h>
+#include <eventdispatcher.h>
+#include <taskinfo.h>
+#include <callbackinfo.h>
+#include <simharness.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#define HARNESS_TASK_PRIORITY (tskIDLE_PRIORITY + configMAX_PRIORITIES - 1) // max priority, inputs land before the modules run
+#define HARNESS_TASK_STACK    (2048 / 4)
+#define HARNESS_SAMPLE_MS     1000
+
+typedef enum {
+    HARNESS_INT8 = 0,
+    HARNESS_UINT8,
+    HARNESS_INT16,
+    HARNESS_UINT16,
+    HARNESS_INT32,
+    HARNESS_UINT32,
+    HARNESS_FLOAT,
+    HARNESS_TYPES
+} HarnessType;
+
+static const char *const harnessTypeNames[HARNESS_TYPES] = {
+    "int8", "uint8", "int16", "uint16", "int32", "uint32", "float"
+};
+static const uint8_t harnessTypeSizes[HARNESS_TYPES] = { 1, 1, 2, 2, 4, 4, 4 };
+
+typedef struct {
+    uint32_t timeMs;
+    uint32_t objId;
+    uint16_t instId;
+    uint16_t offset;
+    uint8_t  type;
+    union {
+        int32_t  i;
+        uint32_t u;
+        float    f;
+    } value;
+} HarnessInput;
+
+// Local variables
+static bool harnessEnabled;
+static uint32_t durationMs;
+static const char *reportPath;
+static HarnessInput *script;
+static uint32_t scriptLength;
+static uint32_t scriptApplied;
+static uint32_t scriptErrors;
+
+// Error counters, accumulated because the system module clears them every second
+static uint32_t objectQueueErrors;
+static uint32_t objectCallbackErrors;
+static uint32_t eventErrors;
+static UAVObjStats lastObjStats;
+static EventStats lastEventStats;
+
+// Load samples
+static uint32_t taskTimeSum[TASKINFO_RUNNING_NUMELEM];
+static uint32_t taskSamples;
+static uint32_t callbackRuns[CALLBACKINFO_RUNNING_NUMELEM];
+
+// Private functions
+static void harnessTask(void *parameters);
+static int32_t loadScript(const char *path);
+static void applyInput(const HarnessInput *input);
+static uint32_t accumulate(uint32_t total, uint32_t last, uint32_t now);
+static void sampleStats(void);
+static void sampleLoad(void);
+static void writeReport(uint64_t wallUs);
+static uint64_t hostMicros(void);
+
+/**
+ * Parse the harness options, see simharness.h
+ */
+int32_t SimHarnessParseArgs(int argc, char *argv[])
+{
+    const char *scriptPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--virtual-clock")) {
+            vPortEnableVirtualClock();
+        } else if (!strcmp(argv[i], "--script") && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (!strcmp(argv[i], "--report") && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else if (!strcmp(argv[i], "--duration") && i + 1 < argc) {
+            durationMs = strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--virtual-clock] [--script file] [--duration ms] [--report file]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (scriptPath && loadScript(scriptPath) != 0) {
+        return -1;
+    }
+    harnessEnabled = scriptPath || durationMs || reportPath || xPortVirtualClockEnabled();
+    return 0;
+}
+
+/**
+ * Start the harness task, see simharness.h
+ */
+int32_t SimHarnessStart(void)
+{
+    xTaskHandle taskHandle;
+
+    if (!harnessEnabled) {
+        return 0;
+    }
+    if (xTaskCreate(harnessTask, "SimHarness", HARNESS_TASK_STACK, NULL, HARNESS_TASK_PRIORITY, &taskHandle) != pdPASS) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Replay the script, keep the statistics and stop at the end of the run
+ */
+static void harnessTask(__attribute__((unused)) void *parameters)
+{
+    portTickType startTick = xTaskGetTickCount();
+    portTickType lastWake  = startTick;
+    uint64_t startUs = hostMicros();
+    uint32_t next    = 0;
+    uint32_t nextSampleMs = HARNESS_SAMPLE_MS;
+
+    while (1) {
+        uint32_t nowMs = (xTaskGetTickCount() - startTick) * portTICK_RATE_MS;
+
+        while (next < scriptLength && script[next].timeMs <= nowMs) {
+            applyInput(&script[next++]);
+        }
+
+        sampleStats();
+        if (nowMs >= nextSampleMs) {
+            sampleLoad();
+            nextSampleMs += HARNESS_SAMPLE_MS;
+        }
+
+        if (durationMs && nowMs >= durationMs) {
+            writeReport(hostMicros() - startUs);
+            exit(0);
+        }
+
+        vTaskDelayUntil(&lastWake, 1);
+    }
+}
+
+/**
+ * Read a compiled script, the lines must be sorted by time
+ */
+static int32_t loadScript(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[160];
+    char typeName[16];
+    char valueText[32];
+    uint32_t lineNumber = 0;
+    uint32_t capacity   = 0;
+
+    if (!file) {
+        fprintf(stderr, "simharness: can't open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        HarnessInput input;
+        unsigned int instId, offset;
+        uint8_t type;
+
+        lineNumber++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        memset(&input, 0, sizeof(input));
+        if (sscanf(line, "%u %x %u %u %15s %31s", &input.timeMs, &input.objId, &instId, &offset, typeName, valueText) != 6) {
+            fprintf(stderr, "simharness: %s:%u: malformed line\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+        for (type = 0; type < HARNESS_TYPES; type++) {
+            if (!strcmp(typeName, harnessTypeNames[type])) {
+                break;
+            }
+        }
+        if (type == HARNESS_TYPES || (scriptLength && input.timeMs < script[scriptLength - 1].timeMs)) {
+            fprintf(stderr, "simharness: %s:%u: bad type or time\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+        input.instId = instId;
+        input.offset = offset;
+        input.type   = type;
+        if (type == HARNESS_FLOAT) {
+            input.value.f = strtof(valueText, NULL);
+        } else if (type == HARNESS_UINT8 || type == HARNESS_UINT16 || type == HARNESS_UINT32) {
+            input.value.u = strtoul(valueText, NULL, 0);
+        } else {
+            input.value.i = strtol(valueText, NULL, 0);
+        }
+
+        if (scriptLength == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            script   = realloc(script, capacity * sizeof(HarnessInput));
+            if (!script) {
+                fclose(file);
+                return -1;
+            }
+        }
+        script[scriptLength++] = input;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Write one value into an object instance, read-modify-write of the whole
+ * instance so that the object sees a single update
+ */
+static void applyInput(const HarnessInput *input)
+{
+    static uint8_t data[UAVOBJECTS_LARGEST];
+    UAVObjHandle obj = UAVObjGetByID(input->objId);
+    uint8_t size     = harnessTypeSizes[input->type];
+
+    if (!obj || input->instId >= UAVObjGetNumInstances(obj) ||
+        input->offset + size > UAVObjGetNumBytes(obj) ||
+        UAVObjGetInstanceData(obj, input->instId, data) != 0) {
+        scriptErrors++;
+        return;
+    }
+
+    switch (input->type) {
+    case HARNESS_INT8:
+    case HARNESS_UINT8:
+    {
+        uint8_t value = input->value.u;
+        memcpy(&data[input->offset], &value, size);
+        break;
+    }
+    case HARNESS_INT16:
+    case HARNESS_UINT16:
+    {
+        uint16_t value = input->value.u;
+        memcpy(&data[input->offset], &value, size);
+        break;
+    }
+    default:
+        memcpy(&data[input->offset], &input->value, size);
+        break;
+    }
+
+    if (UAVObjSetInstanceData(obj, input->instId, data) != 0) {
+        scriptErrors++;
+        return;
+    }
+    scriptApplied++;
+}
+
+/**
+ * Add the increase of a counter that is cleared behind our back, a value
+ * smaller than last time means it was cleared in between.
+ */
+static uint32_t accumulate(uint32_t total, uint32_t last, uint32_t now)
+{
+    return total + ((now >= last) ? now - last : now);
+}
+
+static void sampleStats(void)
+{
+    UAVObjStats objStats;
+    EventStats eventStats;
+
+    UAVObjGetStats(&objStats);
+    EventGetStats(&eventStats);
+    objectQueueErrors    = accumulate(objectQueueErrors, lastObjStats.eventQueueErrors, objStats.eventQueueErrors);
+    objectCallbackErrors = accumulate(objectCallbackErrors, lastObjStats.eventCallbackErrors, objStats.eventCallbackErrors);
+    eventErrors = accumulate(eventErrors, lastEventStats.eventErrors, eventStats.eventErrors);
+    lastObjStats   = objStats;
+    lastEventStats = eventStats;
+}
+
+/**
+ * Sample the load the system module published during the last second
+ */
+static void sampleLoad(void)
+{
+    TaskInfoData taskInfo;
+    CallbackInfoData callbackInfo;
+
+    TaskInfoGet(&taskInfo);
+    for (uint16_t i = 0; i < TASKINFO_RUNNING_NUMELEM; i++) {
+        taskTimeSum[i] += ((uint8_t *)&taskInfo.RunningTime)[i];
+    }
+    taskSamples++;
+
+    CallbackInfoGet(&callbackInfo);
+    memcpy(callbackRuns, &callbackInfo.RunningTime, sizeof(callbackRuns));
+}
+
+static void writeReport(uint64_t wallUs)
+{
+    FILE *out = reportPath ? fopen(reportPath, "w") : stdout;
+    struct rusage usage;
+    uint32_t events, dropped, udpTx, udpRx;
+
+    if (!out) {
+        fprintf(stderr, "simharness: can't write %s\n", reportPath);
+        exit(1);
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+    EventGetTotals(&events, &dropped);
+    PIOS_UDP_GetTotals(&udpTx, &udpRx);
+
+    fprintf(out, "sim_time_ms %u\n", durationMs);
+    fprintf(out, "host_wall_us %llu\n", (unsigned long long)wallUs);
+    fprintf(out, "host_cpu_us %llu\n", (unsigned long long)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+            usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    fprintf(out, "virtual_clock %d\n", xPortVirtualClockEnabled() ? 1 : 0);
+    fprintf(out, "clock_stalls %lu\n", ulPortGetVirtualClockStalls());
+    fprintf(out, "script_applied %u\n", scriptApplied);
+    fprintf(out, "script_errors %u\n", scriptErrors);
+    fprintf(out, "events_total %u\n", events);
+    fprintf(out, "events_dropped %u\n", dropped);
+    fprintf(out, "event_errors %u\n", eventErrors);
+    fprintf(out, "object_queue_errors %u\n", objectQueueErrors);
+    fprintf(out, "object_callback_errors %u\n", objectCallbackErrors);
+    fprintf(out, "udp_tx_bytes %u\n", udpTx);
+    fprintf(out, "udp_rx_bytes %u\n", udpRx);
+    for (uint16_t i = 0; i < TASKINFO_RUNNING_NUMELEM; i++) {
+        fprintf(out, "task_cpu_pct.%u %u\n", i, taskSamples ? taskTimeSum[i] / taskSamples : 0);
+    }
+    for (uint16_t i = 0; i < CALLBACKINFO_RUNNING_NUMELEM; i++) {
+        fprintf(out, "callback_runs.%u %u\n", i, callbackRuns[i]);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+static uint64_t hostMicros(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/**
+ * @}
+ * @}
+ */
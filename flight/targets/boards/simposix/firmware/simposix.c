@@ -34,6 +34,7 @@
 #include "inc/openpilot.h"
 #include <systemmod.h>
 #include <uavobjectsinit.h>
+#include <simharness.h>
 
 /* Task Priorities */
 #define PRIORITY_TASK_HOOKS (tskIDLE_PRIORITY + 3)
@@ -84,11 +85,16 @@ extern void InitModules(void);
  * Start FreeRTOS Scheduler (vTaskStartScheduler)<BR>
  * If something goes wrong, blink LED1 and LED2 every 100ms
  *
+ * The simulator also takes the performance harness options, see simharness.h
  */
-int main()
+int main(int argc, char *argv[])
 {
     int result;
 
+    if (SimHarnessParseArgs(argc, argv) != 0) {
+        return 1;
+    }
+
     /* NOTE: Do NOT modify the following start-up sequence */
     /* Any new initialization functions should be added in OpenPilotInit() */
 
@@ -129,6 +135,11 @@ void initTask(__attribute__((unused)) void *parameters)
     /* Initialize modules */
     MODULE_INITIALISE_ALL;
 
+    /* scripted input and reporting, if requested on the command line */
+    if (SimHarnessStart() != 0) {
+        PIOS_Assert(0);
+    }
+
     /* terminate this task */
     vTaskDelete(NULL);
 }
@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <assert.h>
+
+/* Single threaded stand-ins for the FreeRTOS calls used by the callback scheduler */
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv)       (free(pv))
+
+#define pdTRUE              1
+#define tskIDLE_PRIORITY    0
+#define portMAX_DELAY       0xffffffff
+#define portTICK_RATE_MS    1
+
+typedef void *xTaskHandle;
+typedef uint32_t *xSemaphoreHandle;
+typedef void (*pdTASK_CODE)(void *);
+
+/* The test drives the clock and counts the scheduler wakeups */
+extern uint32_t test_tick;
+extern uint32_t test_signals;
+
+static inline uint32_t xTaskGetTickCount(void)
+{
+    return test_tick;
+}
+
+/* Scheduler tasks are not spawned, the test runs them one step at a time */
+static inline long xTaskCreate(pdTASK_CODE code, const char *name, uint16_t stack, void *param, uint32_t priority, xTaskHandle *handle)
+{
+    (void)code;
+    (void)name;
+    (void)stack;
+    (void)priority;
+    *handle = param;
+    return pdTRUE;
+}
+
+static inline xSemaphoreHandle xSemaphoreCreateRecursiveMutex(void)
+{
+    return &test_signals;
+}
+
+static inline long xSemaphoreTakeRecursive(xSemaphoreHandle sem, uint32_t wait)
+{
+    (void)sem;
+    (void)wait;
+    return pdTRUE;
+}
+
+static inline long xSemaphoreGiveRecursive(xSemaphoreHandle sem)
+{
+    (void)sem;
+    return pdTRUE;
+}
+
+#define vSemaphoreCreateBinary(sem) ((sem) = &test_signals)
+
+static inline long xSemaphoreGive(xSemaphoreHandle sem)
+{
+    ++*sem;
+    return pdTRUE;
+}
+
+static inline long xSemaphoreGiveFromISR(xSemaphoreHandle sem, long *woken)
+{
+    (void)woken;
+    ++*sem;
+    return pdTRUE;
+}
+
+static inline long xSemaphoreTake(xSemaphoreHandle sem, uint32_t wait)
+{
+    (void)sem;
+    (void)wait;
+    return pdTRUE;
+}
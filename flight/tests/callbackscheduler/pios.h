@@ -0,0 +1,30 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#endif
+#include "pios_mem.h"
+
+#define PIOS_Assert(test) assert(test)
+
+/* The scheduler measures latencies against this clock */
+extern uint32_t test_raw_us;
+#define PIOS_DELAY_GetRaw()     (test_raw_us)
+#define PIOS_DELAY_DiffuS(raw)  (test_raw_us - (raw))
+
+#define PIOS_TASK_MONITOR_RegisterTask(id, handle)
+
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+#include "pios_callbackscheduler.h"
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,7 @@
+#ifndef TASKINFO_H
+#define TASKINFO_H
+
+#define TASKINFO_RUNNING_CALLBACKSCHEDULER0 0
+#define TASKINFO_RUNNING_CALLBACKSCHEDULER3 3
+
+#endif /* TASKINFO_H */
@@ -0,0 +1,4 @@
+#ifndef UAVOBJECTMANAGER_H
+#define UAVOBJECTMANAGER_H
+
+#endif /* UAVOBJECTMANAGER_H */
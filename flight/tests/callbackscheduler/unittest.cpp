@@ -0,0 +1,273 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+
+#include <string>
+
+extern "C" {
+#include "pios.h"
+
+extern uint32_t test_tick;
+extern uint32_t test_raw_us;
+
+void test_reset_scheduler(void);
+int32_t test_run_next_callback(DelayedCallbackInfo *cbinfo);
+}
+
+/* Execution trace, one letter per callback run */
+static std::string trace;
+
+/* Callbacks that keep dispatching themselves stay ready for ever */
+static DelayedCallbackInfo *handles[6];
+static bool redispatch;
+static uint32_t execution_us;
+
+#define TEST_CALLBACK(n, letter) \
+    static void callback_ ## letter(void) \
+    { \
+        trace += #letter; \
+        test_raw_us += execution_us; \
+        if (redispatch) { \
+            PIOS_CALLBACKSCHEDULER_Dispatch(handles[n]); \
+        } \
+    }
+
+TEST_CALLBACK(0, A)
+TEST_CALLBACK(1, B)
+TEST_CALLBACK(2, c)
+TEST_CALLBACK(3, d)
+TEST_CALLBACK(4, x)
+TEST_CALLBACK(5, y)
+
+static DelayedCallback callbacks[6] = { callback_A, callback_B, callback_c, callback_d, callback_x, callback_y };
+static DelayedCallbackPriority priorities[6] = {
+    CALLBACK_PRIORITY_CRITICAL, CALLBACK_PRIORITY_CRITICAL,
+    CALLBACK_PRIORITY_REGULAR,  CALLBACK_PRIORITY_REGULAR,
+    CALLBACK_PRIORITY_LOW,      CALLBACK_PRIORITY_LOW
+};
+
+/* ForEachCallback receiver */
+static struct pios_callback_info reported[6];
+
+static void collect_info(int16_t callback_id, const struct pios_callback_info *info, void *context)
+{
+    (void)context;
+    reported[callback_id] = *info;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CallbackSchedulerTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        test_tick    = 1000;
+        test_raw_us  = 0;
+        execution_us = 0;
+        redispatch   = false;
+        trace.clear();
+        memset(reported, 0, sizeof(reported));
+
+        test_reset_scheduler();
+        for (int i = 0; i < 6; i++) {
+            handles[i] = PIOS_CALLBACKSCHEDULER_Create(callbacks[i], priorities[i], CALLBACK_TASK_AUXILIARY, i, 64);
+            ASSERT_TRUE(handles[i] != NULL);
+        }
+        ASSERT_EQ(0, PIOS_CALLBACKSCHEDULER_Start());
+    }
+
+    /* run the scheduler task until it wants to sleep or runs limit callbacks */
+    int32_t run(int limit)
+    {
+        int32_t delay = 0;
+
+        for (int i = 0; i < limit; i++) {
+            delay = test_run_next_callback(handles[0]);
+            if (delay) {
+                break;
+            }
+        }
+        return delay;
+    }
+};
+
+TEST_F(CallbackSchedulerTest, RoundRobinAllWaiting) {
+    redispatch = true;
+    for (int i = 0; i < 6; i++) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(handles[i]);
+    }
+    run(36);
+    EXPECT_EQ("ABcABdABxABcABdAByABcABdABxABcABdABy", trace);
+}
+
+TEST_F(CallbackSchedulerTest, RoundRobinSomeWaiting) {
+    redispatch = true;
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[0]);
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[2]);
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[4]);
+    run(16);
+    EXPECT_EQ("AcAxAcAxAcAxAcAx", trace);
+
+    /* only A and y */
+    redispatch = false;
+    run(10);
+    trace.clear();
+    redispatch = true;
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[0]);
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[5]);
+    run(8);
+    EXPECT_EQ("AyAyAyAy", trace);
+}
+
+TEST_F(CallbackSchedulerTest, DispatchIsMerged) {
+    /* repeated dispatches before execution run the callback once */
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[3]);
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[3]);
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[1]);
+    EXPECT_EQ(1000, run(10));
+    EXPECT_EQ("Bd", trace);
+}
+
+TEST_F(CallbackSchedulerTest, TimersRunInOrder) {
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[4], 30, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[0], 50, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[2], 10, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[5], 20, CALLBACK_UPDATEMODE_NONE));
+
+    /* the sleep time is the distance to the earliest timer */
+    EXPECT_EQ(10, run(10));
+    EXPECT_EQ("", trace);
+
+    test_tick += 10;
+    EXPECT_EQ(10, run(10));
+    EXPECT_EQ("c", trace);
+
+    test_tick += 10;
+    EXPECT_EQ(10, run(10));
+    EXPECT_EQ("cy", trace);
+
+    /* callbacks due together run in round robin order */
+    EXPECT_EQ(2, PIOS_CALLBACKSCHEDULER_Schedule(handles[0], 10, CALLBACK_UPDATEMODE_SOONER));
+    test_tick += 10;
+    EXPECT_EQ(1000, run(10));
+    EXPECT_EQ("cyAx", trace);
+}
+
+TEST_F(CallbackSchedulerTest, RescheduleModes) {
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 20, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(0, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 10, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(0, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 10, CALLBACK_UPDATEMODE_LATER));
+    EXPECT_EQ(0, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 30, CALLBACK_UPDATEMODE_SOONER));
+    EXPECT_EQ(20, run(10));
+
+    EXPECT_EQ(2, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 5, CALLBACK_UPDATEMODE_SOONER));
+    EXPECT_EQ(5, run(10));
+
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[3], 15, CALLBACK_UPDATEMODE_NONE));
+    EXPECT_EQ(2, PIOS_CALLBACKSCHEDULER_Schedule(handles[1], 40, CALLBACK_UPDATEMODE_LATER));
+    EXPECT_EQ(15, run(10));
+
+    EXPECT_EQ(2, PIOS_CALLBACKSCHEDULER_Schedule(handles[3], 50, CALLBACK_UPDATEMODE_OVERRIDE));
+    EXPECT_EQ(40, run(10));
+
+    test_tick += 40;
+    EXPECT_EQ(10, run(10));
+    EXPECT_EQ("B", trace);
+    test_tick += 10;
+    EXPECT_EQ(1000, run(10));
+    EXPECT_EQ("Bd", trace);
+}
+
+TEST_F(CallbackSchedulerTest, DispatchClearsSchedule) {
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[2], 100, CALLBACK_UPDATEMODE_NONE));
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[2]);
+    EXPECT_EQ(1000, run(10));
+    EXPECT_EQ("c", trace);
+
+    /* the executed callback is no longer scheduled */
+    test_tick += 200;
+    EXPECT_EQ(1000, run(10));
+    EXPECT_EQ("c", trace);
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[2], 100, CALLBACK_UPDATEMODE_NONE));
+}
+
+TEST_F(CallbackSchedulerTest, CallbackLimit) {
+    int created = 0;
+
+    /* the ready mask of a priority holds 32 callbacks, two are already taken */
+    while (PIOS_CALLBACKSCHEDULER_Create(callback_A, CALLBACK_PRIORITY_CRITICAL, CALLBACK_TASK_AUXILIARY, 100, 64)) {
+        created++;
+        ASSERT_LT(created, 100);
+    }
+    EXPECT_EQ(30, created);
+
+    /* other priorities and tasks are not affected */
+    EXPECT_TRUE(PIOS_CALLBACKSCHEDULER_Create(callback_x, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, 101, 64) != NULL);
+    EXPECT_TRUE(PIOS_CALLBACKSCHEDULER_Create(callback_A, CALLBACK_PRIORITY_CRITICAL, CALLBACK_TASK_NAVIGATION, 102, 64) != NULL);
+
+    /* and the grown tables still schedule correctly */
+    EXPECT_EQ(1, PIOS_CALLBACKSCHEDULER_Schedule(handles[4], 10, CALLBACK_UPDATEMODE_NONE));
+    PIOS_CALLBACKSCHEDULER_Dispatch(handles[1]);
+    EXPECT_EQ(10, run(10));
+    EXPECT_EQ("B", trace);
+}
+
+TEST_F(CallbackSchedulerTest, LatencyHistograms) {
+    /* bucket n counts samples below 16 << (2 * n) microseconds */
+    static const uint32_t latencies[] = { 0, 15, 16, 100, 300, 2000, 70000, 123456 };
+
+    execution_us = 20;
+    for (unsigned i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(handles[2]);
+        test_raw_us += latencies[i];
+        run(1);
+    }
+    EXPECT_EQ("cccccccc", trace);
+
+    PIOS_CALLBACKSCHEDULER_ForEachCallback(collect_info, NULL);
+    EXPECT_EQ(8u, reported[2].running_time_count);
+    EXPECT_EQ(2, reported[2].dispatch_latency[0]);
+    EXPECT_EQ(1, reported[2].dispatch_latency[1]);
+    EXPECT_EQ(1, reported[2].dispatch_latency[2]);
+    EXPECT_EQ(1, reported[2].dispatch_latency[3]);
+    EXPECT_EQ(1, reported[2].dispatch_latency[4]);
+    EXPECT_EQ(0, reported[2].dispatch_latency[5]);
+    EXPECT_EQ(0, reported[2].dispatch_latency[6]);
+    EXPECT_EQ(2, reported[2].dispatch_latency[7]);
+    EXPECT_EQ(123456u, reported[2].max_dispatch_latency);
+    EXPECT_EQ(8, reported[2].execution_time[1]);
+    EXPECT_EQ(20u, reported[2].max_execution_time);
+    EXPECT_EQ(0u, reported[3].running_time_count);
+    EXPECT_EQ(0, reported[3].dispatch_latency[0]);
+
+    /* reporting starts a new period */
+    PIOS_CALLBACKSCHEDULER_ForEachCallback(collect_info, NULL);
+    EXPECT_EQ(8u, reported[2].running_time_count);
+    EXPECT_EQ(0, reported[2].dispatch_latency[0]);
+    EXPECT_EQ(0, reported[2].dispatch_latency[7]);
+    EXPECT_EQ(0u, reported[2].max_dispatch_latency);
+    EXPECT_EQ(0, reported[2].execution_time[1]);
+}
+
+TEST_F(CallbackSchedulerTest, SchedulerOverhead) {
+    const int runs = 1000000;
+    struct timespec start, end;
+
+    /* all six callbacks permanently ready, cost of picking and running one */
+    redispatch = true;
+    for (int i = 0; i < 6; i++) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(handles[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < runs; i++) {
+        if (trace.size() > 1024) {
+            trace.clear();
+        }
+        test_run_next_callback(handles[0]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / runs;
+    printf("scheduler: %.1f ns/callback\n", ns);
+    RecordProperty("scheduler_ns", (int)ns);
+}
@@ -0,0 +1,20 @@
+/*
+ * The scheduler core is private to its translation unit, build it here
+ * and export the entry points the test needs.
+ */
+
+#include "pios_callbackscheduler.c"
+
+uint32_t test_tick;
+uint32_t test_signals;
+uint32_t test_raw_us;
+
+void test_reset_scheduler(void)
+{
+    PIOS_CALLBACKSCHEDULER_Initialize();
+}
+
+int32_t test_run_next_callback(DelayedCallbackInfo *cbinfo)
+{
+    return runNextCallback(cbinfo->task);
+}
@@ -0,0 +1,35 @@
+/*
+ * Minimal stand-in for the generated GPSPositionSensor UAVObject header,
+ * the setter is implemented by the unit test.
+ */
+#ifndef GPSPOSITIONSENSOR_H
+#define GPSPOSITIONSENSOR_H
+
+#include <stdint.h>
+
+#define GPSPOSITIONSENSOR_OBJID 0x9DF1F67A
+
+typedef enum {
+    GPSPOSITIONSENSOR_STATUS_NOGPS = 0,
+    GPSPOSITIONSENSOR_STATUS_NOFIX = 1,
+    GPSPOSITIONSENSOR_STATUS_FIX2D = 2,
+    GPSPOSITIONSENSOR_STATUS_FIX3D = 3
+} GPSPositionSensorStatusOptions;
+
+typedef struct {
+    int32_t Latitude;
+    int32_t Longitude;
+    float   Altitude;
+    float   GeoidSeparation;
+    float   Heading;
+    float   Groundspeed;
+    float   PDOP;
+    float   HDOP;
+    float   VDOP;
+    uint8_t Status;
+    int8_t  Satellites;
+} GPSPositionSensorData;
+
+int32_t GPSPositionSensorSet(GPSPositionSensorData *dataIn);
+
+#endif /* GPSPOSITIONSENSOR_H */
@@ -0,0 +1,22 @@
+/*
+ * Minimal stand-in for the generated GPSSatellites UAVObject header,
+ * the setter is implemented by the unit test.
+ */
+#ifndef GPSSATELLITES_H
+#define GPSSATELLITES_H
+
+#include <stdint.h>
+
+#define GPSSATELLITES_PRN_NUMELEM 16
+
+typedef struct {
+    float  Elevation[16];
+    float  Azimuth[16];
+    int8_t SatsInView;
+    int8_t PRN[16];
+    int8_t SNR[16];
+} GPSSatellitesData;
+
+int32_t GPSSatellitesSet(GPSSatellitesData *dataIn);
+
+#endif /* GPSSATELLITES_H */
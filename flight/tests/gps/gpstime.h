@@ -0,0 +1,22 @@
+/*
+ * Minimal stand-in for the generated GPSTime UAVObject header,
+ * the accessors are implemented by the unit test.
+ */
+#ifndef GPSTIME_H
+#define GPSTIME_H
+
+#include <stdint.h>
+
+typedef struct {
+    int16_t Year;
+    int8_t  Month;
+    int8_t  Day;
+    int8_t  Hour;
+    int8_t  Minute;
+    int8_t  Second;
+} GPSTimeData;
+
+int32_t GPSTimeGet(GPSTimeData *dataOut);
+int32_t GPSTimeSet(GPSTimeData *dataIn);
+
+#endif /* GPSTIME_H */
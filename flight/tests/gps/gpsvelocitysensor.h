@@ -0,0 +1,18 @@
+/*
+ * Minimal stand-in for the generated GPSVelocitySensor UAVObject header,
+ * the setter is implemented by the unit test.
+ */
+#ifndef GPSVELOCITYSENSOR_H
+#define GPSVELOCITYSENSOR_H
+
+#include <stdint.h>
+
+typedef struct {
+    float North;
+    float East;
+    float Down;
+} GPSVelocitySensorData;
+
+int32_t GPSVelocitySensorSet(GPSVelocitySensorData *dataIn);
+
+#endif /* GPSVELOCITYSENSOR_H */
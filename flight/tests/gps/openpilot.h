@@ -0,0 +1,16 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIOS_Assert(x) \
+    if (!(x)) { while (1) {; } \
+    }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+
+#define NELEMENTS(x) (sizeof(x) / sizeof((x)[0]))
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,289 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* strtoul */
+#include <string.h> /* memset */
+#include <time.h> /* clock_gettime */
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "GPS.h"
+#include "NMEA.h"
+
+/* UBX.h can't be included from C++ (its header has a field named "class") */
+int parse_ubx_stream(uint8_t, char *, GPSPositionSensorData *, struct GPS_RX_STATS *);
+
+/* UAVObject stand-ins, record what the parsers publish */
+static GPSPositionSensorData gpsposition;
+static GPSVelocitySensorData gpsvelocity;
+static GPSSatellitesData gpssatellites;
+static GPSTimeData gpstime;
+
+static uint32_t gpsposition_updates;
+static uint32_t gpssatellites_updates;
+
+int32_t GPSPositionSensorSet(GPSPositionSensorData *dataIn)
+{
+    gpsposition = *dataIn;
+    gpsposition_updates++;
+    return 0;
+}
+
+int32_t GPSVelocitySensorSet(GPSVelocitySensorData *dataIn)
+{
+    gpsvelocity = *dataIn;
+    return 0;
+}
+
+int32_t GPSSatellitesSet(GPSSatellitesData *dataIn)
+{
+    gpssatellites = *dataIn;
+    gpssatellites_updates++;
+    return 0;
+}
+
+int32_t GPSTimeGet(GPSTimeData *dataOut)
+{
+    *dataOut = gpstime;
+    return 0;
+}
+
+int32_t GPSTimeSet(GPSTimeData *dataIn)
+{
+    gpstime = *dataIn;
+    return 0;
+}
+}
+
+/* Number of times the corpora are replayed for the throughput figures */
+#define BENCHMARK_PASSES 500
+
+static std::vector<uint8_t> load_nmea_corpus()
+{
+    std::vector<uint8_t> corpus;
+    FILE *f = fopen(GPS_CORPUS_DIR "/nmea_corpus.txt", "rb");
+    int c;
+
+    if (f) {
+        while ((c = fgetc(f)) != EOF) {
+            corpus.push_back(c);
+        }
+        fclose(f);
+    }
+    return corpus;
+}
+
+static std::vector<uint8_t> load_ubx_corpus()
+{
+    std::vector<uint8_t> corpus;
+    FILE *f = fopen(GPS_CORPUS_DIR "/ubx_corpus.txt", "r");
+    char line[128];
+
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            if (line[0] == '#') {
+                continue;
+            }
+            for (char *p = line; p[0] && p[1] && p[0] != '\n'; p += 2) {
+                char byte[3] = { p[0], p[1], 0 };
+                corpus.push_back(strtoul(byte, NULL, 16));
+            }
+        }
+        fclose(f);
+    }
+    return corpus;
+}
+
+static double now_seconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class GpsParserTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(&gpsposition, 0, sizeof(gpsposition));
+        memset(&gpsvelocity, 0, sizeof(gpsvelocity));
+        memset(&gpssatellites, 0, sizeof(gpssatellites));
+        memset(&gpstime, 0, sizeof(gpstime));
+        gpsposition_updates   = 0;
+        gpssatellites_updates = 0;
+
+        memset(&data, 0, sizeof(data));
+        memset(&stats, 0, sizeof(stats));
+        memset(rx_buffer, 0, sizeof(rx_buffer));
+    }
+
+    int feed(int (*parser)(uint8_t, char *, GPSPositionSensorData *, struct GPS_RX_STATS *), const std::vector<uint8_t> & corpus)
+    {
+        int complete = 0;
+
+        for (size_t i = 0; i < corpus.size(); i++) {
+            if (parser(corpus[i], rx_buffer, &data, &stats) == PARSER_COMPLETE) {
+                complete++;
+            }
+        }
+        return complete;
+    }
+
+    double benchmark(int (*parser)(uint8_t, char *, GPSPositionSensorData *, struct GPS_RX_STATS *), const std::vector<uint8_t> & corpus)
+    {
+        double start = now_seconds();
+
+        for (int pass = 0; pass < BENCHMARK_PASSES; pass++) {
+            feed(parser, corpus);
+        }
+        return (corpus.size() * (double)BENCHMARK_PASSES) / (now_seconds() - start);
+    }
+
+    GPSPositionSensorData data;
+    struct GPS_RX_STATS stats;
+    /* large enough for a struct UBXPacket as well as an NMEA sentence */
+    char rx_buffer[256] __attribute__((aligned(4)));
+};
+
+TEST_F(GpsParserTest, NmeaCorpus) {
+    std::vector<uint8_t> corpus = load_nmea_corpus();
+    ASSERT_FALSE(corpus.empty());
+
+    EXPECT_EQ(98, feed(parse_nmea_stream, corpus));
+
+    /* 94 known sentences, 4 GLGSV without a parser, 1 dropped character */
+    EXPECT_EQ(94, stats.gpsRxReceived);
+    EXPECT_EQ(4, stats.gpsRxParserError);
+    EXPECT_EQ(1, stats.gpsRxChkSumError);
+    EXPECT_EQ(0, stats.gpsRxOverflow);
+
+    /* one update per GGA sentence */
+    EXPECT_EQ(20u, gpsposition_updates);
+    EXPECT_EQ(GPSPOSITIONSENSOR_STATUS_FIX3D, gpsposition.Status);
+    EXPECT_EQ(-338520607, gpsposition.Latitude); /* 3351.123646 S */
+    EXPECT_EQ(1512094711, gpsposition.Longitude); /* 15112.56827 E */
+    EXPECT_FLOAT_EQ(-12.3f, gpsposition.Altitude);
+    EXPECT_FLOAT_EQ(-34.2f, gpsposition.GeoidSeparation);
+    EXPECT_EQ(9, gpsposition.Satellites);
+    EXPECT_FLOAT_EQ(1.8f, gpsposition.PDOP);
+    EXPECT_FLOAT_EQ(0.9f, gpsposition.HDOP);
+    EXPECT_FLOAT_EQ(1.5f, gpsposition.VDOP);
+
+    /* VTG follows GGA, so the last values are only in the working copy */
+    EXPECT_FLOAT_EQ(54.7f, data.Heading);
+    EXPECT_FLOAT_EQ(12.5f * 0.51444f, data.Groundspeed);
+
+    EXPECT_EQ(4u, gpssatellites_updates);
+    EXPECT_EQ(11, gpssatellites.SatsInView);
+    EXPECT_EQ(5, gpssatellites.PRN[0]);
+    EXPECT_EQ(30, gpssatellites.PRN[10]);
+    EXPECT_FLOAT_EQ(301.0f, gpssatellites.Azimuth[2]);
+    EXPECT_EQ(0, gpssatellites.SNR[5]);
+
+    EXPECT_EQ(2026, gpstime.Year);
+    EXPECT_EQ(10, gpstime.Month);
+    EXPECT_EQ(19, gpstime.Day);
+    EXPECT_EQ(9, gpstime.Hour);
+    EXPECT_EQ(56, gpstime.Minute);
+    EXPECT_EQ(13, gpstime.Second);
+}
+
+TEST_F(GpsParserTest, NmeaOverrun) {
+    std::vector<uint8_t> sentence(1, '$');
+
+    sentence.insert(sentence.end(), NMEA_MAX_PACKET_LENGTH, 'A');
+    feed(parse_nmea_stream, sentence);
+    EXPECT_EQ(1, stats.gpsRxOverflow);
+
+    /* the parser resynchronizes on the next sentence */
+    const char *gsa = "$GPGSA,A,2,05,09,13,,,,,,,,,,2.8,1.9,2.5*38\r\n";
+    sentence.assign(gsa, gsa + strlen(gsa));
+    EXPECT_EQ(1, feed(parse_nmea_stream, sentence));
+    EXPECT_EQ(1, stats.gpsRxReceived);
+    EXPECT_EQ(GPSPOSITIONSENSOR_STATUS_FIX2D, data.Status);
+    EXPECT_FLOAT_EQ(2.5f, data.VDOP);
+}
+
+TEST_F(GpsParserTest, NmeaTooManyFields) {
+    /* five satellites in a GSV sentence, one field more than the tokenizer keeps */
+    std::string sentence = "GPGSV,2,1,08,01,10,100,40,02,20,200,41,03,30,300,42,04,40,010,43,05,50,020,44";
+    uint8_t checksum     = 0;
+    char tail[8];
+
+    for (size_t i = 0; i < sentence.size(); i++) {
+        checksum ^= sentence[i];
+    }
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    sentence = "$" + sentence + tail;
+
+    std::vector<uint8_t> bytes(sentence.begin(), sentence.end());
+    EXPECT_EQ(1, feed(parse_nmea_stream, bytes));
+    EXPECT_EQ(1, stats.gpsRxReceived);
+    EXPECT_EQ(0, stats.gpsRxChkSumError);
+
+    /* the last field kept ends at the next comma, the rest is not stored */
+    const char *field = rx_buffer;
+    for (int i = 0; i < 19; i++) {
+        field += strlen(field) + 1;
+    }
+    EXPECT_STREQ("43", field);
+    EXPECT_EQ(0, field[strlen(field) + 1]);
+}
+
+TEST_F(GpsParserTest, UbxCorpus) {
+    std::vector<uint8_t> corpus = load_ubx_corpus();
+    ASSERT_FALSE(corpus.empty());
+
+    EXPECT_EQ(84, feed(parse_ubx_stream, corpus));
+    EXPECT_EQ(84, stats.gpsRxReceived);
+    EXPECT_EQ(1, stats.gpsRxChkSumError);
+    EXPECT_EQ(0, stats.gpsRxOverflow);
+
+    /* one update per complete POSLLH/SOL/DOP/VELNED set */
+    EXPECT_EQ(20u, gpsposition_updates);
+    EXPECT_EQ(GPSPOSITIONSENSOR_STATUS_FIX3D, gpsposition.Status);
+    EXPECT_EQ(-338520633, gpsposition.Latitude);
+    EXPECT_EQ(1511234757, gpsposition.Longitude);
+    EXPECT_FLOAT_EQ(-12.3f, gpsposition.Altitude);
+    EXPECT_FLOAT_EQ(62.319f, gpsposition.GeoidSeparation);
+    EXPECT_EQ(9, gpsposition.Satellites);
+    EXPECT_FLOAT_EQ(1.8f, gpsposition.PDOP);
+    EXPECT_FLOAT_EQ(0.9f, gpsposition.HDOP);
+    EXPECT_FLOAT_EQ(1.5f, gpsposition.VDOP);
+    EXPECT_FLOAT_EQ(3.7f, gpsposition.Groundspeed);
+    EXPECT_FLOAT_EQ(54.7f, gpsposition.Heading);
+
+    EXPECT_FLOAT_EQ(3.5f, gpsvelocity.North);
+    EXPECT_FLOAT_EQ(-1.2f, gpsvelocity.East);
+    EXPECT_FLOAT_EQ(-0.05f, gpsvelocity.Down);
+
+    EXPECT_EQ(11, gpssatellites.SatsInView);
+    EXPECT_EQ(13, gpssatellites.PRN[3]);
+    EXPECT_EQ(0, gpssatellites.PRN[11]);
+
+    EXPECT_EQ(2026, gpstime.Year);
+    EXPECT_EQ(12, gpstime.Second);
+}
+
+TEST_F(GpsParserTest, CorpusThroughput) {
+    std::vector<uint8_t> nmea = load_nmea_corpus();
+    std::vector<uint8_t> ubx  = load_ubx_corpus();
+    ASSERT_FALSE(nmea.empty());
+    ASSERT_FALSE(ubx.empty());
+
+    double nmea_rate = benchmark(parse_nmea_stream, nmea);
+    double ubx_rate  = benchmark(parse_ubx_stream, ubx);
+
+    printf("NMEA: %.1f MB/s (%lu bytes x %d)\n", nmea_rate * 1e-6, (unsigned long)nmea.size(), BENCHMARK_PASSES);
+    printf("UBX:  %.1f MB/s (%lu bytes x %d)\n", ubx_rate * 1e-6, (unsigned long)ubx.size(), BENCHMARK_PASSES);
+    RecordProperty("nmea_bytes_per_second", (int)nmea_rate);
+    RecordProperty("ubx_bytes_per_second", (int)ubx_rate);
+
+    /* every replay must decode the same way */
+    EXPECT_EQ(0, stats.gpsRxOverflow);
+    EXPECT_EQ(BENCHMARK_PASSES * 2, stats.gpsRxChkSumError);
+}
@@ -0,0 +1,9 @@
+/*
+ * Minimal stand-in for the generated ActuatorCommand UAVObject header.
+ */
+#ifndef ACTUATORCOMMAND_H
+#define ACTUATORCOMMAND_H
+
+#define ACTUATORCOMMAND_CHANNEL_NUMELEM 12
+
+#endif /* ACTUATORCOMMAND_H */
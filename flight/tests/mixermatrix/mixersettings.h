@@ -0,0 +1,88 @@
+/*
+ * Minimal stand-in for the generated MixerSettings UAVObject header, with
+ * the same field layout the UAVObject generator produces.
+ */
+#ifndef MIXERSETTINGS_H
+#define MIXERSETTINGS_H
+
+#include <stdint.h>
+
+typedef struct __attribute__ ((__packed__)) {
+    int8_t ThrottleCurve1;
+    int8_t ThrottleCurve2;
+    int8_t Roll;
+    int8_t Pitch;
+    int8_t Yaw;
+}  MixerSettingsMixer1VectorData;
+
+typedef struct {
+    float   MaxAccel;
+    float   FeedForward;
+    float   AccelTime;
+    float   DecelTime;
+    float   ThrottleCurve1[5];
+    float   ThrottleCurve2[5];
+    uint8_t Curve2Source;
+    uint8_t Mixer1Type;
+    MixerSettingsMixer1VectorData Mixer1Vector;
+    uint8_t Mixer2Type;
+    MixerSettingsMixer1VectorData Mixer2Vector;
+    uint8_t Mixer3Type;
+    MixerSettingsMixer1VectorData Mixer3Vector;
+    uint8_t Mixer4Type;
+    MixerSettingsMixer1VectorData Mixer4Vector;
+    uint8_t Mixer5Type;
+    MixerSettingsMixer1VectorData Mixer5Vector;
+    uint8_t Mixer6Type;
+    MixerSettingsMixer1VectorData Mixer6Vector;
+    uint8_t Mixer7Type;
+    MixerSettingsMixer1VectorData Mixer7Vector;
+    uint8_t Mixer8Type;
+    MixerSettingsMixer1VectorData Mixer8Vector;
+    uint8_t Mixer9Type;
+    MixerSettingsMixer1VectorData Mixer9Vector;
+    uint8_t Mixer10Type;
+    MixerSettingsMixer1VectorData Mixer10Vector;
+    uint8_t Mixer11Type;
+    MixerSettingsMixer1VectorData Mixer11Vector;
+    uint8_t Mixer12Type;
+    MixerSettingsMixer1VectorData Mixer12Vector;
+} __attribute__((packed)) MixerSettingsDataPacked;
+
+typedef MixerSettingsDataPacked __attribute__((aligned(4))) MixerSettingsData;
+
+/* Field ThrottleCurve1 information */
+#define MIXERSETTINGS_THROTTLECURVE1_NUMELEM 5
+
+/* Field ThrottleCurve2 information */
+#define MIXERSETTINGS_THROTTLECURVE2_NUMELEM 5
+
+/* Field Mixer1Type information */
+typedef enum {
+    MIXERSETTINGS_MIXER1TYPE_DISABLED=0,
+    MIXERSETTINGS_MIXER1TYPE_MOTOR=1,
+    MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR=2,
+    MIXERSETTINGS_MIXER1TYPE_SERVO=3,
+    MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1=4,
+    MIXERSETTINGS_MIXER1TYPE_CAMERAPITCHORSERVO2=5,
+    MIXERSETTINGS_MIXER1TYPE_CAMERAYAW=6,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY0=7,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY1=8,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY2=9,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY3=10,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY4=11,
+    MIXERSETTINGS_MIXER1TYPE_ACCESSORY5=12
+} MixerSettingsMixer1TypeOptions;
+
+/* Field Mixer1Vector information */
+typedef enum {
+    MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1=0,
+    MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2=1,
+    MIXERSETTINGS_MIXER1VECTOR_ROLL=2,
+    MIXERSETTINGS_MIXER1VECTOR_PITCH=3,
+    MIXERSETTINGS_MIXER1VECTOR_YAW=4
+} MixerSettingsMixer1VectorElem;
+
+#define MIXERSETTINGS_MIXER1VECTOR_NUMELEM 5
+
+#endif /* MIXERSETTINGS_H */
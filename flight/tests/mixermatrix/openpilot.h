@@ -0,0 +1,8 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#endif /* OPENPILOT_H */
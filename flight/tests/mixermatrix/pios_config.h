@@ -0,0 +1,6 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+/* Enable/Disable PiOS modules */
+
+#endif /* PIOS_CONFIG_H */
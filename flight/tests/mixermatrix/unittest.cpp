@@ -0,0 +1,199 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "mixermatrix.h"
+}
+
+#define TEST_ITERATIONS 20000
+
+/*
+ * Reference implementation: the per-channel mixing the actuator module
+ * did before the mixer matrix existed.
+ */
+static float ReferenceMixerCurve(const float throttle, const float *curve, uint8_t elements)
+{
+    float scale = throttle * (float)(elements - 1);
+    int idx1    = scale;
+
+    scale -= (float)idx1; // remainder
+    if (curve[0] < -1) {
+        return throttle;
+    }
+    if (idx1 < 0) {
+        idx1  = 0; // clamp to lowest entry in table
+        scale = 0;
+    }
+    int idx2 = idx1 + 1;
+    if (idx2 >= elements) {
+        idx2 = elements - 1; // clamp to highest entry in table
+        if (idx1 >= elements) {
+            idx1 = elements - 1;
+        }
+    }
+    return curve[idx1] * (1.0f - scale) + curve[idx2] * scale;
+}
+
+static float ReferenceMixer(const int index, const float curve1, const float curve2,
+                            const MixerSettingsData *mixerSettings, const float roll, const float pitch, const float yaw)
+{
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type;
+    const Mixer_t *mixer  = &mixers[index];
+
+    return (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] / 128.0f) * curve1) +
+           (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] / 128.0f) * curve2) +
+           (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL] / 128.0f) * roll) +
+           (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH] / 128.0f) * pitch) +
+           (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW] / 128.0f) * yaw);
+}
+
+static float random_float(float min, float max)
+{
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+static void random_curve(float *curve)
+{
+    for (int i = 0; i < MIXERSETTINGS_THROTTLECURVE1_NUMELEM; i++) {
+        curve[i] = random_float(-1.0f, 1.0f);
+    }
+    /* sometimes disable the curve */
+    if (rand() % 8 == 0) {
+        curve[0] = -2.0f;
+    }
+}
+
+static void random_settings(MixerSettingsData *settings)
+{
+    Mixer_t *mixers = (Mixer_t *)&settings->Mixer1Type;
+
+    memset(settings, 0, sizeof(*settings));
+    random_curve(settings->ThrottleCurve1);
+    random_curve(settings->ThrottleCurve2);
+    for (int ct = 0; ct < MIXERMATRIX_MIXERS; ct++) {
+        mixers[ct].type = rand() % (MIXERSETTINGS_MIXER1TYPE_ACCESSORY5 + 1);
+        for (int in = 0; in < MIXERMATRIX_INPUTS; in++) {
+            mixers[ct].matrix[in] = (rand() % 256) - 128;
+        }
+    }
+}
+
+/* inputs are mostly in range, with some samples on the curve grid and some outside */
+static float random_input()
+{
+    switch (rand() % 4) {
+    case 0:
+        return (rand() % 5) * 0.25f;
+
+    case 1:
+        return random_float(-1.5f, 1.5f);
+
+    default:
+        return random_float(-1.0f, 1.0f);
+    }
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class MixerMatrixTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(12345);
+    }
+};
+
+TEST_F(MixerMatrixTest, CompiledLayout) {
+    MixerSettingsData settings;
+    MixerMatrix_t mixerMatrix;
+
+    memset(&settings, 0, sizeof(settings));
+    settings.Mixer1Type = MIXERSETTINGS_MIXER1TYPE_MOTOR;
+    settings.Mixer1Vector.ThrottleCurve1 = 128 - 1;
+    settings.Mixer1Vector.Roll   = -64;
+    settings.Mixer3Type = MIXERSETTINGS_MIXER1TYPE_SERVO;
+    settings.Mixer3Vector.Yaw    = 32;
+    settings.Mixer12Type = MIXERSETTINGS_MIXER1TYPE_CAMERAYAW;
+    settings.ThrottleCurve1[0]   = -2.0f;
+
+    MixerMatrixCompile(&mixerMatrix, &settings);
+
+    EXPECT_EQ(3, mixerMatrix.nMixers);
+    EXPECT_EQ((1 << 0) | (1 << 2), mixerMatrix.mixed);
+    EXPECT_EQ(MIXERSETTINGS_MIXER1TYPE_CAMERAYAW, mixerMatrix.type[11]);
+    EXPECT_FLOAT_EQ(127.0f / 128.0f, mixerMatrix.matrix[0][MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1]);
+    EXPECT_FLOAT_EQ(-0.5f, mixerMatrix.matrix[0][MIXERSETTINGS_MIXER1VECTOR_ROLL]);
+    EXPECT_FLOAT_EQ(0.25f, mixerMatrix.matrix[2][MIXERSETTINGS_MIXER1VECTOR_YAW]);
+    EXPECT_TRUE(mixerMatrix.curve1.passthrough);
+    EXPECT_FALSE(mixerMatrix.curve2.passthrough);
+}
+
+TEST_F(MixerMatrixTest, CurveMatchesReference) {
+    MixerSettingsData settings;
+    MixerMatrix_t mixerMatrix;
+
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        if (i % 100 == 0) {
+            random_settings(&settings);
+            MixerMatrixCompile(&mixerMatrix, &settings);
+        }
+
+        float input     = random_input();
+        float expected1 = ReferenceMixerCurve(input, settings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+        float expected2 = ReferenceMixerCurve(input, settings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+        float curve1    = MixerMatrixCurve(&mixerMatrix.curve1, input);
+        float curve2    = MixerMatrixCurve(&mixerMatrix.curve2, input);
+
+        /* bit exact */
+        ASSERT_EQ(0, memcmp(&expected1, &curve1, sizeof(float))) << "input " << input;
+        ASSERT_EQ(0, memcmp(&expected2, &curve2, sizeof(float))) << "input " << input;
+    }
+}
+
+TEST_F(MixerMatrixTest, MatrixMatchesReference) {
+    MixerSettingsData settings;
+    MixerMatrix_t mixerMatrix;
+    float output[MIXERMATRIX_MIXERS];
+
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        if (i % 100 == 0) {
+            random_settings(&settings);
+            MixerMatrixCompile(&mixerMatrix, &settings);
+        }
+
+        float throttle = random_input();
+        float roll     = random_input();
+        float pitch    = random_input();
+        float yaw = random_input();
+        float curve1   = MixerMatrixCurve(&mixerMatrix.curve1, throttle);
+        float curve2   = MixerMatrixCurve(&mixerMatrix.curve2, roll);
+
+        float input[MIXERMATRIX_INPUTS];
+        input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1;
+        input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2;
+        input[MIXERSETTINGS_MIXER1VECTOR_ROLL]  = roll;
+        input[MIXERSETTINGS_MIXER1VECTOR_PITCH] = pitch;
+        input[MIXERSETTINGS_MIXER1VECTOR_YAW]   = yaw;
+
+        /* untouched outputs must stay untouched */
+        for (int ct = 0; ct < MIXERMATRIX_MIXERS; ct++) {
+            output[ct] = 42.0f;
+        }
+        MixerMatrixApply(&mixerMatrix, input, output);
+
+        const Mixer_t *mixers = (Mixer_t *)&settings.Mixer1Type;
+        for (int ct = 0; ct < MIXERMATRIX_MIXERS; ct++) {
+            if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) ||
+                (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) ||
+                (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
+                float expected = ReferenceMixer(ct, curve1, curve2, &settings, roll, pitch, yaw);
+                /* bit exact */
+                ASSERT_EQ(0, memcmp(&expected, &output[ct], sizeof(float))) << "mixer " << ct;
+            } else {
+                ASSERT_EQ(42.0f, output[ct]) << "mixer " << ct;
+            }
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/**
+ ******************************************************************************
+ *
+ * @file       dfudevice.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      The bootloader DFU protocol on the host, against a RAM flash.
+ *             Used by this test and by the GCS uploader test.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "pios.h"
+#include "common.h"
+#include "op_dfu.h"
+#include "pios_bl_helper.h"
+#include "pios_com_msg.h"
+#include <pios_board_info.h>
+#include "dfudevice.h"
+
+/* The bootloader keeps these in main.c, 8 bit enums there */
+uint8_t DeviceState;
+uint8_t JumpToApp;
+
+#define FLASH_BASE 0x08000000
+#define FW_BASE    (FLASH_BASE + 0x4000)
+
+const struct pios_board_info pios_board_info_blob = {
+    PIOS_BOARD_INFO_BLOB_MAGIC,
+    0x09, /* board_type */
+    0x03, /* board_rev */
+    0x04, /* bl_rev */
+    0, /* hw_type */
+    FW_BASE,
+    DFUDEVICE_FW_SIZE,
+    FW_BASE + DFUDEVICE_FW_SIZE,
+    DFUDEVICE_DESC_SIZE,
+    0,
+    0,
+};
+
+/* Flash stand-in, programming can only clear bits like the real one */
+static uint8_t flash[FW_BASE - FLASH_BASE + DFUDEVICE_FW_SIZE + DFUDEVICE_DESC_SIZE];
+static uint32_t erases;
+
+/* Replies of the device, one report at a time is enough for the protocol */
+static uint8_t reply[DFUDEVICE_REPORT];
+static int replyPending;
+
+uint8_t FLASH_ProgramWord(uint32_t address, uint32_t data)
+{
+    uint8_t *word = &flash[address - FLASH_BASE];
+
+    for (int i = 0; i < 4; i++) {
+        word[i] &= (uint8_t)(data >> (8 * i));
+        if (word[i] != (uint8_t)(data >> (8 * i))) {
+            return 0;
+        }
+    }
+    return FLASH_COMPLETE;
+}
+
+void FLASH_Lock(void) {}
+
+void PIOS_IAP_WriteBootCount(__attribute__((unused)) uint16_t count) {}
+
+void PIOS_IAP_WriteBootCmd(__attribute__((unused)) uint8_t number, __attribute__((unused)) uint32_t value) {}
+
+void PIOS_SYS_Reset(void) {}
+
+uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
+{
+    return &flash[SectorAddress - FLASH_BASE];
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Ini()
+{
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Start()
+{
+    /* Erases the firmware and the description, as the real one */
+    memset(&flash[FW_BASE - FLASH_BASE], 0xFF, DFUDEVICE_FW_SIZE + DFUDEVICE_DESC_SIZE);
+    erases++;
+    return 1;
+}
+
+/* What the STM32 CRC unit computes, one bit at a time */
+uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < DFUDEVICE_FW_SIZE; i += 4) {
+        const uint8_t *word = &flash[FW_BASE - FLASH_BASE + i];
+        crc ^= word[0] | word[1] << 8 | word[2] << 16 | (uint32_t)word[3] << 24;
+        for (int bit = 0; bit < 32; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+int32_t PIOS_COM_MSG_Send(__attribute__((unused)) uint32_t com_id, const uint8_t *msg, uint16_t msg_len)
+{
+    memset(reply, 0, sizeof(reply));
+    reply[0] = 0x01;
+    memcpy(&reply[1], msg, msg_len);
+    replyPending = 1;
+    return 0;
+}
+
+void dfudevice_init(void)
+{
+    memset(flash, 0xFF, sizeof(flash));
+    erases       = 0;
+    replyPending = 0;
+    DeviceState  = BLidle;
+    OPDfuIni(false);
+
+    uint8_t report[DFUDEVICE_REPORT] = { 0x02, Abort_Operation };
+    dfudevice_send(report);
+    report[1] = EnterDFU;
+    dfudevice_send(report);
+}
+
+void dfudevice_send(const uint8_t *report)
+{
+    uint8_t buf[DFUDEVICE_REPORT];
+
+    /* The device gets the report without its ID */
+    memcpy(buf, report + 1, DFUDEVICE_REPORT - 1);
+    processComand(buf);
+}
+
+int dfudevice_receive(uint8_t *report)
+{
+    if (DeviceState == downloading) {
+        DataDownload(start);
+    }
+    if (!replyPending) {
+        return 0;
+    }
+    memcpy(report, reply, DFUDEVICE_REPORT);
+    replyPending = 0;
+    return DFUDEVICE_REPORT;
+}
+
+const uint8_t *dfudevice_firmware(void)
+{
+    return &flash[FW_BASE - FLASH_BASE];
+}
+
+const uint8_t *dfudevice_description(void)
+{
+    return &flash[FW_BASE - FLASH_BASE + DFUDEVICE_FW_SIZE];
+}
+
+uint32_t dfudevice_erases(void)
+{
+    return erases;
+}
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ *
+ * @file       dfudevice.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      The bootloader DFU protocol on the host, against a RAM flash.
+ *             Used by this test and by the GCS uploader test.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DFUDEVICE_H
+#define DFUDEVICE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DFUDEVICE_FW_SIZE   0x20000
+#define DFUDEVICE_DESC_SIZE 100
+#define DFUDEVICE_REPORT    64
+
+/* Erased flash, the bootloader in DFU mode */
+void dfudevice_init(void);
+
+/* Hands a report, with its ID, to the bootloader */
+void dfudevice_send(const uint8_t *report);
+
+/* Next report of the bootloader, with its ID, returns 0 if there is none */
+int dfudevice_receive(uint8_t *report);
+
+const uint8_t *dfudevice_firmware(void);
+const uint8_t *dfudevice_description(void);
+uint32_t dfudevice_erases(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DFUDEVICE_H
@@ -0,0 +1,21 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough of PiOS to build the bootloader DFU protocol on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PIOS_COM_TELEM_USB 0
+#define BOARD_READABLE     true
+#define BOARD_WRITABLE     true
+
+#define FLASH_COMPLETE     1
+
+uint8_t FLASH_ProgramWord(uint32_t address, uint32_t data);
+void FLASH_Lock(void);
+void PIOS_IAP_WriteBootCount(uint16_t);
+void PIOS_IAP_WriteBootCmd(uint8_t number, uint32_t value);
+void PIOS_SYS_Reset(void);
+
+#endif /* PIOS_H */
@@ -0,0 +1,266 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock_gettime */
+
+#include <vector>
+
+extern "C" {
+#include "common.h"
+#include "dfudevice.h"
+}
+
+/* Same as the GCS uploader */
+#define UPLOAD_WINDOW 32
+
+/* Number of images written for the throughput figures */
+#define BENCH_UPLOADS 20
+
+/**
+ * Talks to the bootloader the way DFUObject in the GCS uploader does, the
+ * reports go to the simulated device instead of over USB.
+ */
+class DfuLink {
+public:
+    DfuLink() : reports(0), statusPolls(0), dropPacket(-1) {}
+
+    uint32_t reports;
+    uint32_t statusPolls;
+    int dropPacket;
+
+    void send(const uint8_t *buf)
+    {
+        reports++;
+        dfudevice_send(buf);
+    }
+
+    bool receive(uint8_t *buf)
+    {
+        return dfudevice_receive(buf) > 0;
+    }
+
+    void command(uint8_t cmd, uint8_t data0 = 0)
+    {
+        uint8_t buf[DFUDEVICE_REPORT] = { 0x02, cmd, 0, 0, 0, 0, data0 };
+
+        send(buf);
+    }
+
+    uint8_t statusRequest()
+    {
+        uint8_t buf[DFUDEVICE_REPORT];
+
+        statusPolls++;
+        command(Status_Request);
+        if (!receive(buf) || buf[1] != Status_Rep) {
+            return 0xFF;
+        }
+        return buf[6];
+    }
+
+    uint32_t deviceCrc()
+    {
+        uint8_t buf[DFUDEVICE_REPORT];
+
+        command(Req_Capabilities, 1);
+        receive(buf);
+        return (uint32_t)buf[10] << 24 | buf[11] << 16 | buf[12] << 8 | buf[13];
+    }
+
+    void startUpload(uint32_t bytes, uint8_t type, uint32_t crc)
+    {
+        uint32_t packets = bytes / 4 / 14;
+        uint8_t last     = (bytes - packets * 4 * 14) / 4;
+
+        if (last == 0) {
+            last = 14;
+        } else {
+            packets++;
+        }
+        uint8_t buf[DFUDEVICE_REPORT] = { 0x02, (uint8_t)(Upload | 0x20),
+                                          (uint8_t)(packets >> 24), (uint8_t)(packets >> 16), (uint8_t)(packets >> 8), (uint8_t)packets,
+                                          type, last,
+                                          (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+        send(buf);
+    }
+
+    /* DFUObject::UploadData(), a status check every UPLOAD_WINDOW packets */
+    bool uploadData(const std::vector<uint8_t> & data)
+    {
+        int32_t packets = data.size() / 4 / 14;
+        int last = (data.size() - packets * 4 * 14) / 4;
+
+        if (last == 0) {
+            last = 14;
+        } else {
+            packets++;
+        }
+        for (int32_t packet = 0; packet < packets; packet++) {
+            uint8_t buf[DFUDEVICE_REPORT] = { 0x02, Upload, (uint8_t)(packet >> 24), (uint8_t)(packet >> 16), (uint8_t)(packet >> 8), (uint8_t)packet };
+            int words = (packet == packets - 1) ? last : 14;
+
+            for (int i = 0; i < words * 4; i += 4) {
+                for (int b = 0; b < 4; b++) {
+                    buf[6 + i + b] = data[packet * 56 + i + 3 - b];
+                }
+            }
+            if (packet != dropPacket) {
+                send(buf);
+            }
+            if ((packet + 1) % UPLOAD_WINDOW == 0 && packet + 1 < packets) {
+                if (statusRequest() != uploading) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /* DFUObject::WriteFirmware() */
+    uint8_t writeFirmware(const std::vector<uint8_t> & image, uint32_t crc)
+    {
+        startUpload(image.size(), FW, crc);
+        uint8_t status = statusRequest();
+        if (status != uploading) {
+            return status;
+        }
+        if (!uploadData(image)) {
+            return statusRequest();
+        }
+        command(Op_END);
+        return statusRequest();
+    }
+
+    std::vector<uint8_t> download(uint32_t bytes, uint8_t type)
+    {
+        uint32_t packets = bytes / 4 / 14;
+        uint8_t last     = (bytes - packets * 4 * 14) / 4;
+
+        if (last == 0) {
+            last = 14;
+        } else {
+            packets++;
+        }
+        uint8_t buf[DFUDEVICE_REPORT] = { 0x02, Download_Req, (uint8_t)(packets >> 24), (uint8_t)(packets >> 16), (uint8_t)(packets >> 8), (uint8_t)packets, type, last };
+        send(buf);
+
+        std::vector<uint8_t> data;
+        for (uint32_t packet = 0; packet < packets && receive(buf); packet++) {
+            data.insert(data.end(), buf + 6, buf + 6 + ((packet == packets - 1) ? last : 14) * 4);
+        }
+        statusRequest();
+        return data;
+    }
+};
+
+/* DFUObject::CRCFromQBArray(), the image padded with 0xFF to the firmware size */
+static uint32_t hostCrc(const std::vector<uint8_t> & image)
+{
+    static const uint32_t CrcTable[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < DFUDEVICE_FW_SIZE; i += 4) {
+        uint32_t word = 0;
+        for (int b = 3; b >= 0; b--) {
+            word = word << 8 | ((i + b < image.size()) ? image[i + b] : 0xFF);
+        }
+        crc ^= word;
+        for (int n = 0; n < 8; n++) {
+            crc = (crc << 4) ^ CrcTable[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+static std::vector<uint8_t> makeImage(uint32_t size, uint32_t seed)
+{
+    std::vector<uint8_t> image(size);
+
+    for (uint32_t i = 0; i < size; i++) {
+        seed     = seed * 1103515245 + 12345;
+        image[i] = seed >> 16;
+    }
+    return image;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class OpDfu : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        dfudevice_init();
+        ASSERT_EQ(DFUidle, link.statusRequest());
+    }
+
+    DfuLink link;
+};
+
+TEST_F(OpDfu, WindowedUploadWritesImage) {
+    std::vector<uint8_t> image = makeImage(100000, 1);
+    uint32_t crc = hostCrc(image);
+
+    EXPECT_EQ(Last_operation_Success, link.writeFirmware(image, crc));
+    EXPECT_EQ(0, memcmp(&image[0], dfudevice_firmware(), image.size()));
+    EXPECT_EQ(1u, dfudevice_erases());
+
+    /* What the uploader compares to skip writing the same image again */
+    EXPECT_EQ(crc, link.deviceCrc());
+
+    /* One status poll per window, and the ones around the transfer */
+    uint32_t packets = (image.size() + 55) / 56;
+    EXPECT_EQ((packets - 1) / UPLOAD_WINDOW + 3, link.statusPolls);
+}
+
+TEST_F(OpDfu, ImageOfWholePackets) {
+    std::vector<uint8_t> image = makeImage(56 * UPLOAD_WINDOW * 4, 2);
+
+    EXPECT_EQ(Last_operation_Success, link.writeFirmware(image, hostCrc(image)));
+    EXPECT_EQ(hostCrc(image), link.deviceCrc());
+}
+
+TEST_F(OpDfu, DroppedPacketStopsAtWindow) {
+    std::vector<uint8_t> image = makeImage(100000, 3);
+
+    uint32_t reports = link.reports;
+
+    link.dropPacket = 40;
+    EXPECT_EQ(wrong_packet_received, link.writeFirmware(image, hostCrc(image)));
+
+    /* Stopped at the end of the window the packet was lost in: start, status,
+       the packets of two windows but the lost one, two window polls, status */
+    EXPECT_EQ(1 + 1 + (2 * UPLOAD_WINDOW - 1) + 2 + 1u, link.reports - reports);
+}
+
+TEST_F(OpDfu, WrongCrcFails) {
+    std::vector<uint8_t> image = makeImage(100000, 4);
+
+    EXPECT_EQ(CRC_Fail, link.writeFirmware(image, hostCrc(image) ^ 1));
+}
+
+TEST_F(OpDfu, DownloadReadsImageBack) {
+    std::vector<uint8_t> image = makeImage(4000, 5);
+
+    ASSERT_EQ(Last_operation_Success, link.writeFirmware(image, hostCrc(image)));
+    EXPECT_EQ(image, link.download(image.size(), FW));
+}
+
+TEST_F(OpDfu, Throughput) {
+    std::vector<uint8_t> image = makeImage(DFUDEVICE_FW_SIZE, 6);
+    uint32_t crc = hostCrc(image);
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_UPLOADS; i++) {
+        ASSERT_EQ(Last_operation_Success, link.writeFirmware(image, crc));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%d uploads of %d bytes: %u reports, %u status polls, %.1f MB/s\n",
+           BENCH_UPLOADS, DFUDEVICE_FW_SIZE, link.reports, link.statusPolls,
+           BENCH_UPLOADS * (double)DFUDEVICE_FW_SIZE / seconds / 1e6);
+}
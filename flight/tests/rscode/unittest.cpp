@@ -0,0 +1,262 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock_gettime */
+
+extern "C" {
+#include "ecc.h"
+#include "rscodec.h"
+
+/* rs.c */
+extern int genPoly[];
+}
+
+#define PACKET_LEN        64
+#define RANDOM_PACKETS    20000
+#define BENCHMARK_PACKETS 200000
+
+// To use a test fixture, derive a class from testing::Test.
+class RSCodecTest : public testing::Test {
+protected:
+    struct rs_codec codec;
+
+    virtual void SetUp()
+    {
+        srand(1);
+        initialize_ecc();
+        rs_codec_init(&codec);
+    }
+
+    virtual void TearDown() {}
+
+    static void random_message(uint8_t *msg, int len)
+    {
+        for (int i = 0; i < len; i++) {
+            msg[i] = rand();
+        }
+    }
+
+    /* Picks distinct positions, counted from the end as the erasures are */
+    static void random_positions(int *positions, int count, int csize)
+    {
+        for (int i = 0; i < count; i++) {
+            bool taken;
+            do {
+                positions[i] = rand() % csize;
+                taken = false;
+                for (int j = 0; j < i; j++) {
+                    taken |= (positions[j] == positions[i]);
+                }
+            } while (taken);
+        }
+    }
+
+    static double now_seconds()
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+};
+
+TEST_F(RSCodecTest, GeneratorMatchesReference) {
+    for (int j = 0; j < RS_ECC_NPARITY; j++) {
+        EXPECT_EQ(genPoly[j], codec.genpoly[j]);
+    }
+    EXPECT_EQ(1, codec.genpoly[RS_ECC_NPARITY]);
+}
+
+TEST_F(RSCodecTest, EncodeIsBitExact) {
+    uint8_t msg[256], expected[256], actual[256];
+
+    for (int n = 0; n < RANDOM_PACKETS; n++) {
+        int len = 1 + rand() % (255 - RS_ECC_NPARITY);
+        random_message(msg, len);
+
+        encode_data(msg, len, expected);
+        rs_encode(&codec, msg, len, actual);
+        ASSERT_EQ(0, memcmp(expected, actual, len + RS_ECC_NPARITY)) << "length " << len;
+
+        // In place, the way the radio driver encodes
+        rs_encode(&codec, msg, len, msg);
+        ASSERT_EQ(0, memcmp(expected, msg, len + RS_ECC_NPARITY)) << "length " << len;
+    }
+}
+
+TEST_F(RSCodecTest, CleanPacketsPass) {
+    uint8_t packet[PACKET_LEN];
+
+    for (int n = 0; n < RANDOM_PACKETS; n++) {
+        int len = 1 + rand() % (PACKET_LEN - RS_ECC_NPARITY);
+        random_message(packet, len);
+        rs_encode(&codec, packet, len, packet);
+
+        EXPECT_TRUE(rs_check(&codec, packet, len + RS_ECC_NPARITY));
+        EXPECT_FALSE(rs_correct(packet, len + RS_ECC_NPARITY, 0, NULL));
+    }
+}
+
+/*
+ * Up to one more error than the code corrects, and erasures on top of
+ * some of them, so the uncorrectable and miscorrected cases get compared
+ * as well as the corrected ones.
+ */
+TEST_F(RSCodecTest, DecodeIsBitExact) {
+    uint8_t packet[PACKET_LEN], expected[PACKET_LEN], actual[PACKET_LEN];
+    int positions[RS_ECC_NPARITY + 1];
+    int corrected = 0, failed = 0;
+
+    for (int n = 0; n < RANDOM_PACKETS; n++) {
+        int len   = 1 + rand() % (PACKET_LEN - RS_ECC_NPARITY);
+        int csize = len + RS_ECC_NPARITY;
+        random_message(packet, len);
+        rs_encode(&codec, packet, len, packet);
+
+        int nerrors = rand() % (RS_ECC_NPARITY + 2);
+        if (nerrors > csize) {
+            nerrors = csize;
+        }
+        random_positions(positions, nerrors, csize);
+        for (int i = 0; i < nerrors; i++) {
+            packet[csize - 1 - positions[i]] ^= 1 + rand() % 255;
+        }
+
+        // The first few errors are flagged as erasures
+        int nerasures = nerrors ? rand() % (nerrors + 1) : 0;
+        int erasures[RS_ECC_NPARITY + 1];
+        uint8_t erasures8[RS_ECC_NPARITY + 1];
+        for (int i = 0; i < nerasures; i++) {
+            erasures[i]  = positions[i];
+            erasures8[i] = positions[i];
+        }
+
+        memcpy(expected, packet, csize);
+        memcpy(actual, packet, csize);
+
+        decode_data(expected, csize);
+        bool expected_clean = (check_syndrome() == 0);
+        bool actual_clean   = rs_check(&codec, actual, csize);
+        ASSERT_EQ(expected_clean, actual_clean) << "packet " << n;
+        if (nerrors <= RS_ECC_NPARITY) {
+            ASSERT_EQ(nerrors == 0, actual_clean) << "packet " << n;
+        }
+
+        bool expected_fixed = correct_errors_erasures(expected, csize, nerasures, erasures) != 0;
+        bool actual_fixed   = rs_correct(actual, csize, nerasures, erasures8);
+        ASSERT_EQ(expected_fixed, actual_fixed) << "packet " << n << ", " << nerrors << " errors, " << nerasures << " erasures";
+        ASSERT_EQ(0, memcmp(expected, actual, csize)) << "packet " << n;
+
+        corrected += actual_fixed;
+        failed    += (nerrors && !actual_fixed);
+    }
+    // Both outcomes were covered
+    EXPECT_GT(corrected, RANDOM_PACKETS / 4);
+    EXPECT_GT(failed, 0);
+}
+
+TEST_F(RSCodecTest, CorrectsWithinCapacity) {
+    uint8_t msg[PACKET_LEN], packet[PACKET_LEN];
+    int positions[RS_ECC_NPARITY];
+    uint8_t erasures[RS_ECC_NPARITY];
+
+    for (int n = 0; n < RANDOM_PACKETS; n++) {
+        int len   = PACKET_LEN - RS_ECC_NPARITY;
+        int csize = PACKET_LEN;
+        random_message(msg, len);
+        rs_encode(&codec, msg, len, packet);
+
+        // 2 * errors + erasures <= RS_ECC_NPARITY always corrects
+        int nerasures = rand() % (RS_ECC_NPARITY + 1);
+        int nerrors   = (RS_ECC_NPARITY - nerasures) / 2;
+        random_positions(positions, nerrors + nerasures, csize);
+        for (int i = 0; i < nerrors + nerasures; i++) {
+            packet[csize - 1 - positions[i]] ^= 1 + rand() % 255;
+        }
+        for (int i = 0; i < nerasures; i++) {
+            erasures[i] = positions[nerrors + i];
+        }
+
+        rs_correct(packet, csize, nerasures, erasures);
+        ASSERT_EQ(0, memcmp(msg, packet, len)) << nerrors << " errors, " << nerasures << " erasures";
+        ASSERT_TRUE(rs_check(&codec, packet, csize));
+    }
+}
+
+TEST_F(RSCodecTest, BenchmarkAgainstReference) {
+    static uint8_t packets[64][PACKET_LEN];
+    uint8_t packet[PACKET_LEN];
+    const int len = PACKET_LEN - RS_ECC_NPARITY;
+    double start;
+
+    for (int i = 0; i < 64; i++) {
+        random_message(packets[i], len);
+    }
+
+    start = now_seconds();
+    for (int n = 0; n < BENCHMARK_PACKETS; n++) {
+        encode_data(packets[n % 64], len, packet);
+    }
+    double ref_encode = BENCHMARK_PACKETS / (now_seconds() - start);
+
+    start = now_seconds();
+    for (int n = 0; n < BENCHMARK_PACKETS; n++) {
+        rs_encode(&codec, packets[n % 64], len, packet);
+    }
+    double encode = BENCHMARK_PACKETS / (now_seconds() - start);
+
+    for (int i = 0; i < 64; i++) {
+        rs_encode(&codec, packets[i], len, packets[i]);
+    }
+
+    // What the receiver does with a packet that arrived intact
+    int clean = 0;
+    start = now_seconds();
+    for (int n = 0; n < BENCHMARK_PACKETS; n++) {
+        decode_data(packets[n % 64], PACKET_LEN);
+        clean += (check_syndrome() == 0);
+    }
+    double ref_check = BENCHMARK_PACKETS / (now_seconds() - start);
+
+    start = now_seconds();
+    for (int n = 0; n < BENCHMARK_PACKETS; n++) {
+        clean += rs_check(&codec, packets[n % 64], PACKET_LEN);
+    }
+    double check = BENCHMARK_PACKETS / (now_seconds() - start);
+    EXPECT_EQ(2 * BENCHMARK_PACKETS, clean);
+
+    // And with one that has two symbol errors
+    const int corrupt_packets = BENCHMARK_PACKETS / 10;
+    start = now_seconds();
+    for (int n = 0; n < corrupt_packets; n++) {
+        memcpy(packet, packets[n % 64], PACKET_LEN);
+        packet[n % PACKET_LEN] ^= 0x5a;
+        packet[(n * 7 + 3) % PACKET_LEN] ^= 0x11;
+        decode_data(packet, PACKET_LEN);
+        if (check_syndrome() != 0) {
+            correct_errors_erasures(packet, PACKET_LEN, 0, 0);
+        }
+    }
+    double ref_correct = corrupt_packets / (now_seconds() - start);
+
+    start = now_seconds();
+    for (int n = 0; n < corrupt_packets; n++) {
+        memcpy(packet, packets[n % 64], PACKET_LEN);
+        packet[n % PACKET_LEN] ^= 0x5a;
+        packet[(n * 7 + 3) % PACKET_LEN] ^= 0x11;
+        if (!rs_check(&codec, packet, PACKET_LEN)) {
+            rs_correct(packet, PACKET_LEN, 0, NULL);
+        }
+    }
+    double correct = corrupt_packets / (now_seconds() - start);
+
+    printf("%d byte packets, packets/s  reference     codec\n", PACKET_LEN);
+    printf("  encode                  %10.0f %10.0f\n", ref_encode, encode);
+    printf("  check clean             %10.0f %10.0f\n", ref_check, check);
+    printf("  correct 2 errors        %10.0f %10.0f\n", ref_correct, correct);
+    RecordProperty("encode_pps", (int)encode);
+    RecordProperty("check_pps", (int)check);
+    RecordProperty("correct_pps", (int)correct);
+}
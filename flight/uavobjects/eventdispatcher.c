@@ -71,7 +71,8 @@ typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
-static xQueueHandle mQueue;
+static EventCallbackInfo mRingBuffer[EVENTRING_SLOTS(MAX_QUEUE_SIZE)];
+static EventRing mRing;
 static DelayedCallbackInfo *eventSchedulerCallback;
 static xSemaphoreHandle mMutex;
 static EventStats mStats;
@@ -100,11 +101,11 @@ int32_t EventDispatcherInitialize()
         return -1;
     }
 
-    // Create event queue
-    mQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
-
     // Create callback
     eventSchedulerCallback = PIOS_CALLBACKSCHEDULER_Create(&eventTask, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_EVENTDISPATCHER, STACK_SIZE * 4);
+
+    // Create event ring, the event callback is woken up when it stops being empty
+    EventRingInit(&mRing, mRingBuffer, sizeof(EventCallbackInfo), EVENTRING_SLOTS(MAX_QUEUE_SIZE), eventSchedulerCallback);
     PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
 
     // Done
@@ -132,12 +133,25 @@ void EventClearStats()
     xSemaphoreGiveRecursive(mMutex);
 }
 
+/**
+ * Get the event totals since start up, these are never cleared
+ * @param[out] events Number of events offered to the dispatcher, including dropped ones
+ * @param[out] dropped Number of events dropped because the event ring was full
+ */
+void EventGetTotals(uint32_t *events, uint32_t *dropped)
+{
+    *events  = mRing.sequence;
+    *dropped = mRing.dropped;
+}
+
 /**
  * Dispatch an event by invoking the supplied callback. The function
  * returns imidiatelly, the callback is invoked from the event task.
+ * The event ring has a single producer, callers must hold the UAVObject
+ * manager lock (the only caller is the object event delivery).
  * \param[in] ev The event to be dispatched
  * \param[in] cb The callback function
- * \return Success (0), failure (-1)
+ * \return pdTRUE if queued, errQUEUE_FULL if the event was dropped
  */
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
 {
@@ -147,10 +161,17 @@ int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
     memcpy(&evInfo.ev, ev, sizeof(UAVObjEvent));
     evInfo.cb    = cb;
     evInfo.queue = 0;
-    // Push to queue
-    int32_t result = xQueueSend(mQueue, &evInfo, 0); // will not block if queue is full
-    PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
-    return result;
+    evInfo.lowpriority = false;
+    // Push to ring, will not block if the ring is full
+    uint16_t pending = EventRingSend(&mRing, &evInfo);
+    if (pending == 0) {
+        return errQUEUE_FULL;
+    }
+    // Only the first event of a burst needs to wake up the event callback
+    if (pending == 1) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
+    }
+    return pdTRUE;
 }
 
 /**
@@ -288,10 +309,10 @@ static void eventTask()
     static uint32_t timeToNextUpdateMs = 0;
     EventCallbackInfo evInfo;
 
-    // Wait for queue message
+    // Drain the event ring
     int limit = MAX_QUEUE_SIZE;
 
-    while (xQueueReceive(mQueue, &evInfo, 0) == pdTRUE) {
+    while (EventRingReceive(&mRing, &evInfo)) {
         // Invoke callback, if any
         if (evInfo.cb != 0) {
             evInfo.cb(&evInfo.ev); // the function is expected to copy the event information
@@ -308,6 +329,11 @@ static void eventTask()
     }
 
     PIOS_CALLBACKSCHEDULER_Schedule(eventSchedulerCallback, timeToNextUpdateMs - (xTaskGetTickCount() * portTICK_RATE_MS), CALLBACK_UPDATEMODE_SOONER);
+
+    // Events left behind by the loop limit will not wake us up again
+    if (EventRingPending(&mRing) > 0) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(eventSchedulerCallback);
+    }
 }
 
 /**
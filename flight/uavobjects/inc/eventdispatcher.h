@@ -39,6 +39,7 @@ typedef struct {
 int32_t EventDispatcherInitialize();
 void EventGetStats(EventStats *statsOut);
 void EventClearStats();
+void EventGetTotals(uint32_t *events, uint32_t *dropped);
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb);
 int32_t EventPeriodicCallbackCreate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
 int32_t EventPeriodicCallbackUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @addtogroup UAVObjects OpenPilot UAVObjects
+ * @{
+ * @addtogroup UAV Object Manager
+ * @{
+ *
+ * @file       eventring.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Lock-free single producer / single consumer event ring
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef EVENTRING_H
+#define EVENTRING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * The ring is used to deliver object events without a queue hop. The
+ * producer only ever writes head, the consumer only ever writes tail, so
+ * neither side needs a lock or a critical section. All producers of a ring
+ * must be serialized by the caller, the UAVObject manager does this with its
+ * own lock, and there must be a single consumer.
+ *
+ * One slot is always kept free to tell a full ring from an empty one, a
+ * ring built on N slots holds up to N - 1 items.
+ */
+
+/*
+ * Index accesses. Reading the other side's index acquires the slots it
+ * published, writing our own index releases the slots we are done with.
+ * The full fence orders an index store against the following load of the
+ * other index, so that the producer and the consumer can't both miss each
+ * other when the ring runs empty.
+ */
+#define EVENTRING_LOAD(index)         __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define EVENTRING_STORE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#define EVENTRING_FENCE()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* Number of slots needed for a ring holding n items */
+#define EVENTRING_SLOTS(n) ((n) + 1)
+
+struct DelayedCallbackInfoStruct;
+
+typedef struct {
+    uint8_t  *buffer; /** Storage for length items of itemSize bytes each */
+    uint16_t itemSize; /** Size of one item in bytes */
+    uint16_t length; /** Number of slots in buffer */
+    volatile uint16_t head; /** Next slot to write, only changed by the producer */
+    volatile uint16_t tail; /** Next slot to read, only changed by the consumer */
+    volatile uint32_t sequence; /** Number of items offered to the ring, including dropped ones */
+    volatile uint32_t dropped; /** Number of items dropped because the ring was full */
+    struct DelayedCallbackInfoStruct *wakeup; /** Consumer callback, dispatched when the ring stops being empty, or NULL */
+} EventRing;
+
+/**
+ * Initialize a ring on top of caller supplied storage
+ * \param[in] ring The ring
+ * \param[in] buffer Storage for EVENTRING_SLOTS(n) items
+ * \param[in] itemSize Size of one item in bytes
+ * \param[in] length Number of slots in buffer
+ * \param[in] wakeup Callback of the consumer, or NULL if the consumer polls
+ * \return 0 if success or -1 if failure
+ */
+static inline int32_t EventRingInit(EventRing *ring, void *buffer, uint16_t itemSize, uint16_t length, struct DelayedCallbackInfoStruct *wakeup)
+{
+    if (!buffer || itemSize == 0 || length < 2) {
+        return -1;
+    }
+    ring->buffer   = (uint8_t *)buffer;
+    ring->itemSize = itemSize;
+    ring->length   = length;
+    ring->head     = 0;
+    ring->tail     = 0;
+    ring->sequence = 0;
+    ring->dropped  = 0;
+    ring->wakeup   = wakeup;
+    return 0;
+}
+
+/**
+ * Number of items waiting in the ring
+ */
+static inline uint16_t EventRingPending(const EventRing *ring)
+{
+    uint16_t head = EVENTRING_LOAD(ring->head);
+    uint16_t tail = EVENTRING_LOAD(ring->tail);
+
+    return (head >= tail) ? (head - tail) : (ring->length - tail + head);
+}
+
+/**
+ * Append an item, never blocks. Producer side only.
+ * \param[in] ring The ring
+ * \param[in] item The item, itemSize bytes are copied
+ * \return The number of items waiting including this one, 0 only if the ring
+ * was full and the item was dropped. A return value of 1 means the consumer
+ * may have drained the ring and needs to be woken up.
+ */
+static inline uint16_t EventRingSend(EventRing *ring, const void *item)
+{
+    uint16_t head = ring->head;
+    uint16_t next = (head + 1 < ring->length) ? head + 1 : 0;
+
+    ++ring->sequence;
+    if (next == EVENTRING_LOAD(ring->tail)) {
+        ++ring->dropped;
+        return 0;
+    }
+    memcpy(&ring->buffer[head * ring->itemSize], item, ring->itemSize);
+    EVENTRING_STORE(ring->head, next);
+    // the tail is read after the head is published, pairs with EventRingReceive()
+    EVENTRING_FENCE();
+    uint16_t pending = EventRingPending(ring);
+    // the consumer may have taken this item already, it was still delivered
+    return (pending > 0) ? pending : 1;
+}
+
+/**
+ * Check whether the ring is empty before the consumer goes to sleep.
+ * Consumer side only.
+ */
+static inline bool eventRingEmpty(EventRing *ring, uint16_t tail)
+{
+    if (EVENTRING_LOAD(ring->head) != tail) {
+        return false;
+    }
+    // look again after our last tail update is visible, pairs with EventRingSend()
+    EVENTRING_FENCE();
+    return EVENTRING_LOAD(ring->head) == tail;
+}
+
+/**
+ * Take the oldest item out of the ring. Consumer side only.
+ * \param[in] ring The ring
+ * \param[out] item Receives itemSize bytes
+ * \return true if an item was received, false if the ring was empty
+ */
+static inline bool EventRingReceive(EventRing *ring, void *item)
+{
+    uint16_t tail = ring->tail;
+
+    if (eventRingEmpty(ring, tail)) {
+        return false;
+    }
+    memcpy(item, &ring->buffer[tail * ring->itemSize], ring->itemSize);
+    EVENTRING_STORE(ring->tail, (tail + 1 < ring->length) ? tail + 1 : 0);
+    return true;
+}
+
+/**
+ * Coalesce a burst: take the newest item out of the ring and discard all the
+ * older ones. Meant for consumers that only care about the latest state of an
+ * object. Consumer side only.
+ * \param[in] ring The ring
+ * \param[out] item Receives itemSize bytes
+ * \return The number of items consumed, 0 if the ring was empty
+ */
+static inline uint16_t EventRingReceiveLatest(EventRing *ring, void *item)
+{
+    uint16_t tail = ring->tail;
+
+    if (eventRingEmpty(ring, tail)) {
+        return 0;
+    }
+    uint16_t head  = EVENTRING_LOAD(ring->head);
+    uint16_t count = (head >= tail) ? (head - tail) : (ring->length - tail + head);
+    uint16_t last  = (head > 0) ? head - 1 : ring->length - 1;
+    memcpy(item, &ring->buffer[last * ring->itemSize], ring->itemSize);
+    EVENTRING_STORE(ring->tail, head);
+    return count;
+}
+
+#endif // EVENTRING_H
+
+/**
+ * @}
+ * @}
+ */
@@ -32,6 +32,8 @@
 #ifndef UAVOBJECTMANAGER_H
 #define UAVOBJECTMANAGER_H
 
+#include "eventring.h"
+
 #define UAVOBJ_ALL_INSTANCES                   0xFFFF
 #define UAVOBJ_MAX_INSTANCES                   1000
 
@@ -205,6 +207,8 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue);
 int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask);
 int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb);
+int32_t UAVObjConnectEventRing(UAVObjHandle obj_handle, EventRing *ring, uint8_t eventMask);
+int32_t UAVObjDisconnectEventRing(UAVObjHandle obj_handle, EventRing *ring);
 void UAVObjRequestUpdate(UAVObjHandle obj);
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId);
 void UAVObjUpdated(UAVObjHandle obj);
@@ -33,6 +33,7 @@
 
 #include "openpilot.h"
 #include "pios_struct_helper.h"
+#include "uavobjectsinit.h"
 
 extern uintptr_t pios_uavo_settings_fs_id;
 
@@ -81,6 +82,7 @@ struct ObjectEventEntry {
     struct ObjectEventEntry *next;
     xQueueHandle queue;
     UAVObjEventCallback     cb;
+    EventRing *ring;
     uint8_t eventMask;
 };
 
@@ -178,12 +180,15 @@ struct UAVOMulti {
 static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType event);
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
 static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
-static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, EventRing *ring, uint8_t eventMask);
+static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, EventRing *ring);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
 
 // Private variables
 static xSemaphoreHandle mutex;
+// UAVObjLoad() reads the flash into this buffer, loads are serialized by loadMutex
+static xSemaphoreHandle loadMutex;
+static uint8_t loadBuffer[UAVOBJECTS_LARGEST];
 static const UAVObjMetadata defMetadata = {
     .flags                    = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
               ACCESS_READWRITE << UAVOBJ_GCS_ACCESS_SHIFT |
@@ -224,6 +229,10 @@ int32_t UAVObjInitialize()
     if (mutex == NULL) {
         return -1;
     }
+    loadMutex = xSemaphoreCreateMutex();
+    if (loadMutex == NULL) {
+        return -1;
+    }
 
     // Done
     return 0;
@@ -849,32 +858,43 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
 
+    uint8_t *data;
+    uint16_t size = UAVObjGetNumBytes(obj_handle);
+
+    PIOS_Assert(size <= sizeof(loadBuffer));
+
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
             return -1;
         }
-
-        // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) == 0) {
-            sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
-        } else {
-            return -1;
-        }
+        data = (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle);
     } else {
         InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
 
         if (instEntry == NULL) {
             return -1;
         }
+        data = InstanceData(instEntry);
+    }
 
-        // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) == 0) {
-            sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
-        } else {
-            return -1;
-        }
+    // The flash is read without the object manager lock, other tasks only
+    // wait for the copy
+    xSemaphoreTake(loadMutex, portMAX_DELAY);
+
+    if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, loadBuffer, size) != 0) {
+        xSemaphoreGive(loadMutex);
+        return -1;
     }
 
+    // Lock, the event is sent with the lock held like on every other path
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    memcpy(data, loadBuffer, size);
+
+    // Fire event on success
+    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
+
+    xSemaphoreGiveRecursive(mutex);
+    xSemaphoreGive(loadMutex);
 
     return 0;
 }
@@ -1569,7 +1589,7 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, queue, 0, eventMask);
+    res = connectObj(obj_handle, queue, 0, 0, eventMask);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1586,7 +1606,7 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, queue, 0);
+    res = disconnectObj(obj_handle, queue, 0, 0);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1605,7 +1625,7 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, 0, cb, eventMask);
+    res = connectObj(obj_handle, 0, cb, 0, eventMask);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1621,7 +1641,47 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = disconnectObj(obj_handle, 0, cb);
+    res = disconnectObj(obj_handle, 0, cb, 0);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Connect an event ring to the object, if the ring is already connected then the event mask is only updated.
+ * Events are copied into the ring without taking any queue lock, and the ring's wakeup callback
+ * is dispatched only when the ring goes from empty to non empty, so the subscriber sees a burst
+ * of events as a single wakeup and can coalesce it with EventRingReceiveLatest().
+ * The same ring may be connected to several objects, it must have a single consumer.
+ * \param[in] obj The object handle
+ * \param[in] ring The event ring, holding UAVObjEvent items
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectEventRing(UAVObjHandle obj_handle, EventRing *ring, uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(ring);
+    PIOS_Assert(ring->itemSize == sizeof(UAVObjEvent));
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, 0, 0, ring, eventMask);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Disconnect an event ring from the object.
+ * \param[in] obj The object handle
+ * \param[in] ring The event ring
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjDisconnectEventRing(UAVObjHandle obj_handle, EventRing *ring)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(ring);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = disconnectObj(obj_handle, 0, 0, ring);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1756,6 +1816,17 @@ static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType
                 }
             }
 
+            // Copy to the subscriber's ring, lock free, and wake it up on the first event of a burst
+            if (event->ring) {
+                uint16_t pending = EventRingSend(event->ring, &msg);
+                if (pending == 0) {
+                    ++stats.eventQueueErrors;
+                    stats.lastQueueErrorID = UAVObjGetID(obj);
+                } else if (pending == 1 && event->ring->wakeup) {
+                    PIOS_CALLBACKSCHEDULER_Dispatch(event->ring->wakeup);
+                }
+            }
+
             // Invoke callback (from event task) if a valid one is registered
             if (event->cb) {
                 // invoke callback from the event task, will not block
@@ -1870,11 +1941,12 @@ static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
  * \param[in] obj The object handle
  * \param[in] queue The event queue
  * \param[in] cb The event callback
+ * \param[in] ring The event ring
  * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
  * \return 0 if success or -1 if failure
  */
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask)
+                          UAVObjEventCallback cb, EventRing *ring, uint8_t eventMask)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
@@ -1882,7 +1954,7 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     // Check that the queue is not already connected, if it is simply update event mask
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
-        if (event->queue == queue && event->cb == cb) {
+        if (event->queue == queue && event->cb == cb && event->ring == ring) {
             // Already connected, update event mask and return
             event->eventMask = eventMask;
             return 0;
@@ -1896,6 +1968,7 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     }
     event->queue     = queue;
     event->cb        = cb;
+    event->ring      = ring;
     event->eventMask = eventMask;
     LL_APPEND(obj->next_event, event);
 
@@ -1908,10 +1981,11 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
  * \param[in] obj The object handle
  * \param[in] queue The event queue
  * \param[in] cb The event callback
+ * \param[in] ring The event ring
  * \return 0 if success or -1 if failure
  */
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                             UAVObjEventCallback cb)
+                             UAVObjEventCallback cb, EventRing *ring)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
@@ -1920,7 +1994,8 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     obj = (struct UAVOBase *)obj_handle;
     LL_FOREACH(obj->next_event, event) {
         if ((event->queue == queue
-             && event->cb == cb)) {
+             && event->cb == cb
+             && event->ring == ring)) {
             LL_DELETE(obj->next_event, event);
             vPortFree(event);
             return 0;
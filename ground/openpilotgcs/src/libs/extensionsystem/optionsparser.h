@@ -48,12 +48,14 @@ public:
 
     static const char *NO_LOAD_OPTION;
     static const char *TEST_OPTION;
+    static const char *STARTUP_PROFILE_OPTION;
 private:
     // return value indicates if the option was processed
     // it doesn't indicate success (--> m_hasError)
     bool checkForEndOfOptions();
     bool checkForNoLoadOption();
     bool checkForTestOption();
+    bool checkForStartupProfileOption();
     bool checkForAppOption();
     bool checkForPluginOption();
     bool checkForUnknownOption();
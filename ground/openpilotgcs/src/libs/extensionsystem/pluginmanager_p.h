@@ -32,6 +32,8 @@
 #include "pluginspec.h"
 
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
@@ -66,6 +68,11 @@ public:
 
     QStringList arguments;
 
+    // -startup-profile, times in milliseconds
+    bool profilingEnabled;
+    qint64 readTime;
+    QHash<PluginSpec *, QMap<int, qint64> > profileTimes; // per destination state
+
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
     PluginSpec *pluginByName(const QString &name) const;
@@ -77,9 +84,11 @@ private:
     PluginManager *q;
 
     void readPluginPaths();
+    void printProfile(const QList<PluginSpec *> &queue) const;
     bool loadQueue(PluginSpec *spec,
                    QList<PluginSpec *> &queue,
                    QList<PluginSpec *> &circularityCheckQueue);
+    void doLoadPlugin(PluginSpec *spec, PluginSpec::State destState);
     void stopAll();
 };
 } // namespace Internal
@@ -37,10 +37,7 @@ GPSItem::GPSItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     localposition = map->FromLatLngToLocal(mapwidget->CurrentPosition());
     this->setPos(localposition.X(), localposition.Y());
     this->setZValue(4);
-    trail     = new QGraphicsItemGroup(this);
-    trail->setParentItem(map);
-    trailLine = new QGraphicsItemGroup(this);
-    trailLine->setParentItem(map);
+    trail = new TrailPathItem(Qt::red, Qt::green, map);
     this->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
     mapfollowtype = UAVMapFollowType::None;
@@ -71,28 +68,12 @@ void GPSItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
     if (coord != position) {
         if (trailtype == UAVTrailType::ByTimeElapsed) {
             if (timer.elapsed() > trailtime * 1000) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
+                trail->AddPoint(position, altitude);
                 timer.restart();
             }
         } else if (trailtype == UAVTrailType::ByDistance) {
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
+                trail->AddPoint(position, altitude);
                 lastcoord     = position;
             }
         }
@@ -146,19 +127,16 @@ void GPSItem::SetTrailType(const UAVTrailType::Types &value)
 void GPSItem::SetShowTrail(const bool &value)
 {
     showtrail = value;
-    trail->setVisible(value);
+    trail->SetShowPoints(value);
 }
 void GPSItem::SetShowTrailLine(const bool &value)
 {
     showtrailline = value;
-    trailLine->setVisible(value);
+    trail->SetShowLine(value);
 }
 void GPSItem::DeleteTrail() const
 {
-    foreach(QGraphicsItem * i, trail->childItems())
-    delete i;
-    foreach(QGraphicsItem * i, trailLine->childItems())
-    delete i;
+    trail->Clear();
 }
 double GPSItem::Distance3D(const internals::PointLatLng &coord, const int &altitude)
 {
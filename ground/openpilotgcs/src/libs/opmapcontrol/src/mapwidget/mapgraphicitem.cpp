@@ -382,6 +382,19 @@ core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & poi
     }
     return ret;
 }
+QTransform MapGraphicItem::PixelToLocalTransform() const
+{
+    core::Point offset = core->GetrenderOffset();
+    QTransform transform;
+
+    if (MapRenderTransform != 1) {
+        transform.translate(-((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2,
+                            -((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2);
+        transform.scale(MapRenderTransform, MapRenderTransform);
+    }
+    transform.translate(offset.X(), offset.Y());
+    return transform;
+}
 internals::PointLatLng MapGraphicItem::FromLocalToLatLng(int x, int y)
 {
     if (MapRenderTransform != 1) {
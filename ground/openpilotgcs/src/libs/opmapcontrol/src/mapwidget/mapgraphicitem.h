@@ -76,6 +76,18 @@ public:
      * @return core::Point Local item point
      */
     core::Point FromLatLngToLocal(internals::PointLatLng const & point);
+    /**
+     * @brief Zoom level of the pixel coordinates FromLatLngToLocal works with
+     */
+    int PixelZoom() const
+    {
+        return core->Zoom();
+    }
+    /**
+     * @brief Maps pixel coordinates at PixelZoom() to local coordinates, the same
+     *        as FromLatLngToLocal does but without projecting every point again
+     */
+    QTransform PixelToLocalTransform() const;
     /**
      * @brief Converts from local item coordinates to LatLong point
      *
@@ -0,0 +1,328 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      A graphicsItem representing a whole trail, points and lines
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "trailpathitem.h"
+#include <QStyleOptionGraphicsItem>
+#include <QGraphicsSceneHoverEvent>
+#include <QDateTime>
+
+// Simplified paths are off by less than half a pixel
+#define SIMPLIFY_TOLERANCE 0.5
+// Tail length after which its simplification is final
+#define TAIL_COMMIT_POINTS 256
+// Radius of a trail point in pixels
+#define POINT_RADIUS       2
+
+namespace mapcontrol {
+TrailPathItem::TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map) : QGraphicsItem(map), map(map),
+    pointcolor(pointColor), linecolor(lineColor), historysize(20000), showpoints(true), showline(true)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setAcceptHoverEvents(true);
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+}
+
+void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    if (points.isEmpty() || (!showpoints && !showline)) {
+        return;
+    }
+
+    ZoomCache &zoomcache = Cache(map->PixelZoom());
+    QTransform transform = map->PixelToLocalTransform();
+    // Cull in pixel coordinates, only what is drawn gets transformed
+    QRectF exposed = transform.inverted().mapRect(option->exposedRect.adjusted(-POINT_RADIUS - 1, -POINT_RADIUS - 1, POINT_RADIUS + 1, POINT_RADIUS + 1));
+    const QVector<QPoint> *parts[2] = { &zoomcache.committedPixels, &zoomcache.tailPixels };
+
+    if (showline) {
+        QPolygonF run;
+        QPoint previous;
+        bool first = true;
+
+        painter->setPen(QPen(QBrush(linecolor), 1));
+        for (int part = 0; part < 2; ++part) {
+            foreach(QPoint pixel, *parts[part]) {
+                if (!first) {
+                    QRectF segment = QRectF(previous, pixel).normalized().adjusted(-1, -1, 1, 1);
+                    if (segment.intersects(exposed)) {
+                        if (run.isEmpty()) {
+                            run << transform.map(QPointF(previous));
+                        }
+                        run << transform.map(QPointF(pixel));
+                    } else if (!run.isEmpty()) {
+                        painter->drawPolyline(run);
+                        run.clear();
+                    }
+                }
+                previous = pixel;
+                first    = false;
+            }
+        }
+        if (!run.isEmpty()) {
+            painter->drawPolyline(run);
+        }
+    }
+
+    if (showpoints) {
+        painter->setPen(Qt::black);
+        painter->setBrush(pointcolor);
+        for (int part = 0; part < 2; ++part) {
+            foreach(QPoint pixel, *parts[part]) {
+                if (exposed.contains(pixel)) {
+                    painter->drawEllipse(transform.map(QPointF(pixel)), POINT_RADIUS, POINT_RADIUS);
+                }
+            }
+        }
+    }
+}
+
+QRectF TrailPathItem::boundingRect() const
+{
+    if (points.isEmpty()) {
+        return QRectF();
+    }
+
+    ZoomCache &zoomcache = Cache(map->PixelZoom());
+    return map->PixelToLocalTransform().mapRect(QRectF(zoomcache.bounds)).adjusted(-POINT_RADIUS - 1, -POINT_RADIUS - 1, POINT_RADIUS + 1, POINT_RADIUS + 1);
+}
+
+int TrailPathItem::type() const
+{
+    return Type;
+}
+
+void TrailPathItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    TrailPoint point;
+
+    point.lat      = coord.Lat();
+    point.lng      = coord.Lng();
+    point.altitude = altitude;
+    point.time     = QDateTime::currentDateTime().toTime_t();
+
+    points.append(point);
+    if (historysize > 0 && points.size() > historysize) {
+        // Drop some more than needed, the caches are rebuilt after a drop
+        prepareGeometryChange();
+        points.remove(0, points.size() - historysize + historysize / 8);
+        cache.clear();
+        return;
+    }
+
+    int zoom     = map->PixelZoom();
+    QPoint pixel = Pixel(points.size() - 1, zoom);
+    if (!cache.contains(zoom) || !cache[zoom].bounds.contains(pixel)) {
+        prepareGeometryChange();
+        return;
+    }
+
+    // The trail did not grow, only the new segment needs repainting
+    QTransform transform = map->PixelToLocalTransform();
+    QRectF segment(transform.map(QPointF(pixel)),
+                   transform.map(QPointF(Pixel(qMax(points.size() - 2, 0), zoom))));
+    update(segment.normalized().adjusted(-POINT_RADIUS - 1, -POINT_RADIUS - 1, POINT_RADIUS + 1, POINT_RADIUS + 1));
+}
+
+void TrailPathItem::Clear()
+{
+    prepareGeometryChange();
+    points.clear();
+    cache.clear();
+    setToolTip(QString());
+}
+
+void TrailPathItem::SetHistorySize(int const & value)
+{
+    historysize = value;
+    if (historysize > 0 && points.size() > historysize) {
+        prepareGeometryChange();
+        points.remove(0, points.size() - historysize);
+        cache.clear();
+    }
+}
+
+void TrailPathItem::SetShowPoints(bool const & value)
+{
+    showpoints = value;
+    update();
+}
+
+void TrailPathItem::SetShowLine(bool const & value)
+{
+    showline = value;
+    update();
+}
+
+void TrailPathItem::RefreshPos()
+{
+    // The map moved or zoomed, the bounding rectangle follows
+    prepareGeometryChange();
+}
+
+void TrailPathItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    int index = Nearest(event->pos());
+
+    if (index < 0) {
+        setToolTip(QString());
+        return;
+    }
+
+    const TrailPoint &point = points[index];
+    QString coord_str = " " + QString::number(point.lat, 'f', 6) + "   " + QString::number(point.lng, 'f', 6);
+    QDateTime time    = QDateTime::fromTime_t(point.time);
+    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(point.altitude)).arg(time.toString()));
+}
+
+/**
+ * Returns the simplified path at a zoom level, the tail of the path is
+ * simplified again when points were added since the last call.
+ */
+TrailPathItem::ZoomCache & TrailPathItem::Cache(int zoom) const
+{
+    ZoomCache &zoomcache = cache[zoom];
+
+    if (zoomcache.count == points.size()) {
+        return zoomcache;
+    }
+
+    int first = zoomcache.committed.isEmpty() ? 0 : zoomcache.committed.last();
+    int last  = points.size() - 1;
+    QVector<QPoint> pixels(last - first + 1);
+    for (int i = first; i <= last; ++i) {
+        pixels[i - first] = Pixel(i, zoom);
+        zoomcache.bounds |= QRect(pixels[i - first], QSize(1, 1));
+    }
+
+    QVector<bool> keep(pixels.size(), false);
+    keep.first() = true;
+    keep.last()  = true;
+    Simplify(pixels, 0, pixels.size() - 1, keep);
+
+    zoomcache.tail.clear();
+    zoomcache.tailPixels.clear();
+    // The first point of the tail is the last committed one
+    for (int i = zoomcache.committed.isEmpty() ? 0 : 1; i < pixels.size(); ++i) {
+        if (keep[i]) {
+            zoomcache.tail.append(first + i);
+            zoomcache.tailPixels.append(pixels[i]);
+        }
+    }
+    if (last - first >= TAIL_COMMIT_POINTS) {
+        zoomcache.committed += zoomcache.tail;
+        zoomcache.committedPixels += zoomcache.tailPixels;
+        zoomcache.tail.clear();
+        zoomcache.tailPixels.clear();
+    }
+    zoomcache.count = points.size();
+    return zoomcache;
+}
+
+QPoint TrailPathItem::Pixel(int index, int zoom) const
+{
+    core::Point pixel = map->Projection()->FromLatLngToPixel(points[index].lat, points[index].lng, zoom);
+
+    return QPoint(pixel.X(), pixel.Y());
+}
+
+/**
+ * Douglas-Peucker, marks the points between first and last to keep. Uses its
+ * own stack, long trails would overflow the call stack.
+ */
+void TrailPathItem::Simplify(QVector<QPoint> const & pixels, int first, int last, QVector<bool> & keep) const
+{
+    QVector<QPair<int, int> > ranges;
+
+    ranges.append(qMakePair(first, last));
+    while (!ranges.isEmpty()) {
+        QPair<int, int> range = ranges.last();
+        ranges.removeLast();
+
+        QPoint a    = pixels[range.first];
+        QPoint b    = pixels[range.second];
+        double dx   = b.x() - a.x();
+        double dy   = b.y() - a.y();
+        double len2 = dx * dx + dy * dy;
+        double max  = SIMPLIFY_TOLERANCE * SIMPLIFY_TOLERANCE;
+        int farthest = -1;
+
+        for (int i = range.first + 1; i < range.second; ++i) {
+            double px = pixels[i].x() - a.x();
+            double py = pixels[i].y() - a.y();
+            double dist2;
+            if (len2 == 0) {
+                dist2 = px * px + py * py;
+            } else {
+                double cross = dx * py - dy * px;
+                dist2 = cross * cross / len2;
+            }
+            if (dist2 > max) {
+                max = dist2;
+                farthest = i;
+            }
+        }
+        if (farthest >= 0) {
+            keep[farthest] = true;
+            ranges.append(qMakePair(range.first, farthest));
+            ranges.append(qMakePair(farthest, range.second));
+        }
+    }
+}
+
+/**
+ * The drawn trail point next to a local position, -1 if there is none
+ */
+int TrailPathItem::Nearest(QPointF const & local) const
+{
+    if (points.isEmpty() || !showpoints) {
+        return -1;
+    }
+
+    ZoomCache &zoomcache = Cache(map->PixelZoom());
+    QTransform transform = map->PixelToLocalTransform();
+    QPointF pixel = transform.inverted().map(local);
+    double radius = (POINT_RADIUS + 1) / transform.m11();
+    double best   = radius * radius;
+    int nearest   = -1;
+
+    const QVector<int> *indexes[2]   = { &zoomcache.committed, &zoomcache.tail };
+    const QVector<QPoint> *pixels[2] = { &zoomcache.committedPixels, &zoomcache.tailPixels };
+    for (int part = 0; part < 2; ++part) {
+        for (int i = 0; i < pixels[part]->size(); ++i) {
+            double dx    = pixels[part]->at(i).x() - pixel.x();
+            double dy    = pixels[part]->at(i).y() - pixel.y();
+            double dist2 = dx * dx + dy * dy;
+            if (dist2 <= best) {
+                best    = dist2;
+                nearest = indexes[part]->at(i);
+            }
+        }
+    }
+    return nearest;
+}
+}
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      A graphicsItem representing a whole trail, points and lines
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QVector>
+#include <QHash>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief The trail of the UAV or the GPS, replaces one TrailItem and one
+ *        TrailLineItem per trail point by a single item.
+ *
+ * The positions are kept in a compact buffer limited to HistorySize() points,
+ * the oldest are dropped. For every zoom level the path is simplified once
+ * (Douglas-Peucker, less than a pixel off) and cached, painting only walks
+ * the cached points and draws what is inside the exposed rectangle.
+ */
+class TrailPathItem : public QObject, public QGraphicsItem {
+    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+public:
+    enum { Type = UserType + 10 };
+    TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map);
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    QRectF boundingRect() const;
+    int type() const;
+
+    /**
+     * @brief Appends a position to the trail
+     */
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    /**
+     * @brief Deletes all the trail points
+     */
+    void Clear();
+    int Count() const
+    {
+        return points.size();
+    }
+    /**
+     * @brief Sets the maximum number of trail points kept, the oldest points are
+     *        dropped once there are more
+     */
+    void SetHistorySize(int const & value);
+    int HistorySize() const
+    {
+        return historysize;
+    }
+    void SetShowPoints(bool const & value);
+    void SetShowLine(bool const & value);
+
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+
+public slots:
+    void RefreshPos();
+
+private:
+    struct TrailPoint {
+        double  lat;
+        double  lng;
+        qint32  altitude;
+        quint32 time;
+    };
+    // The simplified path at one zoom level. The committed part is final, the
+    // tail after the last committed point is simplified again as points come in.
+    struct ZoomCache {
+        ZoomCache() : count(0) {}
+        QVector<int>    committed;
+        QVector<QPoint> committedPixels;
+        QVector<int>    tail;
+        QVector<QPoint> tailPixels;
+        int count; // trail points the cache covers
+        QRect bounds;
+    };
+
+    QVector<TrailPoint> points;
+    mutable QHash<int, ZoomCache> cache;
+    MapGraphicItem *map;
+    QColor pointcolor;
+    QColor linecolor;
+    int historysize;
+    bool showpoints;
+    bool showline;
+
+    ZoomCache & Cache(int zoom) const;
+    QPoint Pixel(int index, int zoom) const;
+    void Simplify(QVector<QPoint> const & pixels, int first, int last, QVector<bool> & keep) const;
+    int Nearest(QPointF const & local) const;
+};
+}
+
+#endif // TRAILPATHITEM_H
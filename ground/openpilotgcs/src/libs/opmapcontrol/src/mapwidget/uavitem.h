@@ -38,8 +38,7 @@
 #include "uavtrailtype.h"
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
-#include "trailitem.h"
-#include "traillineitem.h"
+#include "trailpathitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -216,6 +215,25 @@ public:
      * @brief Deletes all the trail points
      */
     void DeleteTrail() const;
+    /**
+     * @brief Sets the maximum number of trail points, the oldest points are
+     *        removed once the trail gets longer
+     *
+     * @param points 0 keeps all points
+     */
+    void SetTrailHistory(int const & points)
+    {
+        trail->SetHistorySize(points);
+    }
+    /**
+     * @brief Returns the maximum number of trail points
+     *
+     * @return int
+     */
+    int TrailHistory() const
+    {
+        return trail->HistorySize();
+    }
     /**
      * @brief Returns true if the UAV automaticaly sets WP reached value (changing its color)
      *
@@ -282,9 +300,7 @@ private:
     double ringTime;
     QPixmap pic;
     core::Point localposition;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailPathItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
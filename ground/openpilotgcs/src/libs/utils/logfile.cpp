@@ -9,7 +9,9 @@ LogFile::LogFile(QObject *parent) :
     m_timeOffset(0),
     m_playbackSpeed(1.0),
     m_nextTimeStamp(0),
-    m_useProvidedTimeStamp(false)
+    m_useProvidedTimeStamp(false),
+    m_compressed(false),
+    m_inflatedPos(0)
 {
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
@@ -36,6 +38,17 @@ bool LogFile::open(OpenMode mode)
         return false;
     }
 
+    m_compressed  = false;
+    m_inflated.clear();
+    m_inflatedPos = 0;
+    if (!(mode & QIODevice::WriteOnly)) {
+        quint32 magic = 0;
+        if (m_file.peek((char *)&magic, sizeof(magic)) == sizeof(magic) && magic == COMPRESSED_MAGIC) {
+            m_file.read((char *)&magic, sizeof(magic));
+            m_compressed = true;
+        }
+    }
+
     // TODO: Write a header at the beginng describing objects so that in future
     // they can be read back if ID's change
 
@@ -98,19 +111,19 @@ void LogFile::timerFired()
 {
     qint64 dataSize;
 
-    if (m_file.bytesAvailable() > 4) {
+    if (replayHas(5)) {
         int time;
         time = m_myTime.elapsed();
 
         // TODO: going back in time will be a problem
         while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
             m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
+            if (!replayHas(sizeof(dataSize))) {
                 stopReplay();
                 return;
             }
 
-            m_file.read((char *)&dataSize, sizeof(dataSize));
+            replayRead((char *)&dataSize, sizeof(dataSize));
 
             if (dataSize < 1 || dataSize > (1024 * 1024)) {
                 qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
@@ -118,24 +131,26 @@ void LogFile::timerFired()
                 return;
             }
 
-            if (m_file.bytesAvailable() < dataSize) {
+            if (!replayHas(dataSize)) {
                 stopReplay();
                 return;
             }
 
             m_mutex.lock();
-            m_dataBuffer.append(m_file.read(dataSize));
+            int offset = m_dataBuffer.size();
+            m_dataBuffer.resize(offset + dataSize);
+            replayRead(m_dataBuffer.data() + offset, dataSize);
             m_mutex.unlock();
 
             emit readyRead();
 
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_lastTimeStamp)) {
+            if (!replayHas(sizeof(m_lastTimeStamp))) {
                 stopReplay();
                 return;
             }
 
             int save = m_lastTimeStamp;
-            m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
+            replayRead((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
             // some validity checks
             if (m_lastTimeStamp < save // logfile goes back in time
                 || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
@@ -158,7 +173,7 @@ bool LogFile::startReplay()
     m_myTime.restart();
     m_timeOffset = 0;
     m_lastPlayed = 0;
-    m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
+    replayRead((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
     m_timer.setInterval(10);
     m_timer.start();
     emit replayStarted();
@@ -182,3 +197,49 @@ void LogFile::resumeReplay()
     m_timeOffset = m_myTime.elapsed();
     m_timer.start();
 }
+
+/**
+ * True if size more bytes of the log can be replayed. Compressed logs are
+ * inflated a block at a time as the replay gets there, a block cut short
+ * by a crash ends the log.
+ */
+bool LogFile::replayHas(qint64 size)
+{
+    if (!m_compressed) {
+        return m_file.bytesAvailable() >= size;
+    }
+
+    while (m_inflated.size() - m_inflatedPos < size) {
+        quint32 blockSize;
+        if (m_file.bytesAvailable() < (qint64)sizeof(blockSize)) {
+            return false;
+        }
+        m_file.read((char *)&blockSize, sizeof(blockSize));
+        if (m_file.bytesAvailable() < blockSize) {
+            return false;
+        }
+        QByteArray block = qUncompress(m_file.read(blockSize));
+        if (block.isEmpty()) {
+            qDebug() << "Error: Logfile corrupted! Bad compressed block at " << m_file.pos();
+            return false;
+        }
+        m_inflated.remove(0, m_inflatedPos);
+        m_inflatedPos = 0;
+        m_inflated.append(block);
+    }
+    return true;
+}
+
+qint64 LogFile::replayRead(char *data, qint64 size)
+{
+    if (!m_compressed) {
+        return m_file.read(data, size);
+    }
+
+    if (!replayHas(size)) {
+        return -1;
+    }
+    memcpy(data, m_inflated.constData() + m_inflatedPos, size);
+    m_inflatedPos += size;
+    return size;
+}
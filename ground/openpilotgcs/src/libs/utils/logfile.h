@@ -13,6 +13,10 @@
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
     Q_OBJECT
 public:
+    // Compressed logs start with "OPLZ", then blocks of records, each a
+    // quint32 size and the qCompress()ed records
+    static const quint32 COMPRESSED_MAGIC = 0x5A4C504F;
+
     explicit LogFile(QObject *parent = 0);
     qint64 bytesAvailable() const;
     qint64 bytesToWrite()
@@ -73,6 +77,12 @@ protected:
 private:
     quint32 m_nextTimeStamp;
     bool m_useProvidedTimeStamp;
+    bool m_compressed;
+    QByteArray m_inflated;
+    int m_inflatedPos;
+
+    bool replayHas(qint64 size);
+    qint64 replayRead(char *data, qint64 size);
 };
 
 #endif // LOGFILE_H
@@ -48,6 +48,7 @@ GeneralSettings::GeneralSettings() :
     m_autoConnect(true),
     m_autoSelect(true),
     m_useUDPMirror(false),
+    m_telemetryHubPort(0),
     m_useExpertMode(false),
     m_dialog(0)
 {}
@@ -124,6 +125,7 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkAutoConnect->setChecked(m_autoConnect);
     m_page->checkAutoSelect->setChecked(m_autoSelect);
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
+    m_page->sbTelemetryHubPort->setValue(m_telemetryHubPort);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
@@ -141,10 +143,11 @@ void GeneralSettings::apply()
     StyleHelper::setBaseColor(m_page->colorButton->color());
 
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
-    m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
-    m_useExpertMode = m_page->cbExpertMode->isChecked();
-    m_autoConnect   = m_page->checkAutoConnect->isChecked();
-    m_autoSelect    = m_page->checkAutoSelect->isChecked();
+    m_useUDPMirror     = m_page->cbUseUDPMirror->isChecked();
+    m_telemetryHubPort = m_page->sbTelemetryHubPort->value();
+    m_useExpertMode    = m_page->cbExpertMode->isChecked();
+    m_autoConnect      = m_page->checkAutoConnect->isChecked();
+    m_autoSelect       = m_page->checkAutoSelect->isChecked();
 }
 
 void GeneralSettings::finish()
@@ -155,12 +158,13 @@ void GeneralSettings::finish()
 void GeneralSettings::readSettings(QSettings *qs)
 {
     qs->beginGroup(QLatin1String("General"));
-    m_language      = qs->value(QLatin1String("OverrideLanguage"), QLocale::system().name()).toString();
+    m_language         = qs->value(QLatin1String("OverrideLanguage"), QLocale::system().name()).toString();
     m_saveSettingsOnExit = qs->value(QLatin1String("SaveSettingsOnExit"), m_saveSettingsOnExit).toBool();
-    m_autoConnect   = qs->value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
-    m_autoSelect    = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
-    m_useUDPMirror  = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
-    m_useExpertMode = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
+    m_autoConnect      = qs->value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
+    m_autoSelect       = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
+    m_useUDPMirror     = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
+    m_telemetryHubPort = qs->value(QLatin1String("TelemetryHubPort"), m_telemetryHubPort).toInt();
+    m_useExpertMode    = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
     qs->endGroup();
 }
 
@@ -178,6 +182,7 @@ void GeneralSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("AutoConnect"), m_autoConnect);
     qs->setValue(QLatin1String("AutoSelect"), m_autoSelect);
     qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
+    qs->setValue(QLatin1String("TelemetryHubPort"), m_telemetryHubPort);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
     qs->endGroup();
 }
@@ -249,6 +254,14 @@ bool GeneralSettings::useUDPMirror() const
     return m_useUDPMirror;
 }
 
+/**
+ * Local port the telemetry hub listens on, 0 when it is off
+ */
+int GeneralSettings::telemetryHubPort() const
+{
+    return m_telemetryHubPort;
+}
+
 bool GeneralSettings::useExpertMode() const
 {
     return m_useExpertMode;
@@ -57,6 +57,7 @@ public:
     bool autoConnect() const;
     bool autoSelect() const;
     bool useUDPMirror() const;
+    int telemetryHubPort() const;
     void readSettings(QSettings *qs);
     void saveSettings(QSettings *qs);
     bool useExpertMode() const;
@@ -78,6 +79,7 @@ private:
     bool m_autoConnect;
     bool m_autoSelect;
     bool m_useUDPMirror;
+    int m_telemetryHubPort;
     bool m_useExpertMode;
     QPointer<QWidget> m_dialog;
     QList<QTextCodec *> m_codecs;
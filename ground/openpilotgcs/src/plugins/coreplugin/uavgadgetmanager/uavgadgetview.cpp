@@ -32,6 +32,8 @@
 #include "iuavgadget.h"
 #include "coreimpl.h"
 #include "minisplitter.h"
+#include "workspacesettings.h"
+#include <extensionsystem/pluginmanager.h>
 #include <coreplugin/coreconstants.h>
 #include <coreplugin/actionmanager/actionmanager.h>
 
@@ -51,6 +53,9 @@
 #include <QToolButton>
 #include <QMenu>
 #include <QClipboard>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QtCore/QTemporaryFile>
 
 #ifdef Q_WS_MAC
 #include <qmacstyle_mac.h>
@@ -70,8 +75,12 @@ UAVGadgetView::UAVGadgetView(Core::UAVGadgetManager *uavGadgetManager, IUAVGadge
     m_uavGadgetList(new QComboBox(this)),
     m_closeButton(new QToolButton(this)),
     m_defaultIndex(0),
-    m_activeLabel(new QLabel)
+    m_activeLabel(new QLabel),
+    m_hasPendingState(false)
 {
+    m_suspendTimer.setSingleShot(true);
+    connect(&m_suspendTimer, SIGNAL(timeout()), this, SLOT(suspendGadget()));
+
     tl = new QVBoxLayout(this);
     tl->setSpacing(0);
     tl->setMargin(0);
@@ -238,6 +247,7 @@ void UAVGadgetView::listSelectionActivated(int index)
     }
 
     QString classId = m_uavGadgetList->itemData(index).toString();
+    m_pendingClassId.clear();
     if (m_uavGadget && (m_uavGadget->classId() == classId)) {
         return;
     }
@@ -264,6 +274,17 @@ void UAVGadgetView::currentGadgetChanged(IUAVGadget *gadget)
 void UAVGadgetView::saveState(QSettings *qSettings)
 {
     qSettings->setValue("type", "uavGadget");
+    if (isPending()) {
+        qSettings->setValue("classId", m_pendingClassId);
+        if (m_hasPendingState) {
+            qSettings->beginGroup("gadget");
+            foreach(QString key, m_pendingState.keys()) {
+                qSettings->setValue(key, m_pendingState.value(key));
+            }
+            qSettings->endGroup();
+        }
+        return;
+    }
     qSettings->setValue("classId", gadget()->classId());
     qSettings->beginGroup("gadget");
     gadget()->saveState(qSettings);
@@ -280,19 +301,118 @@ void UAVGadgetView::restoreState(QSettings *qSettings)
     }
     classId = m_uavGadgetList->itemData(index).toString();
 
+    m_hasPendingState = qSettings->childGroups().contains("gadget");
+    m_pendingState.clear();
+    if (m_hasPendingState) {
+        qSettings->beginGroup("gadget");
+        foreach(QString key, qSettings->allKeys()) {
+            m_pendingState.insert(key, qSettings->value(key));
+        }
+        qSettings->endGroup();
+    }
+    m_pendingClassId = classId;
+
+    if (isVisible()) {
+        createPendingGadget();
+        return;
+    }
+
+    // Hidden workspace, hold the default gadget until the view shows
+    if (!m_uavGadget) {
+        UAVGadgetInstanceManager *im = ICore::instance()->uavGadgetInstanceManager();
+        replaceGadget(im->createGadget(m_uavGadgetList->itemData(m_defaultIndex).toString(), this));
+    }
+    m_uavGadgetList->setCurrentIndex(index);
+}
+
+void UAVGadgetView::showEvent(QShowEvent *event)
+{
+    m_suspendTimer.stop();
+    if (isPending()) {
+        createPendingGadget();
+    }
+    QWidget::showEvent(event);
+}
+
+void UAVGadgetView::hideEvent(QHideEvent *event)
+{
+    // Only switching workspaces suspends gadgets, not minimizing the window
+    if (!event->spontaneous() && m_uavGadget && !isPending()) {
+        WorkspaceSettings *settings = ExtensionSystem::PluginManager::instance()->getObject<WorkspaceSettings>();
+        int minutes = settings ? settings->suspendHiddenGadgetsAfter() : 0;
+        if (minutes > 0 && m_uavGadget->classId() != m_uavGadgetList->itemData(m_defaultIndex).toString()) {
+            m_suspendTimer.start(minutes * 60 * 1000);
+        }
+    }
+    QWidget::hideEvent(event);
+}
+
+/**
+ * Replaces the gadget of a view hidden for a while by the default gadget,
+ * the gadget is created again from its saved state when the view shows.
+ */
+void UAVGadgetView::suspendGadget()
+{
+    if (isVisible() || isPending() || !m_uavGadget) {
+        return;
+    }
+
+    QTemporaryFile file;
+    if (!file.open()) {
+        return;
+    }
+    QSettings state(file.fileName(), QSettings::IniFormat);
+    m_uavGadget->saveState(&state);
+
+    m_pendingState.clear();
+    foreach(QString key, state.allKeys()) {
+        m_pendingState.insert(key, state.value(key));
+    }
+    m_hasPendingState = true;
+
+    QString classId = m_uavGadget->classId();
+    UAVGadgetInstanceManager *im = ICore::instance()->uavGadgetInstanceManager();
+    replaceGadget(im->createGadget(m_uavGadgetList->itemData(m_defaultIndex).toString(), this));
+    m_pendingClassId = classId;
+    m_uavGadgetList->setCurrentIndex(indexOfClassId(classId));
+}
+
+void UAVGadgetView::createPendingGadget()
+{
+    QString classId = m_pendingClassId;
+
+    m_pendingClassId.clear();
+
     IUAVGadget *newGadget;
     UAVGadgetInstanceManager *im = ICore::instance()->uavGadgetInstanceManager();
-    if (qSettings->childGroups().contains("gadget")) {
+    if (m_hasPendingState) {
         newGadget = im->createGadget(classId, this, false);
-        qSettings->beginGroup("gadget");
-        newGadget->restoreState(qSettings);
-        qSettings->endGroup();
+        // The gadgets restore from QSettings, give them the saved group back
+        QTemporaryFile file;
+        if (file.open()) {
+            QSettings state(file.fileName(), QSettings::IniFormat);
+            foreach(QString key, m_pendingState.keys()) {
+                state.setValue(key, m_pendingState.value(key));
+            }
+            newGadget->restoreState(&state);
+        }
     } else {
         newGadget = im->createGadget(classId, this);
     }
+    m_pendingState.clear();
+    m_hasPendingState = false;
 
+    replaceGadget(newGadget);
+}
+
+void UAVGadgetView::replaceGadget(IUAVGadget *newGadget)
+{
     IUAVGadget *gadgetToRemove = m_uavGadget;
+    bool isCurrent = !gadgetToRemove || m_uavGadgetManager->currentGadget() == gadgetToRemove;
+
     setGadget(newGadget);
-    m_uavGadgetManager->setCurrentGadget(newGadget);
-    im->removeGadget(gadgetToRemove);
+    if (isCurrent) {
+        m_uavGadgetManager->setCurrentGadget(newGadget);
+    }
+    ICore::instance()->uavGadgetInstanceManager()->removeGadget(gadgetToRemove);
 }
@@ -38,6 +38,9 @@
 #include <QVBoxLayout>
 #include <QStackedLayout>
 #include <QtCore/QPointer>
+#include <QtCore/QMap>
+#include <QtCore/QVariant>
+#include <QtCore/QTimer>
 
 
 QT_BEGIN_NAMESPACE
@@ -76,13 +79,24 @@ public:
 public slots:
     void closeView();
 
+protected:
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+
 private slots:
     void listSelectionActivated(int index);
     void currentGadgetChanged(IUAVGadget *gadget);
+    void suspendGadget();
 
 private:
     int indexOfClassId(QString classId);
     void updateToolBar();
+    void replaceGadget(IUAVGadget *newGadget);
+    void createPendingGadget();
+    bool isPending() const
+    {
+        return !m_pendingClassId.isEmpty();
+    }
 
     QPointer<UAVGadgetManager> m_uavGadgetManager;
     QPointer<IUAVGadget> m_uavGadget;
@@ -96,6 +110,14 @@ private:
     QVBoxLayout *tl; // top layout
     int m_defaultIndex;
     QLabel *m_activeLabel;
+
+    // A gadget restored or suspended while the view is hidden is only
+    // created when the view shows, the view holds the default gadget and
+    // the saved state until then.
+    QString m_pendingClassId;
+    bool m_hasPendingState;
+    QMap<QString, QVariant> m_pendingState; // the "gadget" settings group
+    QTimer m_suspendTimer;
 };
 }
 }
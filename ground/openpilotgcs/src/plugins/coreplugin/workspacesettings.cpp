@@ -96,6 +96,7 @@ QWidget *WorkspaceSettings::createPage(QWidget *parent)
     }
     m_page->checkBoxAllowTabMovement->setChecked(m_allowTabBarMovement);
     m_page->checkBoxRestoreSelectedOnStartup->setChecked(m_restoreSelectedOnStartup);
+    m_page->spinBoxSuspendHiddenGadgets->setValue(m_suspendHiddenGadgetsAfter);
 
     return w;
 }
@@ -119,9 +120,10 @@ void WorkspaceSettings::readSettings(QSettings *qs)
         m_iconNames.append(iconName);
         m_modeNames.append(QString("Mode") + QString::number(i));
     }
-    m_tabBarPlacementIndex     = qs->value(QLatin1String("TabBarPlacementIndex"), 1).toInt(); // 1 == "Bottom"
-    m_allowTabBarMovement      = qs->value(QLatin1String("AllowTabBarMovement"), false).toBool();
-    m_restoreSelectedOnStartup = qs->value(QLatin1String("RestoreSelectedOnStartup"), false).toBool();
+    m_tabBarPlacementIndex      = qs->value(QLatin1String("TabBarPlacementIndex"), 1).toInt(); // 1 == "Bottom"
+    m_allowTabBarMovement       = qs->value(QLatin1String("AllowTabBarMovement"), false).toBool();
+    m_restoreSelectedOnStartup  = qs->value(QLatin1String("RestoreSelectedOnStartup"), false).toBool();
+    m_suspendHiddenGadgetsAfter = qs->value(QLatin1String("SuspendHiddenGadgetsAfter"), 0).toInt();
 
     qs->endGroup();
 
@@ -145,6 +147,7 @@ void WorkspaceSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("TabBarPlacementIndex"), m_tabBarPlacementIndex);
     qs->setValue(QLatin1String("AllowTabBarMovement"), m_allowTabBarMovement);
     qs->setValue(QLatin1String("RestoreSelectedOnStartup"), m_restoreSelectedOnStartup);
+    qs->setValue(QLatin1String("SuspendHiddenGadgetsAfter"), m_suspendHiddenGadgetsAfter);
     qs->endGroup();
 }
 
@@ -167,9 +170,10 @@ void WorkspaceSettings::apply()
             modeManager->updateModeNameIcon(mode, QIcon(iconName(i)), name(i));
         }
     }
-    m_tabBarPlacementIndex     = m_page->comboBoxTabBarPlacement->currentIndex();
-    m_allowTabBarMovement      = m_page->checkBoxAllowTabMovement->isChecked();
-    m_restoreSelectedOnStartup = m_page->checkBoxRestoreSelectedOnStartup->isChecked();
+    m_tabBarPlacementIndex      = m_page->comboBoxTabBarPlacement->currentIndex();
+    m_allowTabBarMovement       = m_page->checkBoxAllowTabMovement->isChecked();
+    m_restoreSelectedOnStartup  = m_page->checkBoxRestoreSelectedOnStartup->isChecked();
+    m_suspendHiddenGadgetsAfter = m_page->spinBoxSuspendHiddenGadgets->value();
 
     QTabWidget::TabPosition pos = m_tabBarPlacementIndex == 0 ? QTabWidget::North : QTabWidget::South;
     emit tabBarSettingsApplied(pos, m_allowTabBarMovement);
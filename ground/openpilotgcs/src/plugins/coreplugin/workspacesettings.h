@@ -81,6 +81,11 @@ public:
     {
         return m_restoreSelectedOnStartup;
     }
+    // minutes after which gadgets on hidden workspaces are unloaded, 0 for never
+    int suspendHiddenGadgetsAfter() const
+    {
+        return m_suspendHiddenGadgetsAfter;
+    }
 
 signals:
     void tabBarSettingsApplied(QTabWidget::TabPosition pos, bool movable);
@@ -103,6 +108,7 @@ private:
     int m_tabBarPlacementIndex;
     bool m_allowTabBarMovement;
     bool m_restoreSelectedOnStartup;
+    int m_suspendHiddenGadgetsAfter;
     static const int MAX_WORKSPACES;
 };
 } // namespace Internal
@@ -87,25 +87,18 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                                       QString object2, QString nfield2,
                                       QString object3, QString nfield3)
 {
-    if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
-    }
-    if (obj2 != NULL) {
-        disconnect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
-    }
-    if (obj3 != NULL) {
-        disconnect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
-    }
-
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    // Needles are redrawn at most once per frame, and not at all while hidden
+    UAVObjectUpdateBus *updateBus = pm->getObject<UAVObjectUpdateBus>();
+
+    updateBus->unsubscribe(this);
 
     // Check validity of arguments first, reject empty args and unknown fields.
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
             // qDebug() << "Connected Object 1 (" << object1 << ").";
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -115,6 +108,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field1 = nfield1;
                 haveSubField1 = false;
             }
+            updateBus->subscribe(obj1, this, "updateNeedle1", QStringList(field1));
         } else {
             qDebug() << "Error: Object is unknown (" << object1 << ").";
         }
@@ -125,7 +119,6 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj2 = dynamic_cast<UAVDataObject *>(objManager->getObject(object2));
         if (obj2 != NULL) {
             // qDebug() << "Connected Object 2 (" << object2 << ").";
-            connect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
             if (nfield2.contains("-")) {
                 QStringList fieldSubfield = nfield2.split("-", QString::SkipEmptyParts);
                 field2        = fieldSubfield.at(0);
@@ -135,6 +128,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field2 = nfield2;
                 haveSubField2 = false;
             }
+            updateBus->subscribe(obj2, this, "updateNeedle2", QStringList(field2));
         } else {
             qDebug() << "Error: Object is unknown (" << object2 << ").";
         }
@@ -145,7 +139,6 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj3 = dynamic_cast<UAVDataObject *>(objManager->getObject(object3));
         if (obj3 != NULL) {
             // qDebug() << "Connected Object 3 (" << object3 << ").";
-            connect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
             if (nfield3.contains("-")) {
                 QStringList fieldSubfield = nfield3.split("-", QString::SkipEmptyParts);
                 field3        = fieldSubfield.at(0);
@@ -155,6 +148,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field3 = nfield3;
                 haveSubField3 = false;
             }
+            updateBus->subscribe(obj3, this, "updateNeedle3", QStringList(field3));
         } else {
             qDebug() << "Error: Object is unknown (" << object3 << ").";
         }
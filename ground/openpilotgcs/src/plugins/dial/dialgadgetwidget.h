@@ -32,6 +32,7 @@
 #include "dialgadgetconfiguration.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatebus.h"
 #include "uavobject.h"
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
@@ -152,6 +152,21 @@ void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int az
     }
 }
 
+/**
+   Replaces all satellites at once, the slots after the last one are emptied.
+ */
+void GpsConstellationWidget::updateSats(const QList<GpsSatellite> &sats)
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (index < sats.size()) {
+            const GpsSatellite &sat = sats.at(index);
+            updateSat(index, sat.prn, sat.elevation, sat.azimuth, sat.snr);
+        } else if (satellites[index][0]) {
+            updateSat(index, 0, 0, 0, 0);
+        }
+    }
+}
+
 /**
    Converts the elevation/azimuth to X/Y coordinates on the map
 
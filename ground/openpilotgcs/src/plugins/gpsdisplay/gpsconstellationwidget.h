@@ -31,6 +31,7 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include "gpsparser.h"
 
 
 class GpsConstellationWidget : public QGraphicsView {
@@ -42,6 +43,7 @@ public:
 
 public slots:
     void updateSat(int index, int prn, int elevation, int azimuth, int snr);
+    void updateSats(const QList<GpsSatellite> &sats);
 
 
 private slots:
@@ -108,8 +108,8 @@ void GpsDisplayGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     connect(parser, SIGNAL(speedheading(double, double)), m_widget, SLOT(setSpeedHeading(double, double)));
     connect(parser, SIGNAL(datetime(double, double)), m_widget, SLOT(setDateTime(double, double)));
     connect(parser, SIGNAL(packet(QString)), m_widget, SLOT(dumpPacket(QString)));
-    connect(parser, SIGNAL(satellite(int, int, int, int, int)), m_widget->gpsSky, SLOT(updateSat(int, int, int, int, int)));
-    connect(parser, SIGNAL(satellite(int, int, int, int, int)), m_widget->gpsSnrWidget, SLOT(updateSat(int, int, int, int, int)));
+    connect(parser, SIGNAL(satellites(QList<GpsSatellite>)), m_widget->gpsSky, SLOT(updateSats(QList<GpsSatellite>)));
+    connect(parser, SIGNAL(satellites(QList<GpsSatellite>)), m_widget->gpsSnrWidget, SLOT(updateSats(QList<GpsSatellite>)));
     connect(parser, SIGNAL(fixtype(QString)), m_widget, SLOT(setFixType(QString)));
     connect(parser, SIGNAL(dop(double, double, double)), m_widget, SLOT(setDOP(double, double, double)));
 }
@@ -166,10 +166,5 @@ void GpsDisplayGadget::onDataAvailable()
 
 void GpsDisplayGadget::processNewSerialData(QByteArray serialData)
 {
-    int dataLength   = serialData.size();
-    const char *data = serialData.constData();
-
-    for (int pos = 0; pos < dataLength; pos++) {
-        parser->processInputStream(data[pos]);
-    }
+    parser->processInputStream(serialData);
 }
@@ -58,6 +58,9 @@ GpsDisplayWidget::GpsDisplayWidget(QWidget *parent) : QWidget(parent)
     fescene->addItem(marker);
     double scale = earthpix.width() / (marker->boundingRect().width() * 20);
     marker->setScale(scale);
+
+    // Packets come in bursts, the oldest lines are dropped by the document
+    textBrowser->document()->setMaximumBlockCount(200);
 }
 
 GpsDisplayWidget::~GpsDisplayWidget()
@@ -102,13 +105,6 @@ void GpsDisplayWidget::setFixType(const QString &fixtype)
 void GpsDisplayWidget::dumpPacket(const QString &packet)
 {
     textBrowser->append(packet);
-    if (textBrowser->document()->lineCount() > 200) {
-        QTextCursor tc = textBrowser->textCursor();
-        tc.movePosition(QTextCursor::Start);
-        tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-        tc.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
-        tc.removeSelectedText();
-    }
 }
 
 void GpsDisplayWidget::setSVs(int sv)
@@ -30,14 +30,13 @@
 GPSParser::GPSParser(QObject *parent) : QObject(parent)
 {
     qRegisterMetaType<QList<int> >("QList<int>");
+    qRegisterMetaType<QList<GpsSatellite> >("QList<GpsSatellite>");
 }
 
 GPSParser::~GPSParser()
 {}
 
-void GPSParser::processInputStream(char c)
+void GPSParser::processInputStream(const QByteArray & data)
 {
-    {
-        Q_UNUSED(c)
-    }
+    Q_UNUSED(data)
 }
@@ -68,6 +68,21 @@ void GpsSnrWidget::updateSat(int index, int prn, int elevation, int azimuth, int
     drawSat(index);
 }
 
+/**
+   Replaces all satellites at once, the slots after the last one are emptied.
+ */
+void GpsSnrWidget::updateSats(const QList<GpsSatellite> &sats)
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (index < sats.size()) {
+            const GpsSatellite &sat = sats.at(index);
+            updateSat(index, sat.prn, sat.elevation, sat.azimuth, sat.snr);
+        } else if (satellites[index][0]) {
+            updateSat(index, 0, 0, 0, 0);
+        }
+    }
+}
+
 void GpsSnrWidget::drawSat(int index)
 {
     if (index >= MAX_SATTELITES) {
@@ -3,6 +3,7 @@
 
 #include <QGraphicsView>
 #include <QGraphicsRectItem>
+#include "gpsparser.h"
 
 class GpsSnrWidget : public QGraphicsView {
     Q_OBJECT
@@ -14,6 +15,7 @@ signals:
 
 public slots:
     void updateSat(int index, int prn, int elevation, int azimuth, int snr);
+    void updateSats(const QList<GpsSatellite> &sats);
 
 private:
     static const int MAX_SATTELITES = 16;
@@ -27,461 +27,396 @@
 
 
 #include "nmeaparser.h"
-#include <iostream>
-#include <math.h>
+#include <string.h>
 #include <QDebug>
-#include <QStringList>
-#include <QWidget>
-#include <QVBoxLayout>
-#include <QPushButton>
-
-// Message Codes
-#define NMEA_NODATA    0       // No data. Packet not available, bad, or not decoded
-#define NMEA_GPGGA     1       // Global Positioning System Fix Data
-#define NMEA_GPVTG     2       // Course over ground and ground speed
-#define NMEA_GPGLL     3       // Geographic position - latitude/longitude
-#define NMEA_GPGSV     4       // GPS satellites in view
-#define NMEA_GPGSA     5       // GPS DOP and active satellites
-#define NMEA_GPRMC     6       // Recommended minimum specific GPS data
-#define NMEA_GPZDA     7       // Time and Date
-#define NMEA_UNKNOWN   0xFF // Packet received but not known
-
-#define GPS_TIMEOUT_MS 500
 
 // Debugging
 
-// #define GPSDEBUG
 // #define NMEA_DEBUG_PKT	///< define to enable debug of all NMEA messages
 
-#ifdef GPSDEBUG
-        #define NMEA_DEBUG_PKT ///< define to enable debug of all NMEA messages
-        #define NMEA_DEBUG_GGA ///< define to enable debug of GGA messages
-        #define NMEA_DEBUG_VTG ///< define to enable debug of VTG messages
-        #define NMEA_DEBUG_RMC ///< define to enable debug of RMC messages
-        #define NMEA_DEBUG_GSA ///< define to enable debug of GSA messages
-        #define NMEA_DEBUG_ZDA ///< define to enable debug of ZDA messages
-#endif
-
 /**
- * Initialize the parser
+ * Numbers are decoded by hand, strtod() follows the locale Qt sets
+ * and would stop at the decimal point in some of them.
  */
-NMEAParser::NMEAParser(QObject *parent) : GPSParser(parent)
+static double nmeaToDouble(const char *s)
 {
-    bufferInit(&gpsRxBuffer, (unsigned char *)gpsRxData, 512);
-    gpsRxOverflow = 0;
+    bool negative = (*s == '-');
+
+    if (*s == '-' || *s == '+') {
+        s++;
+    }
+    double value = 0;
+    for (; *s >= '0' && *s <= '9'; s++) {
+        value = value * 10 + (*s - '0');
+    }
+    if (*s == '.') {
+        double fraction = 0;
+        double divisor  = 1;
+        for (s++; *s >= '0' && *s <= '9'; s++) {
+            fraction = fraction * 10 + (*s - '0');
+            divisor *= 10;
+        }
+        value += fraction / divisor;
+    }
+    return negative ? -value : value;
 }
 
-NMEAParser::~NMEAParser()
-{}
+static int nmeaToInt(const char *s)
+{
+    return (int)nmeaToDouble(s);
+}
 
-/**
- * Called each time there are data in the input buffer
- */
-void NMEAParser::processInputStream(char c)
+static int nmeaHexValue(char c)
 {
-    if (!bufferAddToEnd(&gpsRxBuffer, c)) {
-        // no space in buffer
-        // count overflow
-        gpsRxOverflow++;
-        return;
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
     }
-    nmeaProcess(&gpsRxBuffer);
+    return -1;
 }
 
-
 /**
- * Prosesses NMEA sentence checksum
- * \param[in] Buffer for parsed nmea sentence
- * \return 0 checksum not valid
- * \return 1 checksum valid
+ * Converts a ddmm.mmmm NMEA coordinate to degrees
  */
-char NMEAParser::nmeaChecksum(char *gps_buffer)
+static double nmeaToDegrees(const char *s, const char *hemisphere)
 {
-    char checksum = 0;
-    char checksum_received = 0;
+    double value = nmeaToDouble(s);
+    int deg = (int)value / 100;
+    double degrees = deg + (value - deg * 100) / 60.0;
 
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
-            // Parsing received checksum...
-            checksum_received = strtol(&gps_buffer[x + 1], NULL, 16);
-
-            break;
-        } else {
-            // XOR the received data...
-            checksum ^= gps_buffer[x];
-        }
-    }
-    if (checksum == checksum_received) {
-        ++numUpdates;
-        return 1;
-    } else {
-        ++numErrors;
-        return 0;
-    }
+    return (*hemisphere == 'S' || *hemisphere == 'W') ? -degrees : degrees;
 }
 
-void NMEAParser::nmeaTerminateAtChecksum(char *gps_buffer)
+/**
+ * Initialize the parser
+ */
+NMEAParser::NMEAParser(QObject *parent) : GPSParser(parent),
+    numUpdates(0), numErrors(0), gpsRxOverflow(0),
+    sentenceLength(-1), numFields(0), updated(0), fixMode(0), fixType(0),
+    gsaCount(0), epochTime(0), epochTimed(false)
 {
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
-            gps_buffer[x] = 0;
-            break;
-        }
-    }
+    memset(&GpsData, 0, sizeof(GpsData));
 }
 
+NMEAParser::~NMEAParser()
+{}
+
 /**
- * Prosesses NMEA sentences
- * \param[in] cBuffer for prosessed nmea sentences
- * \return Message code for found packet
- * \return 0xFF NO packet found
+ * Called each time there are data in the input buffer. Sentences cut at the
+ * end of the chunk are completed with the next one.
  */
-uint8_t NMEAParser::nmeaProcess(cBuffer *rxBuffer)
+void NMEAParser::processInputStream(const QByteArray & data)
 {
-    uint8_t foundpacket = NMEA_NODATA;
-    uint8_t startFlag   = false;
-    // u08 data;
-    uint16_t i, j;
-
-    // process the receive buffer
-    // go through buffer looking for packets
-    while (rxBuffer->datalength) {
-        // look for a start of NMEA packet
-        if (bufferGetAtIndex(rxBuffer, 0) == '$') {
-            // found start
-            startFlag = true;
-            // when start is found, we leave it intact in the receive buffer
-            // in case the full NMEA string is not completely received.  The
-            // start will be detected in the next nmeaProcess iteration.
-
-            // done looking for start
-            break;
-        } else {
-            bufferGetFromFront(rxBuffer);
-        }
-    }
-
-    // if we detected a start, look for end of packet
-    if (startFlag) {
-        for (i = 1; i < (rxBuffer->datalength) - 1; i++) {
-            // check for end of NMEA packet <CR><LF>
-            if ((bufferGetAtIndex(rxBuffer, i) == '\r') && (bufferGetAtIndex(rxBuffer, i + 1) == '\n')) {
-                // have a packet end
-                // dump initial '$'
-                bufferGetFromFront(rxBuffer);
-                // copy packet to NmeaPacket
-                for (j = 0; j < (i - 1); j++) {
-                    // although NMEA strings should be 80 characters or less,
-                    // receive buffer errors can generate erroneous packets.
-                    // Protect against packet buffer overflow
-                    if (j < (NMEA_BUFFERSIZE - 1)) {
-                        NmeaPacket[j] = bufferGetFromFront(rxBuffer);
-                    } else {
-                        bufferGetFromFront(rxBuffer);
-                    }
-                }
-                // null terminate it
-                if (j < (NMEA_BUFFERSIZE - 1)) {
-                    NmeaPacket[j] = 0;
-                } else {
-                    NmeaPacket[NMEA_BUFFERSIZE - 1] = 0;
-                }
-                // dump <CR><LF> from rxBuffer
-                bufferGetFromFront(rxBuffer);
-                bufferGetFromFront(rxBuffer);
-                // DEBUG
-                                #ifdef NMEA_DEBUG_PKT
-                qDebug() << NmeaPacket;
-                                #endif
-                emit packet(QString(NmeaPacket));
-                // found a packet
-                // done with this processing session
-                foundpacket = NMEA_UNKNOWN;
+    const char *pos = data.constData();
+    const char *end = pos + data.size();
+
+    while (pos < end) {
+        if (sentenceLength < 0) {
+            // look for a start of NMEA packet
+            const char *start = (const char *)memchr(pos, '$', end - pos);
+            if (!start) {
                 break;
             }
+            pos = start + 1;
+            sentenceLength = 0;
+            continue;
         }
-    }
 
-    if (foundpacket) {
-        // check message type and process appropriately
-        if (!strncmp(NmeaPacket, "GPGGA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGGA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGGA;
-        } else if (!strncmp(NmeaPacket, "GPVTG", 5)) {
-            // process packet of this type
-            nmeaProcessGPVTG(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPVTG;
-        } else if (!strncmp(NmeaPacket, "GPGSA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGSA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGSA;
-        } else if (!strncmp(NmeaPacket, "GPRMC", 5)) {
-            // process packet of this type
-            nmeaProcessGPRMC(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPRMC;
-        } else if (!strncmp(NmeaPacket, "GPGSV", 5)) {
-            // Process packet of this type
-            nmeaProcessGPGSV(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPGSV;
-        } else if (!strncmp(NmeaPacket, "GPZDA", 5)) {
-            // Process packet of this type
-            nmeaProcessGPZDA(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPZDA;
+        char c = *pos++;
+        if (c == '\r' || c == '\n') {
+            sentence[sentenceLength] = 0;
+            processSentence();
+            sentenceLength = -1;
+        } else if (c == '$') {
+            // previous sentence was cut short
+            ++numErrors;
+            sentenceLength = 0;
+        } else if (sentenceLength < NMEA_BUFFERSIZE - 1) {
+            sentence[sentenceLength++] = c;
+        } else {
+            // although NMEA strings should be 80 characters or less,
+            // receive errors can generate erroneous packets
+            ++gpsRxOverflow;
+            sentenceLength = -1;
         }
-    } else if (rxBuffer->datalength >= rxBuffer->size) {
-        // if we found no packet, and the buffer is full
-        // we're logjammed, flush entire buffer
-        bufferFlush(rxBuffer);
     }
-    return foundpacket;
+
+    if (!epochTimed) {
+        emitUpdates();
+    }
 }
 
 /**
- * Processes NMEA GSV sentences (satellites in view)
- * \param[in] Buffer for parsed nmea GSV sentence
+ * Field of the current sentence, empty if the sentence is too short
  */
-void NMEAParser::nmeaProcessGPGSV(char *packet)
+const char *NMEAParser::field(int index) const
 {
-    // start parsing just after "GPGSV,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
+    return index < numFields ? fields[index] : "";
+}
+
+/**
+ * Checks the sentence in the buffer, splits it into fields and decodes it
+ */
+void NMEAParser::processSentence()
+{
+#ifdef NMEA_DEBUG_PKT
+    qDebug() << sentence;
+#endif
+    if (receivers(SIGNAL(packet(QString))) > 0) {
+        packets.append(sentence, sentenceLength);
+        packets.append('\n');
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
+    // XOR everything up to the '*', two hex digits follow
+    char checksum = 0;
+    int star = 0;
+    for (; star < sentenceLength && sentence[star] != '*'; star++) {
+        checksum ^= sentence[star];
+    }
+    if (star + 3 > sentenceLength
+        || nmeaHexValue(sentence[star + 1]) < 0 || nmeaHexValue(sentence[star + 2]) < 0
+        || (char)(nmeaHexValue(sentence[star + 1]) << 4 | nmeaHexValue(sentence[star + 2])) != checksum) {
+        ++numErrors;
         return;
     }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
-
-    // Officially there should be a max of three sentences (12 sats), some gps receivers do more..
-
-    const int sentence_total = tokenslist.at(1).toInt(); // Number of sentences for full data
-    const int sentence_index = tokenslist.at(2).toInt(); // sentence x of y
-
-    int sats = (tokenslist.size() - 4) / 4;
-    for (int sat = 0; sat < sats; sat++) {
-        int base          = 4 + sat * 4;
-        const int id      = tokenslist.at(base + 0).toInt(); // Satellite PRN number
-        const int elv     = tokenslist.at(base + 1).toInt(); // Elevation, degrees
-        const int azimuth = tokenslist.at(base + 2).toInt(); // Azimuth, degrees
-        const int sig     = tokenslist.at(base + 3).toInt(); // SNR - higher is better
-        const int index   = (sentence_index - 1) * 4 + sat;
-        emit satellite(index, id, elv, azimuth, sig);
+    ++numUpdates;
+    sentence[star] = 0;
+
+    // split in place
+    char *pos = sentence;
+    numFields = 0;
+    fields[numFields++] = pos;
+    while (numFields < NMEA_MAX_FIELDS && (pos = strchr(pos, ',')) != NULL) {
+        *pos++ = 0;
+        fields[numFields++] = pos;
     }
 
-    if (sentence_index == sentence_total) {
-        // Last sentence
-        int total_sats = (sentence_index - 1) * 4 + sats;
-        for (int emptySatIndex = total_sats; emptySatIndex < 16; emptySatIndex++) {
-            // Wipe the rest.
-            emit satellite(emptySatIndex, 0, 0, 0, 0);
-        }
+    // talker (GP, GL, GN, ...) and sentence type, reject empty packets right away
+    if (strlen(fields[0]) != 5 || *field(1) == 0) {
+        return;
+    }
+    const char *type = fields[0] + 2;
+    if (!strcmp(type, "GGA")) {
+        nmeaProcessGPGGA();
+    } else if (!strcmp(type, "RMC")) {
+        nmeaProcessGPRMC();
+    } else if (!strcmp(type, "VTG")) {
+        nmeaProcessGPVTG();
+    } else if (!strcmp(type, "GSA")) {
+        nmeaProcessGPGSA();
+    } else if (!strcmp(type, "GSV")) {
+        nmeaProcessGPGSV();
+    } else if (!strcmp(type, "ZDA")) {
+        nmeaProcessGPZDA();
     }
 }
 
 /**
- * Prosesses NMEA GPGGA sentences
- * \param[in] Buffer for parsed nmea GPGGA sentence
+ * Called with the fix time of GGA, RMC and ZDA sentences, another time
+ * than the one of the current epoch completes it
  */
-void NMEAParser::nmeaProcessGPGGA(char *packet)
+void NMEAParser::startEpoch(const char *time)
 {
-    // start parsing just after "GPGGA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (!*time) {
+        // no fix time, updates go out once per chunk
+        epochTimed = false;
         return;
     }
-
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
+    double t = nmeaToDouble(time);
+    if (epochTimed && t == epochTime) {
         return;
     }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime  = tokenslist.at(1).toDouble();
-    GpsData.Latitude = tokenslist.at(2).toDouble();
-    int deg    = (int)GpsData.Latitude / 100;
-    double min = ((GpsData.Latitude) - (deg * 100)) / 60.0;
-    GpsData.Latitude = deg + min;
-    // next field: N/S indicator
-    // correct latitute for N/S
-    if (tokenslist.at(3).contains("S")) {
-        GpsData.Latitude = -GpsData.Latitude;
-    }
-
-    GpsData.Longitude = tokenslist.at(4).toDouble();
-    deg = (int)GpsData.Longitude / 100;
-    min = ((GpsData.Longitude) - (deg * 100)) / 60.0;
-    GpsData.Longitude = deg + min;
-    // next field: E/W indicator
-    // correct latitute for E/W
-    if (tokenslist.at(5).contains("W")) {
-        GpsData.Longitude = -GpsData.Longitude;
+    if (epochTimed) {
+        emitUpdates();
     }
-
-    GpsData.SV = tokenslist.at(7).toInt();
-
-    GpsData.Altitude = tokenslist.at(9).toDouble();
-    GpsData.GeoidSeparation = tokenslist.at(11).toDouble();
-    emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
-    emit sv(GpsData.SV);
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    epochTime  = t;
+    epochTimed = true;
+    usedSVs.clear();
+    gsaCount   = 0;
 }
 
 /**
- * Prosesses NMEA GPRMC sentences
- * \param[in] Buffer for parsed nmea GPRMC sentence
+ * Hands the latest state of everything the epoch updated to the widgets
  */
-void NMEAParser::nmeaProcessGPRMC(char *packet)
+void NMEAParser::emitUpdates()
 {
-    // start parsing just after "GPRMC,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
+    if (!packets.isEmpty()) {
+        packets.chop(1);
+        emit packet(QString::fromLatin1(packets));
+        packets.clear();
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
+    if (updated & UpdatePosition) {
+        emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
+    }
+    if (updated & UpdateSV) {
+        emit sv(GpsData.SV);
+    }
+    if (updated & UpdateDateTime) {
+        emit datetime(GpsData.GPSdate, GpsData.GPStime);
     }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
-    GpsData.Groundspeed = GpsData.Groundspeed * 0.51444;
-    GpsData.Heading     = tokenslist.at(8).toDouble();
-    GpsData.GPSdate     = tokenslist.at(9).toDouble();
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
-    emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+    if (updated & UpdateSpeedHeading) {
+        emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+    }
+    if (updated & UpdateFix) {
+        // M=Manual, forced to operate in 2D or 3D
+        // A=Automatic, 3D/2D
+        if (fixMode == 'A') {
+            emit fixmode(QString("Auto"));
+        } else if (fixMode == 'M') {
+            emit fixmode(QString("Manual"));
+        }
+        // Mode: 1=Fix not available, 2=2D, 3=3D
+        if (fixType == 1) {
+            emit fixtype(QString("NoFix"));
+        } else if (fixType == 2) {
+            emit fixtype(QString("Fix2D"));
+        } else if (fixType == 3) {
+            emit fixtype(QString("Fix3D"));
+        }
+        QList<int> svs;
+        foreach(const QList<int> &systemSVs, usedSVs) {
+            svs += systemSVs;
+        }
+        emit fixSVs(svs);
+    }
+    if (updated & UpdateDOP) {
+        emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
+    }
+    if (updated & UpdateSatellites) {
+        QList<GpsSatellite> sats;
+        foreach(const QList<GpsSatellite> &talkerSats, satsInView) {
+            sats += talkerSats;
+        }
+        emit satellites(sats);
+    }
+    updated = 0;
 }
 
-
 /**
- * Prosesses NMEA GPVTG sentences
- * \param[in] Buffer for parsed nmea GPVTG sentence
+ * Processes NMEA GSV sentences (satellites in view)
  */
-void NMEAParser::nmeaProcessGPVTG(char *packet)
+void NMEAParser::nmeaProcessGPGSV()
 {
-    // start parsing just after "GPVTG,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
+    // Officially there should be a max of three sentences (12 sats), some gps receivers do more..
+    const quint16 talker = (quint16)(fields[0][0] << 8 | fields[0][1]);
+    const int sentence_total = nmeaToInt(field(1)); // Number of sentences for full data
+    const int sentence_index = nmeaToInt(field(2)); // sentence x of y
+    QList<GpsSatellite> &pending = satsPending[talker];
+
+    if (sentence_index == 1) {
+        pending.clear();
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
+    int sats = (numFields - 4) / 4;
+    for (int sat = 0; sat < sats; sat++) {
+        int base = 4 + sat * 4;
+        GpsSatellite info;
+        info.prn       = nmeaToInt(field(base + 0)); // Satellite PRN number
+        info.elevation = nmeaToInt(field(base + 1)); // Elevation, degrees
+        info.azimuth   = nmeaToInt(field(base + 2)); // Azimuth, degrees
+        info.snr       = nmeaToInt(field(base + 3)); // SNR - higher is better
+        pending.append(info);
     }
-    nmeaTerminateAtChecksum(packet);
 
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
+    if (sentence_index == sentence_total) {
+        // Last sentence, the group replaces what this talker reported before
+        satsInView[talker] = pending;
+        updated |= UpdateSatellites;
+    }
+}
 
-    GpsData.Heading     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
-    GpsData.Groundspeed = GpsData.Groundspeed / 3.6;
-    emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+/**
+ * Processes NMEA GPGGA sentences
+ */
+void NMEAParser::nmeaProcessGPGGA()
+{
+    startEpoch(field(1));
+    GpsData.GPStime   = nmeaToDouble(field(1));
+    GpsData.Latitude  = nmeaToDegrees(field(2), field(3));
+    GpsData.Longitude = nmeaToDegrees(field(4), field(5));
+    GpsData.SV = nmeaToInt(field(7));
+    GpsData.Altitude  = nmeaToDouble(field(9));
+    GpsData.GeoidSeparation = nmeaToDouble(field(11));
+    updated |= UpdatePosition | UpdateSV | UpdateDateTime;
 }
 
 /**
- * Prosesses NMEA GPGSA sentences
- * \param[in] Buffer for parsed nmea GPGSA sentence
+ * Processes NMEA GPRMC sentences
  */
-void NMEAParser::nmeaProcessGPGSA(char *packet)
+void NMEAParser::nmeaProcessGPRMC()
 {
-    // start parsing just after "GPGSA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
+    startEpoch(field(1));
+    GpsData.GPStime     = nmeaToDouble(field(1));
+    GpsData.Groundspeed = nmeaToDouble(field(7)) * 0.51444;
+    GpsData.Heading     = nmeaToDouble(field(8));
+    GpsData.GPSdate     = nmeaToDouble(field(9));
+    updated |= UpdateDateTime | UpdateSpeedHeading;
+}
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
-    // M=Manual, forced to operate in 2D or 3D
-    // A=Automatic, 3D/2D
-    QString fixmodeValue = tokenslist.at(1);
-    if (fixmodeValue == "A") {
-        emit fixmode(QString("Auto"));
-    } else if (fixmodeValue == "B") {
-        emit fixmode(QString("Manual"));
-    }
+/**
+ * Processes NMEA GPVTG sentences
+ */
+void NMEAParser::nmeaProcessGPVTG()
+{
+    GpsData.Heading     = nmeaToDouble(field(1));
+    GpsData.Groundspeed = nmeaToDouble(field(7)) / 3.6;
+    updated |= UpdateSpeedHeading;
+}
 
-    // Mode: 1=Fix not available, 2=2D, 3=3D
-    int fixtypeValue = tokenslist.at(2).toInt();
-    if (fixtypeValue == 1) {
-        emit fixtype(QString("NoFix"));
-    } else if (fixtypeValue == 2) {
-        emit fixtype(QString("Fix2D"));
-    } else if (fixtypeValue == 3) {
-        emit fixtype(QString("Fix3D"));
+/**
+ * Processes NMEA GPGSA sentences, a multi-GNSS receiver sends one per
+ * GNSS in every epoch
+ */
+void NMEAParser::nmeaProcessGPGSA()
+{
+    fixMode = *field(1);
+    fixType = nmeaToInt(field(2));
+
+    // 18 = GNSS system ID since NMEA 4.10, the GNGSA sentences of older
+    // receivers are told apart by their order in the epoch
+    int system;
+    if (*field(18)) {
+        system = nmeaToInt(field(18));
+    } else if (!strncmp(fields[0], "GN", 2)) {
+        system = 0x100 + gsaCount;
+    } else {
+        system = fields[0][0] << 8 | fields[0][1];
     }
+    gsaCount++;
 
     // 3-14 = IDs of SVs used in position fix (null for unused fields)
-    QList<int> svList;
+    QList<int> &svs = usedSVs[system];
+    svs.clear();
     for (int pos = 0; pos < 12; pos++) {
-        QString sv = tokenslist.at(3 + pos);
-        if (!sv.isEmpty()) {
-            svList.append(sv.toInt());
+        const char *sv = field(3 + pos);
+        if (*sv) {
+            svs.append(nmeaToInt(sv));
         }
     }
-    emit fixSVs(svList);
 
     // 15   = PDOP
     // 16   = HDOP
     // 17   = VDOP
-    GpsData.PDOP = tokenslist.at(15).toDouble();
-    GpsData.HDOP = tokenslist.at(16).toDouble();
-    GpsData.VDOP = tokenslist.at(17).toDouble();
-    emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
+    GpsData.PDOP = nmeaToDouble(field(15));
+    GpsData.HDOP = nmeaToDouble(field(16));
+    GpsData.VDOP = nmeaToDouble(field(17));
+    updated |= UpdateFix | UpdateDOP;
 }
 
 /**
- * Prosesses NMEA GPZDA sentences
- * \param[in] Buffer for parsed nmea GPZDA sentence
+ * Processes NMEA GPZDA sentences
  */
-void NMEAParser::nmeaProcessGPZDA(char *packet)
+void NMEAParser::nmeaProcessGPZDA()
 {
-    // start parsing just after "GPZDA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
-
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
-    GpsData.GPStime = tokenslist.at(1).toDouble();
-    int day   = tokenslist.at(2).toInt();
-    int month = tokenslist.at(3).toInt();
-    int year  = tokenslist.at(4).toInt();
+    startEpoch(field(1));
+    GpsData.GPStime = nmeaToDouble(field(1));
+    int day   = nmeaToInt(field(2));
+    int month = nmeaToInt(field(3));
+    int year  = nmeaToInt(field(4));
     GpsData.GPSdate = day * 10000 + month * 100 + (year - 2000);
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    updated |= UpdateDateTime;
 }
@@ -31,11 +31,11 @@
 #include <QObject>
 #include <QtCore>
 #include <stdint.h>
-#include "buffer.h"
 #include "gpsparser.h"
 
 // constants/macros/typdefs
 #define NMEA_BUFFERSIZE 128
+#define NMEA_MAX_FIELDS 24
 
 typedef struct struct_GpsData {
     double Latitude;
@@ -53,30 +53,66 @@ typedef struct struct_GpsData {
     double GPSdate;
 } GpsData_t;
 
+/**
+ * Decodes NMEA sentences a chunk of serial data at a time. Sentences are
+ * split in place, nothing is allocated per sentence.
+ *
+ * All sentences of an epoch update GpsData and the satellites, the signals
+ * are emitted once per epoch with its complete state so a fast receiver does
+ * not flood the widgets. An epoch ends when a GGA, RMC or ZDA sentence with
+ * another fix time arrives, its updates are therefore handed over when the
+ * next epoch starts. Without fix times the updates go out once per chunk.
+ */
 class NMEAParser : public GPSParser {
     Q_OBJECT
 
 public:
     NMEAParser(QObject *parent = 0);
     ~NMEAParser();
-    void processInputStream(char c);
-    char *nmeaGetPacketBuffer(void);
-    char nmeaChecksum(char *gps_buffer);
-    void nmeaTerminateAtChecksum(char *gps_buffer);
-    uint8_t nmeaProcess(cBuffer *rxBuffer);
-    void nmeaProcessGPGGA(char *packet);
-    void nmeaProcessGPRMC(char *packet);
-    void nmeaProcessGPVTG(char *packet);
-    void nmeaProcessGPGSA(char *packet);
-    void nmeaProcessGPGSV(char *packet);
-    void nmeaProcessGPZDA(char *packet);
+    void processInputStream(const QByteArray & data);
     GpsData_t GpsData;
-    cBuffer gpsRxBuffer;
-    char gpsRxData[512];
-    char NmeaPacket[NMEA_BUFFERSIZE];
     uint32_t numUpdates;
     uint32_t numErrors;
     int32_t gpsRxOverflow;
+
+private:
+    enum {
+        UpdatePosition     = 0x01,
+        UpdateSV           = 0x02,
+        UpdateDateTime     = 0x04,
+        UpdateSpeedHeading = 0x08,
+        UpdateFix          = 0x10,
+        UpdateDOP          = 0x20,
+        UpdateSatellites   = 0x40
+    };
+
+    char sentence[NMEA_BUFFERSIZE];
+    int sentenceLength; // -1 while looking for the next '$'
+    const char *fields[NMEA_MAX_FIELDS];
+    int numFields;
+    int updated;
+    QByteArray packets;
+    char fixMode;
+    int fixType;
+    // SVs used in the fix per GNSS, a multi-GNSS receiver sends one GSA each
+    QMap<int, QList<int> > usedSVs;
+    int gsaCount;
+    double epochTime;
+    bool epochTimed;
+    // Satellites in view per talker, GPS, GLONASS, ... each send their own GSV group
+    QMap<quint16, QList<GpsSatellite> > satsInView;
+    QMap<quint16, QList<GpsSatellite> > satsPending;
+
+    const char *field(int index) const;
+    void processSentence();
+    void startEpoch(const char *time);
+    void emitUpdates();
+    void nmeaProcessGPGGA();
+    void nmeaProcessGPRMC();
+    void nmeaProcessGPVTG();
+    void nmeaProcessGPGSA();
+    void nmeaProcessGPGSV();
+    void nmeaProcessGPZDA();
 };
 
 #endif // NMEAPARSER_H
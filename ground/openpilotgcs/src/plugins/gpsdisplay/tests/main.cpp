@@ -0,0 +1,202 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup GPSGadgetPlugin GPS Gadget Plugin
+ * @{
+ * @brief Replays NMEA captures through the NMEA parser and reports its throughput
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <stdio.h>
+#include "../nmeaparser.h"
+
+// Each capture is replayed until this much data went through the parser
+#define BENCH_BYTES (16 * 1024 * 1024)
+// Epochs of the multi-GNSS capture, the SVs used by GLONASS and Galileo change after GNSS_EPOCHS_A
+#define GNSS_EPOCHS   20
+#define GNSS_EPOCHS_A 10
+
+/**
+ * An NMEA sentence with its checksum
+ */
+static QByteArray nmeaSentence(const QByteArray & body)
+{
+    char checksum = 0;
+
+    for (int i = 0; i < body.size(); i++) {
+        checksum ^= body[i];
+    }
+    return QByteArray("$") + body + "*" + QByteArray::number((uchar)checksum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+/**
+ * The multi-GNSS capture sends one GNGSA per GNSS in every epoch, every
+ * epoch must give one position update and the SVs of all three GSA
+ */
+static int checkEpochs(const QByteArray & capture, int chunkSize)
+{
+    static const int svsA[] = { 2, 5, 12, 13, 15, 18, 20, 25, 29, 65, 66, 72, 74, 81, 82, 7, 11, 26, 30 };
+    static const int svsB[] = { 2, 5, 12, 13, 15, 18, 20, 25, 29, 65, 66, 74, 81, 82, 7, 11, 26, 30, 33 };
+    NMEAParser parser;
+    QSignalSpy positions(&parser, SIGNAL(position(double, double, double)));
+    QSignalSpy fixSVs(&parser, SIGNAL(fixSVs(QList<int>)));
+    int failed = 0;
+
+    for (int pos = 0; pos < capture.size(); pos += chunkSize) {
+        parser.processInputStream(capture.mid(pos, chunkSize));
+    }
+
+    // the last epoch is handed over when the next one starts
+    if (positions.count() != GNSS_EPOCHS - 1 || fixSVs.count() != GNSS_EPOCHS - 1) {
+        fprintf(stderr, "  chunk %d: %d position and %d fix SV updates for %d epochs\n",
+                chunkSize, positions.count(), fixSVs.count(), GNSS_EPOCHS);
+        failed++;
+    }
+    for (int epoch = 0; epoch < fixSVs.count(); epoch++) {
+        QList<int> expected;
+        if (epoch < GNSS_EPOCHS_A) {
+            for (unsigned int i = 0; i < sizeof(svsA) / sizeof(svsA[0]); i++) {
+                expected << svsA[i];
+            }
+        } else {
+            for (unsigned int i = 0; i < sizeof(svsB) / sizeof(svsB[0]); i++) {
+                expected << svsB[i];
+            }
+        }
+        if (fixSVs.at(epoch).at(0).value<QList<int> >() != expected) {
+            fprintf(stderr, "  chunk %d: wrong fix SVs in epoch %d\n", chunkSize, epoch);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+/**
+ * GNGSA sentences without the system ID of NMEA 4.10 are told apart by
+ * their order in the epoch
+ */
+static int checkUntaggedGsa()
+{
+    QByteArray stream;
+    NMEAParser parser;
+    QSignalSpy fixSVs(&parser, SIGNAL(fixSVs(QList<int>)));
+
+    for (int epoch = 0; epoch < 2; epoch++) {
+        QByteArray time = QByteArray("1015") + QByteArray::number(30 + epoch) + ".00";
+        stream += nmeaSentence("GNGGA," + time + ",4723.38150,N,00832.59290,E,1,12,0.71,498.3,M,47.4,M,,");
+        stream += nmeaSentence("GNGSA,A,3,02,05,12,,,,,,,,,,1.27,0.71,1.05");
+        stream += nmeaSentence("GNGSA,A,3,65,66,,,,,,,,,,,1.27,0.71,1.05");
+    }
+    stream += nmeaSentence("GNGGA,101532.00,4723.38150,N,00832.59290,E,1,12,0.71,498.3,M,47.4,M,,");
+    parser.processInputStream(stream);
+
+    QList<int> expected;
+    expected << 2 << 5 << 12 << 65 << 66;
+    if (fixSVs.count() != 2 || fixSVs.at(1).at(0).value<QList<int> >() != expected) {
+        fprintf(stderr, "untagged GNGSA: %d fix SV updates, expected the SVs of both sentences\n", fixSVs.count());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Usage: nmeaparserbench [capture.nmea ...]
+ *
+ * Checks first that the multi-GNSS capture gives one update per epoch
+ * with the SVs of all its GNGSA sentences, whatever the chunk size.
+ *
+ * Every capture is then fed to a fresh parser in chunks of the sizes a
+ * serial port typically hands over, from single bytes to a full 10Hz
+ * epoch of a multi-constellation receiver. Reports MB/s, sentences/s and
+ * how many updates reached the widgets.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QStringList captures = a.arguments().mid(1);
+
+    if (captures.isEmpty()) {
+        captures << NMEA_CORPUS << NMEA_GNSS_CORPUS;
+    }
+
+    static const int chunkSizes[] = { 1, 16, 64, 512, 4096 };
+    int failed = 0;
+
+    QFile gnss(NMEA_GNSS_CORPUS);
+    if (!gnss.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "cannot open %s\n", NMEA_GNSS_CORPUS);
+        return 1;
+    }
+    QByteArray gnssCapture = gnss.readAll();
+    for (unsigned int i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++) {
+        failed += checkEpochs(gnssCapture, chunkSizes[i]);
+    }
+    failed += checkUntaggedGsa();
+    printf("multi-GNSS epochs: %s\n", failed ? "FAILED" : "ok");
+
+    foreach(QString capture, captures) {
+        QFile file(capture);
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(capture));
+            failed++;
+            continue;
+        }
+        QByteArray corpus = file.readAll();
+        if (corpus.isEmpty()) {
+            fprintf(stderr, "%s is empty\n", qPrintable(capture));
+            failed++;
+            continue;
+        }
+        printf("%s, %d bytes\n", qPrintable(capture), corpus.size());
+
+        for (unsigned int i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++) {
+            int chunkSize = chunkSizes[i];
+            NMEAParser parser;
+            QSignalSpy positions(&parser, SIGNAL(position(double, double, double)));
+            QSignalSpy satellites(&parser, SIGNAL(satellites(QList<GpsSatellite>)));
+            qint64 bytes = 0;
+            QElapsedTimer timer;
+
+            timer.start();
+            while (bytes < BENCH_BYTES) {
+                for (int pos = 0; pos < corpus.size(); pos += chunkSize) {
+                    parser.processInputStream(QByteArray::fromRawData(corpus.constData() + pos,
+                                                                      qMin(chunkSize, corpus.size() - pos)));
+                }
+                bytes += corpus.size();
+            }
+            qint64 ns = timer.nsecsElapsed();
+
+            printf("  chunk %5d: %8.2f MB/s %10.0f sentences/s, %d position and %d satellite updates, %u bad sentences\n",
+                   chunkSize, bytes / (ns / 1e9) / (1024 * 1024), parser.numUpdates / (ns / 1e9),
+                   positions.count(), satellites.count(), parser.numErrors);
+            if (parser.numUpdates == 0) {
+                failed++;
+            }
+        }
+    }
+
+    return failed ? 1 : 0;
+}
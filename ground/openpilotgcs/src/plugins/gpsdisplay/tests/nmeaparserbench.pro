@@ -0,0 +1,18 @@
+# -------------------------------------------------
+# Replays recorded NMEA captures through the NMEA parser
+# of the GPS display gadget, checks the per epoch updates
+# of a multi-GNSS receiver and reports its throughput.
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = nmeaparserbench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += NMEA_CORPUS=\\\"$$PWD/../../../../../../flight/tests/gps/nmea_corpus.txt\\\"
+DEFINES += NMEA_GNSS_CORPUS=\\\"$$PWD/../../../../../../flight/tests/gps/nmea_gnss_corpus.txt\\\"
+SOURCES += main.cpp \
+    ../gpsparser.cpp \
+    ../nmeaparser.cpp
+HEADERS += ../gpsparser.h \
+    ../nmeaparser.h
@@ -29,6 +29,7 @@
 #include "extensionsystem/pluginmanager.h"
 #include "coreplugin/icore.h"
 #include "coreplugin/threadmanager.h"
+#include <QtEndian>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -51,6 +52,7 @@ FGSimulator::FGSimulator(const SimulatorSettings & params) :
 {
     udpCounterFGrecv  = 0;
     udpCounterGCSsend = 0;
+    badDatagrams = 0;
 }
 
 FGSimulator::~FGSimulator()
@@ -62,6 +64,7 @@ void FGSimulator::setupUdpPorts(const QString & host, int inPort, int outPort)
 {
     Q_UNUSED(outPort);
 
+    remoteHost = QHostAddress(settings.remoteAddress);
     if (inSocket->bind(QHostAddress(host), inPort)) {
         emit processOutput("Successfully bound to address " + host + " on port " + QString::number(inPort) + "\n");
     } else {
@@ -109,6 +112,7 @@ bool FGSimulator::setupProcess()
     // Setup arguments
     // Note: The input generic protocol is set to update at a much higher rate than the actual updates are sent by the GCS.
     // If this is not done then a lag will be introduced by FlightGear, likelly because the receive socket buffer builds up during startup.
+    QString protocol(settings.binaryProtocol ? "opfgprotocol-binary" : "opfgprotocol");
     QString args("--fg-root=\"" + settings.dataPath + "\" " +
                  "--timeofday=noon " +
                  "--httpd=5400 " +
@@ -117,9 +121,9 @@ bool FGSimulator::setupProcess()
                  "--altitude=3000 " +
                  "--vc=100 " +
                  "--log-level=alert " +
-                 "--generic=socket,out,20," + settings.hostAddress + "," + QString::number(settings.inPort) + ",udp,opfgprotocol");
+                 "--generic=socket,out,20," + settings.hostAddress + "," + QString::number(settings.inPort) + ",udp," + protocol);
     if (settings.manualControlEnabled) { // <--[BCH] What does this do? Why does it depend on ManualControl?
-        args.append(" --generic=socket,in,400," + settings.remoteAddress + "," + QString::number(settings.outPort) + ",udp,opfgprotocol");
+        args.append(" --generic=socket,in,400," + settings.remoteAddress + "," + QString::number(settings.outPort) + ",udp," + protocol);
     }
 
     // Start FlightGear - only if checkbox is selected in HITL options page
@@ -177,35 +181,26 @@ void FGSimulator::transmitUpdate()
         throttle = actData.Thrust;
     }
 
-    int allowableDifference = 10;
-
-    // qDebug() << "UDP sent:" << udpCounterGCSsend << " - UDP Received:" << udpCounterFGrecv;
-
-    if (udpCounterFGrecv == udpCounterGCSsend) {
-        udpCounterGCSsend = 0;
-    }
+    if (isLockStep()) {
+        // The counter tells which step the flight side acknowledged
+        sendControls(ailerons, elevator, rudder, throttle, acknowledgedStep());
+    } else {
+        int allowableDifference = 10;
 
-    if ((udpCounterGCSsend < allowableDifference) || (udpCounterFGrecv == 0)) { // FG udp queue is not delayed
-        udpCounterGCSsend++;
+        // qDebug() << "UDP sent:" << udpCounterGCSsend << " - UDP Received:" << udpCounterFGrecv;
 
-        // Send update to FlightGear
-        QString cmd;
-        cmd = QString("%1,%2,%3,%4,%5\n")
-              .arg(ailerons) // ailerons
-              .arg(elevator) // elevator
-              .arg(rudder) // rudder
-              .arg(throttle) // throttle
-              .arg(udpCounterGCSsend); // UDP packet counter delay
-
-        QByteArray data = cmd.toLatin1();
+        if (udpCounterFGrecv == udpCounterGCSsend) {
+            udpCounterGCSsend = 0;
+        }
 
-        if (outSocket->writeDatagram(data, QHostAddress(settings.remoteAddress), settings.outPort) == -1) {
-            emit processOutput("Error sending UDP packet to FG: " + outSocket->errorString() + "\n");
+        if ((udpCounterGCSsend < allowableDifference) || (udpCounterFGrecv == 0)) { // FG udp queue is not delayed
+            udpCounterGCSsend++;
+            sendControls(ailerons, elevator, rudder, throttle, udpCounterGCSsend);
+        } else {
+            // don't send new packet. Flightgear cannot process UDP fast enough.
+            // V1.9.1 reads udp packets at set frequency and will get delayed if packets are sent too fast
+            // V2.0 does not currently work with --generic-protocol
         }
-    } else {
-        // don't send new packet. Flightgear cannot process UDP fast enough.
-        // V1.9.1 reads udp packets at set frequency and will get delayed if packets are sent too fast
-        // V2.0 does not currently work with --generic-protocol
     }
 
     if (settings.manualControlEnabled) {
@@ -220,65 +215,135 @@ void FGSimulator::transmitUpdate()
 }
 
 
+void FGSimulator::sendControls(float ailerons, float elevator, float rudder, float throttle, qint32 counter)
+{
+    qint64 res;
+
+    if (settings.binaryProtocol) {
+        uchar *p = (uchar *)controlDatagram;
+        float controls[4] = { ailerons, elevator, rudder, throttle };
+        for (int i = 0; i < 4; i++) {
+            quint32 bits;
+            memcpy(&bits, &controls[i], sizeof(bits));
+            qToBigEndian<quint32>(bits, p + i * 4);
+        }
+        qToBigEndian<qint32>(counter, p + 16);
+        res = outSocket->writeDatagram(controlDatagram, FG_BINARY_CONTROL_SIZE, remoteHost, settings.outPort);
+    } else {
+        QString cmd;
+        cmd = QString("%1,%2,%3,%4,%5\n")
+              .arg(ailerons) // ailerons
+              .arg(elevator) // elevator
+              .arg(rudder) // rudder
+              .arg(throttle) // throttle
+              .arg(counter); // UDP packet counter delay
+        res = outSocket->writeDatagram(cmd.toLatin1(), remoteHost, settings.outPort);
+    }
+    if (res == -1) {
+        emit processOutput("Error sending UDP packet to FG: " + outSocket->errorString() + "\n");
+    }
+}
+
+bool FGSimulator::decodeText(const QByteArray & data, float *fields, qint32 *counter)
+{
+    QStringList values = QString(data).split(",");
+
+    if (values.size() <= FG_STATE_FLOATS) {
+        return false;
+    }
+    for (int i = 0; i < FG_STATE_FLOATS; i++) {
+        fields[i] = values[i].toFloat();
+    }
+    *counter = values[FG_STATE_FLOATS].toInt();
+    return true;
+}
+
+/**
+ * Reads the fields in place, nothing is allocated
+ */
+bool FGSimulator::decodeBinary(const QByteArray & data, float *fields, qint32 *counter)
+{
+    if (data.size() != FG_BINARY_STATE_SIZE) {
+        return false;
+    }
+
+    const uchar *p = (const uchar *)data.constData();
+    for (int i = 0; i < FG_STATE_FLOATS; i++) {
+        quint32 bits = qFromBigEndian<quint32>(p + i * 4);
+        memcpy(&fields[i], &bits, sizeof(bits));
+    }
+    *counter = qFromBigEndian<qint32>(p + FG_STATE_FLOATS * 4);
+    return true;
+}
+
 void FGSimulator::processUpdate(const QByteArray & inp)
 {
     // TODO: this does not use the FLIGHT_PARAM structure, it should!
-    // Split
-    QString data(inp);
-    QStringList fields = data.split(",");
+    float fields[FG_STATE_FLOATS];
+    qint32 counter;
+    bool valid = settings.binaryProtocol ? decodeBinary(inp, fields, &counter) : decodeText(inp, fields, &counter);
+
+    if (!valid) {
+        if (badDatagrams++ == 0) {
+            emit processOutput("Ignoring malformed datagrams from FG, check the protocol settings\n");
+        }
+        return;
+    }
+    if (isLockStep() && !beginStep(counter)) {
+        return;
+    }
+
     // Get xRate (deg/s)
-    // float xRate = fields[0].toFloat() * 180.0/M_PI;
+    // float xRate = fields[0] * 180.0/M_PI;
     // Get yRate (deg/s)
-    // float yRate = fields[1].toFloat() * 180.0/M_PI;
+    // float yRate = fields[1] * 180.0/M_PI;
     // Get zRate (deg/s)
-    // float zRate = fields[2].toFloat() * 180.0/M_PI;
+    // float zRate = fields[2] * 180.0/M_PI;
     // Get xAccel (m/s^2)
-    float xAccel    = fields[3].toFloat() * FT2M;
+    float xAccel    = fields[3] * FT2M;
     // Get yAccel (m/s^2)
-    float yAccel    = fields[4].toFloat() * FT2M;
+    float yAccel    = fields[4] * FT2M;
     // Get xAccel (m/s^2)
-    float zAccel    = fields[5].toFloat() * FT2M;
+    float zAccel    = fields[5] * FT2M;
     // Get pitch (deg)
-    float pitch     = fields[6].toFloat();
+    float pitch     = fields[6];
     // Get pitchRate (deg/s)
-    float pitchRate = fields[7].toFloat();
+    float pitchRate = fields[7];
     // Get roll (deg)
-    float roll     = fields[8].toFloat();
+    float roll     = fields[8];
     // Get rollRate (deg/s)
-    float rollRate = fields[9].toFloat();
+    float rollRate = fields[9];
     // Get yaw (deg)
-    float yaw       = fields[10].toFloat();
+    float yaw       = fields[10];
     // Get yawRate (deg/s)
-    float yawRate   = fields[11].toFloat();
+    float yawRate   = fields[11];
     // Get latitude (deg)
-    float latitude  = fields[12].toFloat();
+    float latitude  = fields[12];
     // Get longitude (deg)
-    float longitude = fields[13].toFloat();
+    float longitude = fields[13];
     // Get heading (deg)
-    // float heading      = fields[14].toFloat();
+    // float heading      = fields[14];
     // Get altitude (m)
-    float altitude_msl = fields[15].toFloat() * FT2M;
+    float altitude_msl = fields[15] * FT2M;
     // Get altitudeAGL (m)
-    float altitude_agl = fields[16].toFloat() * FT2M;
+    float altitude_agl = fields[16] * FT2M;
     // Get groundspeed (m/s)
-    float groundspeed  = fields[17].toFloat() * KT2MPS;
+    float groundspeed  = fields[17] * KT2MPS;
     // Get airspeed (m/s)
-    float airspeed     = fields[18].toFloat() * KT2MPS;
+    float airspeed     = fields[18] * KT2MPS;
     // Get temperature (degC)
-    float temperature  = fields[19].toFloat();
+    float temperature  = fields[19];
     // Get pressure (kpa)
-    float pressure     = fields[20].toFloat() * INHG2KPA;
+    float pressure     = fields[20] * INHG2KPA;
     // Get VelocityState Down (m/s)
-    float velocityStateDown  = -fields[21].toFloat() * FPS2CMPS * 1e-2f;
+    float velocityStateDown  = -fields[21] * FPS2CMPS * 1e-2f;
     // Get VelocityState East (m/s)
-    float velocityStateEast  = fields[22].toFloat() * FPS2CMPS * 1e-2f;
+    float velocityStateEast  = fields[22] * FPS2CMPS * 1e-2f;
     // Get VelocityState Down (m/s)
-    float velocityStateNorth = fields[23].toFloat() * FPS2CMPS * 1e-2f;
-
-    // Get UDP packets received by FG
-    int n = fields[24].toInt();
+    float velocityStateNorth = fields[23] * FPS2CMPS * 1e-2f;
 
-    udpCounterFGrecv = n;
+    // Get UDP packets received by FG, the step number in lock-step
+    udpCounterFGrecv = counter;
 
     ///////
     // Output formatting
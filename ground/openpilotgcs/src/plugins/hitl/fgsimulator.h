@@ -29,8 +29,15 @@
 #define FGSIMULATOR_H_H
 
 #include <QObject>
+#include <QHostAddress>
 #include "simulator.h"
 
+// Number of float fields in the state sent by FlightGear, followed by an int
+#define FG_STATE_FLOATS       24
+// Binary datagrams of opfgprotocol-binary.xml, fields in network byte order
+#define FG_BINARY_STATE_SIZE   (FG_STATE_FLOATS * 4 + 4)
+#define FG_BINARY_CONTROL_SIZE (4 * 4 + 4)
+
 class FGSimulator : public Simulator {
     Q_OBJECT
 
@@ -40,6 +47,10 @@ public:
 
     bool setupProcess();
     void setupUdpPorts(const QString & host, int inPort, int outPort);
+    bool supportsLockStep() const
+    {
+        return true;
+    }
 
 private slots:
     void transmitUpdate();
@@ -49,8 +60,14 @@ private:
 
     int udpCounterGCSsend; // keeps track of udp packets sent to FG
     int udpCounterFGrecv; // keeps track of udp packets received by FG
+    int badDatagrams;
+    QHostAddress remoteHost;
+    char controlDatagram[FG_BINARY_CONTROL_SIZE];
 
     void processUpdate(const QByteArray & data);
+    bool decodeText(const QByteArray & data, float *fields, qint32 *counter);
+    bool decodeBinary(const QByteArray & data, float *fields, qint32 *counter);
+    void sendControls(float ailerons, float elevator, float rudder, float throttle, qint32 counter);
 };
 
 class FGSimulatorCreator : public SimulatorCreator {
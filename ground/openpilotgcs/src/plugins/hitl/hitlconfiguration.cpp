@@ -37,6 +37,8 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
     settings.manualControlEnabled = true;
     settings.startSim             = false;
     settings.addNoise             = false;
+    settings.binaryProtocol       = false;
+    settings.lockStep             = false;
     settings.hostAddress          = "127.0.0.1";
     settings.remoteAddress        = "127.0.0.1";
     settings.outPort              = 0;
@@ -82,6 +84,8 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
         settings.longitude     = qSettings->value("longitude").toString();
         settings.startSim      = qSettings->value("startSim").toBool();
         settings.addNoise      = qSettings->value("noiseCheckBox").toBool();
+        settings.binaryProtocol = qSettings->value("binaryProtocol").toBool();
+        settings.lockStep      = qSettings->value("lockStep").toBool();
 
         settings.gcsReceiverEnabled   = qSettings->value("gcsReceiverEnabled").toBool();
         settings.manualControlEnabled = qSettings->value("manualControlEnabled").toBool();
@@ -138,6 +142,8 @@ void HITLConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("longitude", settings.longitude);
     qSettings->setValue("addNoise", settings.addNoise);
     qSettings->setValue("startSim", settings.startSim);
+    qSettings->setValue("binaryProtocol", settings.binaryProtocol);
+    qSettings->setValue("lockStep", settings.lockStep);
 
     qSettings->setValue("gcsReceiverEnabled", settings.gcsReceiverEnabled);
     qSettings->setValue("manualControlEnabled", settings.manualControlEnabled);
@@ -82,6 +82,8 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
 
     m_optionsPage->startSim->setChecked(config->Settings().startSim);
     m_optionsPage->noiseCheckBox->setChecked(config->Settings().addNoise);
+    m_optionsPage->binaryProtocol->setChecked(config->Settings().binaryProtocol);
+    m_optionsPage->lockStep->setChecked(config->Settings().lockStep);
 
     m_optionsPage->hostAddress->setText(config->Settings().hostAddress);
     m_optionsPage->remoteAddress->setText(config->Settings().remoteAddress);
@@ -126,6 +128,8 @@ void HITLOptionsPage::apply()
     settings.dataPath             = m_optionsPage->dataPath->path();
     settings.startSim             = m_optionsPage->startSim->isChecked();
     settings.addNoise             = m_optionsPage->noiseCheckBox->isChecked();
+    settings.binaryProtocol       = m_optionsPage->binaryProtocol->isChecked();
+    settings.lockStep             = m_optionsPage->lockStep->isChecked();
     settings.hostAddress          = m_optionsPage->hostAddress->text();
     settings.remoteAddress        = m_optionsPage->remoteAddress->text();
 
@@ -57,6 +57,10 @@ Simulator::Simulator(const SimulatorSettings & params) :
     simConnectionStatus(false),
     txTimer(NULL),
     simTimer(NULL),
+    lockStepActive(false),
+    stepReceived(0),
+    stepAcked(0),
+    stepPending(false),
     name("")
 {
     // move to thread
@@ -197,11 +201,31 @@ void Simulator::onStart()
 
     connect(inSocket, SIGNAL(readyRead()), this, SLOT(receiveUpdate()), Qt::DirectConnection);
 
-    // Setup transmit timer
+    // Lock-step needs an output the flight side acknowledges, the raw sensors
+    lockStepActive = settings.lockStep && settings.attRawEnabled && supportsLockStep();
+    if (settings.lockStep && !lockStepActive) {
+        emit processOutput("Lock-step needs a simulator that supports it and the raw attitude sensors as output, running in real time\n");
+    } else if (lockStepActive) {
+        emit processOutput("Lock-step paces the simulator only, the flight side keeps its real-time clock and runs are not reproducible\n");
+    }
+
+    // Setup transmit timer, in lock-step the acknowledgements drive the transmission
     txTimer = new QTimer();
     connect(txTimer, SIGNAL(timeout()), this, SLOT(transmitUpdate()), Qt::DirectConnection);
     txTimer->setInterval(updatePeriod);
-    txTimer->start();
+    if (lockStepActive) {
+        connect(accelState, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(onStepAcknowledged(UAVObject *, bool)));
+        // the output rates count in simulated time
+        gpsPosTime        = QTime(0, 0);
+        groundTruthTime   = QTime(0, 0);
+        gcsRcvrTime       = QTime(0, 0);
+        attRawTime        = QTime(0, 0);
+        baroAltTime       = QTime(0, 0);
+        battTime = QTime(0, 0);
+        airspeedStateTime = QTime(0, 0);
+    } else {
+        txTimer->start();
+    }
     // Setup simulator connection timer
     simTimer = new QTimer();
     connect(simTimer, SIGNAL(timeout()), this, SLOT(onSimulatorConnectionTimeout()), Qt::DirectConnection);
@@ -228,8 +252,7 @@ void Simulator::receiveUpdate()
 
     // Process data
     while (inSocket->hasPendingDatagrams()) {
-        // Receive datagram
-        QByteArray datagram;
+        // Receive datagram, the buffer only grows
         datagram.resize(inSocket->pendingDatagramSize());
         QHostAddress sender;
         quint16 senderPort;
@@ -336,8 +359,14 @@ void Simulator::setupOutputObject(UAVObject *obj, quint32 updatePeriod)
     mdata = obj->getDefaultMetadata();
 
     UAVObject::SetGcsAccess(mdata, UAVObject::ACCESS_READWRITE);
-    UAVObject::SetGcsTelemetryAcked(mdata, false);
-    UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
+    if (lockStepActive) {
+        // every step goes out, the last output of a step is acknowledged
+        UAVObject::SetGcsTelemetryAcked(mdata, obj == accelState);
+        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_ONCHANGE);
+    } else {
+        UAVObject::SetGcsTelemetryAcked(mdata, false);
+        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
+    }
     mdata.gcsTelemetryUpdatePeriod = updatePeriod;
 
     UAVObject::SetFlightAccess(mdata, UAVObject::ACCESS_READONLY);
@@ -381,6 +410,46 @@ void Simulator::telStatsUpdated(UAVObject *obj)
 }
 
 
+/**
+ * Called by the simulators in lock-step with the step number of a state
+ * received, returns false if the state is not to be processed. The
+ * simulator repeats a step it got no answer for: the acknowledgement is
+ * sent again if the step was acknowledged, the step's outputs are sent
+ * again if the flight side did not acknowledge them yet (e.g. it was not
+ * connected yet).
+ *
+ * The flight side does not step with the simulator, the outputs sent back
+ * for a step are the ones it last sent, whenever that was.
+ */
+bool Simulator::beginStep(quint32 step)
+{
+    if (step == stepAcked) {
+        transmitUpdate();
+        return false;
+    }
+    if (stepPending && step == stepReceived) {
+        accelState->updated();
+        return false;
+    }
+    stepReceived = step;
+    stepPending  = true;
+    return true;
+}
+
+void Simulator::onStepAcknowledged(UAVObject *obj, bool success)
+{
+    if (!success) {
+        // the flight side did not get the step, send it again
+        obj->updated();
+        return;
+    }
+    if (stepPending) {
+        stepPending = false;
+        stepAcked   = stepReceived;
+        transmitUpdate();
+    }
+}
+
 void Simulator::resetInitialHomePosition()
 {
     once = false;
@@ -389,7 +458,8 @@ void Simulator::resetInitialHomePosition()
 
 void Simulator::updateUAVOs(Output2Hardware out)
 {
-    QTime currentTime = QTime::currentTime();
+    // In lock-step the simulated time counts, the simulators step at the transmit rate
+    QTime currentTime = lockStepActive ? QTime(0, 0).addMSecs((stepReceived * updatePeriod) % (24 * 3600 * 1000)) : QTime::currentTime();
 
     Noise noise;
     HitlNoiseGeneration noiseSource;
@@ -752,7 +822,8 @@ void Simulator::updateUAVOs(Output2Hardware out)
     /*******************************/
     // Update raw attitude sensors
     if (settings.attRawEnabled) {
-        if (attRawTime.msecsTo(currentTime) >= settings.attRawRate) {
+        // in lock-step every step ends with the acknowledged accelerometer update
+        if (lockStepActive || attRawTime.msecsTo(currentTime) >= settings.attRawRate) {
             // Update gyroscope sensor data
             GyroState::DataFields gyroStateData;
             memset(&gyroStateData, 0, sizeof(GyroState::DataFields));
@@ -122,6 +122,8 @@ typedef struct _CONNECTION {
     int     inPort;
     bool    startSim;
     bool    addNoise;
+    bool    binaryProtocol; // fixed layout datagrams instead of text
+    bool    lockStep; // the simulator waits for the flight side after each step, pacing only
     QString latitude;
     QString longitude;
 
@@ -265,6 +267,10 @@ public:
     }
 
     virtual void stopProcess() {}
+    virtual bool supportsLockStep() const
+    {
+        return false;
+    }
     virtual void setupUdpPorts(const QString & host, int inPort, int outPort)
     {
         Q_UNUSED(host) Q_UNUSED(inPort) Q_UNUSED(outPort)
@@ -273,6 +279,15 @@ public:
     void resetInitialHomePosition();
     void updateUAVOs(Output2Hardware out);
 
+    bool isLockStep() const
+    {
+        return lockStepActive;
+    }
+    quint32 acknowledgedStep() const
+    {
+        return stepAcked;
+    }
+
     AirParameters getAirParameters();
     void setAirParameters(AirParameters airParameters);
 
@@ -297,6 +312,7 @@ private slots:
     void onAutopilotDisconnect();
     void onSimulatorConnectionTimeout();
     void telStatsUpdated(UAVObject *obj);
+    void onStepAcknowledged(UAVObject *obj, bool success);
     Q_INVOKABLE void onDeleteSimulator(void);
 
     virtual void transmitUpdate() = 0;
@@ -342,6 +358,8 @@ protected:
     FLIGHT_PARAM old;
     QMutex lock;
 
+    bool beginStep(quint32 step);
+
 private:
     bool once;
     float initN;
@@ -354,6 +372,19 @@ private:
     volatile bool simConnectionStatus;
     QTimer *txTimer;
     QTimer *simTimer;
+    QByteArray datagram; // receive buffer, reused for every datagram
+
+    // Lock-step: step n is simulated, its outputs sent to the flight side, and
+    // step n + 1 is only requested once the flight side acknowledged them.
+    // This only paces the simulator. The flight side keeps running on its own
+    // real-time clock and the acknowledgement only says telemetry got the
+    // step, so how many control loop iterations a step gets, and which
+    // outputs come back, depend on the link and the host. Runs are not
+    // reproducible.
+    bool lockStepActive;
+    quint32 stepReceived; // steps start at 1, 0 means none
+    quint32 stepAcked;
+    bool stepPending;
 
     QTime attRawTime;
     QTime gpsPosTime;
@@ -7,11 +7,13 @@ QT += svg
 include(../../openpilotgcsplugin.pri)
 include(logging_dependencies.pri)
 HEADERS += loggingplugin.h \
+    logwriter.h \
     logginggadgetwidget.h \
     logginggadget.h \
     logginggadgetfactory.h
 
 SOURCES += loggingplugin.cpp \
+    logwriter.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
     logginggadgetfactory.cpp
@@ -37,7 +37,6 @@
 #include <QFileDialog>
 #include <QList>
 #include <QErrorMessage>
-#include <QWriteLocker>
 
 #include <extensionsystem/pluginmanager.h>
 #include <QKeySequence>
@@ -73,7 +72,7 @@ QIODevice *LoggingConnection::openDevice(const QString &deviceName)
     loggingPlugin->stopLogging();
     closeDevice(deviceName);
 
-    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl)"));
+    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl *.oplz)"));
     if (!fileName.isNull()) {
         startReplay(fileName);
     }
@@ -119,19 +118,16 @@ LoggingThread::~LoggingThread()
 
 /**
  * Sets the file to use for logging and takes the parent plugin
- * to connect to stop logging signal
+ * to connect to stop logging signal. Files named *.oplz are compressed.
  * @param[in] file File name to write to
  * @param[in] parent plugin
  */
 bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
 {
-    logFile.setFileName(file);
-    logFile.open(QIODevice::WriteOnly);
-
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    if (!writer.open(file, file.endsWith(".oplz", Qt::CaseInsensitive))) {
+        return false;
+    }
 
-    uavTalk = new UAVTalk(&logFile, objManager);
     connect(parent, SIGNAL(stopLoggingSignal()), this, SLOT(stopLogging()));
 
     return true;
@@ -142,14 +138,19 @@ bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
  * timestamp as a 32 bit uint counting ms from start of
  * file writing (flight time will be embedded in stream),
  * then object packet size, then the packed UAVObject.
+ * Only the object data is copied here, the writer thread
+ * builds the packet and writes it.
  */
 void LoggingThread::objectUpdated(UAVObject *obj)
 {
-    QWriteLocker locker(&lock);
+    quint8 data[LogWriter::MAX_DATA_LENGTH];
+    int length = obj->getNumBytes();
 
-    if (!uavTalk->sendObject(obj, false, false)) {
+    if (length > LogWriter::MAX_DATA_LENGTH || !obj->pack(data)) {
         qDebug() << "Error logging " << obj->getName();
+        return;
     }
+    writer.append(obj->getObjID(), obj->getInstID(), data, length);
 };
 
 /**
@@ -194,8 +195,6 @@ void LoggingThread::run()
  */
 void LoggingThread::stopLogging()
 {
-    QWriteLocker locker(&lock);
-
     // Disconnect all objects we registered with:
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -211,7 +210,7 @@ void LoggingThread::stopLogging()
         }
     }
 
-    logFile.close();
+    writer.close();
     qDebug() << "File closed";
     quit();
 }
@@ -349,12 +348,18 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
 void LoggingPlugin::toggleLogging()
 {
     if (state == IDLE) {
+        QString compressedFilter = tr("Compressed OpenPilot Log (*.oplz)");
+        QString selectedFilter;
         QString fileName = QFileDialog::getSaveFileName(NULL, tr("Start Log"),
                                                         tr("OP-%0.opl").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
-                                                        tr("OpenPilot Log (*.opl)"));
+                                                        tr("OpenPilot Log (*.opl)") + ";;" + compressedFilter, &selectedFilter);
         if (fileName.isEmpty()) {
             return;
         }
+        // The writer compresses files named *.oplz
+        if (selectedFilter == compressedFilter && !fileName.endsWith(".oplz", Qt::CaseInsensitive)) {
+            fileName += fileName.endsWith(".opl", Qt::CaseInsensitive) ? "z" : ".oplz";
+        }
 
         startLogging(fileName);
         cmd->action()->setText(tr("Stop logging"));
@@ -34,12 +34,11 @@
 #include <extensionsystem/iplugin.h>
 #include "uavobjectmanager.h"
 #include "gcstelemetrystats.h"
-#include <uavtalk/uavtalk.h>
 #include <utils/logfile.h>
+#include "logwriter.h"
 
 #include <QThread>
 #include <QQueue>
-#include <QReadWriteLock>
 
 class LoggingPlugin;
 class LoggingGadgetFactory;
@@ -103,9 +102,7 @@ public slots:
 
 protected:
     void run();
-    QReadWriteLock lock;
-    LogFile logFile;
-    UAVTalk *uavTalk;
+    LogWriter writer;
 
 private:
     QQueue<UAVDataObject *> queue;
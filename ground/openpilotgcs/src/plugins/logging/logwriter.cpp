@@ -0,0 +1,251 @@
+/**
+ ******************************************************************************
+ * @file       logwriter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ * @brief      Writes telemetry logs from a thread of its own
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logwriter.h"
+#include <utils/crc.h>
+#include <utils/logfile.h>
+#include <QtEndian>
+#include <QDebug>
+
+// UAVTalk object packet: sync(1), type(1), size(2), object ID(4), instance ID(2), data, checksum(1)
+#define UAVTALK_SYNC_VAL      0x3C
+#define UAVTALK_TYPE_OBJ      0x20
+#define UAVTALK_HEADER_LENGTH 10
+
+// The writer looks for new records this often
+#define POLL_INTERVAL_MS      10
+
+using namespace Utils;
+
+LogWriter::LogWriter() :
+    m_head(0),
+    m_compressed(false),
+    m_writeFailed(false),
+    m_blockRecords(0),
+    m_bytesWritten(0),
+    m_recordsWritten(0)
+{}
+
+LogWriter::~LogWriter()
+{
+    close();
+}
+
+/**
+ * Opens the log file and starts the writer thread
+ */
+bool LogWriter::open(const QString & fileName, bool compressed)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Unable to open" << fileName << "for logging";
+        return false;
+    }
+
+    m_compressed     = compressed;
+    m_writeFailed    = false;
+    m_blockRecords   = 0;
+    m_bytesWritten   = 0;
+    m_recordsWritten = 0;
+    m_dropped.store(0);
+    m_stop.store(0);
+    m_block.clear();
+    m_block.reserve(BLOCK_SIZE + sizeof(quint32) + sizeof(qint64) + UAVTALK_HEADER_LENGTH + MAX_DATA_LENGTH + 1);
+    if (m_compressed) {
+        quint32 magic = LogFile::COMPRESSED_MAGIC;
+        if (!write((const char *)&magic, sizeof(magic))) {
+            m_file.close();
+            return false;
+        }
+    }
+    m_time.start();
+    start();
+    return true;
+}
+
+/**
+ * Stops the writer thread once everything queued is written, then closes the file
+ */
+void LogWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    m_stop.store(1);
+    wait();
+    m_file.close();
+    if (m_writeFailed) {
+        qDebug() << "Logging: writing the log failed, dropped" << m_dropped.load() << "updates";
+    } else if (m_dropped.load() > 0) {
+        qDebug() << "Logging: dropped" << m_dropped.load() << "updates, the disk did not keep up";
+    }
+}
+
+bool LogWriter::append(quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    if (length > MAX_DATA_LENGTH) {
+        return false;
+    }
+    if (m_queued.fetchAndAddRelaxed(1) >= MAX_QUEUED) {
+        m_queued.fetchAndAddRelaxed(-1);
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    Record *record = new Record;
+    record->timeStamp = m_time.elapsed();
+    record->objId     = objId;
+    record->instId    = instId;
+    record->length    = length;
+    memcpy(record->data, data, length);
+
+    // Push onto the list, the writer takes the whole list at once
+    Record *head;
+    do {
+        head = m_head.loadAcquire();
+        record->next = head;
+    } while (!m_head.testAndSetRelease(head, record));
+    return true;
+}
+
+void LogWriter::run()
+{
+    QElapsedTimer sinceSync;
+
+    sinceSync.start();
+    while (!m_stop.load()) {
+        drain();
+        if (m_block.size() >= BLOCK_SIZE || (sinceSync.elapsed() >= SYNC_INTERVAL_MS && !m_block.isEmpty())) {
+            writeBlock();
+            sinceSync.restart();
+        }
+        msleep(POLL_INTERVAL_MS);
+    }
+    drain();
+    writeBlock();
+}
+
+/**
+ * Frames all queued records, oldest first
+ */
+void LogWriter::drain()
+{
+    Record *list = m_head.fetchAndStoreAcquire(0);
+    Record *ordered = 0;
+
+    while (list) {
+        Record *next = list->next;
+        list->next = ordered;
+        ordered    = list;
+        list = next;
+    }
+    while (ordered) {
+        Record *next = ordered->next;
+        frame(ordered);
+        delete ordered;
+        m_queued.fetchAndAddRelaxed(-1);
+        ordered = next;
+        if (m_block.size() >= BLOCK_SIZE) {
+            writeBlock();
+        }
+    }
+}
+
+/**
+ * Appends a record the way LogFile::writeData() writes a UAVTalk packet:
+ * the timestamp, the packet size, then the packet
+ */
+void LogWriter::frame(const Record *record)
+{
+    qint64 packetSize = UAVTALK_HEADER_LENGTH + record->length + 1;
+    int offset = m_block.size();
+
+    m_block.resize(offset + sizeof(quint32) + sizeof(qint64) + packetSize);
+    quint8 *out = (quint8 *)m_block.data() + offset;
+    memcpy(out, &record->timeStamp, sizeof(quint32));
+    memcpy(out + sizeof(quint32), &packetSize, sizeof(qint64));
+
+    quint8 *packet = out + sizeof(quint32) + sizeof(qint64);
+    packet[0] = UAVTALK_SYNC_VAL;
+    packet[1] = UAVTALK_TYPE_OBJ;
+    qToLittleEndian<quint16>(UAVTALK_HEADER_LENGTH + record->length, &packet[2]);
+    qToLittleEndian<quint32>(record->objId, &packet[4]);
+    qToLittleEndian<quint16>(record->instId, &packet[8]);
+    memcpy(packet + UAVTALK_HEADER_LENGTH, record->data, record->length);
+    packet[UAVTALK_HEADER_LENGTH + record->length] = Crc::updateCRC(0, packet, UAVTALK_HEADER_LENGTH + record->length);
+    m_blockRecords++;
+}
+
+/**
+ * Writes the block, its records are dropped when the file can not take it
+ */
+void LogWriter::writeBlock()
+{
+    if (m_block.isEmpty()) {
+        return;
+    }
+    bool written;
+    if (m_writeFailed) {
+        written = false;
+    } else if (m_compressed) {
+        QByteArray compressed = qCompress(m_block);
+        quint32 size = compressed.size();
+        written = write((const char *)&size, sizeof(size)) && write(compressed.constData(), compressed.size());
+    } else {
+        written = write(m_block.constData(), m_block.size());
+    }
+    if (written) {
+        m_recordsWritten += m_blockRecords;
+    } else {
+        m_dropped.fetchAndAddRelaxed(m_blockRecords);
+    }
+    m_blockRecords = 0;
+    m_block.resize(0);
+}
+
+/**
+ * Writes and flushes, a short write or an error stops all further writes
+ */
+bool LogWriter::write(const char *data, qint64 length)
+{
+    qint64 written = m_file.write(data, length);
+
+    if (written > 0) {
+        m_bytesWritten += written;
+    }
+    if (written != length || !m_file.flush()) {
+        qDebug() << "Logging: cannot write to" << m_file.fileName() << ":" << m_file.errorString();
+        m_writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @}
+ * @}
+ */
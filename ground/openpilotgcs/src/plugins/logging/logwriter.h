@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ * @file       logwriter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ * @brief      Writes telemetry logs from a thread of its own
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QThread>
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QByteArray>
+
+/**
+ * Object updates are appended from the telemetry thread without locking or
+ * touching the file. A writer thread frames them as UAVTalk packets in the
+ * .opl record format and writes them a block at a time, at least every
+ * SYNC_INTERVAL_MS.
+ *
+ * Compressed logs hold every block qCompress()ed on its own, see LogFile.
+ * A crash loses at most the block that was not written yet.
+ *
+ * Once a block can not be written in full the file is left as it is, the
+ * records of that block and every later one are counted as dropped.
+ */
+class LogWriter : public QThread {
+    Q_OBJECT
+
+public:
+    static const int BLOCK_SIZE       = 64 * 1024;
+    static const int SYNC_INTERVAL_MS = 1000;
+    // Updates queued when the disk does not keep up are dropped beyond this
+    static const int MAX_QUEUED       = 64 * 1024;
+    // Object data of one update, as UAVTalk::MAX_PAYLOAD_LENGTH
+    static const int MAX_DATA_LENGTH  = 256;
+
+    LogWriter();
+    ~LogWriter();
+
+    bool open(const QString & fileName, bool compressed);
+    void close();
+
+    /**
+     * Queue an object update, can be called from any thread
+     */
+    bool append(quint32 objId, quint16 instId, const quint8 *data, int length);
+
+    qint64 bytesWritten() const
+    {
+        return m_bytesWritten;
+    }
+    qint64 recordsWritten() const
+    {
+        return m_recordsWritten;
+    }
+    int recordsDropped() const
+    {
+        return m_dropped.load();
+    }
+    bool writeFailed() const
+    {
+        return m_writeFailed;
+    }
+
+protected:
+    void run();
+
+private:
+    struct Record {
+        Record *next;
+        quint32 timeStamp;
+        quint32 objId;
+        quint16 instId;
+        quint16 length;
+        quint8  data[MAX_DATA_LENGTH];
+    };
+
+    QAtomicPointer<Record> m_head;
+    QAtomicInt m_queued;
+    QAtomicInt m_dropped;
+    QAtomicInt m_stop;
+    QElapsedTimer m_time;
+    QFile m_file;
+    bool m_compressed;
+    bool m_writeFailed;
+    QByteArray m_block;
+    int m_blockRecords;
+    qint64 m_bytesWritten;
+    qint64 m_recordsWritten;
+
+    void drain();
+    void frame(const Record *record);
+    void writeBlock();
+    bool write(const char *data, qint64 length);
+};
+
+#endif // LOGWRITER_H
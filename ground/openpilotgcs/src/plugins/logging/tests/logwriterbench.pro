@@ -0,0 +1,19 @@
+# -------------------------------------------------
+# Feeds a synthetic 10kHz object update stream to the
+# log writer of the logging plugin, reports the update
+# latency and the bytes written, replays the log and
+# checks that a full disk is reported.
+# -------------------------------------------------
+QT -= gui
+TARGET = logwriterbench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += QTCREATOR_UTILS_STATIC_LIB
+INCLUDEPATH += ../../../libs
+SOURCES += main.cpp \
+    ../logwriter.cpp \
+    ../../../libs/utils/logfile.cpp \
+    ../../../libs/utils/crc.cpp
+HEADERS += ../logwriter.h \
+    ../../../libs/utils/logfile.h
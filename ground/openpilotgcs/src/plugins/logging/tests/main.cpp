@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ * @brief Feeds a synthetic object update stream to the log writer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <stdio.h>
+#include <math.h>
+#include "../logwriter.h"
+#include <utils/logfile.h>
+
+// Updates per second of the synthetic stream
+#define UPDATE_RATE    10000
+// UAVTalk header and checksum around the object data
+#define PACKET_OVERHEAD 11
+
+/**
+ * Usage: logwriterbench [seconds]
+ *
+ * Appends updates of a dozen objects of different sizes at UPDATE_RATE,
+ * first to a plain then to a compressed log. Prints the append latency
+ * of every second, which must not grow while the writer works, and the
+ * bytes written per second. Each log is then replayed through LogFile
+ * and must give back every packet. On Linux a log written to /dev/full
+ * must report the failed write and count its records as dropped.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int seconds = (argc > 1) ? atoi(argv[1]) : 5;
+    QTemporaryDir dir;
+    int failed  = 0;
+
+    static const int objectSizes[] = { 4, 12, 16, 24, 36, 40, 48, 60, 84, 100, 148, 200 };
+    const int objects = sizeof(objectSizes) / sizeof(objectSizes[0]);
+
+    for (int compressed = 0; compressed < 2; compressed++) {
+        QString fileName = dir.path() + (compressed ? "/bench.oplz" : "/bench.opl");
+        LogWriter writer;
+
+        if (!writer.open(fileName, compressed)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(fileName));
+            return 1;
+        }
+        printf("%s log, %d updates/s for %ds\n", compressed ? "compressed" : "plain", UPDATE_RATE, seconds);
+
+        QElapsedTimer timer;
+        quint8 data[LogWriter::MAX_DATA_LENGTH];
+        qint64 packetBytes = 0;
+        qint64 updates     = (qint64)seconds * UPDATE_RATE;
+
+        timer.start();
+        for (int second = 0; second < seconds; second++) {
+            qint64 total = 0;
+            qint64 worst = 0;
+
+            for (int i = 0; i < UPDATE_RATE; i++) {
+                qint64 n = (qint64)second * UPDATE_RATE + i;
+
+                // Pace the stream, the appends happen at the update rate
+                while (timer.nsecsElapsed() < n * (1000000000 / UPDATE_RATE)) {}
+
+                int object = n % objects;
+                int length = objectSizes[object];
+                for (int j = 0; j + 4 <= length; j += 4) {
+                    float value = sinf(n * 1e-4f + j) * 100.0f;
+                    memcpy(data + j, &value, 4);
+                }
+
+                qint64 start = timer.nsecsElapsed();
+                writer.append(0x1000 + object * 0x10, 0, data, length);
+                qint64 latency = timer.nsecsElapsed() - start;
+
+                total += latency;
+                worst  = qMax(worst, latency);
+                packetBytes += length + PACKET_OVERHEAD;
+            }
+            printf("  second %2d: append mean %6.0f ns, max %8lld ns\n", second + 1, (double)total / UPDATE_RATE, worst);
+        }
+        writer.close();
+
+        qint64 size = QFileInfo(fileName).size();
+        printf("  %lld records, %d dropped, %lld bytes written, %.0f bytes/s, %.1f%% of the packets\n",
+               writer.recordsWritten(), writer.recordsDropped(), writer.bytesWritten(),
+               (double)writer.bytesWritten() / seconds, 100.0 * size / packetBytes);
+        if (writer.recordsWritten() != updates || writer.recordsDropped() != 0 || size != writer.bytesWritten()) {
+            failed++;
+        }
+
+        // Everything must come back out of the replay, ten seconds of log per replay tick
+        LogFile log;
+        QEventLoop loop;
+        qint64 replayed = 0;
+        log.setFileName(fileName);
+        if (!log.open(QIODevice::ReadOnly)) {
+            failed++;
+            continue;
+        }
+        log.setReplaySpeed(1000);
+        log.startReplay();
+        for (bool open = true; open;) {
+            char buf[4096];
+            qint64 read;
+            loop.processEvents(QEventLoop::WaitForMoreEvents);
+            open = log.isOpen();
+            // readData() still hands out what was replayed before the log closed
+            while ((read = log.readData(buf, sizeof(buf))) > 0) {
+                replayed += read;
+            }
+        }
+        printf("  replayed %lld of %lld packet bytes\n", replayed, packetBytes);
+        if (replayed != packetBytes) {
+            failed++;
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    // A disk that is full, the writer reports it and drops the records
+    {
+        LogWriter writer;
+        quint8 data[LogWriter::MAX_DATA_LENGTH] = { 0 };
+
+        if (!writer.open("/dev/full", false)) {
+            failed++;
+        } else {
+            writer.append(0x1000, 0, data, LogWriter::MAX_DATA_LENGTH);
+            writer.close();
+            printf("full disk: write %s, %lld records, %d dropped\n", writer.writeFailed() ? "failed" : "succeeded",
+                   writer.recordsWritten(), writer.recordsDropped());
+            if (!writer.writeFailed() || writer.recordsWritten() != 0 || writer.recordsDropped() != 1) {
+                failed++;
+            }
+        }
+    }
+#endif
+
+    return failed ? 1 : 0;
+}
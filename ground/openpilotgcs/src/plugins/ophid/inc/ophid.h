@@ -33,9 +33,7 @@
 #include <QThread>
 #include <QIODevice>
 #include <QMutex>
-#include <QByteArray>
-#include "ophid_hidapi.h"
-#include "ophid_usbmon.h"
+#include "ophid_backend.h"
 
 class RawHIDReadThread;
 class RawHIDWriteThread;
@@ -52,7 +50,8 @@ class OPHID_EXPORT RawHID : public QIODevice {
 
 public:
     RawHID();
-    RawHID(const QString &deviceName);
+    /** Opens the device with that serial number, takes ownership of the backend */
+    RawHID(const QString &deviceName, opHID_backend *backend);
     virtual ~RawHID();
 
     virtual bool open(OpenMode mode);
@@ -80,7 +79,7 @@ protected:
     QString serialNumber;
 
     int m_deviceNo;
-    opHID_hidapi dev;
+    opHID_backend *dev;
     bool device_open;
 
     RawHIDReadThread *m_readThread;
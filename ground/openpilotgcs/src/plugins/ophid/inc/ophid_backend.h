@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ophid_backend.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup opHIDPlugin Raw HID Plugin
+ * @{
+ * @brief Interface of the HID report transport RawHID runs on
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OPHID_BACKEND_H
+#define OPHID_BACKEND_H
+
+#include <QObject>
+#include <QString>
+#include "ophid_global.h"
+
+/**
+ *   Moves whole HID reports to and from the devices. opHID_hidapi talks to
+ *   the USB hardware, tests can run RawHID on a backend of their own.
+ */
+class OPHID_EXPORT opHID_backend : public QObject {
+    Q_OBJECT
+
+public:
+    virtual ~opHID_backend() {}
+
+    /** Opens up to max matching devices, returns how many were opened */
+    virtual int open(int max, int vid, int pid, int usage_page, int usage) = 0;
+
+    /** Waits up to timeout ms for a report, returns its length, 0 on timeout, < 0 on error */
+    virtual int receive(int num, void *buf, int len, int timeout) = 0;
+
+    /** Sends a report, returns the bytes sent, < 0 on error */
+    virtual int send(int num, void *buf, int len, int timeout) = 0;
+
+    virtual void close(int num) = 0;
+
+    virtual QString getserial(int num) = 0;
+
+signals:
+    void deviceUnplugged(int);
+};
+
+#endif // OPHID_BACKEND_H
@@ -39,9 +39,10 @@
 #include "../hidapi/hidapi.h"
 #include "ophid_const.h"
 #include "ophid_global.h"
+#include "ophid_backend.h"
 
 
-class OPHID_EXPORT opHID_hidapi : public QObject {
+class OPHID_EXPORT opHID_hidapi : public opHID_backend {
     Q_OBJECT
 
 public:
@@ -71,9 +72,6 @@ private:
 
     /** A mutex to protect hid read */
     QMutex hid_read_Mtx;
-
-signals:
-    void deviceUnplugged(int);
 };
 
 #endif // ifndef OPHID_HIDAPI_H
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ophid_ringbuffer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup opHIDPlugin Raw HID Plugin
+ * @{
+ * @brief Lock-free byte ring between the RawHID threads and its users
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OPHID_RINGBUFFER_H
+#define OPHID_RINGBUFFER_H
+
+#include <QAtomicInt>
+#include "ophid_global.h"
+
+/**
+ *   Fixed capacity byte ring for one producer and one consumer thread.
+ *   Neither side locks, each only moves its own index. The capacity is
+ *   rounded up to a power of two.
+ */
+class OPHID_EXPORT RawHIDRingBuffer {
+public:
+    explicit RawHIDRingBuffer(int capacity);
+    ~RawHIDRingBuffer();
+
+    int capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /** Bytes queued, can be called from either side */
+    int used() const
+    {
+        return (quint32)m_head.loadAcquire() - (quint32)m_tail.loadAcquire();
+    }
+
+    int available() const
+    {
+        return capacity() - used();
+    }
+
+    /** Producer: queues as much of data as fits, returns the bytes queued */
+    int write(const char *data, int size);
+
+    /** Consumer: copies up to size bytes out without dequeuing them */
+    int peek(char *data, int size) const;
+
+    /** Consumer: dequeues size bytes, at most used() */
+    void skip(int size);
+
+    /** Consumer: peek() and skip() */
+    int read(char *data, int size);
+
+private:
+    Q_DISABLE_COPY(RawHIDRingBuffer)
+
+    char *m_buffer;
+    int m_mask;
+    // Running byte counts, the head is only written by the producer, the tail by the consumer
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+};
+
+#endif // OPHID_RINGBUFFER_H
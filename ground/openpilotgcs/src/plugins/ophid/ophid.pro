@@ -8,12 +8,15 @@ HEADERS += inc/ophid_global.h \
            inc/ophid_plugin.h \
            inc/ophid.h \
            inc/ophid_hidapi.h \
+           inc/ophid_backend.h \
+           inc/ophid_ringbuffer.h \
            inc/ophid_const.h \
            inc/ophid_usbmon.h \
            inc/ophid_usbsignal.h \
            hidapi/hidapi.h
 SOURCES += src/ophid_plugin.cpp \
            src/ophid.cpp \
+           src/ophid_ringbuffer.cpp \
            src/ophid_usbsignal.cpp \
            src/ophid_hidapi.cpp
 FORMS += 
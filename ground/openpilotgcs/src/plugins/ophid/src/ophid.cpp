@@ -27,15 +27,11 @@
 
 #include "ophid.h"
 #include "ophid_const.h"
-#include "coreplugin/connectionmanager.h"
-#include <extensionsystem/pluginmanager.h>
+#include "ophid_ringbuffer.h"
 #include <QtGlobal>
-#include <QList>
 #include <QMutexLocker>
 #include <QWaitCondition>
 
-class IConnection;
-
 // timeout value used when we want to return directly without waiting
 static const int READ_TIMEOUT  = 200;
 static const int READ_SIZE     = 64;
@@ -43,6 +39,9 @@ static const int READ_SIZE     = 64;
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// Bytes buffered each way, a couple of seconds of full speed USB telemetry
+static const int BUFFER_SIZE   = 64 * 1024;
+
 
 // *********************************************************************************
 
@@ -64,24 +63,28 @@ public slots:
     void terminate()
     {
         m_running = false;
+        QMutexLocker lock(&m_wakeMtx);
+        m_spaceToRead.wakeAll();
     }
 
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** The reports' payload, filled by this thread and emptied by the reader */
+    RawHIDRingBuffer m_readBuffer;
+
+    /** Only protects the wait below, never the data */
+    QMutex m_wakeMtx;
 
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    /** Wakes up this thread waiting on a full buffer */
+    QWaitCondition m_spaceToRead;
 
     RawHID *m_hid;
 
-    opHID_hidapi *hiddev;
+    opHID_backend *hiddev;
     int hidno;
 
-    bool m_running;
+    volatile bool m_running;
 };
 
 
@@ -95,7 +98,7 @@ public:
     RawHIDWriteThread(RawHID *hid);
     virtual ~RawHIDWriteThread();
 
-    /** Add some data to be written without waiting */
+    /** Add some data to be written, waits only while the buffer is full */
     int pushDataToWrite(const char *data, int size);
 
     /** Return the number of bytes buffered */
@@ -105,34 +108,40 @@ public slots:
     void terminate()
     {
         m_running = false;
+        QMutexLocker lock(&m_wakeMtx);
+        m_newDataToWrite.wakeAll();
+        m_spaceToWrite.wakeAll();
     }
 
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Filled by the writer, emptied a report at a time by this thread */
+    RawHIDRingBuffer m_writeBuffer;
 
-    /** A mutex to protect read buffer */
-    QMutex m_writeBufMtx;
+    /** Only protects the waits below, never the data */
+    QMutex m_wakeMtx;
 
     /** Synchronize task with data arival */
     QWaitCondition m_newDataToWrite;
 
+    /** Wakes up a writer waiting on a full buffer */
+    QWaitCondition m_spaceToWrite;
+
     RawHID *m_hid;
 
-    opHID_hidapi *hiddev;
+    opHID_backend *hiddev;
     int hidno;
 
-    bool m_running;
+    volatile bool m_running;
 };
 
 // *********************************************************************************
 
 RawHIDReadThread::RawHIDReadThread(RawHID *hid)
-    : m_hid(hid),
-    hiddev(&hid->dev),
+    : m_readBuffer(BUFFER_SIZE),
+    m_hid(hid),
+    hiddev(hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
 {
@@ -143,7 +152,7 @@ RawHIDReadThread::RawHIDReadThread(RawHID *hid)
 
 RawHIDReadThread::~RawHIDReadThread()
 {
-    m_running = false;
+    terminate();
     // wait for the thread to terminate
     if (wait(10000) == false) {
         qDebug() << "Cannot terminate RawHIDReadThread";
@@ -155,11 +164,9 @@ void RawHIDReadThread::run()
     OPHID_TRACE("IN");
 
     m_running = m_hid->openDevice();
+    hidno     = m_hid->m_deviceNo;
 
     while (m_running) {
-        // here we use a temporary buffer so we don't need to lock
-        // the mutex while we are reading from the device
-
         // Want to read in regular chunks that match the packet size the device
         // is using.  In this case it is 64 bytes (the interrupt packet limit)
         // although it would be nice if the device had a different report to
@@ -169,10 +176,18 @@ void RawHIDReadThread::run()
         int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
 
         if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
             // Note: Preprocess the USB packets in this OS independent code
             // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
+            int size = qMin((int)(quint8)buffer[1], READ_SIZE - 2);
+
+            // Nothing is dropped, the device buffers while the reader catches up
+            if (m_readBuffer.available() < size) {
+                QMutexLocker lock(&m_wakeMtx);
+                while (m_readBuffer.available() < size && m_running) {
+                    m_spaceToRead.wait(&m_wakeMtx);
+                }
+            }
+            m_readBuffer.write(&buffer[2], size);
 
             emit m_hid->readyRead();
         } else if (ret == 0) { // nothing read
@@ -188,35 +203,34 @@ void RawHIDReadThread::run()
 
 int RawHIDReadThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
+    int read = m_readBuffer.read(data, size);
 
-    return size;
+    if (read > 0) {
+        // signal that there is room again
+        QMutexLocker lock(&m_wakeMtx);
+        m_spaceToRead.wakeOne();
+    }
+    return read;
 }
 
 qint64 RawHIDReadThread::getBytesAvailable()
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    return m_readBuffer.size();
+    return m_readBuffer.used();
 }
 
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
-    hiddev(&hid->dev),
+    : m_writeBuffer(BUFFER_SIZE),
+    m_hid(hid),
+    hiddev(hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
 {}
 
 RawHIDWriteThread::~RawHIDWriteThread()
 {
-    m_running = false;
+    terminate();
     // wait for the thread to terminate
     if (wait(10000) == false) {
         qDebug() << "Cannot terminate RawHIDReadThread";
@@ -225,42 +239,41 @@ RawHIDWriteThread::~RawHIDWriteThread()
 
 void RawHIDWriteThread::run()
 {
+    // The device is opened by now
+    hidno = m_hid->m_deviceNo;
+
     while (m_running) {
         char buffer[WRITE_SIZE] = { 0 };
-        int size;
-
-        {
-            QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
-                // wait on new data to write condition, the timeout
-                // enable the thread to shutdown properly
-                m_newDataToWrite.wait(&m_writeBufMtx, 200);
-                if (!m_running) {
-                    return;
-                }
 
-                size = m_writeBuffer.size();
+        // NOTE: data size is limited to 2 bytes less than the
+        // usb packet size (64 bytes for interrupt) to make room
+        // for the reportID and valid data length. Whatever is queued
+        // goes into the report, small writes share one.
+        int size = m_writeBuffer.peek(&buffer[2], WRITE_SIZE - 2);
+
+        if (size == 0) {
+            QMutexLocker lock(&m_wakeMtx);
+            // wait on new data to write condition, the timeout
+            // enable the thread to shutdown properly
+            if (m_running && m_writeBuffer.used() == 0) {
+                m_newDataToWrite.wait(&m_wakeMtx, 200);
             }
-
-            // NOTE: data size is limited to 2 bytes less than the
-            // usb packet size (64 bytes for interrupt) to make room
-            // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
-            buffer[1] = size; // valid data length
-            buffer[0] = 2; // reportID
+            continue;
         }
+        buffer[1] = size; // valid data length
+        buffer[0] = 2; // reportID
 
-        // must hold lock through the send to know how much was sent
         int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
 
         if (ret > 0) {
             // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
+            m_writeBuffer.skip(size);
+            {
+                QMutexLocker lock(&m_wakeMtx);
+                m_spaceToWrite.wakeAll();
+            }
 
-            emit m_hid->bytesWritten(ret - 2);
+            emit m_hid->bytesWritten(size);
         } else if (ret < 0) { // < 0 => error
             // TODO! make proper error handling, this only quick hack for unplug freeze
             m_running = false;
@@ -273,26 +286,35 @@ void RawHIDWriteThread::run()
 
 int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
+    QMutexLocker lock(&m_wakeMtx);
+    int written = m_writeBuffer.write(data, size);
 
-    m_writeBuffer.append(data, size);
     m_newDataToWrite.wakeOne(); // signal that new data arrived
 
-    return size;
+    // A full buffer gets WRITE_TIMEOUT to make room before the write comes up short
+    while (written < size && m_running) {
+        if (!m_spaceToWrite.wait(&m_wakeMtx, WRITE_TIMEOUT)) {
+            break;
+        }
+        written += m_writeBuffer.write(data + written, size - written);
+        m_newDataToWrite.wakeOne();
+    }
+
+    return written;
 }
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
-    return m_writeBuffer.size();
+    return m_writeBuffer.used();
 }
 
 // *********************************************************************************
 
-RawHID::RawHID(const QString &deviceName)
+RawHID::RawHID(const QString &deviceName, opHID_backend *backend)
     : QIODevice(),
     serialNumber(deviceName),
     m_deviceNo(-1),
+    dev(backend),
     m_readThread(NULL),
     m_writeThread(NULL),
     m_mutex(NULL)
@@ -304,7 +326,7 @@ RawHID::RawHID(const QString &deviceName)
     m_startedMutex = new QMutex();
 
     // detect if the USB device is unplugged
-    QObject::connect(&dev, SIGNAL(deviceUnplugged(int)), this, SLOT(onDeviceUnplugged(int)));
+    QObject::connect(dev, SIGNAL(deviceUnplugged(int)), this, SLOT(onDeviceUnplugged(int)));
 
     m_writeThread = new RawHIDWriteThread(this);
 
@@ -329,14 +351,14 @@ bool RawHID::openDevice()
 {
     OPHID_TRACE("IN");
 
-    uint32_t opened = dev.open(USB_MAX_DEVICES, USB_VID, USB_PID_ANY, USB_USAGE_PAGE, USB_USAGE);
+    uint32_t opened = dev->open(USB_MAX_DEVICES, USB_VID, USB_PID_ANY, USB_USAGE_PAGE, USB_USAGE);
 
     OPHID_DEBUG("opened %d devices", opened);
     for (uint32_t i = 0; i < opened; i++) {
-        if (serialNumber == dev.getserial(i)) {
+        if (serialNumber == dev->getserial(i)) {
             m_deviceNo = i;
         } else {
-            dev.close(i);
+            dev->close(i);
         }
     }
 
@@ -365,7 +387,7 @@ bool RawHID::closeDevice()
 {
     OPHID_TRACE("IN");
 
-    dev.close(m_deviceNo);
+    dev->close(m_deviceNo);
 
     OPHID_TRACE("OUT");
 
@@ -380,6 +402,7 @@ RawHID::~RawHID()
     if (m_readThread) {
         close();
     }
+    delete dev;
 
     // OPHID_TRACE("OUT");
 }
@@ -138,7 +138,7 @@ QIODevice *RawHIDConnection::openDevice(const QString &deviceName)
         closeDevice(deviceName);
     }
 
-    RawHidHandle = new RawHID(deviceName);
+    RawHidHandle = new RawHID(deviceName, new opHID_hidapi());
 
     if (!RawHidHandle) {
         OPHID_ERROR("Could not instentiate HID device");
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ophid_ringbuffer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup opHIDPlugin Raw HID Plugin
+ * @{
+ * @brief Lock-free byte ring between the RawHID threads and its users
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ophid_ringbuffer.h"
+#include <string.h>
+
+RawHIDRingBuffer::RawHIDRingBuffer(int capacity)
+    : m_head(0),
+    m_tail(0)
+{
+    int size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_buffer = new char[size];
+    m_mask   = size - 1;
+}
+
+RawHIDRingBuffer::~RawHIDRingBuffer()
+{
+    delete[] m_buffer;
+}
+
+int RawHIDRingBuffer::write(const char *data, int size)
+{
+    quint32 head = m_head.loadAcquire();
+
+    size = qMin(size, available());
+    if (size <= 0) {
+        return 0;
+    }
+
+    // Up to the end of the buffer, then the rest from its start
+    int offset = head & m_mask;
+    int first  = qMin(size, capacity() - offset);
+    memcpy(m_buffer + offset, data, first);
+    memcpy(m_buffer, data + first, size - first);
+
+    // Publish the bytes only once they are in place
+    m_head.storeRelease(head + size);
+    return size;
+}
+
+int RawHIDRingBuffer::peek(char *data, int size) const
+{
+    quint32 tail = m_tail.loadAcquire();
+
+    size = qMin(size, used());
+    if (size <= 0) {
+        return 0;
+    }
+
+    int offset = tail & m_mask;
+    int first  = qMin(size, capacity() - offset);
+    memcpy(data, m_buffer + offset, first);
+    memcpy(data + first, m_buffer, size - first);
+    return size;
+}
+
+void RawHIDRingBuffer::skip(int size)
+{
+    size = qMin(size, used());
+    if (size > 0) {
+        m_tail.storeRelease((quint32)m_tail.loadAcquire() + size);
+    }
+}
+
+int RawHIDRingBuffer::read(char *data, int size)
+{
+    size = peek(data, size);
+    skip(size);
+    return size;
+}
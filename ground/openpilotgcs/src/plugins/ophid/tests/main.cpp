@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup opHIDPlugin Raw HID Plugin
+ * @{
+ * @brief Drives RawHID over a loopback backend
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QThread>
+#include <stdio.h>
+#include "ophid.h"
+
+// Bytes per write in the throughput run, odd so that writes share reports
+#define WRITE_CHUNK     37
+// Bytes per round trip in the latency run, a small UAVTalk object
+#define LATENCY_PACKET  20
+#define LATENCY_ROUNDS  1000
+// Bytes written while nothing is read, more than RawHID buffers, and how long
+#define HOLD_BYTES      (256 * 1024)
+#define HOLD_TIME       200
+// The run fails when nothing arrives for this long
+#define STALL_TIMEOUT   5000
+
+/**
+ * Every report sent comes back as received, as if the board echoed it.
+ * The reports are counted to show how full RawHID packs them.
+ */
+class LoopbackBackend : public opHID_backend {
+public:
+    LoopbackBackend() : m_sent(0) {}
+
+    int open(int max, int vid, int pid, int usage_page, int usage)
+    {
+        Q_UNUSED(max)
+        Q_UNUSED(vid)
+        Q_UNUSED(pid)
+        Q_UNUSED(usage_page)
+        Q_UNUSED(usage)
+        return 1;
+    }
+
+    int receive(int num, void *buf, int len, int timeout)
+    {
+        Q_UNUSED(num)
+        QMutexLocker lock(&m_mutex);
+        if (m_reports.isEmpty()) {
+            m_reportReady.wait(&m_mutex, timeout);
+        }
+        if (m_reports.isEmpty()) {
+            return 0;
+        }
+        QByteArray report = m_reports.dequeue();
+        len = qMin(len, report.size());
+        memcpy(buf, report.constData(), len);
+        return len;
+    }
+
+    int send(int num, void *buf, int len, int timeout)
+    {
+        Q_UNUSED(num)
+        Q_UNUSED(timeout)
+        QMutexLocker lock(&m_mutex);
+        m_reports.enqueue(QByteArray((const char *)buf, len));
+        m_sent++;
+        m_reportReady.wakeOne();
+        return len;
+    }
+
+    void close(int num)
+    {
+        Q_UNUSED(num)
+    }
+
+    QString getserial(int num)
+    {
+        Q_UNUSED(num)
+        return QString("loopback");
+    }
+
+    qint64 reportsSent()
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_sent;
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_reportReady;
+    QQueue<QByteArray> m_reports;
+    qint64 m_sent;
+};
+
+/**
+ * Usage: rawhidbench [megabytes]
+ *
+ * Streams the given amount through RawHID and the loopback in small
+ * writes, checks that every byte comes back in order and prints the
+ * throughput and how full the reports were. Then leaves HOLD_BYTES unread
+ * for HOLD_TIME and checks they all come back in order once read, and
+ * times LATENCY_ROUNDS round trips of a single small packet.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int megabytes = (argc > 1) ? atoi(argv[1]) : 16;
+    int failed    = 0;
+
+    LoopbackBackend *backend = new LoopbackBackend;
+    RawHID hid("loopback", backend);
+
+    if (!hid.open(QIODevice::ReadWrite)) {
+        fprintf(stderr, "cannot open the loopback device\n");
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    QElapsedTimer sinceProgress;
+    qint64 total      = (qint64)megabytes * 1024 * 1024;
+    qint64 sent       = 0;
+    qint64 received   = 0;
+    qint64 mismatched = 0;
+    quint8 nextOut    = 0;
+    quint8 nextIn     = 0;
+    char out[WRITE_CHUNK];
+    char in[4096];
+
+    timer.start();
+    sinceProgress.start();
+    while (received < total) {
+        if (sent < total) {
+            int size = qMin<qint64>(WRITE_CHUNK, total - sent);
+            for (int i = 0; i < size; i++) {
+                out[i] = nextOut++;
+            }
+            if (hid.write(out, size) != size) {
+                fprintf(stderr, "short write after %lld bytes\n", sent);
+                failed++;
+                break;
+            }
+            sent += size;
+        }
+
+        qint64 read = hid.read(in, sizeof(in));
+        for (qint64 i = 0; i < read; i++) {
+            mismatched += ((quint8)in[i] != nextIn++);
+        }
+        if (read > 0) {
+            received += read;
+            sinceProgress.restart();
+        } else if (sinceProgress.elapsed() > STALL_TIMEOUT) {
+            fprintf(stderr, "stalled after %lld bytes\n", received);
+            failed++;
+            break;
+        } else if (sent >= total) {
+            QThread::yieldCurrentThread();
+        }
+    }
+    double seconds = timer.nsecsElapsed() * 1e-9;
+    qint64 reports = backend->reportsSent();
+    printf("%lld bytes in %.2fs, %.1f MB/s, %lld reports, %.1f%% full, %lld bytes out of order\n",
+           received, seconds, received / seconds / (1024 * 1024), reports,
+           reports ? 100.0 * received / (reports * 62.0) : 0.0, mismatched);
+    if (mismatched) {
+        failed++;
+    }
+
+    // The read thread waits for room while nothing is read, it must not
+    // drop or reorder what it holds
+    qint64 held = 0;
+    while (held < HOLD_BYTES && !failed) {
+        int size = qMin<qint64>(WRITE_CHUNK, HOLD_BYTES - held);
+        for (int i = 0; i < size; i++) {
+            out[i] = nextOut++;
+        }
+        if (hid.write(out, size) != size) {
+            fprintf(stderr, "short write after %lld bytes held\n", held);
+            failed++;
+        }
+        held += size;
+    }
+    QThread::msleep(HOLD_TIME);
+    qint64 released = 0;
+    qint64 start    = timer.nsecsElapsed();
+    sinceProgress.restart();
+    while (released < held && !failed) {
+        qint64 read = hid.read(in, sizeof(in));
+        for (qint64 i = 0; i < read; i++) {
+            mismatched += ((quint8)in[i] != nextIn++);
+        }
+        if (read > 0) {
+            released += read;
+            sinceProgress.restart();
+        } else if (sinceProgress.elapsed() > STALL_TIMEOUT) {
+            fprintf(stderr, "stalled after %lld of %lld bytes held\n", released, held);
+            failed++;
+        }
+    }
+    if (!failed) {
+        printf("%lld bytes held for %d ms, read back in %.1f ms, %lld bytes out of order\n",
+               released, HOLD_TIME, (timer.nsecsElapsed() - start) * 1e-6, mismatched);
+    }
+    if (mismatched) {
+        failed++;
+    }
+
+    qint64 totalNs = 0;
+    qint64 worstNs = 0;
+    for (int round = 0; round < LATENCY_ROUNDS && !failed; round++) {
+        char packet[LATENCY_PACKET];
+        memset(packet, round, sizeof(packet));
+
+        qint64 start = timer.nsecsElapsed();
+        hid.write(packet, sizeof(packet));
+        int got = 0;
+        while (got < LATENCY_PACKET) {
+            got += hid.read(in + got, LATENCY_PACKET - got);
+            if (timer.nsecsElapsed() - start > (qint64)STALL_TIMEOUT * 1000000) {
+                fprintf(stderr, "round trip %d never completed\n", round);
+                failed++;
+                break;
+            }
+        }
+        qint64 latency = timer.nsecsElapsed() - start;
+        totalNs += latency;
+        worstNs  = qMax(worstNs, latency);
+    }
+    if (!failed) {
+        printf("%d round trips of %d bytes: mean %.1f us, max %.1f us\n", LATENCY_ROUNDS, LATENCY_PACKET,
+               totalNs * 1e-3 / LATENCY_ROUNDS, worstNs * 1e-3);
+    }
+
+    hid.close();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+# -------------------------------------------------
+# Runs RawHID over a loopback HID backend, without
+# USB hardware, and reports the throughput and the
+# write to read latency of the transport.
+# -------------------------------------------------
+QT -= gui
+TARGET = rawhidbench
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += OPHID_LIBRARY
+INCLUDEPATH += ../inc
+SOURCES += main.cpp \
+    ../src/ophid.cpp \
+    ../src/ophid_ringbuffer.cpp
+HEADERS += ../inc/ophid.h \
+    ../inc/ophid_backend.h \
+    ../inc/ophid_ringbuffer.h
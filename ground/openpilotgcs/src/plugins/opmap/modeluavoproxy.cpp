@@ -38,89 +38,170 @@ ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObjec
     objMngr = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objMngr != NULL);
 
-    completionCountdown = 0;
-    successCountdown    = 0;
+    transferState = TRANSFER_IDLE;
+    transferRound = 0;
 }
 
+// The waypoints and path actions are transferred instance by instance, with
+// up to TRANSFER_WINDOW transactions in flight. Instances that failed are
+// retransmitted alone, up to TRANSFER_ROUNDS times. The path plan, with the
+// counts and the CRC, is sent after all its elements made it.
 void ModelUavoProxy::sendPathPlan()
 {
-    modelToObjects();
-
-    PathPlan *pathPlan = PathPlan::GetInstance(objMngr, 0);
-    connect(pathPlan, SIGNAL(transactionCompleted(UAVObject *, bool)),
-            this, SLOT(pathPlanElementSent(UAVObject *, bool)), Qt::UniqueConnection);
+    if (transferState != TRANSFER_IDLE) {
+        qDebug() << "ModelUavoProxy::sendPathPlan - transfer in progress";
+        return;
+    }
 
-    Waypoint *waypoint = Waypoint::GetInstance(objMngr, 0);
-    connect(waypoint, SIGNAL(transactionCompleted(UAVObject *, bool)),
-            this, SLOT(pathPlanElementSent(UAVObject *, bool)), Qt::UniqueConnection);
+    modelToObjects();
 
-    PathAction *action = PathAction::GetInstance(objMngr, 0);
-    connect(action, SIGNAL(transactionCompleted(UAVObject *, bool)),
-            this, SLOT(pathPlanElementSent(UAVObject *, bool)), Qt::UniqueConnection);
+    PathPlan::DataFields pathPlanData = PathPlan::GetInstance(objMngr)->getData();
+    startTransfer(SENDING_ELEMENTS, pathPlanElements(pathPlanData.WaypointCount, pathPlanData.PathActionCount));
+}
 
-    // we will start 3 update all
-    completionCountdown = 3;
-    successCountdown    = completionCountdown;
+void ModelUavoProxy::receivePathPlan()
+{
+    if (transferState != TRANSFER_IDLE) {
+        qDebug() << "ModelUavoProxy::receivePathPlan - transfer in progress";
+        return;
+    }
 
-    pathPlan->updated();
-    waypoint->updatedAll();
-    action->updatedAll();
+    // the path plan tells how many elements to fetch
+    startTransfer(RECEIVING_PLAN, QList<UAVObject *>() << PathPlan::GetInstance(objMngr));
 }
 
-void ModelUavoProxy::pathPlanElementSent(UAVObject *obj, bool success)
+QList<UAVObject *> ModelUavoProxy::pathPlanElements(int waypointCount, int actionCount)
 {
-    obj->disconnect(this);
+    QList<UAVObject *> elements;
 
-    completionCountdown--;
-    successCountdown -= success ? 1 : 0;
-
-    if (completionCountdown == 0) {
-        qDebug() << "ModelUavoProxy::pathPlanSent - completed" << (successCountdown == 0);
-        if (successCountdown == 0) {
-            QMessageBox::information(NULL, tr("Path Plan Upload Successful"), tr("Path plan upload was successful."));
-        } else {
-            QMessageBox::critical(NULL, tr("Path Plan Upload Failed"), tr("Failed to upload the path plan !"));
-        }
+    for (int i = 0; i < waypointCount; ++i) {
+        elements.append(createWaypoint(i, NULL));
+    }
+    for (int i = 0; i < actionCount; ++i) {
+        elements.append(createPathAction(i, NULL));
     }
+    return elements;
 }
 
-void ModelUavoProxy::receivePathPlan()
+void ModelUavoProxy::startTransfer(TransferState state, const QList<UAVObject *> & objects)
 {
-    PathPlan *pathPlan = PathPlan::GetInstance(objMngr, 0);
+    transferState = state;
+    transferQueue = objects;
+    transferFailed.clear();
+    transferPending.clear();
+    transferRound = 0;
+    transferNext();
+}
 
-    connect(pathPlan, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(pathPlanElementReceived(UAVObject *, bool)));
+void ModelUavoProxy::transferNext()
+{
+    bool sending = (transferState == SENDING_ELEMENTS || transferState == SENDING_PLAN);
 
-    Waypoint *waypoint = Waypoint::GetInstance(objMngr, 0);
-    connect(waypoint, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(pathPlanElementReceived(UAVObject *, bool)));
+    while (transferPending.size() < TRANSFER_WINDOW && !transferQueue.isEmpty()) {
+        UAVObject *obj = transferQueue.takeFirst();
+        if (!obj) {
+            // instance could not be created
+            transferFailed.append(obj);
+            continue;
+        }
+        transferPending.insert(obj);
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)),
+                this, SLOT(transactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+        if (sending) {
+            obj->updated();
+        } else {
+            obj->requestUpdate();
+        }
+    }
 
-    PathAction *action = PathAction::GetInstance(objMngr, 0);
-    connect(action, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(pathPlanElementReceived(UAVObject *, bool)));
+    if (!transferPending.isEmpty()) {
+        return;
+    }
 
-    // we will start 3 update requests
-    completionCountdown = 3;
-    successCountdown    = completionCountdown;
+    if (!transferFailed.isEmpty()) {
+        if (transferFailed.contains(NULL) || ++transferRound >= TRANSFER_ROUNDS) {
+            qDebug() << "ModelUavoProxy - transfer failed," << transferFailed.size() << "instances left";
+            transferDone(false);
+            return;
+        }
+        qDebug() << "ModelUavoProxy - retransmitting" << transferFailed.size() << "instances, round" << transferRound;
+        transferQueue = transferFailed;
+        transferFailed.clear();
+        transferNext();
+        return;
+    }
 
-    pathPlan->requestUpdate();
-    waypoint->requestUpdateAll();
-    action->requestUpdateAll();
+    transferDone(true);
 }
 
-void ModelUavoProxy::pathPlanElementReceived(UAVObject *obj, bool success)
+void ModelUavoProxy::transactionCompleted(UAVObject *obj, bool success)
 {
+    if (!transferPending.remove(obj)) {
+        return;
+    }
     obj->disconnect(this);
+    if (!success) {
+        transferFailed.append(obj);
+    }
+    transferNext();
+}
+
+void ModelUavoProxy::transferDone(bool success)
+{
+    TransferState state = transferState;
+
+    transferState = TRANSFER_IDLE;
+
+    switch (state) {
+    case SENDING_ELEMENTS:
+        if (success) {
+            // the elements may have been changed by telemetry while they were sent
+            PathPlan *pathPlan = PathPlan::GetInstance(objMngr);
+            PathPlan::DataFields pathPlanData = pathPlan->getData();
+            if (pathPlanData.Crc != computePathPlanCrc(pathPlanData.WaypointCount, pathPlanData.PathActionCount)) {
+                qDebug() << "ModelUavoProxy::sendPathPlan - CRC changed during the upload";
+                success = false;
+                break;
+            }
+            startTransfer(SENDING_PLAN, QList<UAVObject *>() << pathPlan);
+            return;
+        }
+        break;
+
+    case SENDING_PLAN:
+        break;
 
-    completionCountdown--;
-    successCountdown -= success ? 1 : 0;
+    case RECEIVING_PLAN:
+        if (success) {
+            PathPlan::DataFields pathPlanData = PathPlan::GetInstance(objMngr)->getData();
+            startTransfer(RECEIVING_ELEMENTS, pathPlanElements(pathPlanData.WaypointCount, pathPlanData.PathActionCount));
+            return;
+        }
+        break;
 
-    if (completionCountdown == 0) {
-        qDebug() << "ModelUavoProxy::pathPlanReceived - completed" << (successCountdown == 0);
-        if (successCountdown == 0) {
+    case RECEIVING_ELEMENTS:
+        qDebug() << "ModelUavoProxy::pathPlanReceived - completed" << success;
+        if (success) {
             if (objectsToModel()) {
                 QMessageBox::information(NULL, tr("Path Plan Download Successful"), tr("Path plan download was successful."));
             }
+            return;
+        }
+        break;
+
+    default:
+        return;
+    }
+
+    if (state == SENDING_ELEMENTS || state == SENDING_PLAN) {
+        qDebug() << "ModelUavoProxy::pathPlanSent - completed" << success;
+        if (success) {
+            QMessageBox::information(NULL, tr("Path Plan Upload Successful"), tr("Path plan upload was successful."));
         } else {
-            QMessageBox::critical(NULL, tr("Path Plan Download Failed"), tr("Failed to download the path plan !"));
+            QMessageBox::critical(NULL, tr("Path Plan Upload Failed"), tr("Failed to upload the path plan !"));
         }
+    } else {
+        QMessageBox::critical(NULL, tr("Path Plan Download Failed"), tr("Failed to download the path plan !"));
     }
 }
 
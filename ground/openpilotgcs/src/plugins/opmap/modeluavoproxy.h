@@ -34,6 +34,8 @@
 #include "waypoint.h"
 
 #include <QObject>
+#include <QList>
+#include <QSet>
 
 class ModelUavoProxy : public QObject {
     Q_OBJECT
@@ -46,11 +48,26 @@ public slots:
     void receivePathPlan();
 
 private:
+    // Instance transactions in flight at the same time
+    static const int TRANSFER_WINDOW = 8;
+    // Rounds of retransmission for the instances that failed
+    static const int TRANSFER_ROUNDS = 3;
+
+    enum TransferState { TRANSFER_IDLE, SENDING_ELEMENTS, SENDING_PLAN, RECEIVING_PLAN, RECEIVING_ELEMENTS };
+
     UAVObjectManager *objMngr;
     flightDataModel *myModel;
 
-    uint completionCountdown;
-    uint successCountdown;
+    TransferState transferState;
+    QList<UAVObject *> transferQueue;
+    QList<UAVObject *> transferFailed;
+    QSet<UAVObject *> transferPending;
+    int transferRound;
+
+    void startTransfer(TransferState state, const QList<UAVObject *> & objects);
+    void transferNext();
+    void transferDone(bool success);
+    QList<UAVObject *> pathPlanElements(int waypointCount, int actionCount);
 
     bool modelToObjects();
     bool objectsToModel();
@@ -69,8 +86,7 @@ private:
     quint8 computePathPlanCrc(int waypointCount, int actionCount);
 
 private slots:
-    void pathPlanElementSent(UAVObject *, bool success);
-    void pathPlanElementReceived(UAVObject *, bool success);
+    void transactionCompleted(UAVObject *obj, bool success);
 };
 
 #endif // MODELUAVOPROXY_H
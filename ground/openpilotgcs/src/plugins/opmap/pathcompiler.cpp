@@ -33,11 +33,17 @@
 
 #include <QDebug>
 
+// Waypoint updates closer than this are handled with one rebuild
+#define REBUILD_DELAY_MS 100
+
 PathCompiler::PathCompiler(QObject *parent) :
     QObject(parent)
 {
     HomeLocation *homeLocation = NULL;
 
+    rebuildTimer.setSingleShot(true);
+    connect(&rebuildTimer, SIGNAL(timeout()), this, SLOT(rebuildFromUAV()));
+
     /* To catch new waypoint UAVOs */
     connect(getObjectManager(), SIGNAL(newInstance(UAVObject *)), this, SLOT(doNewInstance(UAVObject *)));
 
@@ -285,6 +291,17 @@ void PathCompiler::doDelAllWaypoints()
  * get the latest version and then update the visualization
  */
 void PathCompiler::doUpdateFromUAV(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    // A path transfer updates every waypoint instance, rebuilding the whole
+    // list on each of them is quadratic in the path length
+    if (!rebuildTimer.isActive()) {
+        rebuildTimer.start(REBUILD_DELAY_MS);
+    }
+}
+
+void PathCompiler::rebuildFromUAV()
 {
     UAVObjectManager *objManager = getObjectManager();
 
@@ -28,6 +28,7 @@
 #define PATHCOMPILER_H
 
 #include <QObject>
+#include <QTimer>
 #include <uavobject.h>
 #include <uavobjectmanager.h>
 #include <waypoint.h>
@@ -90,6 +91,9 @@ private:
     Waypoint::DataFields InternalToUavo(waypoint);
 
     QList <waypoint> previousWaypoints;
+
+    // ! Collects the waypoint updates of a transfer into one rebuild
+    QTimer rebuildTimer;
 signals:
     /**
      * Indicates something changed the waypoints and the map should
@@ -143,6 +147,12 @@ public slots:
      * get the latest version and then update the visualization
      */
     void doUpdateFromUAV(UAVObject *);
+
+private slots:
+    /**
+     * Rebuild the waypoint list from the UAVOs and update the visualization
+     */
+    void rebuildFromUAV();
 };
 
 #endif // PATHCOMPILER_H
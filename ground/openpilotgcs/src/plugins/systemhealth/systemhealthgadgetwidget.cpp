@@ -31,6 +31,7 @@
 #include "utils/stylehelper.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatebus.h"
 #include <uavtalk/telemetrymanager.h>
 
 #include <QDebug>
@@ -58,7 +59,7 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    pm->getObject<UAVObjectUpdateBus>()->subscribe(obj, this, "updateAlarms");
 
     // Listen to autopilot connection events
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
@@ -53,10 +53,10 @@ class FieldTreeItem : public TreeItem {
 public:
 
     FieldTreeItem(int index, const QList<QVariant> &data, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_index(index) {}
+        TreeItem(data, parent), m_index(index), m_rawValue(0), m_rawValueValid(false) {}
 
     FieldTreeItem(int index, const QVariant &data, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_index(index) {}
+        TreeItem(data, parent), m_index(index), m_rawValue(0), m_rawValueValid(false) {}
 
     bool isEditable()
     {
@@ -70,6 +70,24 @@ public:
 
 protected:
     int m_index;
+
+    // Most fields of an updated object did not change, comparing the raw
+    // element is much cheaper than getValue() and a QVariant compare.
+    bool rawValueChanged(UAVObjectField *field)
+    {
+        quint32 raw = field->getRawValue(m_index);
+
+        if (m_rawValueValid && raw == m_rawValue) {
+            return false;
+        }
+        m_rawValue = raw;
+        m_rawValueValid = true;
+        return true;
+    }
+
+private:
+    quint32 m_rawValue;
+    bool m_rawValueValid;
 };
 
 class EnumFieldTreeItem : public FieldTreeItem {
@@ -83,11 +101,7 @@ public:
 
     void setData(QVariant value, int column)
     {
-        QStringList options = m_field->getOptions();
-        QVariant tmpValue   = m_field->getValue(m_index);
-        int tmpValIndex     = options.indexOf(tmpValue.toString());
-
-        setChanged(tmpValIndex != value);
+        setChanged(currentIndex() != value);
         TreeItem::setData(value, column);
     }
 
@@ -102,17 +116,18 @@ public:
     void apply()
     {
         int value = data().toInt();
-        QStringList options = m_field->getOptions();
 
-        m_field->setValue(options[value], m_index);
+        m_field->setValue(m_enumOptions[value], m_index);
         setChanged(false);
     }
 
     void update()
     {
-        QStringList options = m_field->getOptions();
-        QVariant value = m_field->getValue(m_index);
-        int valIndex   = options.indexOf(value.toString());
+        if (!rawValueChanged(m_field) && !changed()) {
+            return;
+        }
+
+        int valIndex = currentIndex();
 
         if (data() != valIndex || changed()) {
             TreeItem::setData(valIndex);
@@ -149,6 +164,17 @@ public:
 private:
     QStringList m_enumOptions;
     UAVObjectField *m_field;
+
+    // Index of the current value in the options
+    int currentIndex()
+    {
+        if (m_field->getType() == UAVObjectField::ENUM) {
+            quint32 raw = m_field->getRawValue(m_index);
+            // Out of range values show the first option, as getValue() does
+            return raw < (quint32)m_enumOptions.length() ? (int)raw : 0;
+        }
+        return m_enumOptions.indexOf(m_field->getValue(m_index).toString());
+    }
 };
 
 class IntFieldTreeItem : public FieldTreeItem {
@@ -237,6 +263,10 @@ public:
 
     void update()
     {
+        if (!rawValueChanged(m_field) && !changed()) {
+            return;
+        }
+
         int value = m_field->getValue(m_index).toInt();
 
         if (data() != value || changed()) {
@@ -274,6 +304,10 @@ public:
 
     void update()
     {
+        if (!rawValueChanged(m_field) && !changed()) {
+            return;
+        }
+
         double value = m_field->getValue(m_index).toDouble();
 
         if (data() != value || changed()) {
@@ -376,6 +410,10 @@ public:
 
     void update()
     {
+        if (!rawValueChanged(m_field) && !changed()) {
+            return;
+        }
+
         QVariant value = toHexString(m_field->getValue(m_index));
 
         if (data() != value || changed()) {
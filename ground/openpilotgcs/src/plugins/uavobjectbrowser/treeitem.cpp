@@ -28,10 +28,10 @@
 #include "treeitem.h"
 
 /* Constructor */
-HighLightManager::HighLightManager(long checkingInterval)
+HighLightManager::HighLightManager(long checkingInterval) :
+    m_checkingInterval(checkingInterval)
 {
-    // Start the timer and connect it to the callback
-    m_expirationTimer.start(checkingInterval);
+    // The timer is started with the first highlighted item
     connect(&m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkItemsExpired()));
 }
 
@@ -41,15 +41,17 @@ HighLightManager::HighLightManager(long checkingInterval)
  */
 bool HighLightManager::add(TreeItem *itemToAdd)
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
+    // Check so that the item isn't already in the set
+    int count = m_items.size();
 
-    // Check so that the item isn't already in the list
-    if (!m_items.contains(itemToAdd)) {
-        m_items.insert(itemToAdd);
-        return true;
+    m_items.insert(itemToAdd);
+    if (m_items.size() == count) {
+        return false;
     }
-    return false;
+    if (!m_expirationTimer.isActive()) {
+        m_expirationTimer.start(m_checkingInterval);
+    }
+    return true;
 }
 
 /*
@@ -58,9 +60,6 @@ bool HighLightManager::add(TreeItem *itemToAdd)
  */
 bool HighLightManager::remove(TreeItem *itemToRemove)
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
     // Remove item and return result
     return m_items.remove(itemToRemove);
 }
@@ -73,26 +72,27 @@ bool HighLightManager::remove(TreeItem *itemToRemove)
  */
 void HighLightManager::checkItemsExpired()
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
-    // Get a mutable iterator for the list
-    QMutableSetIterator<TreeItem *> iter(m_items);
-
     // This is the timestamp to compare with
     QTime now = QTime::currentTime();
+    QList<TreeItem *> expired;
 
-    // Loop over all items, check if they expired.
+    // Collect the expired items first, removeHighlight() ends up in the
+    // model which must not see the set while it is iterated.
+    QMutableSetIterator<TreeItem *> iter(m_items);
     while (iter.hasNext()) {
         TreeItem *item = iter.next();
         if (item->getHiglightExpires() < now) {
-            // If expired, call removeHighlight
-            item->removeHighlight();
-
-            // Remove from list since it is restored.
+            expired.append(item);
             iter.remove();
         }
     }
+    if (m_items.isEmpty()) {
+        m_expirationTimer.stop();
+    }
+
+    foreach(TreeItem * item, expired) {
+        item->removeHighlight();
+    }
 }
 
 int TreeItem::m_highlightTimeMs = 500;
@@ -101,6 +101,8 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
     QObject(0),
     m_data(data),
     m_parent(parent),
+    m_row(0),
+    m_expanded(false),
     m_highlight(false),
     m_changed(false)
 {}
@@ -108,6 +110,8 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
 TreeItem::TreeItem(const QVariant &data, TreeItem *parent) :
     QObject(0),
     m_parent(parent),
+    m_row(0),
+    m_expanded(false),
     m_highlight(false),
     m_changed(false)
 {
@@ -121,6 +125,7 @@ TreeItem::~TreeItem()
 
 void TreeItem::appendChild(TreeItem *child)
 {
+    child->m_row = m_children.count();
     m_children.append(child);
     child->setParentTree(this);
 }
@@ -131,6 +136,10 @@ void TreeItem::insertChild(TreeItem *child)
 
     m_children.insert(index, child);
     child->setParentTree(this);
+    // Keep the cached rows of the following siblings right
+    for (int i = index; i < m_children.count(); ++i) {
+        m_children[i]->m_row = i;
+    }
 }
 
 TreeItem *TreeItem::getChild(int index)
@@ -143,15 +152,6 @@ int TreeItem::childCount() const
     return m_children.count();
 }
 
-int TreeItem::row() const
-{
-    if (m_parent) {
-        return m_parent->m_children.indexOf(const_cast<TreeItem *>(this));
-    }
-
-    return 0;
-}
-
 int TreeItem::columnCount() const
 {
     return m_data.count();
@@ -179,6 +179,14 @@ void TreeItem::apply()
     child->apply();
 }
 
+/*
+ * The children of an item can be seen if it and all its parents are expanded.
+ */
+bool TreeItem::childrenShown()
+{
+    return m_expanded && (!m_parent || m_parent->childrenShown());
+}
+
 /*
  * Called after a value has changed to trigger highlightning of tree item.
  */
@@ -224,6 +232,22 @@ QTime TreeItem::getHiglightExpires()
     return m_highlightExpires;
 }
 
+bool ObjectTreeItem::objectDataChanged()
+{
+    if (!m_obj) {
+        return false;
+    }
+
+    QByteArray current(m_obj->getNumBytes(), 0);
+
+    m_obj->pack((quint8 *)current.data());
+    if (current == m_objectData) {
+        return false;
+    }
+    m_objectData = current;
+    return true;
+}
+
 QList<MetaObjectTreeItem *> TopTreeItem::getMetaObjectItems()
 {
     return m_metaObjectTreeItemsPerObjectIds.values();
@@ -35,6 +35,7 @@
 #include <QtCore/QLinkedList>
 #include <QtCore/QMap>
 #include <QtCore/QVariant>
+#include <QtCore/QByteArray>
 #include <QtCore/QTime>
 #include <QtCore/QTimer>
 #include <QtCore/QObject>
@@ -46,16 +47,18 @@ class TreeItem;
  * Small utility class that handles the higlighting of
  * tree grid items.
  * Basicly it maintains all items due to be restored to
- * non highlighted state in a linked list.
- * A timer traverses this list periodically to find out
+ * non highlighted state in a set.
+ * A timer traverses this set periodically to find out
  * if any of the items should be restored. All items are
  * updated withan expiration timestamp when they expires.
  * An item that is beeing restored is removed from the
- * list and its removeHighlight() method is called. Items
- * that are not expired are left in the list til next time.
+ * set and its removeHighlight() method is called. Items
+ * that are not expired are left in the set til next time.
  * Items that are updated during the expiration time are
- * left untouched in the list. This reduces unwanted emits
+ * left untouched in the set. This reduces unwanted emits
  * of signals to the repaint/update function.
+ * The tree lives in the GUI thread only, so there is no
+ * locking. The timer only runs while items are highlighted.
  */
 class HighLightManager : public QObject {
     Q_OBJECT
@@ -77,12 +80,10 @@ private slots:
 private:
     // The timer checking highlight expiration.
     QTimer m_expirationTimer;
+    long m_checkingInterval;
 
     // The collection holding all items due to be updated.
     QSet<TreeItem *> m_items;
-
-    // Mutex to lock when accessing collection.
-    QMutex m_mutex;
 };
 
 class TreeItem : public QObject {
@@ -118,7 +119,10 @@ public:
     // only column 1 (TreeItem::dataColumn) is changed with setData currently
     // other columns are initialized in constructor
     virtual void setData(QVariant value, int column = 1);
-    int row() const;
+    inline int row() const
+    {
+        return m_row;
+    }
     TreeItem *parent()
     {
         return m_parent;
@@ -134,6 +138,18 @@ public:
     virtual void update();
     virtual void apply();
 
+    // Expansion state of the item in the view, only rows below expanded
+    // items are visible and need to be kept up to date.
+    inline bool expanded()
+    {
+        return m_expanded;
+    }
+    inline void setExpanded(bool expanded)
+    {
+        m_expanded = expanded;
+    }
+    bool childrenShown();
+
     inline bool highlighted()
     {
         return m_highlight;
@@ -190,6 +206,8 @@ private:
     QList<QVariant> m_data;
     QString m_description;
     TreeItem *m_parent;
+    int m_row;
+    bool m_expanded;
     bool m_highlight;
     bool m_changed;
     QTime m_highlightExpires;
@@ -239,9 +257,9 @@ class ObjectTreeItem : public TreeItem {
     Q_OBJECT
 public:
     ObjectTreeItem(const QList<QVariant> &data, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(0) {}
+        TreeItem(data, parent), m_obj(0), m_stale(false) {}
     ObjectTreeItem(const QVariant &data, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(0) {}
+        TreeItem(data, parent), m_obj(0), m_stale(false) {}
     void setObject(UAVObject *obj)
     {
         m_obj = obj; setDescription(obj->getDescription());
@@ -250,8 +268,32 @@ public:
     {
         return m_obj;
     }
+
+    // The fields of a collapsed object are not updated, the item is marked
+    // stale and brought up to date when it is shown or applied.
+    inline bool stale()
+    {
+        return m_stale;
+    }
+    inline void setStale(bool stale)
+    {
+        m_stale = stale;
+    }
+    void refreshIfStale()
+    {
+        if (m_stale) {
+            m_stale = false;
+            update();
+        }
+    }
+
+    // True if the packed object differs from the last call
+    bool objectDataChanged();
+
 private:
     UAVObject *m_obj;
+    bool m_stale;
+    QByteArray m_objectData;
 };
 
 class MetaObjectTreeItem : public ObjectTreeItem {
@@ -267,6 +309,11 @@ public:
     {
         setObject(obj);
     }
+    virtual void apply()
+    {
+        refreshIfStale();
+        TreeItem::apply();
+    }
 };
 
 class DataObjectTreeItem : public ObjectTreeItem {
@@ -278,6 +325,7 @@ public:
         ObjectTreeItem(data, parent) {}
     virtual void apply()
     {
+        refreshIfStale();
         foreach(TreeItem * child, treeChildren()) {
             MetaObjectTreeItem *metaChild = dynamic_cast<MetaObjectTreeItem *>(child);
 
@@ -313,6 +361,7 @@ public:
     }
     virtual void apply()
     {
+        refreshIfStale();
         TreeItem::apply();
     }
     virtual void update()
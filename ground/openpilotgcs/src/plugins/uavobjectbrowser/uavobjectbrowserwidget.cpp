@@ -31,6 +31,7 @@
 #include "ui_uavobjectbrowser.h"
 #include "ui_viewoptions.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatebus.h"
 #include <QStringList>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -57,6 +58,7 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
     m_browser->treeView->setSelectionBehavior(QAbstractItemView::SelectItems);
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
+    connectExpansion();
     connect(m_viewoptions->cbMetaData, SIGNAL(toggled(bool)), this, SLOT(showMetaData(bool)));
     connect(m_viewoptions->cbCategorized, SIGNAL(toggled(bool)), this, SLOT(categorize(bool)));
     connect(m_browser->saveSDButton, SIGNAL(clicked()), this, SLOT(saveObject()));
@@ -84,6 +86,21 @@ void UAVObjectBrowserWidget::setViewOptions(bool categorized, bool scientific, b
     m_viewoptions->cbScientific->setChecked(scientific);
 }
 
+/**
+ * The model only follows the objects while the browser can be seen
+ */
+void UAVObjectBrowserWidget::showEvent(QShowEvent *event)
+{
+    ExtensionSystem::PluginManager::instance()->getObject<UAVObjectUpdateBus>()->setPaused(m_model, false);
+    QWidget::showEvent(event);
+}
+
+void UAVObjectBrowserWidget::hideEvent(QHideEvent *event)
+{
+    ExtensionSystem::PluginManager::instance()->getObject<UAVObjectUpdateBus>()->setPaused(m_model, true);
+    QWidget::hideEvent(event);
+}
+
 void UAVObjectBrowserWidget::showMetaData(bool show)
 {
     QList<QModelIndex> metaIndexes = m_model->getMetaDataIndexes();
@@ -104,6 +121,7 @@ void UAVObjectBrowserWidget::categorize(bool categorize)
     m_browser->treeView->setModel(m_model);
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
+    connectExpansion();
 
     delete tmpModel;
 }
@@ -119,10 +137,20 @@ void UAVObjectBrowserWidget::useScientificNotation(bool scientific)
     m_browser->treeView->setModel(m_model);
     showMetaData(m_viewoptions->cbMetaData->isChecked());
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
+    connectExpansion();
 
     delete tmpModel;
 }
 
+/**
+ * The model only keeps the rows up to date that can be seen
+ */
+void UAVObjectBrowserWidget::connectExpansion()
+{
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), m_model, SLOT(itemExpanded(QModelIndex)), Qt::UniqueConnection);
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), m_model, SLOT(itemCollapsed(QModelIndex)), Qt::UniqueConnection);
+}
+
 void UAVObjectBrowserWidget::sendUpdate()
 {
     this->setFocus();
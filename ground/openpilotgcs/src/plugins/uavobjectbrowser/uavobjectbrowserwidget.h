@@ -77,6 +77,9 @@ private slots:
     void viewOptionsChangedSlot();
 signals:
     void viewOptionsChanged(bool categorized, bool scientific, bool metadata);
+protected:
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
 private:
     QPushButton *m_requestUpdate;
     QPushButton *m_sendUpdate;
@@ -92,6 +95,7 @@ private:
 
     void updateObjectPersistance(ObjectPersistence::OperationOptions op, UAVObject *obj);
     void enableSendRequest(bool enable);
+    void connectExpansion();
     ObjectTreeItem *findCurrentObjectTreeItem();
 };
 
@@ -31,6 +31,7 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include "uavobjectfield.h"
+#include "uavobjectupdatebus.h"
 #include "extensionsystem/pluginmanager.h"
 #include <QColor>
 #include <QtCore/QTimer>
@@ -69,6 +70,7 @@ void UAVObjectTreeModel::setupModelData(UAVObjectManager *objManager)
     QList<QVariant> rootData;
     rootData << tr("Property") << tr("Value") << tr("Unit");
     m_rootItem        = new TreeItem(rootData);
+    m_rootItem->setExpanded(true);
 
     m_settingsTree    = new TopTreeItem(tr("Settings"), m_rootItem);
     m_settingsTree->setHighlightManager(m_highlightManager);
@@ -146,9 +148,10 @@ TreeItem *UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    ExtensionSystem::PluginManager::instance()->getObject<UAVObjectUpdateBus>()->subscribe(obj, this, "highlightUpdatedObject");
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
+    m_objectTreeItems[obj] = meta;
     meta->setHighlightManager(m_highlightManager);
     connect(meta, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
     foreach(UAVObjectField * field, obj->getFields()) {
@@ -164,7 +167,7 @@ MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
+    ExtensionSystem::PluginManager::instance()->getObject<UAVObjectUpdateBus>()->subscribe(obj, this, "highlightUpdatedObject");
     TreeItem *item;
     if (obj->isSingleInstance()) {
         item = parent;
@@ -177,6 +180,7 @@ void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
         connect(item, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
         parent->appendChild(item);
     }
+    m_objectTreeItems[obj] = static_cast<ObjectTreeItem *>(item);
     foreach(UAVObjectField * field, obj->getFields()) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
@@ -276,17 +280,7 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
         return QModelIndex();
     }
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item) {
-            return childIndex;
-        }
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    return createIndex(item->row(), 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -429,56 +423,101 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
     return QVariant();
 }
 
+/**
+ * Only the fields that can be seen are updated, a collapsed object just
+ * highlights its row when the data changed and is refreshed when expanded.
+ */
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    ObjectTreeItem *item = findObjectTreeItem(obj);
+    ObjectTreeItem *item = m_objectTreeItems.value(obj);
     Q_ASSERT(item);
     if (!m_onlyHilightChangedValues) {
         item->setHighlight(true);
     }
-    item->update();
-    if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    if (!item->objectDataChanged()) {
+        return;
+    }
+    if (item->childrenShown()) {
+        item->setStale(false);
+        item->update();
+    } else {
+        item->setStale(true);
+        item->setHighlight(true);
     }
 }
 
-ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
+void UAVObjectTreeModel::itemExpanded(const QModelIndex &index)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(object);
-    UAVMetaObject *metaObject = qobject_cast<UAVMetaObject *>(object);
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
 
-    Q_ASSERT(dataObject || metaObject);
-    if (dataObject) {
-        return findDataObjectTreeItem(dataObject);
-    } else {
-        return findMetaObjectTreeItem(metaObject);
-    }
-    return 0;
+    item->setExpanded(true);
+    refreshStaleItems(item);
 }
 
-DataObjectTreeItem *UAVObjectTreeModel::findDataObjectTreeItem(UAVDataObject *obj)
+void UAVObjectTreeModel::itemCollapsed(const QModelIndex &index)
 {
-    TopTreeItem *root = obj->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
 
-    return root->findDataObjectTreeItemByObjectId(obj->getObjID());
+    item->setExpanded(false);
 }
 
-MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *obj)
+/**
+ * Bring the objects that became visible below an expanded item up to date
+ */
+void UAVObjectTreeModel::refreshStaleItems(TreeItem *item)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(obj->getParentObject());
+    if (!item->childrenShown()) {
+        return;
+    }
 
-    Q_ASSERT(dataObject);
-    TopTreeItem *root = dataObject->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
-    return root->findMetaObjectTreeItemByObjectId(obj->getObjID());
+    ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(item);
+    if (objItem) {
+        objItem->refreshIfStale();
+    }
+    foreach(TreeItem * child, item->treeChildren()) {
+        refreshStaleItems(child);
+    }
 }
 
+/**
+ * Changed items are collected and emitted as ranges of rows once the
+ * current batch of updates is done
+ */
 void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    QModelIndex itemIndex = index(item);
+    if (m_highlightChanges.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(emitHighlightChanges()));
+    }
+    m_highlightChanges.insert(item);
+}
 
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::dataColumn));
+void UAVObjectTreeModel::emitHighlightChanges()
+{
+    QHash<TreeItem *, QList<int> > rowsPerParent;
+
+    foreach(TreeItem * item, m_highlightChanges) {
+        rowsPerParent[item->parent()].append(item->row());
+    }
+    m_highlightChanges.clear();
+
+    QHashIterator<TreeItem *, QList<int> > iter(rowsPerParent);
+    while (iter.hasNext()) {
+        iter.next();
+        // Rows below a collapsed item can't be seen
+        if (!iter.key()->childrenShown()) {
+            continue;
+        }
+
+        QModelIndex parentIndex = index(iter.key());
+        QList<int> rows = iter.value();
+        qSort(rows);
+        int first = 0;
+        for (int i = 1; i <= rows.size(); ++i) {
+            if (i == rows.size() || rows[i] != rows[i - 1] + 1) {
+                emit dataChanged(index(rows[first], 0, parentIndex), index(rows[i - 1], TreeItem::dataColumn, parentIndex));
+                first = i;
+            }
+        }
+    }
 }
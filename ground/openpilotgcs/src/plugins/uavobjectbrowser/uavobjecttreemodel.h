@@ -32,6 +32,8 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QColor>
 
 class TopTreeItem;
@@ -86,10 +88,13 @@ signals:
 
 public slots:
     void newObject(UAVObject *obj);
+    void itemExpanded(const QModelIndex &index);
+    void itemCollapsed(const QModelIndex &index);
 
 private slots:
     void highlightUpdatedObject(UAVObject *obj);
     void updateHighlight(TreeItem *);
+    void emitHighlightChanges();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -103,9 +108,7 @@ private:
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
     QString updateMode(quint8 updateMode);
-    ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
-    DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
-    MetaObjectTreeItem *findMetaObjectTreeItem(UAVMetaObject *obj);
+    void refreshStaleItems(TreeItem *item);
 
     TreeItem *m_rootItem;
     TopTreeItem *m_settingsTree;
@@ -117,6 +120,12 @@ private:
     QColor m_manuallyChangedColor;
     bool m_onlyHilightChangedValues;
 
+    // The item of every object, instance and meta object
+    QHash<UAVObject *, ObjectTreeItem *> m_objectTreeItems;
+
+    // Items with a changed highlight, emitted as row ranges
+    QSet<TreeItem *> m_highlightChanges;
+
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
 };
@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ *
+ * @file       fielddescriptorstest.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Field descriptors shared between object instances
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtTest>
+#include <QElapsedTimer>
+#include "uavobjectmanager.h"
+#include "waypoint.h"
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#endif
+
+// Heap one Waypoint instance may take, its fields and registration included
+#define MAX_HEAP_PER_INSTANCE 2048
+
+class FieldDescriptorsTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sharedDescriptors();
+    void instances();
+};
+
+/**
+ * Bytes in use on the heap, -1 where it can not be measured
+ */
+static qint64 heapInUse()
+{
+#ifdef Q_OS_LINUX
+    struct mallinfo info = mallinfo();
+    return (qint64)(unsigned int)info.uordblks + (qint64)(unsigned int)info.hblkhd;
+#else
+    return -1;
+#endif
+}
+
+void FieldDescriptorsTest::sharedDescriptors()
+{
+    UAVObjectManager objMngr;
+    Waypoint *first = new Waypoint();
+
+    QVERIFY(objMngr.registerObject(first));
+    UAVDataObject *second = first->clone(1);
+    QVERIFY(objMngr.registerObject(second));
+
+    QList<UAVObjectField *> firstFields  = first->getFields();
+    QList<UAVObjectField *> secondFields = second->getFields();
+
+    QCOMPARE(firstFields.size(), secondFields.size());
+    QVERIFY(firstFields.size() > 0);
+    for (int i = 0; i < firstFields.size(); ++i) {
+        QVERIFY(firstFields[i] != secondFields[i]);
+        QCOMPARE(firstFields[i]->getDescriptor(), secondFields[i]->getDescriptor());
+        QCOMPARE(firstFields[i]->getName(), secondFields[i]->getName());
+    }
+
+    // the data is not shared
+    UAVObjectField *position = first->getField("Position");
+    QVERIFY(position != NULL);
+    position->setDouble(12.5, 0);
+    QCOMPARE(position->getDouble(0), 12.5);
+    QCOMPARE(second->getField("Position")->getDouble(0), 0.0);
+}
+
+void FieldDescriptorsTest::instances()
+{
+    const quint32 numInstances = UAVObjectManager::MAX_INSTANCES;
+    UAVObjectManager objMngr;
+    Waypoint *waypoint = new Waypoint();
+
+    QVERIFY(objMngr.registerObject(waypoint));
+
+    QList<UAVDataObject *> clones;
+    clones.reserve(numInstances);
+    qint64 heapBefore = heapInUse();
+    QElapsedTimer timer;
+    timer.start();
+    for (quint32 instId = 1; instId < numInstances; ++instId) {
+        clones.append(waypoint->clone(instId));
+    }
+    qint64 cloneNs = timer.nsecsElapsed();
+    foreach(UAVDataObject * clone, clones) {
+        QVERIFY(objMngr.registerObject(clone));
+    }
+    qint64 heapAfter = heapInUse();
+
+    QCOMPARE(objMngr.getNumInstances(Waypoint::OBJID), (qint32)numInstances);
+    QCOMPARE(clones.last()->getField("Position")->getDescriptor(), waypoint->getField("Position")->getDescriptor());
+
+    // timing depends on the machine, it is only reported
+    qDebug() << "clone:" << cloneNs / clones.size() << "ns per instance";
+
+    if (heapBefore < 0) {
+        QSKIP("heap usage can not be measured on this platform");
+    }
+    qint64 heapPerInstance = (heapAfter - heapBefore) / clones.size();
+    qDebug() << "heap:" << heapPerInstance << "bytes per instance";
+    QVERIFY2(heapPerInstance <= MAX_HEAP_PER_INSTANCE, qPrintable(QString("%1 bytes per instance").arg(heapPerInstance)));
+}
+
+QTEST_MAIN(FieldDescriptorsTest)
+
+#include "fielddescriptorstest.moc"
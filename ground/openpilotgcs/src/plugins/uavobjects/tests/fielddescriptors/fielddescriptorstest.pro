@@ -0,0 +1,35 @@
+# -------------------------------------------------
+# Checks that the instances of a generated object share
+# their field descriptors, measures the heap an instance
+# takes and reports how long cloning takes.
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = fielddescriptorstest
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+
+# Generated objects, built with the uavobjects plugin
+UAVOBJECT_SYNTHETICS = $${GCS_BUILD_TREE}/../uavobject-synthetics/gcs
+INCLUDEPATH += $$UAVOBJECT_SYNTHETICS \
+    ../.. \
+    ../../../../libs
+DEFINES += UAVOBJECTS_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+
+SOURCES += fielddescriptorstest.cpp \
+    ../../uavobjectmanager.cpp \
+    ../../uavobjectfield.cpp \
+    ../../uavobject.cpp \
+    ../../uavmetaobject.cpp \
+    ../../uavdataobject.cpp \
+    ../../../../libs/utils/crc.cpp \
+    $$UAVOBJECT_SYNTHETICS/waypoint.cpp
+HEADERS += ../../uavobjectmanager.h \
+    ../../uavobjectfield.h \
+    ../../uavobject.h \
+    ../../uavmetaobject.h \
+    ../../uavdataobject.h \
+    $$UAVOBJECT_SYNTHETICS/waypoint.h
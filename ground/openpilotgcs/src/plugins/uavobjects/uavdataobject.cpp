@@ -27,6 +27,8 @@
  */
 #include "uavdataobject.h"
 
+#include <QTimer>
+
 /**
  * Constructor
  */
@@ -35,6 +37,7 @@ UAVDataObject::UAVDataObject(quint32 objID, bool isSingleInst, bool isSettings,
 {
     m_metaObject = NULL;
     this->m_isSettings = isSettings;
+    m_notificationPending = false;
 }
 
 /**
@@ -66,6 +69,25 @@ bool UAVDataObject::isSettingsObject()
     return m_isSettings;
 }
 
+/**
+ * Called on every object update. A burst of updates within a frame results
+ * in a single call of emitNotifications(), which only signals the properties
+ * that really changed, so QML bindings are not re-evaluated at telemetry rate.
+ */
+void UAVDataObject::scheduleNotifications()
+{
+    if (!m_notificationPending) {
+        m_notificationPending = true;
+        QTimer::singleShot(NOTIFICATION_INTERVAL_MS, this, SLOT(deliverNotifications()));
+    }
+}
+
+void UAVDataObject::deliverNotifications()
+{
+    m_notificationPending = false;
+    emitNotifications();
+}
+
 /**
  * Set the object's metadata
  */
@@ -50,9 +50,22 @@ public:
     bool isSettingsObject();
     bool isDataObject();
 
+    // Property notifications are coalesced to one per object per frame
+    static const int NOTIFICATION_INTERVAL_MS = 16;
+
+protected slots:
+    void scheduleNotifications();
+
+protected:
+    virtual void emitNotifications() {}
+
+private slots:
+    void deliverNotifications();
+
 private:
     UAVMetaObject *m_metaObject;
     bool m_isSettings;
+    bool m_notificationPending;
 };
 
 #endif // UAVDATAOBJECT_H
@@ -28,6 +28,22 @@
 #include "uavmetaobject.h"
 #include "uavobjectfield.h"
 
+/**
+ * The fields of all the metaobjects
+ */
+static QList<const UAVObjectFieldDescriptor *> createFieldDescriptors()
+{
+    QStringList modesBitField;
+
+    modesBitField << UAVMetaObject::tr("FlightReadOnly") << UAVMetaObject::tr("GCSReadOnly") << UAVMetaObject::tr("FlightTelemetryAcked") << UAVMetaObject::tr("GCSTelemetryAcked") << UAVMetaObject::tr("FlightUpdatePeriodic") << UAVMetaObject::tr("FlightUpdateOnChange") << UAVMetaObject::tr("GCSUpdatePeriodic") << UAVMetaObject::tr("GCSUpdateOnChange") << UAVMetaObject::tr("LoggingUpdatePeriodic") << UAVMetaObject::tr("LoggingUpdateOnChange");
+    QList<const UAVObjectFieldDescriptor *> descriptors;
+    descriptors.append(new UAVObjectFieldDescriptor(UAVMetaObject::tr("Modes"), UAVMetaObject::tr("boolean"), UAVObjectField::BITFIELD, modesBitField, QStringList()));
+    descriptors.append(new UAVObjectFieldDescriptor(UAVMetaObject::tr("Flight Telemetry Update Period"), UAVMetaObject::tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
+    descriptors.append(new UAVObjectFieldDescriptor(UAVMetaObject::tr("GCS Telemetry Update Period"), UAVMetaObject::tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
+    descriptors.append(new UAVObjectFieldDescriptor(UAVMetaObject::tr("Logging Update Period"), UAVMetaObject::tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
+    return descriptors;
+}
+
 /**
  * Constructor
  */
@@ -37,17 +53,11 @@ UAVMetaObject::UAVMetaObject(quint32 objID, const QString & name, UAVObject *par
     this->parent = parent;
     // Setup default metadata of metaobject (can not be changed)
     UAVObject::MetadataInitialize(ownMetadata);
-    // Setup fields
-    QStringList modesBitField;
-    modesBitField << tr("FlightReadOnly") << tr("GCSReadOnly") << tr("FlightTelemetryAcked") << tr("GCSTelemetryAcked") << tr("FlightUpdatePeriodic") << tr("FlightUpdateOnChange") << tr("GCSUpdatePeriodic") << tr("GCSUpdateOnChange") << tr("LoggingUpdatePeriodic") << tr("LoggingUpdateOnChange");
-    QList<UAVObjectField *> fields;
-    fields.append(new UAVObjectField(tr("Modes"), tr("boolean"), UAVObjectField::BITFIELD, modesBitField, QStringList()));
-    fields.append(new UAVObjectField(tr("Flight Telemetry Update Period"), tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
-    fields.append(new UAVObjectField(tr("GCS Telemetry Update Period"), tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
-    fields.append(new UAVObjectField(tr("Logging Update Period"), tr("ms"), UAVObjectField::UINT16, 1, QStringList()));
+    // Setup fields, the descriptors are shared by all the metaobjects
+    static const QList<const UAVObjectFieldDescriptor *> descriptors = createFieldDescriptors();
     // Initialize parent
     UAVObject::initialize(0);
-    UAVObject::initializeFields(fields, (quint8 *)&parentMetadata, sizeof(Metadata));
+    UAVObject::initializeFields(descriptors, (quint8 *)&parentMetadata, sizeof(Metadata));
     // Setup metadata of parent
     parentMetadata = parent->getDefaultMetadata();
 }
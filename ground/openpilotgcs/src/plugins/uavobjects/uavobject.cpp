@@ -92,10 +92,24 @@ void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data,
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->initialize(data, offset, this);
         offset += fields[n]->getNumBytes();
-        connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
     }
 }
 
+/**
+ * Create the fields of this instance from the descriptors shared by all
+ * the instances of the object type
+ */
+void UAVObject::initializeFields(const QList<const UAVObjectFieldDescriptor *> & descriptors, quint8 *data, quint32 numBytes)
+{
+    QList<UAVObjectField *> fields;
+
+    fields.reserve(descriptors.size());
+    foreach(const UAVObjectFieldDescriptor * descriptor, descriptors) {
+        fields.append(new UAVObjectField(descriptor));
+    }
+    initializeFields(fields, data, numBytes);
+}
+
 /**
  * Called from the fields each time they are updated
  */
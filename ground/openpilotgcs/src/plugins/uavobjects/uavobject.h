@@ -50,6 +50,7 @@
 #define UAVOBJ_UPDATE_MODE_MASK                0x3
 
 class UAVObjectField;
+class UAVObjectFieldDescriptor;
 
 class UAVOBJECTS_EXPORT UAVObject : public QObject {
     Q_OBJECT
@@ -186,6 +187,7 @@ protected:
     QList<UAVObjectField *> fields;
 
     void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes);
+    void initializeFields(const QList<const UAVObjectFieldDescriptor *> & descriptors, quint8 *data, quint32 numBytes);
     void setDescription(const QString & description);
     void setCategory(const QString & category);
 };
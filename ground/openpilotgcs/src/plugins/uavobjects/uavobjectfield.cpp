@@ -29,7 +29,45 @@
 #include <QtEndian>
 #include <QDebug>
 
+UAVObjectField::UAVObjectField(const UAVObjectFieldDescriptor *descriptor) : ownDescriptor(NULL)
+{
+    descriptorInitialize(descriptor);
+}
+
 UAVObjectField::UAVObjectField(const QString & name, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
+{
+    ownDescriptor = new UAVObjectFieldDescriptor(name, units, type, numElements, options, limits);
+    descriptorInitialize(ownDescriptor);
+}
+
+UAVObjectField::UAVObjectField(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+{
+    ownDescriptor = new UAVObjectFieldDescriptor(name, units, type, elementNames, options, limits);
+    descriptorInitialize(ownDescriptor);
+}
+
+UAVObjectField::~UAVObjectField()
+{
+    delete ownDescriptor;
+}
+
+void UAVObjectField::descriptorInitialize(const UAVObjectFieldDescriptor *descriptor)
+{
+    this->descriptor   = descriptor;
+    this->type         = descriptor->type;
+    this->numElements  = descriptor->numElements;
+    this->numBytesPerElement = descriptor->numBytesPerElement;
+    this->offset = 0;
+    this->data   = NULL;
+    this->obj    = NULL;
+}
+
+const UAVObjectFieldDescriptor *UAVObjectField::getDescriptor() const
+{
+    return descriptor;
+}
+
+UAVObjectFieldDescriptor::UAVObjectFieldDescriptor(const QString & name, const QString & units, UAVObjectField::FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
 {
     QStringList elementNames;
 
@@ -38,15 +76,15 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & units, Fiel
         elementNames.append(QString("%1").arg(n));
     }
     // Initialize
-    constructorInitialize(name, units, type, elementNames, options, limits);
+    initialize(name, units, type, elementNames, options, limits);
 }
 
-UAVObjectField::UAVObjectField(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+UAVObjectFieldDescriptor::UAVObjectFieldDescriptor(const QString & name, const QString & units, UAVObjectField::FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
-    constructorInitialize(name, units, type, elementNames, options, limits);
+    initialize(name, units, type, elementNames, options, limits);
 }
 
-void UAVObjectField::constructorInitialize(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+void UAVObjectFieldDescriptor::initialize(const QString & name, const QString & units, UAVObjectField::FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     // Copy params
     this->name         = name;
@@ -54,41 +92,38 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     this->type         = type;
     this->options      = options;
     this->numElements  = elementNames.length();
-    this->offset       = 0;
-    this->data         = NULL;
-    this->obj = NULL;
     this->elementNames = elementNames;
     // Set field size
     switch (type) {
-    case INT8:
+    case UAVObjectField::INT8:
         numBytesPerElement = sizeof(qint8);
         break;
-    case INT16:
+    case UAVObjectField::INT16:
         numBytesPerElement = sizeof(qint16);
         break;
-    case INT32:
+    case UAVObjectField::INT32:
         numBytesPerElement = sizeof(qint32);
         break;
-    case UINT8:
+    case UAVObjectField::UINT8:
         numBytesPerElement = sizeof(quint8);
         break;
-    case UINT16:
+    case UAVObjectField::UINT16:
         numBytesPerElement = sizeof(quint16);
         break;
-    case UINT32:
+    case UAVObjectField::UINT32:
         numBytesPerElement = sizeof(quint32);
         break;
-    case FLOAT32:
+    case UAVObjectField::FLOAT32:
         numBytesPerElement = sizeof(quint32);
         break;
-    case ENUM:
+    case UAVObjectField::ENUM:
         numBytesPerElement = sizeof(quint8);
         break;
-    case BITFIELD:
+    case UAVObjectField::BITFIELD:
         numBytesPerElement = sizeof(quint8);
-        this->options = QStringList() << tr("0") << tr("1");
+        this->options = QStringList() << UAVObjectField::tr("0") << UAVObjectField::tr("1");
         break;
-    case STRING:
+    case UAVObjectField::STRING:
         numBytesPerElement = sizeof(quint8);
         break;
     default:
@@ -97,7 +132,7 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     limitsInitialize(limits);
 }
 
-void UAVObjectField::limitsInitialize(const QString &limits)
+void UAVObjectFieldDescriptor::limitsInitialize(const QString &limits)
 {
     // Limit string format:
     // %        - start char
@@ -117,12 +152,19 @@ void UAVObjectField::limitsInitialize(const QString &limits)
     if (limits.isEmpty()) {
         return;
     }
+    if (type == UAVObjectField::ENUM) {
+        for (int i = 0; i < options.size(); ++i) {
+            if (!optionIndexes.contains(options.at(i))) {
+                optionIndexes.insert(options.at(i), i);
+            }
+        }
+    }
     QStringList stringPerElement = limits.split(";");
     quint32 index = 0;
     foreach(QString str, stringPerElement) {
         QStringList ruleList = str.split(",");
 
-        QList<LimitStruct> limitList;
+        QList<UAVObjectField::LimitStruct> limitList;
         foreach(QString rule, ruleList) {
             QString _str = rule.trimmed();
 
@@ -130,7 +172,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 continue;
             }
             QStringList valuesPerElement = _str.split(":");
-            LimitStruct lstruc;
+            UAVObjectField::LimitStruct lstruc;
             bool startFlag    = valuesPerElement.at(0).startsWith("%");
             bool maxIndexFlag = (int)(index) < (int)numElements;
             bool elemNumberSizeFlag = valuesPerElement.at(0).size() == 3;
@@ -144,47 +186,59 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                     lstruc.board = 0;
                 }
                 if (valuesPerElement.at(0).right(2) == "EQ") {
-                    lstruc.type = EQUAL;
+                    lstruc.type = UAVObjectField::EQUAL;
                 } else if (valuesPerElement.at(0).right(2) == "NE") {
-                    lstruc.type = NOT_EQUAL;
+                    lstruc.type = UAVObjectField::NOT_EQUAL;
                 } else if (valuesPerElement.at(0).right(2) == "BE") {
-                    lstruc.type = BETWEEN;
+                    lstruc.type = UAVObjectField::BETWEEN;
                 } else if (valuesPerElement.at(0).right(2) == "BI") {
-                    lstruc.type = BIGGER;
+                    lstruc.type = UAVObjectField::BIGGER;
                 } else if (valuesPerElement.at(0).right(2) == "SM") {
-                    lstruc.type = SMALLER;
+                    lstruc.type = UAVObjectField::SMALLER;
                 } else {
                     qDebug() << "limits parsing failed (invalid property) on UAVObjectField" << name;
+                    continue;
                 }
                 valuesPerElement.removeAt(0);
                 foreach(QString _value, valuesPerElement) {
                     QString value = _value.trimmed();
 
                     switch (type) {
-                    case UINT8:
-                    case UINT16:
-                    case UINT32:
-                    case BITFIELD:
+                    case UAVObjectField::UINT8:
+                    case UAVObjectField::UINT16:
+                    case UAVObjectField::UINT32:
+                    case UAVObjectField::BITFIELD:
                         lstruc.values.append((quint32)value.toULong());
+                        lstruc.intValues.append((quint32)value.toULong());
                         break;
-                    case INT8:
-                    case INT16:
-                    case INT32:
+                    case UAVObjectField::INT8:
+                    case UAVObjectField::INT16:
+                    case UAVObjectField::INT32:
                         lstruc.values.append((qint32)value.toLong());
+                        lstruc.intValues.append((qint32)value.toLong());
                         break;
-                    case FLOAT32:
+                    case UAVObjectField::FLOAT32:
                         lstruc.values.append((float)value.toFloat());
+                        lstruc.floatValues.append(value.toFloat());
                         break;
-                    case ENUM:
+                    case UAVObjectField::ENUM:
                         lstruc.values.append((QString)value);
+                        lstruc.stringValues.append(value);
+                        lstruc.intValues.append(optionIndexes.value(value, -1));
                         break;
-                    case STRING:
+                    case UAVObjectField::STRING:
                         lstruc.values.append((QString)value);
+                        lstruc.stringValues.append(value);
                         break;
                     default:
                         lstruc.values.append(QVariant());
                     }
                 }
+                if (lstruc.type == UAVObjectField::BETWEEN && lstruc.values.length() > 2) {
+                    qDebug() << "limits parsing: between limit with more than 1 pair, using first; field" << name;
+                } else if ((lstruc.type == UAVObjectField::BIGGER || lstruc.type == UAVObjectField::SMALLER) && lstruc.values.length() > 1) {
+                    qDebug() << "limits parsing: bigger/smaller limit with more than 1 value, using first; field" << name;
+                }
                 limitList.append(lstruc);
             } else {
                 if (!valuesPerElement.at(0).isEmpty() && !startFlag) {
@@ -196,267 +250,96 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 }
             }
         }
-        elementLimits.insert(index, limitList);
+        elementLimits.append(limitList);
         ++index;
     }
-    // foreach(QList<LimitStruct> limitList, elementLimits) {
-    // foreach(LimitStruct limit, limitList) {
-    // qDebug() << "Limit type" << limit.type << "for board" << limit.board << "for field" << getName();
-    // foreach(QVariant var, limit.values) {
-    // qDebug() << "value" << var;
-    // }
-    // }
-    // }
 }
+
+/**
+ * Check a value against the limits of an element. The first rule that
+ * applies to the board decides, the limits were parsed and converted to
+ * the field type by limitsInitialize() so this only compares numbers.
+ */
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (index >= (quint32)descriptor->elementLimits.size() || descriptor->elementLimits.at(index).isEmpty()) {
+        return true;
+    }
+
+    // Convert the value once, as the limits were
+    qint64 intValue  = 0;
+    float floatValue = 0;
+    QString stringValue;
+    switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+        intValue = var.toInt();
+        break;
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case BITFIELD:
+        intValue = var.toUInt();
+        break;
+    case FLOAT32:
+        floatValue = var.toFloat();
+        break;
+    case ENUM:
+        stringValue = var.toString();
+        intValue    = descriptor->optionIndexes.value(stringValue, -1);
+        break;
+    case STRING:
+        stringValue = var.toString();
+        break;
+    default:
         return true;
     }
 
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    const QList<LimitStruct> & limitList = descriptor->elementLimits.at(index);
+    for (int i = 0; i < limitList.size(); ++i) {
+        const LimitStruct & struc = limitList.at(i);
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
         switch (struc.type) {
         case EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            default:
-                return true;
-            }
-            break;
         case NOT_EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            default:
-                return true;
+        {
+            bool equal = false;
+            if (type == ENUM || type == STRING) {
+                equal = struc.stringValues.contains(stringValue);
+            } else if (type == FLOAT32) {
+                equal = struc.floatValues.contains(floatValue);
+            } else {
+                equal = struc.intValues.contains(intValue);
             }
-            break;
+            return (struc.type == EQUAL) ? equal : !equal;
+        }
         case BETWEEN:
             if (struc.values.length() < 2) {
-                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << name;
+                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << descriptor->name;
                 return true;
             }
-            if (struc.values.length() > 2) {
-                qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << name;
-            }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt() && var.toInt() <= struc.values.at(1).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt() && var.toUInt() <= struc.values.at(1).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat() && var.toFloat() <= struc.values.at(1).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
+            if (type == STRING) {
                 return true;
+            } else if (type == FLOAT32) {
+                return floatValue >= struc.floatValues.at(0) && floatValue <= struc.floatValues.at(1);
             }
-            break;
+            return intValue >= struc.intValues.at(0) && intValue <= struc.intValues.at(1);
+
         case BIGGER:
+        case SMALLER:
             if (struc.values.length() < 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << name;
+                qDebug() << __FUNCTION__ << "bigger/smaller limit with less than 1 value, aborting; field:" << descriptor->name;
                 return true;
             }
-            if (struc.values.length() > 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with more than 1 value, using first; field" << name;
-            }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
-                return true;
-            }
-            break;
-        case SMALLER:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() <= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() <= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case STRING:
-                return true;
-
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() <= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            default:
+            if (type == STRING) {
                 return true;
+            } else if (type == FLOAT32) {
+                return (struc.type == BIGGER) ? floatValue >= struc.floatValues.at(0) : floatValue <= struc.floatValues.at(0);
             }
+            return (struc.type == BIGGER) ? intValue >= struc.intValues.at(0) : intValue <= struc.intValues.at(0);
         }
     }
     return true;
@@ -464,10 +347,10 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (index >= (quint32)descriptor->elementLimits.size()) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, descriptor->elementLimits.at(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
@@ -480,11 +363,11 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
             break;
             break;
         case BETWEEN:
-            return struc.values.at(1);
+            return struc.values.value(1);
 
             break;
         case SMALLER:
-            return struc.values.at(0);
+            return struc.values.value(0);
 
             break;
         default:
@@ -497,10 +380,10 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (index >= (quint32)descriptor->elementLimits.size()) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, descriptor->elementLimits.at(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             return QVariant();
         }
@@ -513,11 +396,11 @@ QVariant UAVObjectField::getMinLimit(quint32 index, int board)
             break;
             break;
         case BETWEEN:
-            return struc.values.at(0);
+            return struc.values.value(0);
 
             break;
         case BIGGER:
-            return struc.values.at(0);
+            return struc.values.value(0);
 
             break;
         default:
@@ -581,7 +464,7 @@ QString UAVObjectField::getTypeAsString()
 
 QStringList UAVObjectField::getElementNames()
 {
-    return elementNames;
+    return descriptor->elementNames;
 }
 
 UAVObject *UAVObjectField::getObject()
@@ -605,17 +488,17 @@ void UAVObjectField::clear()
 
 QString UAVObjectField::getName()
 {
-    return name;
+    return descriptor->name;
 }
 
 QString UAVObjectField::getUnits()
 {
-    return units;
+    return descriptor->units;
 }
 
 QStringList UAVObjectField::getOptions()
 {
-    return options;
+    return descriptor->options;
 }
 
 quint32 UAVObjectField::getNumElements()
@@ -646,11 +529,11 @@ QString UAVObjectField::toString()
 {
     QString sout;
 
-    sout.append(QString("%1: [ ").arg(name));
+    sout.append(QString("%1: [ ").arg(descriptor->name));
     for (unsigned int n = 0; n < numElements; ++n) {
         sout.append(QString("%1 ").arg(getDouble(n)));
     }
-    sout.append(QString("] %1\n").arg(units));
+    sout.append(QString("] %1\n").arg(descriptor->units));
     return sout;
 }
 
@@ -926,11 +809,11 @@ QVariant UAVObjectField::getValue(quint32 index)
     {
         quint8 tmpenum;
         memcpy(&tmpenum, &data[offset + numBytesPerElement * index], numBytesPerElement);
-        if (tmpenum >= options.length()) {
-            qDebug() << "Invalid value for" << name;
+        if (tmpenum >= descriptor->options.length()) {
+            qDebug() << "Invalid value for" << descriptor->name;
             tmpenum = 0;
         }
-        return QVariant(options[tmpenum]);
+        return QVariant(descriptor->options[tmpenum]);
 
         break;
     }
@@ -956,6 +839,40 @@ QVariant UAVObjectField::getValue(quint32 index)
     return QVariant();
 }
 
+/**
+ * The bytes of an element zero extended to 32 bits, the option index of an
+ * enum and a single bit of a bitfield. Cheap to compare for changes, no
+ * conversion and no QVariant involved. Strings are not supported.
+ */
+quint32 UAVObjectField::getRawValue(quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    if (index >= numElements || type == STRING) {
+        return 0;
+    }
+    if (type == BITFIELD) {
+        return (data[offset + numBytesPerElement * ((quint32)(index / 8))] >> (index % 8)) & 1;
+    }
+    switch (numBytesPerElement) {
+    case 1:
+        return data[offset + index];
+
+    case 2:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, &data[offset + 2 * index], 2);
+        return tmpuint16;
+    }
+    default:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, &data[offset + 4 * index], 4);
+        return tmpuint32;
+    }
+    }
+}
+
 bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
 {
     QMutexLocker locker(obj->getMutex());
@@ -983,7 +900,7 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
             break;
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = descriptor->options.indexOf(value.toString());
             return (tmpenum < 0) ? false : true;
 
             break;
@@ -1054,7 +971,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
         }
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = descriptor->options.indexOf(value.toString());
             // Default to 0 on invalid values.
             if (tmpenum < 0) {
                 tmpenum = 0;
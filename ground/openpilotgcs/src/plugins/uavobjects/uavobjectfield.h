@@ -34,10 +34,19 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QVector>
+#include <QHash>
 #include <QXmlStreamWriter>
 
 class UAVObject;
+class UAVObjectFieldDescriptor;
 
+/**
+ * A field of an object instance. The name, units, type, element names,
+ * options and limits are in a UAVObjectFieldDescriptor shared by all the
+ * instances of the object type, a field only points to it and to the data
+ * of its instance.
+ */
 class UAVOBJECTS_EXPORT UAVObjectField : public QObject {
     Q_OBJECT
 
@@ -48,10 +57,17 @@ public:
         LimitType type;
         QList<QVariant> values;
         int board;
+        // values parsed for the comparisons in isWithinLimits()
+        QVector<qint64> intValues; // integers, bitfields and enum option indexes
+        QVector<float> floatValues;
+        QStringList stringValues;
     } LimitStruct;
 
+    UAVObjectField(const UAVObjectFieldDescriptor *descriptor);
     UAVObjectField(const QString & name, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+    ~UAVObjectField();
+    const UAVObjectFieldDescriptor *getDescriptor() const;
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
     FieldType getType();
@@ -67,6 +83,7 @@ public:
     bool checkValue(const QVariant & data, quint32 index = 0);
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
+    quint32 getRawValue(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
     quint32 getDataOffset();
     quint32 getNumBytes();
@@ -83,19 +100,41 @@ signals:
     void fieldUpdated(UAVObjectField *field);
 
 protected:
-    QString name;
-    QString units;
+    const UAVObjectFieldDescriptor *descriptor;
+    UAVObjectFieldDescriptor *ownDescriptor; // only for fields not built from a shared descriptor
+    // copied from the descriptor, used by every access to the data
     FieldType type;
-    QStringList elementNames;
-    QStringList options;
     quint32 numElements;
     quint32 numBytesPerElement;
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
-    QMap<quint32, QList<LimitStruct> > elementLimits;
     void clear();
-    void constructorInitialize(const QString & name, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
+    void descriptorInitialize(const UAVObjectFieldDescriptor *descriptor);
+};
+
+/**
+ * The immutable part of a field. The generated objects build a table of
+ * descriptors the first time an object of their type is created and all
+ * the instances share it.
+ */
+class UAVOBJECTS_EXPORT UAVObjectFieldDescriptor {
+public:
+    UAVObjectFieldDescriptor(const QString & name, const QString & units, UAVObjectField::FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
+    UAVObjectFieldDescriptor(const QString & name, const QString & units, UAVObjectField::FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+
+    QString name;
+    QString units;
+    UAVObjectField::FieldType type;
+    QStringList elementNames;
+    QStringList options;
+    quint32 numElements;
+    quint32 numBytesPerElement;
+    QVector<QList<UAVObjectField::LimitStruct> > elementLimits; // indexed by element
+    QHash<QString, int> optionIndexes; // enum fields with limits only
+
+private:
+    void initialize(const QString & name, const QString & units, UAVObjectField::FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
 };
 
@@ -14,14 +14,16 @@ HEADERS += \
     uavdataobject.h \
     uavobjectfield.h \
     uavobjectsinit.h \
-    uavobjectsplugin.h
+    uavobjectsplugin.h \
+    uavobjectupdatebus.h
 SOURCES += \
     uavobject.cpp \
     uavmetaobject.cpp \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
-    uavobjectsplugin.cpp
+    uavobjectsplugin.cpp \
+    uavobjectupdatebus.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
 
@@ -102,6 +104,7 @@ HEADERS += \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.h \
     $$UAVOBJECT_SYNTHETICS/taskinfo.h \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.h \
+    $$UAVOBJECT_SYNTHETICS/callbacklatency.h \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.h \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.h \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.h \
@@ -205,6 +208,7 @@ SOURCES += \
     $$UAVOBJECT_SYNTHETICS/flightbatterysettings.cpp \
     $$UAVOBJECT_SYNTHETICS/taskinfo.cpp \
     $$UAVOBJECT_SYNTHETICS/callbackinfo.cpp \
+    $$UAVOBJECT_SYNTHETICS/callbacklatency.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplanstatus.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplansettings.cpp \
     $$UAVOBJECT_SYNTHETICS/flightplancontrol.cpp \
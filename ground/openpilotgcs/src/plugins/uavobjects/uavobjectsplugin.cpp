@@ -27,6 +27,7 @@
  */
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
+#include "uavobjectupdatebus.h"
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
@@ -45,6 +46,8 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
     UAVObjectsInitialize(objMngr);
+    // Frame coalesced updates for the gadgets
+    addAutoReleasedObject(new UAVObjectUpdateBus());
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
@@ -0,0 +1,312 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatebus.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Frame coalesced delivery of object updates to the user interface
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectupdatebus.h"
+#include "uavobjectfield.h"
+#include <QEvent>
+#include <QDebug>
+
+// Hidden widgets are checked this often for becoming visible again
+#define HELD_RECHECK_INTERVAL_MS 250
+
+/**
+ * Constructor
+ */
+UAVObjectUpdateBus::UAVObjectUpdateBus()
+{
+    m_frameTimer.setSingleShot(true);
+    connect(&m_frameTimer, SIGNAL(timeout()), this, SLOT(deliver()));
+}
+
+UAVObjectUpdateBus::~UAVObjectUpdateBus()
+{}
+
+/**
+ * Subscribe a receiver method to the updates of an object
+ */
+void UAVObjectUpdateBus::subscribe(UAVObject *obj, QObject *receiver, const char *method, const QStringList & fields)
+{
+    if (obj == NULL || receiver == NULL) {
+        return;
+    }
+
+    Subscription subscription;
+    subscription.receiver = receiver;
+    subscription.widget   = qobject_cast<QWidget *>(receiver);
+    subscription.method   = method;
+    subscription.pending  = false;
+    foreach(QString name, fields) {
+        UAVObjectField *field = obj->getField(name);
+
+        if (field) {
+            subscription.fields.append(field);
+        } else {
+            qDebug() << "UAVObjectUpdateBus: unknown field" << obj->getName() << name;
+        }
+    }
+
+    if (!m_subscriptions.contains(obj)) {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+    }
+    m_subscriptions[obj].append(subscription);
+
+    if (m_receivers[receiver]++ == 0) {
+        connect(receiver, SIGNAL(destroyed(QObject *)), this, SLOT(receiverDestroyed(QObject *)));
+        if (subscription.widget) {
+            subscription.widget->installEventFilter(this);
+        }
+    }
+}
+
+/**
+ * Remove all subscriptions of a receiver to an object
+ */
+void UAVObjectUpdateBus::unsubscribe(UAVObject *obj, QObject *receiver)
+{
+    QHash<UAVObject *, QList<Subscription> >::iterator it = m_subscriptions.find(obj);
+
+    if (it == m_subscriptions.end()) {
+        return;
+    }
+
+    QList<Subscription> & subscriptions = it.value();
+    int removed = 0;
+    for (int i = subscriptions.size() - 1; i >= 0; --i) {
+        if (subscriptions[i].receiver == receiver) {
+            subscriptions.removeAt(i);
+            removed++;
+        }
+    }
+    if (subscriptions.isEmpty()) {
+        disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+        m_subscriptions.erase(it);
+        m_updated.remove(obj);
+        m_held.remove(obj);
+    }
+    removeReceiver(receiver, removed);
+}
+
+/**
+ * Remove all subscriptions of a receiver
+ */
+void UAVObjectUpdateBus::unsubscribe(QObject *receiver)
+{
+    foreach(UAVObject * obj, m_subscriptions.keys()) {
+        unsubscribe(obj, receiver);
+    }
+}
+
+/**
+ * Hold the updates of a receiver, a paused receiver gets the latest state
+ * of its objects when it is resumed
+ */
+void UAVObjectUpdateBus::setPaused(QObject *receiver, bool paused)
+{
+    if (paused) {
+        m_paused.insert(receiver);
+    } else if (m_paused.remove(receiver)) {
+        resume(receiver);
+    }
+}
+
+/**
+ * Deliver held updates as soon as a widget shows again
+ */
+bool UAVObjectUpdateBus::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Show) {
+        resume(watched);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void UAVObjectUpdateBus::objectUpdated(UAVObject *obj)
+{
+    m_updated.insert(obj);
+    scheduleFrame();
+}
+
+void UAVObjectUpdateBus::receiverDestroyed(QObject *receiver)
+{
+    // the receiver is half destroyed already, only drop our references
+    QHash<UAVObject *, QList<Subscription> >::iterator it = m_subscriptions.begin();
+    while (it != m_subscriptions.end()) {
+        UAVObject *obj = it.key();
+        QList<Subscription> & subscriptions = it.value();
+        for (int i = subscriptions.size() - 1; i >= 0; --i) {
+            if (subscriptions[i].receiver == receiver) {
+                subscriptions.removeAt(i);
+            }
+        }
+        if (subscriptions.isEmpty()) {
+            disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
+            it = m_subscriptions.erase(it);
+            m_updated.remove(obj);
+            m_held.remove(obj);
+        } else {
+            ++it;
+        }
+    }
+    m_receivers.remove(receiver);
+    m_paused.remove(receiver);
+}
+
+/**
+ * Called once per frame, hands the latest state of every object updated
+ * since the last frame to its subscribers. Objects that are only held are
+ * delivered to the subscriptions that still wait for them, the others
+ * have seen the latest state already.
+ */
+void UAVObjectUpdateBus::deliver()
+{
+    struct Delivery {
+        QPointer<QObject> receiver;
+        QByteArray method;
+        UAVObject *obj;
+    };
+    QList<Delivery> deliveries;
+    QSet<UAVObject *> updated = m_updated;
+    QSet<UAVObject *> objects = m_updated | m_held;
+
+    m_updated.clear();
+    m_held.clear();
+
+    // settle what to deliver first, the receivers may (un)subscribe
+    foreach(UAVObject * obj, objects) {
+        QHash<UAVObject *, QList<Subscription> >::iterator it = m_subscriptions.find(obj);
+
+        if (it == m_subscriptions.end()) {
+            continue;
+        }
+        QList<Subscription> & subscriptions = it.value();
+        bool fresh = updated.contains(obj);
+
+        for (int i = 0; i < subscriptions.size(); ++i) {
+            Subscription & subscription = subscriptions[i];
+
+            if (!fresh && !subscription.pending) {
+                continue;
+            }
+            if (isPaused(subscription)) {
+                subscription.pending = true;
+                if (!m_paused.contains(subscription.receiver)) {
+                    m_held.insert(obj);
+                }
+                continue;
+            }
+            subscription.pending = false;
+            if (!subscription.fields.isEmpty()) {
+                QByteArray packed = packFields(subscription.fields);
+                if (packed == subscription.lastFields) {
+                    continue;
+                }
+                subscription.lastFields = packed;
+            }
+
+            Delivery delivery;
+            delivery.receiver = subscription.receiver;
+            delivery.method   = subscription.method;
+            delivery.obj = obj;
+            deliveries.append(delivery);
+        }
+    }
+
+    foreach(const Delivery &delivery, deliveries) {
+        if (delivery.receiver) {
+            QMetaObject::invokeMethod(delivery.receiver, delivery.method.constData(),
+                                      Qt::DirectConnection, Q_ARG(UAVObject *, delivery.obj));
+        }
+    }
+
+    // look again later for widgets that were hidden or minimized
+    if (!m_held.isEmpty() && !m_frameTimer.isActive()) {
+        m_frameTimer.start(HELD_RECHECK_INTERVAL_MS);
+    }
+}
+
+bool UAVObjectUpdateBus::isPaused(const Subscription & subscription) const
+{
+    if (m_paused.contains(subscription.receiver)) {
+        return true;
+    }
+    if (subscription.widget) {
+        return !subscription.widget->isVisible() || subscription.widget->window()->isMinimized();
+    }
+    return false;
+}
+
+QByteArray UAVObjectUpdateBus::packFields(const QList<UAVObjectField *> & fields) const
+{
+    QByteArray packed;
+
+    foreach(UAVObjectField * field, fields) {
+        int offset = packed.size();
+
+        packed.resize(offset + field->getNumBytes());
+        field->pack((quint8 *)packed.data() + offset);
+    }
+    return packed;
+}
+
+void UAVObjectUpdateBus::resume(QObject *receiver)
+{
+    bool pending = false;
+
+    for (QHash<UAVObject *, QList<Subscription> >::const_iterator it = m_subscriptions.constBegin();
+         it != m_subscriptions.constEnd(); ++it) {
+        foreach(const Subscription &subscription, it.value()) {
+            if (subscription.receiver == receiver && subscription.pending) {
+                m_held.insert(it.key());
+                pending = true;
+            }
+        }
+    }
+    if (pending) {
+        scheduleFrame();
+    }
+}
+
+void UAVObjectUpdateBus::scheduleFrame()
+{
+    if (!m_frameTimer.isActive() || m_frameTimer.remainingTime() > FRAME_INTERVAL_MS) {
+        m_frameTimer.start(FRAME_INTERVAL_MS);
+    }
+}
+
+void UAVObjectUpdateBus::removeReceiver(QObject *receiver, int count)
+{
+    if (count == 0 || !m_receivers.contains(receiver)) {
+        return;
+    }
+    m_receivers[receiver] -= count;
+    if (m_receivers[receiver] <= 0) {
+        m_receivers.remove(receiver);
+        m_paused.remove(receiver);
+        disconnect(receiver, SIGNAL(destroyed(QObject *)), this, SLOT(receiverDestroyed(QObject *)));
+        receiver->removeEventFilter(this);
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatebus.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Frame coalesced delivery of object updates to the user interface
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTUPDATEBUS_H
+#define UAVOBJECTUPDATEBUS_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+#include <QObject>
+#include <QPointer>
+#include <QWidget>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QStringList>
+#include <QByteArray>
+
+/**
+ * Telemetry updates objects much faster than the screen refreshes. Gadgets
+ * subscribe here instead of connecting to UAVObject::objectUpdated and get
+ * called at most once per frame with the latest state of the object.
+ *
+ * Subscriptions of a QWidget receiver are held while the widget is hidden or
+ * its window is minimized, the latest update is delivered when it shows
+ * again. Other receivers can be paused explicitly with setPaused().
+ *
+ * The bus is in the plugin manager object pool:
+ *   pm->getObject<UAVObjectUpdateBus>()->subscribe(obj, this, "updateNeedle1");
+ */
+class UAVOBJECTS_EXPORT UAVObjectUpdateBus : public QObject {
+    Q_OBJECT
+
+public:
+    static const int FRAME_INTERVAL_MS = 16;
+
+    UAVObjectUpdateBus();
+    ~UAVObjectUpdateBus();
+
+    /**
+     * Call receiver->method(UAVObject *) after updates of obj. The method is
+     * given by name and must be a slot or Q_INVOKABLE. If fields is not
+     * empty the method is only called when one of these fields changed.
+     */
+    void subscribe(UAVObject *obj, QObject *receiver, const char *method, const QStringList & fields = QStringList());
+    void unsubscribe(UAVObject *obj, QObject *receiver);
+    void unsubscribe(QObject *receiver);
+    void setPaused(QObject *receiver, bool paused);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void receiverDestroyed(QObject *receiver);
+    void deliver();
+
+private:
+    struct Subscription {
+        QObject *receiver;
+        QPointer<QWidget> widget;
+        QByteArray method;
+        QList<UAVObjectField *> fields;
+        QByteArray lastFields;
+        bool pending;
+    };
+
+    QHash<UAVObject *, QList<Subscription> > m_subscriptions;
+    QHash<QObject *, int> m_receivers; // number of subscriptions of each receiver
+    QSet<QObject *> m_paused;
+    QSet<UAVObject *> m_updated; // updated since the last frame, for all subscribers
+    QSet<UAVObject *> m_held; // with held subscriptions, only for those
+    QTimer m_frameTimer;
+
+    bool isPaused(const Subscription & subscription) const;
+    QByteArray packFields(const QList<UAVObjectField *> & fields) const;
+    void resume(QObject *receiver);
+    void scheduleFrame();
+    void removeReceiver(QObject *receiver, int count);
+};
+
+#endif // UAVOBJECTUPDATEBUS_H
@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectbatchupload.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectUtilPlugin UAVObjectUtil Plugin
+ * @{
+ * @brief      Sends and saves a set of objects to the board in a pipeline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectbatchupload.h"
+#include "uavobjectutilmanager.h"
+#include <QDebug>
+
+UAVObjectBatchUpload::UAVObjectBatchUpload(UAVObjectUtilManager *utilManager, QObject *parent) :
+    QObject(parent),
+    m_utilManager(utilManager),
+    m_next(0),
+    m_inFlight(0),
+    m_completed(0),
+    m_operation(SEND),
+    m_running(false)
+{
+    m_stallTimer.setSingleShot(true);
+    connect(&m_stallTimer, SIGNAL(timeout()), this, SLOT(stalled()));
+}
+
+UAVObjectBatchUpload::~UAVObjectBatchUpload()
+{
+    foreach(UAVObject * obj, m_objects) {
+        obj->disconnect(this);
+    }
+}
+
+void UAVObjectBatchUpload::addObject(UAVObject *obj)
+{
+    Q_ASSERT(!m_running);
+    if (!m_status.contains(obj)) {
+        m_objects.append(obj);
+        m_status.insert(obj, PENDING);
+    }
+}
+
+void UAVObjectBatchUpload::clear()
+{
+    Q_ASSERT(!m_running);
+    foreach(UAVObject * obj, m_objects) {
+        obj->disconnect(this);
+    }
+    m_objects.clear();
+    m_status.clear();
+    m_saveQueue.clear();
+}
+
+/**
+ * Starts sending the objects, finished() is emitted once every object
+ * was sent, and saved if asked for, or received, or failed
+ */
+void UAVObjectBatchUpload::start(Operation operation)
+{
+    Q_ASSERT(!m_running);
+    m_operation = operation;
+    m_next      = 0;
+    m_inFlight  = 0;
+    m_completed = 0;
+    m_saveQueue.clear();
+    foreach(UAVObject * obj, m_objects) {
+        m_status[obj] = PENDING;
+    }
+    if (m_objects.isEmpty()) {
+        emit finished(true);
+        return;
+    }
+
+    m_running = true;
+    if (m_operation != SEND && m_operation != REQUEST) {
+        connect(m_utilManager, SIGNAL(saveCompleted(int, bool)), this, SLOT(saveCompleted(int, bool)));
+    }
+    m_stallTimer.start(STALL_TIMEOUT_MS);
+    sendNext();
+}
+
+UAVObjectBatchUpload::Status UAVObjectBatchUpload::status(UAVObject *obj) const
+{
+    return m_status.value(obj, PENDING);
+}
+
+QString UAVObjectBatchUpload::statusText(Status status)
+{
+    switch (status) {
+    case PENDING:
+        return tr("Not sent");
+    case SENDING:
+        return tr("Sending");
+    case SENT:
+        return tr("Sent");
+    case SAVING:
+        return tr("Saving");
+    case SAVED:
+        return tr("Saved");
+    case SEND_FAILED:
+        return tr("Error (Not acknowledged)");
+    case SAVE_FAILED:
+        return tr("Error (Save failed)");
+    case RECEIVED:
+        return tr("Received");
+    case REQUEST_FAILED:
+        return tr("Error (Not received)");
+    }
+    return QString();
+}
+
+/**
+ * Fills the send window. Objects without acked telemetry never complete
+ * a transaction and count as sent right away, a request always completes
+ * with the object or a timeout.
+ */
+void UAVObjectBatchUpload::sendNext()
+{
+    while (m_running && m_inFlight < SEND_WINDOW && m_next < m_objects.count()) {
+        UAVObject *obj = m_objects.at(m_next++);
+        m_status[obj] = SENDING;
+        if (m_operation == SAVE) {
+            sent(obj, true);
+        } else if (m_operation == REQUEST) {
+            m_inFlight++;
+            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+            obj->requestUpdate();
+        } else if (UAVObject::GetGcsTelemetryAcked(obj->getMetadata())) {
+            m_inFlight++;
+            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+            obj->updated();
+        } else {
+            obj->updated();
+            sent(obj, true);
+        }
+    }
+}
+
+void UAVObjectBatchUpload::transactionCompleted(UAVObject *obj, bool success)
+{
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    if (m_status.value(obj) != SENDING) {
+        return;
+    }
+    m_inFlight--;
+    m_stallTimer.start(STALL_TIMEOUT_MS);
+    sent(obj, success);
+    sendNext();
+}
+
+void UAVObjectBatchUpload::sent(UAVObject *obj, bool success)
+{
+    if (m_operation == REQUEST) {
+        complete(obj, success ? RECEIVED : REQUEST_FAILED);
+    } else if (!success) {
+        complete(obj, SEND_FAILED);
+    } else if (m_operation != SEND) {
+        m_status[obj] = SAVING;
+        m_saveQueue.append(obj);
+        m_utilManager->saveObjectToSD(obj);
+    } else {
+        complete(obj, SENT);
+    }
+}
+
+/**
+ * The util manager saves in the order it was asked to, other users of it
+ * can have saves in the same queue
+ */
+void UAVObjectBatchUpload::saveCompleted(int objectID, bool success)
+{
+    if (m_saveQueue.isEmpty() || m_saveQueue.first()->getObjID() != (quint32)objectID) {
+        return;
+    }
+    m_stallTimer.start(STALL_TIMEOUT_MS);
+    complete(m_saveQueue.takeFirst(), success ? SAVED : SAVE_FAILED);
+}
+
+/**
+ * Nothing was acknowledged or saved for STALL_TIMEOUT_MS, fail what is left
+ */
+void UAVObjectBatchUpload::stalled()
+{
+    qDebug() << "UAVObjectBatchUpload: no progress, giving up on" << m_objects.count() - m_completed << "objects";
+    m_saveQueue.clear();
+    foreach(UAVObject * obj, m_objects) {
+        switch (m_status.value(obj)) {
+        case PENDING:
+            complete(obj, m_operation == REQUEST ? REQUEST_FAILED : SEND_FAILED);
+            break;
+        case SENDING:
+            disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+            complete(obj, m_operation == REQUEST ? REQUEST_FAILED : SEND_FAILED);
+            break;
+        case SAVING:
+            complete(obj, SAVE_FAILED);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void UAVObjectBatchUpload::complete(UAVObject *obj, Status status)
+{
+    m_status[obj] = status;
+    m_completed++;
+    emit objectCompleted(obj, status);
+    emit progress(m_completed, m_objects.count());
+    if (m_completed < m_objects.count()) {
+        return;
+    }
+
+    m_running  = false;
+    m_inFlight = 0;
+    m_stallTimer.stop();
+    if (m_operation != SEND && m_operation != REQUEST) {
+        disconnect(m_utilManager, SIGNAL(saveCompleted(int, bool)), this, SLOT(saveCompleted(int, bool)));
+    }
+
+    bool success = true;
+    foreach(UAVObject * object, m_objects) {
+        Status s = m_status.value(object);
+        success &= (s == SENT || s == SAVED || s == RECEIVED);
+    }
+    emit finished(success);
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectbatchupload.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectUtilPlugin UAVObjectUtil Plugin
+ * @{
+ * @brief      Sends and saves a set of objects to the board in a pipeline
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVOBJECTBATCHUPLOAD_H
+#define UAVOBJECTBATCHUPLOAD_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QTimer>
+
+#include "uavobjectutil_global.h"
+#include "uavobject.h"
+
+class UAVObjectUtilManager;
+
+/**
+ * Sends a list of objects to the board keeping up to SEND_WINDOW acked
+ * updates in flight instead of waiting for each ack in turn. With saving
+ * enabled every object is queued for saving as soon as its ack arrives, so
+ * the saves run while the rest is still being sent. SAVE only saves objects
+ * the board already has, REQUEST fetches the board's copy of each object
+ * with the same window.
+ *
+ * The board serves one ObjectPersistence request at a time, the saves go
+ * through UAVObjectUtilManager::saveObjectToSD() which keeps them in order.
+ */
+class UAVOBJECTUTIL_EXPORT UAVObjectBatchUpload : public QObject {
+    Q_OBJECT
+
+public:
+    // Below the telemetry event queue length, so no update is dropped there
+    static const int SEND_WINDOW      = 8;
+    // An upload that makes no progress for this long is given up
+    static const int STALL_TIMEOUT_MS = 5000;
+
+    enum Operation { SEND, SEND_AND_SAVE, SAVE, REQUEST };
+    enum Status { PENDING, SENDING, SENT, SAVING, SAVED, SEND_FAILED, SAVE_FAILED, RECEIVED, REQUEST_FAILED };
+
+    explicit UAVObjectBatchUpload(UAVObjectUtilManager *utilManager, QObject *parent = 0);
+    ~UAVObjectBatchUpload();
+
+    void addObject(UAVObject *obj);
+    void clear();
+    void start(Operation operation);
+
+    bool isRunning() const
+    {
+        return m_running;
+    }
+    int count() const
+    {
+        return m_objects.count();
+    }
+    Status status(UAVObject *obj) const;
+    static QString statusText(Status status);
+
+signals:
+    void objectCompleted(UAVObject *obj, UAVObjectBatchUpload::Status status);
+    void progress(int completed, int total);
+    void finished(bool success);
+
+private slots:
+    void transactionCompleted(UAVObject *obj, bool success);
+    void saveCompleted(int objectID, bool success);
+    void stalled();
+
+private:
+    UAVObjectUtilManager *m_utilManager;
+    QList<UAVObject *> m_objects;
+    QHash<UAVObject *, Status> m_status;
+    QList<UAVObject *> m_saveQueue;
+    QTimer m_stallTimer;
+    int m_next;
+    int m_inFlight;
+    int m_completed;
+    Operation m_operation;
+    bool m_running;
+
+    void sendNext();
+    void sent(UAVObject *obj, bool success);
+    void complete(UAVObject *obj, Status status);
+};
+
+#endif // UAVOBJECTBATCHUPLOAD_H
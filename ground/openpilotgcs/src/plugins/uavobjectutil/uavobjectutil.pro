@@ -8,10 +8,12 @@ HEADERS += uavobjectutil_global.h \
 	uavobjectutilmanager.h \
     uavobjectutilplugin.h \
    devicedescriptorstruct.h \
-    uavobjecthelper.h
+    uavobjecthelper.h \
+    uavobjectbatchupload.h
 
 SOURCES += uavobjectutilmanager.cpp \
     uavobjectutilplugin.cpp \
-    uavobjecthelper.cpp
+    uavobjecthelper.cpp \
+    uavobjectbatchupload.cpp
 
 OTHER_FILES += UAVObjectUtil.pluginspec
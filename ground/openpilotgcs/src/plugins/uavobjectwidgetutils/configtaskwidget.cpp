@@ -133,7 +133,7 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
         Q_ASSERT(object);
         m_updatedObjects.insert(object, true);
         connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(scheduleRefresh(UAVObject *)), Qt::UniqueConnection);
     }
 
     if (!fieldName.isEmpty() && object) {
@@ -146,6 +146,10 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
     binding->setIsEnabled(m_widgetBindingsPerWidget.count(widget) == 0);
     m_widgetBindingsPerWidget.insert(widget, binding);
 
+    if (object && field && widget && !m_widgetBindingsPerField.contains(qMakePair(field, index))) {
+        m_widgetBindingsPerField.insert(qMakePair(field, index), binding);
+    }
+
     if (object) {
         m_widgetBindingsPerObject.insert(object, binding);
         if (m_saveButton) {
@@ -465,20 +469,16 @@ bool ConfigTaskWidget::isDirty()
 void ConfigTaskWidget::disableObjectUpdates()
 {
     m_isWidgetUpdatesAllowed = false;
-    foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
-        if (binding->object()) {
-            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)));
-        }
+    foreach(UAVObject * object, m_widgetBindingsPerObject.uniqueKeys()) {
+        disconnect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(scheduleRefresh(UAVObject *)));
     }
 }
 
 void ConfigTaskWidget::enableObjectUpdates()
 {
     m_isWidgetUpdatesAllowed = true;
-    foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
-        if (binding->object()) {
-            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
-        }
+    foreach(UAVObject * object, m_widgetBindingsPerObject.uniqueKeys()) {
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(scheduleRefresh(UAVObject *)), Qt::UniqueConnection);
     }
 }
 
@@ -487,6 +487,32 @@ void ConfigTaskWidget::objectUpdated(UAVObject *object)
     m_updatedObjects[object] = true;
 }
 
+/**
+ * Objects are often updated several times in a row, on connection or when
+ * a whole settings object is loaded. The widgets bound to an object are
+ * refreshed once, when control returns to the event loop.
+ */
+void ConfigTaskWidget::scheduleRefresh(UAVObject *object)
+{
+    if (m_pendingRefreshObjects.contains(object)) {
+        return;
+    }
+    if (m_pendingRefreshObjects.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(refreshPendingObjects()));
+    }
+    m_pendingRefreshObjects.append(object);
+}
+
+void ConfigTaskWidget::refreshPendingObjects()
+{
+    QList<UAVObject *> objects = m_pendingRefreshObjects;
+
+    m_pendingRefreshObjects.clear();
+    foreach(UAVObject * object, objects) {
+        refreshWidgetsValues(object);
+    }
+}
+
 bool ConfigTaskWidget::allObjectsUpdated()
 {
     bool result = true;
@@ -527,25 +553,31 @@ void ConfigTaskWidget::save()
 bool ConfigTaskWidget::addShadowWidgetBinding(QString objectName, QString fieldName, QWidget *widget, int index, double scale, bool isLimited,
                                               QList<int> *defaultReloadGroups, quint32 instID)
 {
-    foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
-        if (!binding->object() || !binding->widget() || !binding->field()) {
-            continue;
-        }
-        if (binding->matches(objectName, fieldName, index, instID)) {
-            binding->addShadow(widget, scale, isLimited);
+    if (objectName.isEmpty() || fieldName.isEmpty()) {
+        return false;
+    }
+    UAVObject *object = getObject(objectName, instID);
+    if (!object) {
+        return false;
+    }
 
-            m_widgetBindingsPerWidget.insert(widget, binding);
-            connectWidgetUpdatesToSlot(widget, SLOT(widgetsContentsChanged()));
-            if (defaultReloadGroups) {
-                addWidgetToReloadGroups(widget, defaultReloadGroups);
-            }
-            if (binding->isEnabled()) {
-                loadWidgetLimits(widget, binding->field(), binding->index(), isLimited, scale);
-            }
-            return true;
-        }
+    // a binding to the same element exists already, the widget shadows it
+    WidgetBinding *binding = m_widgetBindingsPerField.value(qMakePair(object->getField(fieldName), index), NULL);
+    if (!binding) {
+        return false;
     }
-    return false;
+
+    binding->addShadow(widget, scale, isLimited);
+
+    m_widgetBindingsPerWidget.insert(widget, binding);
+    connectWidgetUpdatesToSlot(widget, SLOT(widgetsContentsChanged()));
+    if (defaultReloadGroups) {
+        addWidgetToReloadGroups(widget, defaultReloadGroups);
+    }
+    if (binding->isEnabled()) {
+        loadWidgetLimits(widget, binding->field(), binding->index(), isLimited, scale);
+    }
+    return true;
 }
 
 void ConfigTaskWidget::autoLoadWidgets()
@@ -680,20 +712,10 @@ void ConfigTaskWidget::autoLoadWidgets()
 
 void ConfigTaskWidget::addWidgetToReloadGroups(QWidget *widget, QList<int> *reloadGroupIDs)
 {
-    foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
-        bool addBinding = false;
-
-        if (binding->widget() == widget) {
-            addBinding = true;
-        } else {
-            foreach(ShadowWidgetBinding * shadow, binding->shadows()) {
-                if (shadow->widget() == widget) {
-                    addBinding = true;
-                }
-            }
-        }
-        if (addBinding) {
-            foreach(int groupID, *reloadGroupIDs) {
+    // the bindings of a widget, as main widget or as shadow
+    foreach(WidgetBinding * binding, m_widgetBindingsPerWidget.values(widget)) {
+        foreach(int groupID, *reloadGroupIDs) {
+            if (!m_reloadGroups.contains(groupID, binding)) {
                 m_reloadGroups.insert(groupID, binding);
             }
         }
@@ -34,6 +34,8 @@
 #include <QQueue>
 #include <QWidget>
 #include <QList>
+#include <QHash>
+#include <QPair>
 #include <QLabel>
 #include "smartsavebutton.h"
 #include "mixercurvewidget.h"
@@ -176,6 +178,8 @@ signals:
 
 private slots:
     void objectUpdated(UAVObject *object);
+    void scheduleRefresh(UAVObject *object);
+    void refreshPendingObjects();
     void defaultButtonClicked();
     void reloadButtonClicked();
 
@@ -210,6 +214,8 @@ private:
     QMultiHash<int, WidgetBinding *> m_reloadGroups;
     QMultiHash<QWidget *, WidgetBinding *> m_widgetBindingsPerWidget;
     QMultiHash<UAVObject *, WidgetBinding *> m_widgetBindingsPerObject;
+    QHash<QPair<UAVObjectField *, int>, WidgetBinding *> m_widgetBindingsPerField;
+    QList<UAVObject *> m_pendingRefreshObjects;
 
     ExtensionSystem::PluginManager *m_pluginManager;
     UAVObjectUtilManager *m_objectUtilManager;
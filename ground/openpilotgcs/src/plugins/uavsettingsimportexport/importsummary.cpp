@@ -47,6 +47,13 @@ ImportSummaryDialog::ImportSummaryDialog(QWidget *parent) :
 
     // Connect the help button
     connect(ui->helpButton, SIGNAL(clicked()), this, SLOT(openHelp()));
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    batch = new UAVObjectBatchUpload(pm->getObject<UAVObjectUtilManager>(), this);
+    connect(batch, SIGNAL(objectCompleted(UAVObject *, UAVObjectBatchUpload::Status)),
+            this, SLOT(objectCompleted(UAVObject *, UAVObjectBatchUpload::Status)));
+    connect(batch, SIGNAL(progress(int, int)), this, SLOT(updateSaveCompletion(int, int)));
+    connect(batch, SIGNAL(finished(bool)), this, SLOT(batchFinished()));
 }
 
 ImportSummaryDialog::~ImportSummaryDialog()
@@ -91,53 +98,121 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     this->showEvent(NULL);
 }
 
+int ImportSummaryDialog::findLine(QString uavObjectName)
+{
+    for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
+        if (ui->importSummaryList->item(i, 1)->text() == uavObjectName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+   Requests the board's copy of the objects, all at once, and waits
+   for it. Returns the objects the board answered for.
+ */
+QList<UAVObject *> ImportSummaryDialog::fetch(const QList<UAVObject *> & objects)
+{
+    QEventLoop loop;
+    QList<UAVObject *> received;
+
+    batch->clear();
+    foreach(UAVObject * obj, objects) {
+        batch->addObject(obj);
+    }
+    connect(batch, SIGNAL(finished(bool)), &loop, SLOT(quit()));
+    ui->saveToFlash->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+    batch->start(UAVObjectBatchUpload::REQUEST);
+    if (batch->isRunning()) {
+        loop.exec();
+    }
+    foreach(UAVObject * obj, objects) {
+        if (batch->status(obj) == UAVObjectBatchUpload::RECEIVED) {
+            received.append(obj);
+        }
+    }
+    batch->clear();
+    return received;
+}
+
+/*
+   Sends the imported objects to the board, all at once,
+   the lines of those which fail are updated
+ */
+void ImportSummaryDialog::upload(const QList<UAVObject *> & objects)
+{
+    batch->clear();
+    foreach(UAVObject * obj, objects) {
+        batch->addObject(obj);
+    }
+    ui->saveToFlash->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+    batch->start(UAVObjectBatchUpload::SEND);
+}
+
 /*
    Saves every checked UAVObjet in the list to Flash
  */
 void ImportSummaryDialog::doTheSaving()
 {
-    int itemCount = 0;
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVObjectUtilManager *utilManager  = pm->getObject<UAVObjectUtilManager>();
-
-    connect(utilManager, SIGNAL(saveCompleted(int, bool)), this, SLOT(updateSaveCompletion()));
 
+    batch->clear();
     for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
+        QString uavObjectName = ui->importSummaryList->item(i, 1)->text();
         QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(i, 0));
         if (box->isChecked()) {
-            ++itemCount;
+            batch->addObject(objManager->getObject(uavObjectName));
         }
     }
-    if (itemCount == 0) {
+    if (batch->count() == 0) {
         return;
     }
-    ui->progressBar->setMaximum(itemCount + 1);
+    ui->progressBar->setMaximum(batch->count() + 1);
     ui->progressBar->setValue(1);
-    for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
-        QString uavObjectName = ui->importSummaryList->item(i, 1)->text();
-        QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(i, 0));
-        if (box->isChecked()) {
-            UAVObject *obj = objManager->getObject(uavObjectName);
-            utilManager->saveObjectToSD(obj);
-            this->repaint();
-        }
-    }
-
     ui->saveToFlash->setEnabled(false);
     ui->closeButton->setEnabled(false);
+
+    // The board holds the imported values of every selected object, they
+    // matched its copy or were sent and acknowledged on import
+    batch->start(UAVObjectBatchUpload::SAVE);
 }
 
+void ImportSummaryDialog::updateSaveCompletion(int completed, int total)
+{
+    ui->progressBar->setMaximum(total + 1);
+    ui->progressBar->setValue(completed + 1);
+}
 
-void ImportSummaryDialog::updateSaveCompletion()
+/*
+   Reports how the upload or the save of an object went,
+   only failures replace the import status of a sent object
+ */
+void ImportSummaryDialog::objectCompleted(UAVObject *obj, UAVObjectBatchUpload::Status status)
 {
-    ui->progressBar->setValue(ui->progressBar->value() + 1);
-    if (ui->progressBar->value() == ui->progressBar->maximum()) {
-        ui->saveToFlash->setEnabled(true);
-        ui->closeButton->setEnabled(true);
+    int row = findLine(obj->getName());
+
+    if (row < 0 || status == UAVObjectBatchUpload::SENT) {
+        return;
     }
+    ui->importSummaryList->item(row, 2)->setText(UAVObjectBatchUpload::statusText(status));
+    if (status == UAVObjectBatchUpload::SEND_FAILED) {
+        QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(row, 0));
+        box->setChecked(false);
+    }
+}
+
+void ImportSummaryDialog::batchFinished()
+{
+    ui->saveToFlash->setEnabled(true);
+    ui->closeButton->setEnabled(true);
+    showEvent(NULL);
 }
 
+
 void ImportSummaryDialog::changeEvent(QEvent *e)
 {
     QDialog::changeEvent(e);
@@ -28,6 +28,7 @@
 #define IMPORTSUMMARY_H
 
 #include <QDialog>
+#include <QEventLoop>
 #include <QCheckBox>
 #include <QDesktopServices>
 #include <QUrl>
@@ -36,6 +37,7 @@
 #include "uavobjectmanager.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectutil/uavobjectutilmanager.h"
+#include "uavobjectutil/uavobjectbatchupload.h"
 
 
 namespace Ui {
@@ -49,6 +51,8 @@ public:
     ImportSummaryDialog(QWidget *parent = 0);
     ~ImportSummaryDialog();
     void addLine(QString objectName, QString text, bool status);
+    QList<UAVObject *> fetch(const QList<UAVObject *> & objects);
+    void upload(const QList<UAVObject *> & objects);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -56,9 +60,13 @@ protected:
 
 private:
     Ui::ImportSummaryDialog *ui;
+    UAVObjectBatchUpload *batch;
+    int findLine(QString objectName);
 
 public slots:
-    void updateSaveCompletion();
+    void updateSaveCompletion(int completed, int total);
+    void objectCompleted(UAVObject *obj, UAVObjectBatchUpload::Status status);
+    void batchFinished();
 
 private slots:
     void doTheSaving();
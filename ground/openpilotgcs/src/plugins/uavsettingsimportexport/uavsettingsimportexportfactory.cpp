@@ -42,6 +42,7 @@
 // for UAVObjects
 #include "uavdataobject.h"
 #include "uavobjectmanager.h"
+#include "gcstelemetrystats.h"
 #include "extensionsystem/pluginmanager.h"
 
 // for XML object
@@ -141,6 +142,27 @@ void UAVSettingsImportExportFactory::importUAVSettings()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     swui.show();
 
+    // The GCS copy may be older than the board's, fetch the board's copy
+    // of every object in the file to compare the imported values with
+    QList<UAVObject *> objects;
+    for (QDomElement e = root.firstChildElement("object"); !e.isNull(); e = e.nextSiblingElement("object")) {
+        UAVObject *obj = objManager->getObject(e.attribute("name"));
+        if (obj) {
+            objects.append(obj);
+        }
+    }
+    QList<UAVObject *> received;
+    GCSTelemetryStats::DataFields gcsStats = GCSTelemetryStats::GetInstance(objManager)->getData();
+    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        received = swui.fetch(objects);
+    }
+
+    // Objects whose imported values differ from the board's copy, or whose
+    // copy did not arrive, these are sent together once the whole file is
+    // read. The board's copy is what its RAM holds, not its flash, so the
+    // objects left unsent are still selected for saving.
+    QList<UAVObject *> changed;
+
     QDomNode node = root.firstChild();
     while (!node.isNull()) {
         QDomElement e = node.toElement();
@@ -157,9 +179,11 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                 swui.addLine(uavObjectName, "Error (Object unknown)", false);
             } else {
                 // - Update each field
-                // - Issue and "updated" command
+                // - Queue an "updated" command if anything changed
                 bool error     = false;
                 bool setError  = false;
+                QByteArray before(obj->getNumBytes(), 0);
+                obj->pack((quint8 *)before.data());
                 QDomNode field = node.firstChild();
                 while (!field.isNull()) {
                     QDomElement f = field.toElement();
@@ -194,7 +218,12 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     }
                     field = field.nextSibling();
                 }
-                obj->updated();
+                QByteArray after(obj->getNumBytes(), 0);
+                obj->pack((quint8 *)after.data());
+                bool unchanged = (before == after) && received.contains(obj);
+                if (!unchanged) {
+                    changed.append(obj);
+                }
 
                 if (error) {
                     swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
@@ -203,6 +232,8 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
                 } else if (setError) {
                     swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+                } else if (unchanged) {
+                    swui.addLine(uavObjectName, "OK (same as board, not sent)", true);
                 } else {
                     swui.addLine(uavObjectName, "OK", true);
                 }
@@ -210,7 +241,8 @@ void UAVSettingsImportExportFactory::importUAVSettings()
         }
         node = node.nextSibling();
     }
-    qDebug() << "End import";
+    qDebug() << "End import," << changed.count() << "objects changed";
+    swui.upload(changed);
     swui.exec();
 }
 
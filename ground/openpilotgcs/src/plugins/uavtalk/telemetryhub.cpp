@@ -0,0 +1,460 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryhub.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Shares the telemetry link with local TCP and UDP clients
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryhub.h"
+#include <utils/crc.h>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QUdpSocket>
+#include <QQueue>
+#include <QSet>
+#include <QtEndian>
+#include <QDebug>
+
+// UAVTalk framing, as in UAVTalk
+#define SYNC_VAL           0x3C
+#define TYPE_MASK          0xF8
+#define TYPE_VER           0x20
+#define HEADER_LENGTH      10
+#define MAX_PAYLOAD_LENGTH 256
+#define CHECKSUM_LENGTH    1
+
+// How often forgotten UDP clients are looked for
+#define EXPIRY_INTERVAL_MS 1000
+
+using namespace Utils;
+
+struct TelemetryHub::Client {
+    Client(QTcpSocket *socket, const QHostAddress &address, quint16 port, qint64 now) :
+        socket(socket),
+        address(address),
+        port(port),
+        lastSeen(now),
+        queueHead(0),
+        queueCount(0),
+        queueBytes(0),
+        tokens(WRITE_BURST),
+        lastRefill(now)
+    {}
+
+    QTcpSocket *socket; // NULL for a UDP client
+    QHostAddress address;
+    quint16 port;
+    qint64 lastSeen;
+
+    // Objects subscribed to, none for all of them
+    QSet<quint32> objects;
+
+    // Frames waiting to go out to the client, a ring of shared frames
+    QByteArray queue[CLIENT_QUEUE_FRAMES];
+    int queueHead;
+    int queueCount;
+    qint64 queueBytes;
+
+    // The start of a frame the client is still sending
+    QByteArray rxBuffer;
+
+    // Frames from the client waiting for the link
+    QQueue<QByteArray> writes;
+    double tokens;
+    qint64 lastRefill;
+};
+
+static quint32 frameObjectId(const QByteArray &frame)
+{
+    return qFromLittleEndian<quint32>((const uchar *)frame.constData() + 4);
+}
+
+TelemetryHub::TelemetryHub(QObject *parent) :
+    QObject(parent),
+    m_server(NULL),
+    m_udpSocket(NULL),
+    m_link(NULL),
+    m_lastExpiry(0),
+    m_nextWriter(0),
+    m_sendingWrites(false)
+{
+    memset(&m_stats, 0, sizeof(Stats));
+    m_clock.start();
+    m_writeTimer.setInterval(WRITE_INTERVAL_MS);
+    connect(&m_writeTimer, SIGNAL(timeout()), this, SLOT(sendWrites()));
+}
+
+TelemetryHub::~TelemetryHub()
+{
+    close();
+}
+
+/**
+ * Accepts clients on the local TCP port and UDP port of the same number,
+ * any free one if port is 0
+ */
+bool TelemetryHub::listen(quint16 port)
+{
+    close();
+
+    m_server = new QTcpServer(this);
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "TelemetryHub - error : can not listen on TCP port" << port << m_server->errorString();
+        close();
+        return false;
+    }
+    m_udpSocket = new QUdpSocket(this);
+    if (!m_udpSocket->bind(QHostAddress::LocalHost, m_server->serverPort())) {
+        qWarning() << "TelemetryHub - error : can not bind UDP port" << m_server->serverPort() << m_udpSocket->errorString();
+        close();
+        return false;
+    }
+    connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+    connect(m_udpSocket, SIGNAL(readyRead()), this, SLOT(udpReadyRead()));
+    return true;
+}
+
+void TelemetryHub::close()
+{
+    m_writeTimer.stop();
+    while (!m_clients.isEmpty()) {
+        removeClient(m_clients.first());
+    }
+    delete m_server;
+    m_server    = NULL;
+    delete m_udpSocket;
+    m_udpSocket = NULL;
+}
+
+quint16 TelemetryHub::port() const
+{
+    return m_server ? m_server->serverPort() : 0;
+}
+
+/**
+ * Sets where the clients' frames go, they are dropped until it is set
+ */
+void TelemetryHub::setLink(Link *link)
+{
+    m_link = link;
+}
+
+/**
+ * Bytes the hub holds for its clients, both ways
+ */
+qint64 TelemetryHub::queuedBytes() const
+{
+    qint64 bytes = 0;
+
+    foreach(Client * client, m_clients) {
+        bytes += client->queueBytes + client->rxBuffer.size();
+        if (client->socket) {
+            bytes += client->socket->bytesToWrite();
+        }
+        foreach(const QByteArray &frame, client->writes) {
+            bytes += frame.size();
+        }
+    }
+    return bytes;
+}
+
+/**
+ * A frame that went over the link, in either direction
+ */
+void TelemetryHub::forwardFrame(const QByteArray &frame)
+{
+    if (frame.size() < HEADER_LENGTH + CHECKSUM_LENGTH) {
+        return;
+    }
+    m_stats.framesForwarded++;
+    expireUdpClients();
+    distribute(frame, NULL);
+}
+
+void TelemetryHub::newConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        m_clients.append(new Client(socket, socket->peerAddress(), socket->peerPort(), m_clock.elapsed()));
+        connect(socket, SIGNAL(readyRead()), this, SLOT(tcpReadyRead()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(tcpBytesWritten()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(tcpDisconnected()));
+    }
+}
+
+void TelemetryHub::tcpReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    Client *client     = findClient(socket);
+
+    if (client) {
+        QByteArray data = socket->readAll();
+        receive(client, data.constData(), data.size());
+    }
+}
+
+void TelemetryHub::tcpBytesWritten()
+{
+    Client *client = findClient(qobject_cast<QTcpSocket *>(sender()));
+
+    if (client) {
+        flush(client);
+    }
+}
+
+void TelemetryHub::tcpDisconnected()
+{
+    Client *client = findClient(qobject_cast<QTcpSocket *>(sender()));
+
+    if (client) {
+        removeClient(client);
+    }
+}
+
+void TelemetryHub::udpReadyRead()
+{
+    QByteArray datagram;
+    QHostAddress address;
+    quint16 port;
+
+    while (m_udpSocket->hasPendingDatagrams()) {
+        datagram.resize(m_udpSocket->pendingDatagramSize());
+        if (m_udpSocket->readDatagram(datagram.data(), datagram.size(), &address, &port) < 0) {
+            continue;
+        }
+        Client *client = findClient(address, port);
+        if (!client) {
+            client = new Client(NULL, address, port, m_clock.elapsed());
+            m_clients.append(client);
+        }
+        client->lastSeen = m_clock.elapsed();
+        receive(client, datagram.constData(), datagram.size());
+        // frames do not span datagrams
+        client->rxBuffer.clear();
+    }
+}
+
+TelemetryHub::Client *TelemetryHub::findClient(QTcpSocket *socket) const
+{
+    foreach(Client * client, m_clients) {
+        if (socket && client->socket == socket) {
+            return client;
+        }
+    }
+    return NULL;
+}
+
+TelemetryHub::Client *TelemetryHub::findClient(const QHostAddress &address, quint16 port) const
+{
+    foreach(Client * client, m_clients) {
+        if (!client->socket && client->port == port && client->address == address) {
+            return client;
+        }
+    }
+    return NULL;
+}
+
+void TelemetryHub::removeClient(Client *client)
+{
+    m_clients.removeOne(client);
+    if (client->socket) {
+        client->socket->disconnect(this);
+        client->socket->abort();
+        client->socket->deleteLater();
+    }
+    delete client;
+}
+
+void TelemetryHub::expireUdpClients()
+{
+    qint64 now = m_clock.elapsed();
+
+    if (m_sendingWrites || now - m_lastExpiry < EXPIRY_INTERVAL_MS) {
+        return;
+    }
+    m_lastExpiry = now;
+    foreach(Client * client, m_clients) {
+        if (!client->socket && now - client->lastSeen > UDP_CLIENT_TIMEOUT_MS) {
+            removeClient(client);
+        }
+    }
+}
+
+/**
+ * Splits what a client sent into frames, skipping bytes that do not start
+ * a frame with a good checksum
+ */
+void TelemetryHub::receive(Client *client, const char *data, int size)
+{
+    client->rxBuffer.append(data, size);
+
+    const quint8 *buffer = (const quint8 *)client->rxBuffer.constData();
+    int available = client->rxBuffer.size();
+    int offset    = 0;
+
+    while (available - offset >= HEADER_LENGTH + CHECKSUM_LENGTH) {
+        const quint8 *frame = buffer + offset;
+        int length = qFromLittleEndian<quint16>(frame + 2);
+
+        if (frame[0] != SYNC_VAL || (frame[1] & TYPE_MASK) != TYPE_VER ||
+            length < HEADER_LENGTH || length > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            m_stats.badBytes++;
+            offset++;
+            continue;
+        }
+        if (available - offset < length + CHECKSUM_LENGTH) {
+            break;
+        }
+        if (Crc::updateCRC(0, frame, length) != frame[length]) {
+            m_stats.badBytes++;
+            offset++;
+            continue;
+        }
+        handleFrame(client, QByteArray((const char *)frame, length + CHECKSUM_LENGTH));
+        offset += length + CHECKSUM_LENGTH;
+    }
+    client->rxBuffer.remove(0, offset);
+}
+
+void TelemetryHub::handleFrame(Client *client, const QByteArray &frame)
+{
+    quint8 type = frame.at(1);
+
+    if (type == TYPE_SUBSCRIBE) {
+        client->objects.insert(frameObjectId(frame));
+    } else if (type == TYPE_UNSUBSCRIBE) {
+        client->objects.remove(frameObjectId(frame));
+    } else if (client->writes.count() >= WRITE_QUEUE_FRAMES) {
+        m_stats.writesDropped++;
+    } else {
+        client->writes.enqueue(frame);
+        m_stats.writesQueued++;
+        if (!m_writeTimer.isActive()) {
+            m_writeTimer.start();
+        }
+    }
+}
+
+/**
+ * Sends what the clients wrote, one frame per client in turn while their
+ * rate allows. The client served first changes each time.
+ */
+void TelemetryHub::sendWrites()
+{
+    qint64 now   = m_clock.elapsed();
+    bool pending = false;
+
+    foreach(Client * client, m_clients) {
+        client->tokens     = qMin((double)WRITE_BURST, client->tokens + (now - client->lastRefill) * WRITE_RATE / 1000.0);
+        client->lastRefill = now;
+    }
+
+    // The link forwards what it sends in reply to a write straight back,
+    // no client is expired until all are served. distribute() does not add
+    // or remove clients.
+    m_sendingWrites = true;
+
+    int count = m_clients.count();
+    bool sent = true;
+    while (sent) {
+        sent = false;
+        for (int n = 0; n < count; n++) {
+            Client *client = m_clients.at((m_nextWriter + n) % count);
+            if (client->writes.isEmpty() || client->tokens < 1) {
+                continue;
+            }
+            client->tokens -= 1;
+            QByteArray frame = client->writes.dequeue();
+            if (m_link && m_link->sendFrame(frame)) {
+                m_stats.writesSent++;
+                // the other clients see it as if it came over the link
+                distribute(frame, client);
+            } else {
+                m_stats.writesFailed++;
+            }
+            sent = true;
+        }
+    }
+    m_sendingWrites = false;
+    m_nextWriter    = (count > 0) ? (m_nextWriter + 1) % count : 0;
+
+    foreach(Client * client, m_clients) {
+        pending |= !client->writes.isEmpty();
+    }
+    if (!pending) {
+        m_writeTimer.stop();
+    }
+}
+
+void TelemetryHub::distribute(const QByteArray &frame, Client *origin)
+{
+    quint32 objId = frameObjectId(frame);
+
+    foreach(Client * client, m_clients) {
+        if (client == origin || (!client->objects.isEmpty() && !client->objects.contains(objId))) {
+            continue;
+        }
+        if (client->queueCount == CLIENT_QUEUE_FRAMES) {
+            // the client does not keep up, the oldest frame makes room
+            QByteArray &oldest = client->queue[client->queueHead];
+            client->queueBytes -= oldest.size();
+            oldest.clear();
+            client->queueHead   = (client->queueHead + 1) % CLIENT_QUEUE_FRAMES;
+            client->queueCount--;
+            m_stats.framesDropped++;
+        }
+        client->queue[(client->queueHead + client->queueCount) % CLIENT_QUEUE_FRAMES] = frame;
+        client->queueCount++;
+        client->queueBytes += frame.size();
+        m_stats.framesQueued++;
+        flush(client);
+    }
+}
+
+/**
+ * Moves queued frames to the client's socket, a TCP client only gets
+ * SOCKET_BACKLOG bytes ahead of what it has taken
+ */
+void TelemetryHub::flush(Client *client)
+{
+    while (client->queueCount > 0) {
+        QByteArray &frame = client->queue[client->queueHead];
+        if (client->socket) {
+            if (client->socket->bytesToWrite() >= SOCKET_BACKLOG) {
+                break;
+            }
+            client->socket->write(frame);
+        } else {
+            m_udpSocket->writeDatagram(frame, client->address, client->port);
+        }
+        client->queueBytes -= frame.size();
+        frame.clear();
+        client->queueHead   = (client->queueHead + 1) % CLIENT_QUEUE_FRAMES;
+        client->queueCount--;
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryhub.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Shares the telemetry link with local TCP and UDP clients
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYHUB_H
+#define TELEMETRYHUB_H
+
+#include "uavtalk_global.h"
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtNetwork/QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+
+/**
+ * Hands every UAVTalk frame of the link to any number of local clients,
+ * on a TCP connection or as UDP datagrams, and sends the frames they write
+ * back out through the link.
+ *
+ * Each client gets the frames of the objects it subscribed to, all of them
+ * until it subscribes to any, in the order they were forwarded. A frame is
+ * queued for a client by reference, never copied. A client that does not
+ * keep up has its oldest frames dropped once CLIENT_QUEUE_FRAMES are
+ * waiting, so the memory it can hold up is bounded.
+ *
+ * Clients subscribe with a frame of type TYPE_SUBSCRIBE or
+ * TYPE_UNSUBSCRIBE carrying the object ID and no data. Any other frame is
+ * queued for the link, at most WRITE_QUEUE_FRAMES per client, and the
+ * queues are served round robin at up to WRITE_RATE frames per second per
+ * client. A frame the link takes is shown to the other clients, one it
+ * does not take is counted in writesFailed and dropped. A UDP client is known by the address it sends from and is
+ * forgotten after UDP_CLIENT_TIMEOUT_MS without a datagram, an unsubscribe
+ * from object 0 registers it or keeps it registered without changing its
+ * subscriptions.
+ */
+class UAVTALK_EXPORT TelemetryHub : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * Where the clients' frames are sent, the link
+     */
+    class Link {
+public:
+        virtual ~Link() {}
+        // Sends a complete frame, false if the link could not take it
+        virtual bool sendFrame(const QByteArray &frame) = 0;
+    };
+
+    static const quint8 TYPE_SUBSCRIBE      = 0x26;
+    static const quint8 TYPE_UNSUBSCRIBE    = 0x27;
+
+    // Frames waiting for one client before the oldest are dropped
+    static const int CLIENT_QUEUE_FRAMES    = 256;
+    // Bytes given to a client's socket ahead of what it has sent
+    static const int SOCKET_BACKLOG         = 4096;
+    // Frames a client may have waiting for the link
+    static const int WRITE_QUEUE_FRAMES     = 32;
+    // Frames per second and burst a client may send through the link
+    static const int WRITE_RATE             = 50;
+    static const int WRITE_BURST            = 10;
+    static const int WRITE_INTERVAL_MS      = 10;
+    static const int UDP_CLIENT_TIMEOUT_MS  = 30000;
+
+    typedef struct {
+        quint32 framesForwarded;
+        quint32 framesQueued;
+        quint32 framesDropped;
+        quint32 writesQueued;
+        quint32 writesSent;
+        quint32 writesFailed;
+        quint32 writesDropped;
+        quint32 badBytes;
+    } Stats;
+
+    explicit TelemetryHub(QObject *parent = 0);
+    ~TelemetryHub();
+
+    bool listen(quint16 port);
+    void close();
+    quint16 port() const;
+    void setLink(Link *link);
+
+    int clientCount() const
+    {
+        return m_clients.count();
+    }
+    qint64 queuedBytes() const;
+    Stats getStats() const
+    {
+        return m_stats;
+    }
+
+public slots:
+    void forwardFrame(const QByteArray &frame);
+
+private slots:
+    void newConnection();
+    void tcpReadyRead();
+    void tcpBytesWritten();
+    void tcpDisconnected();
+    void udpReadyRead();
+    void sendWrites();
+
+private:
+    struct Client;
+
+    QTcpServer *m_server;
+    QUdpSocket *m_udpSocket;
+    Link *m_link;
+    QList<Client *> m_clients;
+    QTimer m_writeTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastExpiry;
+    int m_nextWriter;
+    bool m_sendingWrites;
+    Stats m_stats;
+
+    Client *findClient(QTcpSocket *socket) const;
+    Client *findClient(const QHostAddress &address, quint16 port) const;
+    void removeClient(Client *client);
+    void receive(Client *client, const char *data, int size);
+    void handleFrame(Client *client, const QByteArray &frame);
+    void distribute(const QByteArray &frame, Client *origin);
+    void flush(Client *client);
+    void expireUdpClients();
+};
+
+#endif // TELEMETRYHUB_H
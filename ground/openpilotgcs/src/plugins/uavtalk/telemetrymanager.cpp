@@ -26,11 +26,13 @@
  */
 
 #include "telemetrymanager.h"
+#include "telemetryhub.h"
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
+#include <coreplugin/generalsettings.h>
 
-TelemetryManager::TelemetryManager() : autopilotConnected(false)
+TelemetryManager::TelemetryManager() : hub(NULL), autopilotConnected(false)
 {
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
     // Get UAVObjectManager instance
@@ -86,6 +88,19 @@ void TelemetryManager::onStart()
         connect(device, SIGNAL(readyRead()), utalk, SLOT(processInputStream()));
     }
 
+    // Local programs share the link through the hub, if it is enabled
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    if (settings->telemetryHubPort() > 0) {
+        hub = new TelemetryHub();
+        if (hub->listen(settings->telemetryHubPort())) {
+            utalk->setTelemetryHub(hub);
+        } else {
+            delete hub;
+            hub = NULL;
+        }
+    }
+
     telemetry    = new Telemetry(utalk, objMngr);
     telemetryMon = new TelemetryMonitor(objMngr, telemetry);
 
@@ -109,6 +124,8 @@ void TelemetryManager::onStop()
     telemetryMon->disconnect(this);
     delete telemetryMon;
     delete telemetry;
+    delete hub;
+    hub = NULL;
     delete utalk;
     onDisconnect();
 }
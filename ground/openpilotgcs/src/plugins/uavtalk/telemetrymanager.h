@@ -36,6 +36,8 @@
 #include <QIODevice>
 #include <QObject>
 
+class TelemetryHub;
+
 class UAVTALK_EXPORT TelemetryManager : public QObject {
     Q_OBJECT
 
@@ -66,6 +68,7 @@ private:
     UAVTalk *utalk;
     Telemetry *telemetry;
     TelemetryMonitor *telemetryMon;
+    TelemetryHub *hub;
     QIODevice *device;
     bool autopilotConnected;
     QThread readerThread;
@@ -0,0 +1,441 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryhubtest.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Telemetry hub delivery, ordering, memory and write arbitration
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QUdpSocket>
+#include <utils/crc.h>
+#include "telemetryhub.h"
+
+using namespace Utils;
+
+#define TYPE_OBJ         0x20
+
+// Objects of the recording, updated every frame, every 5th and every 20th
+#define ATTITUDE_OBJID   0x1000
+#define GPS_OBJID        0x2000
+#define STATS_OBJID      0x3000
+// Objects written by the clients
+#define SETTINGS_A_OBJID 0x4000
+#define SETTINGS_B_OBJID 0x5000
+
+// Frames replayed for the delivery test, and to a client that does not read
+#define DELIVERY_FRAMES  2000
+#define SLOW_FRAMES      100000
+// Frames between two waits for the clients, the link delivers in chunks too
+#define CHUNK_FRAMES     50
+#define PAYLOAD_LENGTH   64
+#define TIMEOUT_MS       10000
+
+/**
+ * Collects the frames a client socket receives, unless told to hold back
+ */
+class FrameCollector : public QObject {
+    Q_OBJECT
+
+public:
+    FrameCollector(QTcpSocket *socket) : reading(true), m_tcp(socket), m_udp(NULL)
+    {
+        connect(socket, SIGNAL(readyRead()), this, SLOT(read()));
+    }
+    FrameCollector(QUdpSocket *socket) : reading(true), m_tcp(NULL), m_udp(socket)
+    {
+        connect(socket, SIGNAL(readyRead()), this, SLOT(read()));
+    }
+
+    QList<QByteArray> frames;
+    bool reading;
+
+public slots:
+    void read()
+    {
+        if (!reading) {
+            return;
+        }
+        if (m_udp) {
+            while (m_udp->hasPendingDatagrams()) {
+                QByteArray datagram;
+                datagram.resize(m_udp->pendingDatagramSize());
+                m_udp->readDatagram(datagram.data(), datagram.size());
+                frames.append(datagram);
+            }
+            return;
+        }
+        m_buffer.append(m_tcp->readAll());
+        while (m_buffer.size() >= 4) {
+            int length = qFromLittleEndian<quint16>((const uchar *)m_buffer.constData() + 2) + 1;
+            if (m_buffer.size() < length) {
+                break;
+            }
+            frames.append(m_buffer.left(length));
+            m_buffer.remove(0, length);
+        }
+    }
+
+private:
+    QTcpSocket *m_tcp;
+    QUdpSocket *m_udp;
+    QByteArray m_buffer;
+};
+
+/**
+ * Records what the hub sends to the link, and when, unless told to refuse
+ */
+class LinkRecorder : public TelemetryHub::Link {
+public:
+    LinkRecorder() : accepting(true)
+    {
+        clock.start();
+    }
+
+    QList<QByteArray> frames;
+    QList<qint64> times;
+    QElapsedTimer clock;
+    bool accepting;
+
+    bool sendFrame(const QByteArray &frame)
+    {
+        if (!accepting) {
+            return false;
+        }
+        frames.append(frame);
+        times.append(clock.elapsed());
+        return true;
+    }
+};
+
+class TelemetryHubTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void delivery();
+    void slowClient();
+    void clientWrites();
+    void linkFailures();
+};
+
+static QByteArray makeFrame(quint8 type, quint32 objId, const QByteArray &data)
+{
+    QByteArray frame(10, 0);
+
+    frame[0] = 0x3C;
+    frame[1] = type;
+    qToLittleEndian<quint16>(10 + data.size(), (uchar *)frame.data() + 2);
+    qToLittleEndian<quint32>(objId, (uchar *)frame.data() + 4);
+    qToLittleEndian<quint16>(0, (uchar *)frame.data() + 8);
+    frame.append(data);
+    frame.append((char)Crc::updateCRC(0, (const quint8 *)frame.constData(), frame.size()));
+    return frame;
+}
+
+static QByteArray makeObjectFrame(quint32 objId, quint32 sequence)
+{
+    QByteArray data(PAYLOAD_LENGTH, 0);
+
+    qToLittleEndian<quint32>(sequence, (uchar *)data.data());
+    return makeFrame(TYPE_OBJ, objId, data);
+}
+
+static quint32 objectId(const QByteArray &frame)
+{
+    return qFromLittleEndian<quint32>((const uchar *)frame.constData() + 4);
+}
+
+static quint32 sequence(const QByteArray &frame)
+{
+    return qFromLittleEndian<quint32>((const uchar *)frame.constData() + 10);
+}
+
+/**
+ * Link traffic as it was logged from a board, each frame carries its
+ * position in the log
+ */
+static QList<QByteArray> recording(int count)
+{
+    QList<QByteArray> frames;
+
+    for (int n = 0; n < count; n++) {
+        quint32 objId = (n % 20 == 0) ? STATS_OBJID : (n % 5 == 0) ? GPS_OBJID : ATTITUDE_OBJID;
+        frames.append(makeObjectFrame(objId, n));
+    }
+    return frames;
+}
+
+static bool waitForFrames(const FrameCollector &collector, int count)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    while (collector.frames.size() < count && timer.elapsed() < TIMEOUT_MS) {
+        QTest::qWait(1);
+    }
+    return collector.frames.size() >= count;
+}
+
+static bool connectClient(QTcpSocket *socket, TelemetryHub *hub)
+{
+    socket->connectToHost(QHostAddress::LocalHost, hub->port());
+    return socket->waitForConnected(TIMEOUT_MS);
+}
+
+void TelemetryHubTest::delivery()
+{
+    TelemetryHub hub;
+
+    QVERIFY(hub.listen(0));
+
+    QTcpSocket allSocket, gpsSocket;
+    FrameCollector all(&allSocket), gps(&gpsSocket);
+    QVERIFY(connectClient(&allSocket, &hub));
+    QVERIFY(connectClient(&gpsSocket, &hub));
+    gpsSocket.write(makeFrame(TelemetryHub::TYPE_SUBSCRIBE, GPS_OBJID, QByteArray()));
+    gpsSocket.flush();
+
+    QUdpSocket udpSocket;
+    FrameCollector udp(&udpSocket);
+    QVERIFY(udpSocket.bind(QHostAddress::LocalHost, 0));
+    udpSocket.writeDatagram(makeFrame(TelemetryHub::TYPE_UNSUBSCRIBE, 0, QByteArray()), QHostAddress::LocalHost, hub.port());
+
+    QTRY_COMPARE(hub.clientCount(), 3);
+    // lets the hub read the subscription
+    QTest::qWait(100);
+
+    QList<QByteArray> frames = recording(DELIVERY_FRAMES);
+    int gpsFrames = 0;
+    for (int n = 0; n < frames.size(); n++) {
+        hub.forwardFrame(frames.at(n));
+        gpsFrames += (objectId(frames.at(n)) == GPS_OBJID);
+        if ((n + 1) % CHUNK_FRAMES == 0) {
+            QVERIFY(waitForFrames(all, n + 1));
+            QVERIFY(waitForFrames(udp, n + 1));
+        }
+    }
+    QVERIFY(waitForFrames(gps, gpsFrames));
+    QTest::qWait(100);
+
+    // Every frame once, in order, the filtered client only its object
+    QCOMPARE(all.frames, frames);
+    QCOMPARE(udp.frames, frames);
+    QCOMPARE(gps.frames.size(), gpsFrames);
+    quint32 last = 0;
+    foreach(const QByteArray &frame, gps.frames) {
+        QCOMPARE(objectId(frame), (quint32)GPS_OBJID);
+        QVERIFY(sequence(frame) > last);
+        last = sequence(frame);
+    }
+
+    TelemetryHub::Stats stats = hub.getStats();
+    QCOMPARE(stats.framesForwarded, (quint32)DELIVERY_FRAMES);
+    QCOMPARE(stats.framesDropped, (quint32)0);
+}
+
+void TelemetryHubTest::slowClient()
+{
+    TelemetryHub hub;
+
+    QVERIFY(hub.listen(0));
+
+    QTcpSocket fastSocket, slowSocket;
+    FrameCollector fast(&fastSocket), slow(&slowSocket);
+    // The slow client takes nothing, small buffers so it is noticed early
+    slow.reading = false;
+    slowSocket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4096);
+    slowSocket.setReadBufferSize(4096);
+    QVERIFY(connectClient(&fastSocket, &hub));
+    QVERIFY(connectClient(&slowSocket, &hub));
+    QTRY_COMPARE(hub.clientCount(), 2);
+
+    const int frameSize   = makeObjectFrame(0, 0).size();
+    // Queue, socket backlog and the frame that crossed it, for each client
+    const qint64 maxBytes = 2 * ((qint64)TelemetryHub::CLIENT_QUEUE_FRAMES * frameSize + TelemetryHub::SOCKET_BACKLOG + frameSize);
+    qint64 mostBytes      = 0;
+
+    for (int n = 0; n < SLOW_FRAMES; n++) {
+        hub.forwardFrame(makeObjectFrame(ATTITUDE_OBJID, n));
+        if ((n + 1) % CHUNK_FRAMES == 0) {
+            mostBytes = qMax(mostBytes, hub.queuedBytes());
+            QVERIFY(waitForFrames(fast, n + 1));
+        }
+    }
+    qDebug() << "most bytes queued" << mostBytes << "of" << maxBytes << "allowed,"
+             << hub.getStats().framesDropped << "frames dropped";
+
+    // The fast client was not held up
+    QCOMPARE(fast.frames.size(), SLOW_FRAMES);
+    for (int n = 0; n < SLOW_FRAMES; n++) {
+        QCOMPARE(sequence(fast.frames.at(n)), (quint32)n);
+    }
+
+    // The hub held on to a bounded amount and dropped the slow client's oldest frames
+    QVERIFY(mostBytes <= maxBytes);
+    QVERIFY(hub.getStats().framesDropped > 0);
+
+    // What the slow client gets is in order and ends with the newest frame
+    slow.reading = true;
+    QElapsedTimer idle;
+    idle.start();
+    int received = 0;
+    while (idle.elapsed() < 500) {
+        QTest::qWait(10);
+        slow.read();
+        if (slow.frames.size() != received) {
+            received = slow.frames.size();
+            idle.start();
+        }
+    }
+    QVERIFY(slow.frames.size() > 0);
+    QVERIFY(slow.frames.size() < SLOW_FRAMES);
+    for (int n = 1; n < slow.frames.size(); n++) {
+        QVERIFY(sequence(slow.frames.at(n)) > sequence(slow.frames.at(n - 1)));
+    }
+    QCOMPARE(sequence(slow.frames.last()), (quint32)(SLOW_FRAMES - 1));
+    QCOMPARE(hub.queuedBytes(), (qint64)0);
+}
+
+void TelemetryHubTest::clientWrites()
+{
+    const int queueFrames = TelemetryHub::WRITE_QUEUE_FRAMES;
+    const int burst       = TelemetryHub::WRITE_BURST;
+    const int rate        = TelemetryHub::WRITE_RATE;
+    const int aWrites     = queueFrames + 8;
+    const int bWrites     = 10;
+
+    TelemetryHub hub;
+    LinkRecorder link;
+
+    QVERIFY(hub.listen(0));
+    hub.setLink(&link);
+
+    QTcpSocket aSocket, bSocket, observerSocket;
+    FrameCollector a(&aSocket), b(&bSocket), observer(&observerSocket);
+    QVERIFY(connectClient(&aSocket, &hub));
+    QVERIFY(connectClient(&bSocket, &hub));
+    QVERIFY(connectClient(&observerSocket, &hub));
+    QTRY_COMPARE(hub.clientCount(), 3);
+
+    // Client a writes more than it may queue, after some noise
+    QByteArray aData("noise");
+    for (int n = 0; n < aWrites; n++) {
+        aData.append(makeObjectFrame(SETTINGS_A_OBJID, n));
+    }
+    aSocket.write(aData);
+    aSocket.flush();
+    QTest::qWait(50);
+    for (int n = 0; n < bWrites; n++) {
+        bSocket.write(makeObjectFrame(SETTINGS_B_OBJID, n));
+    }
+    bSocket.flush();
+
+    QTRY_COMPARE_WITH_TIMEOUT(link.frames.size(), queueFrames + bWrites, TIMEOUT_MS);
+    QTest::qWait(100);
+    QCOMPARE(link.frames.size(), queueFrames + bWrites);
+
+    TelemetryHub::Stats stats = hub.getStats();
+    QCOMPARE(stats.writesDropped, (quint32)(aWrites - queueFrames));
+    QCOMPARE(stats.writesSent, (quint32)(queueFrames + bWrites));
+    QCOMPARE(stats.writesFailed, (quint32)0);
+    QCOMPARE(stats.badBytes, (quint32)aData.indexOf((char)0x3C));
+
+    // In order per client, a at its rate, b not kept waiting behind a
+    QList<qint64> aTimes;
+    int aSent = 0, bSent = 0, lastA = 0, lastB = 0;
+    for (int n = 0; n < link.frames.size(); n++) {
+        const QByteArray &frame = link.frames.at(n);
+        if (objectId(frame) == SETTINGS_A_OBJID) {
+            QCOMPARE(sequence(frame), (quint32)aSent++);
+            aTimes.append(link.times.at(n));
+            lastA = n;
+        } else {
+            QCOMPARE(objectId(frame), (quint32)SETTINGS_B_OBJID);
+            QCOMPARE(sequence(frame), (quint32)bSent++);
+            lastB = n;
+        }
+    }
+    QCOMPARE(aSent, queueFrames);
+    QCOMPARE(bSent, bWrites);
+    QVERIFY(lastB < lastA);
+    for (int k = burst + 1; k < aTimes.size(); k++) {
+        qint64 earliest = (k - burst - 1) * 1000 / rate;
+        QVERIFY2(aTimes.at(k) - aTimes.first() >= earliest,
+                 qPrintable(QString("write %1 after %2 ms").arg(k).arg(aTimes.at(k) - aTimes.first())));
+    }
+
+    // The other clients see the writes, the writer does not get its own back
+    QVERIFY(waitForFrames(observer, queueFrames + bWrites));
+    QVERIFY(waitForFrames(a, bWrites));
+    QVERIFY(waitForFrames(b, queueFrames));
+    QTest::qWait(100);
+    QCOMPARE(observer.frames, link.frames);
+    QCOMPARE(a.frames.size(), bWrites);
+    QCOMPARE(b.frames.size(), queueFrames);
+}
+
+void TelemetryHubTest::linkFailures()
+{
+    const int writes = TelemetryHub::WRITE_BURST;
+
+    TelemetryHub hub;
+    LinkRecorder link;
+
+    QVERIFY(hub.listen(0));
+    hub.setLink(&link);
+    link.accepting = false;
+
+    QTcpSocket writerSocket, observerSocket;
+    FrameCollector writer(&writerSocket), observer(&observerSocket);
+    QVERIFY(connectClient(&writerSocket, &hub));
+    QVERIFY(connectClient(&observerSocket, &hub));
+    QTRY_COMPARE(hub.clientCount(), 2);
+
+    for (int n = 0; n < writes; n++) {
+        writerSocket.write(makeObjectFrame(SETTINGS_A_OBJID, n));
+    }
+    writerSocket.flush();
+    QTRY_COMPARE(hub.getStats().writesFailed, (quint32)writes);
+
+    // Nothing counts as sent and the others do not see what the link refused
+    QTest::qWait(100);
+    TelemetryHub::Stats stats = hub.getStats();
+    QCOMPARE(stats.writesQueued, (quint32)writes);
+    QCOMPARE(stats.writesSent, (quint32)0);
+    QCOMPARE(stats.writesFailed, (quint32)writes);
+    QCOMPARE(observer.frames.size(), 0);
+
+    // Once the link takes them again the writes go through
+    link.accepting = true;
+    writerSocket.write(makeObjectFrame(SETTINGS_A_OBJID, writes));
+    writerSocket.flush();
+    QVERIFY(waitForFrames(observer, 1));
+    QCOMPARE(link.frames.size(), 1);
+    QCOMPARE(hub.getStats().writesSent, (quint32)1);
+}
+
+QTEST_MAIN(TelemetryHubTest)
+
+#include "telemetryhubtest.moc"
@@ -0,0 +1,20 @@
+# -------------------------------------------------
+# Replays recorded link traffic through the telemetry
+# hub to several socket clients, checks delivery,
+# ordering, the memory a slow client holds up, the
+# arbitration of the clients' writes and the writes the
+# link refuses.
+# -------------------------------------------------
+QT -= gui
+QT += network testlib
+TARGET = telemetryhubtest
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+INCLUDEPATH += ../.. \
+    ../../../../libs
+DEFINES += UAVTALK_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+SOURCES += telemetryhubtest.cpp \
+    ../../telemetryhub.cpp \
+    ../../../../libs/utils/crc.cpp
+HEADERS += ../../telemetryhub.h
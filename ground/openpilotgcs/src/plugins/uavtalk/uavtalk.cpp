@@ -55,6 +55,7 @@ UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMn
     rxPacketLength = 0;
 
     memset(&stats, 0, sizeof(ComStats));
+    useHub = false;
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
@@ -98,6 +99,70 @@ UAVTalk::ComStats UAVTalk::getStats()
     return stats;
 }
 
+/**
+ * Shares the link with the clients of the hub: the hub gets every frame
+ * that goes over the link and its clients' frames are sent out.
+ */
+void UAVTalk::setTelemetryHub(TelemetryHub *hub)
+{
+    QMutexLocker locker(&mutex);
+
+    connect(this, SIGNAL(frameTransferred(QByteArray)), hub, SLOT(forwardFrame(QByteArray)));
+    hub->setLink(this);
+    useHub = true;
+}
+
+/**
+ * Send a complete frame as it is, the telemetry hub's clients write
+ * through this. Transactions are left to the client that sent it, an
+ * object it sends is also applied to the GCS copy.
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::sendFrame(const QByteArray &frame)
+{
+    QMutexLocker locker(&mutex);
+
+    if (io.isNull() || !io->isWritable()) {
+        ++stats.txErrors;
+        return false;
+    }
+    if (io->bytesToWrite() >= TX_BUFFER_SIZE) {
+        qWarning() << "UAVTalk - error transmitting : io device full";
+        ++stats.txErrors;
+        return false;
+    }
+    io->write(frame);
+    stats.txBytes += frame.size();
+    applyFrame(frame);
+    return true;
+}
+
+/**
+ * Unpacks an object a telemetry hub client sent into the GCS copy, as if
+ * the board had sent it. The GCS then shows what the board was told and
+ * telemetry does not send it again, the board's next update of the object
+ * replaces it if the board did not take it.
+ */
+void UAVTalk::applyFrame(const QByteArray &frame)
+{
+    if (frame.size() < HEADER_LENGTH + CHECKSUM_LENGTH) {
+        return;
+    }
+    const quint8 *data = (const quint8 *)frame.constData();
+    quint8 type    = data[1];
+    quint32 objId  = qFromLittleEndian<quint32>(data + 4);
+    quint16 instId = qFromLittleEndian<quint16>(data + 8);
+
+    if ((type != TYPE_OBJ && type != TYPE_OBJ_ACK) || instId == ALL_INSTANCES) {
+        return;
+    }
+    UAVObject *obj = objMngr->getObject(objId);
+    if (obj == NULL || frame.size() != HEADER_LENGTH + (int)obj->getNumBytes() + CHECKSUM_LENGTH) {
+        return;
+    }
+    updateObject(objId, instId, (quint8 *)data + HEADER_LENGTH);
+}
+
 void UAVTalk::dummyUDPRead()
 {
     QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
@@ -233,6 +298,9 @@ void UAVTalk::processInputStream()
                     // accessed from this thread only
                     udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
                 }
+                if (useHub) {
+                    emit frameTransferred(rxDataArray);
+                }
             }
         }
     }
@@ -248,7 +316,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
 
-        if (useUDPMirror) {
+        if (useUDPMirror || useHub) {
             rxDataArray.clear();
         }
     }
@@ -259,7 +327,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
+    if (useUDPMirror || useHub) {
         rxDataArray.append(rxbyte);
     }
 
@@ -792,6 +860,9 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
             if (useUDPMirror) {
                 udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
             }
+            if (useHub) {
+                emit frameTransferred(QByteArray((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH));
+            }
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
             ++stats.txErrors;
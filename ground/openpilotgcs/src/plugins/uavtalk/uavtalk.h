@@ -37,8 +37,9 @@
 #include <QMap>
 #include <QThread>
 #include <QtNetwork/QUdpSocket>
+#include "telemetryhub.h"
 
-class UAVTALK_EXPORT UAVTalk : public QObject {
+class UAVTALK_EXPORT UAVTalk : public QObject, public TelemetryHub::Link {
     Q_OBJECT
 
     friend class IODeviceReader;
@@ -70,8 +71,13 @@ public:
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
+    void setTelemetryHub(TelemetryHub *hub);
+    bool sendFrame(const QByteArray &frame);
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
+    // Every complete frame received or sent, for the telemetry hub
+    void frameTransferred(const QByteArray &frame);
 
 private slots:
     void processInputStream();
@@ -141,6 +147,7 @@ private:
     quint8 rxCS;
 
     bool useUDPMirror;
+    bool useHub;
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
     QByteArray rxDataArray;
@@ -150,6 +157,7 @@ private:
     bool processInputByte(quint8 rxbyte);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
+    void applyFrame(const QByteArray &frame);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
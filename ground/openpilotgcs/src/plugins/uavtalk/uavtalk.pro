@@ -17,13 +17,15 @@ HEADERS += \
     telemetrymonitor.h \
     telemetrymanager.h \
     uavtalk_global.h \
-    telemetry.h
+    telemetry.h \
+    telemetryhub.h
 
 SOURCES += \
     uavtalk.cpp \
     uavtalkplugin.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
-    telemetry.cpp
+    telemetry.cpp \
+    telemetryhub.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
@@ -38,6 +38,8 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
 {
     info = NULL;
     numberOfDevices = 0;
+    deltaUpload     = false;
+    skippedFirmwareCrc = 0;
 
     qRegisterMetaType<OP_DFU::Status>("Status");
 
@@ -120,6 +122,18 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     }
 }
 
+DFUObject::DFUObject(bool _debug) :
+    debug(_debug), use_serial(false), mready(true)
+{
+    info = NULL;
+    serialhandle    = NULL;
+    numberOfDevices = 0;
+    deltaUpload     = false;
+    skippedFirmwareCrc = 0;
+
+    qRegisterMetaType<OP_DFU::Status>("Status");
+}
+
 DFUObject::~DFUObject()
 {
     if (use_serial) {
@@ -210,7 +224,6 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     }
 
     int result = sendData(buf, BUF_LEN);
-    delay::msleep(1000);
 
     if (debug) {
         qDebug() << result << " bytes sent";
@@ -221,10 +234,33 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     return false;
 }
 
+/**
+   Polls the device status until it answers with a status other than
+   uploadingStarting, the device does not answer while it erases.
+   A status the device did send, abort included, is returned at once.
+ */
+OP_DFU::Status DFUObject::WaitForStatus(int timeoutMs)
+{
+    OP_DFU::Status ret;
+    bool answered;
+    QTime time;
+
+    time.start();
+    for (;;) {
+        ret = StatusRequest(answered);
+        if ((answered && ret != OP_DFU::uploadingStarting) || time.elapsed() >= timeoutMs) {
+            return ret;
+        }
+        delay::msleep(ERASE_POLL_MS);
+    }
+}
+
 
 /**
    Does the actual data upload to the board. Needs to be called once the
    board is ready to accept data following a StartUpload command, and it is erased.
+   The packets are streamed, the device status is only checked after every
+   UPLOAD_WINDOW packets so a failed transfer stops early.
  */
 bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
 {
@@ -253,7 +289,7 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
             printProgBar((int)percentage, "UPLOADING");
         }
         laspercentage = (int)percentage;
-        if (packetcount == numberOfPackets) {
+        if (packetcount == numberOfPackets - 1) {
             packetsize = lastPacketCount;
         } else {
             packetsize = 14;
@@ -283,6 +319,15 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
         if (result < 1) {
             return false;
         }
+        if ((packetcount + 1) % UPLOAD_WINDOW == 0 && packetcount + 1 < numberOfPackets) {
+            OP_DFU::Status status = StatusRequest();
+            if (status != OP_DFU::uploading) {
+                if (debug) {
+                    qDebug() << "Upload stopped at packet" << packetcount << StatusToString(status);
+                }
+                return false;
+            }
+        }
 
         // qDebug() << "UPLOAD:"<<"Data="<<(int)buf[6]<<(int)buf[7]<<(int)buf[8]<<(int)buf[9]<<";"<<result << " bytes sent";
     }
@@ -298,6 +343,7 @@ OP_DFU::Status DFUObject::UploadDescription(QVariant desc)
 {
     cout << "Starting uploading description\n";
     QByteArray array;
+    OP_DFU::Status ret;
 
     if (desc.type() == QMetaType::QString) {
         QString description = desc.toString();
@@ -314,6 +360,22 @@ OP_DFU::Status DFUObject::UploadDescription(QVariant desc)
         array = desc.toByteArray();
     }
 
+    if (!skippedFirmware.isEmpty()) {
+        // The firmware was not written, flash can not be written twice
+        // without an erase so a new description needs the firmware too
+        QByteArray current = DownloadDescriptionAsBA(array.length());
+        if (current == array) {
+            skippedFirmware.clear();
+            cout << "Description unchanged\n";
+            return OP_DFU::Last_operation_Success;
+        }
+        ret = WriteFirmware(skippedFirmware, skippedFirmwareCrc);
+        skippedFirmware.clear();
+        if (ret != OP_DFU::Last_operation_Success) {
+            return ret;
+        }
+    }
+
     if (!StartUpload(array.length(), OP_DFU::Descript, 0)) {
         return OP_DFU::abort;
     }
@@ -323,7 +385,7 @@ OP_DFU::Status DFUObject::UploadDescription(QVariant desc)
     if (!EndOperation()) {
         return OP_DFU::abort;
     }
-    OP_DFU::Status ret = StatusRequest();
+    ret = StatusRequest();
 
 
     if (debug) {
@@ -560,6 +622,16 @@ int DFUObject::JumpToApp(bool safeboot, bool erase)
 }
 
 OP_DFU::Status DFUObject::StatusRequest()
+{
+    bool answered;
+
+    return StatusRequest(answered);
+}
+
+/**
+   Same as StatusRequest(), answered tells if the device sent a reply at all
+ */
+OP_DFU::Status DFUObject::StatusRequest(bool &answered)
 {
     char buf[BUF_LEN];
 
@@ -578,11 +650,12 @@ OP_DFU::Status DFUObject::StatusRequest()
     if (debug) {
         qDebug() << "StatusRequest: " << result << " bytes sent";
     }
-    result = receiveData(buf, BUF_LEN);
+    result   = receiveData(buf, BUF_LEN);
+    answered = result > 0;
     if (debug) {
         qDebug() << "StatusRequest: " << result << " bytes received";
     }
-    if (buf[1] == OP_DFU::Status_Rep) {
+    if (answered && buf[1] == OP_DFU::Status_Rep) {
         return (OP_DFU::Status)buf[6];
     } else {
         return OP_DFU::abort;
@@ -761,6 +834,45 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
+    skippedFirmware.clear();
+    if (deltaUpload && crc == devices[device].FW_CRC) {
+        // Same image, keep it and only write it if the description differs
+        skippedFirmware    = arr;
+        skippedFirmwareCrc = crc;
+        emit operationProgress(QString("Firmware unchanged, skipping upload"));
+        ret = OP_DFU::Last_operation_Success;
+    } else {
+        ret = WriteFirmware(arr, crc);
+        if (ret != OP_DFU::Last_operation_Success) {
+            return ret;
+        }
+    }
+
+    if (verify) {
+        emit operationProgress(QString("Verifying firmware"));
+        cout << "Starting code verification\n";
+        QByteArray arr2;
+        StartDownloadT(&arr2, arr.length(), OP_DFU::FW);
+        if (arr != arr2) {
+            cout << "Verify:FAILED\n";
+            return OP_DFU::abort;
+        }
+    }
+
+    if (debug) {
+        qDebug() << "Status=" << ret;
+    }
+    cout << "Firmware Uploading succeeded\n";
+    return ret;
+}
+
+/**
+   Erases the firmware area and writes a firmware image to it
+ */
+OP_DFU::Status DFUObject::WriteFirmware(QByteArray & arr, quint32 crc)
+{
+    OP_DFU::Status ret;
+
     if (!StartUpload(arr.length(), OP_DFU::FW, crc)) {
         ret = StatusRequest();
         if (debug) {
@@ -775,22 +887,12 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
     if (debug) {
         qDebug() << "Erasing memory";
     }
-    if (StatusRequest() == OP_DFU::abort) {
-        return OP_DFU::abort;
+    ret = WaitForStatus(ERASE_TIMEOUT_MS);
+    if (debug) {
+        qDebug() << "Erase returned: " << StatusToString(ret);
     }
-
-    // TODO: why is there a loop there? The "if" statement
-    // will cause a break or return anyway!!
-    for (int x = 0; x < 3; ++x) {
-        ret = StatusRequest();
-        if (debug) {
-            qDebug() << "Erase returned: " << StatusToString(ret);
-        }
-        if (ret == OP_DFU::uploading) {
-            break;
-        } else {
-            return ret;
-        }
+    if (ret != OP_DFU::uploading) {
+        return ret;
     }
 
     emit operationProgress(QString("Uploading firmware"));
@@ -810,27 +912,7 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         }
         return ret;
     }
-    ret = StatusRequest();
-    if (ret != OP_DFU::Last_operation_Success) {
-        return ret;
-    }
-
-    if (verify) {
-        emit operationProgress(QString("Verifying firmware"));
-        cout << "Starting code verification\n";
-        QByteArray arr2;
-        StartDownloadT(&arr2, arr.length(), OP_DFU::FW);
-        if (arr != arr2) {
-            cout << "Verify:FAILED\n";
-            return OP_DFU::abort;
-        }
-    }
-
-    if (debug) {
-        qDebug() << "Status=" << ret;
-    }
-    cout << "Firmware Uploading succeeded\n";
-    return ret;
+    return StatusRequest();
 }
 
 
@@ -30,6 +30,13 @@ using namespace std;
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
 
+// Upload packets sent before the device status is checked again
+#define UPLOAD_WINDOW       32
+// Erasing a large flash takes several seconds
+#define ERASE_TIMEOUT_MS    30000
+// Pause between the status polls while the device erases
+#define ERASE_POLL_MS       10
+
 namespace OP_DFU {
 enum TransferTypes {
     FW,
@@ -112,7 +119,6 @@ class DFUObject : public QThread {
 
 public:
     static quint32 CRCFromQBArray(QByteArray array, quint32 Size);
-    // DFUObject(bool debug);
     DFUObject(bool debug, bool use_serial, QString port);
 
     virtual ~DFUObject();
@@ -123,12 +129,18 @@ public:
     int JumpToApp(bool safeboot, bool erase);
     int ResetDevice(void);
     OP_DFU::Status StatusRequest();
+    OP_DFU::Status StatusRequest(bool &answered);
     bool EndOperation();
     int AbortOperation(void);
     bool ready()
     {
         return mready;
     }
+    // Skip the upload of a firmware the device already has
+    void setDeltaUpload(bool enabled)
+    {
+        deltaUpload = enabled;
+    }
 
     // Upload (send to device) commands
     OP_DFU::Status UploadDescription(QVariant description);
@@ -174,8 +186,6 @@ private:
     bool mready;
     int RWFlags;
     qsspt *serialhandle;
-    int sendData(void *, int);
-    int receiveData(void *data, int size);
     uint8_t sspTxBuf[MAX_PACKET_BUF_SIZE];
     uint8_t sspRxBuf[MAX_PACKET_BUF_SIZE];
     port *info;
@@ -190,13 +200,16 @@ private:
 
     void CopyWords(char *source, char *destination, int count);
     void printProgBar(int const & percent, QString const & label);
-    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
-    bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+
+    // Delta upload: the firmware is not written when the device has it, the
+    // description upload that follows writes it if the description differs
+    bool deltaUpload;
+    QByteArray skippedFirmware;
+    quint32 skippedFirmwareCrc;
 
     // Thread management:
     // Same as startDownload except that we store in an external array:
     bool StartDownloadT(QByteArray *fw, qint32 const & numberOfBytes, TransferTypes const & type);
-    OP_DFU::Status UploadFirmwareT(const QString &sfile, const bool &verify, int device);
     QMutex mutex;
     OP_DFU::Commands requestedOperation;
     qint32 requestSize;
@@ -207,6 +220,18 @@ private:
     int requestDevice;
 
 protected:
+    // For a device that is reached through another transport, which
+    // overrides sendData and receiveData. No port is opened.
+    DFUObject(bool debug);
+    virtual int sendData(void *, int);
+    virtual int receiveData(void *data, int size);
+
+    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
+    bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+    OP_DFU::Status WaitForStatus(int timeoutMs);
+    OP_DFU::Status WriteFirmware(QByteArray & arr, quint32 crc);
+    OP_DFU::Status UploadFirmwareT(const QString &sfile, const bool &verify, int device);
+
     void run(); // Executes the upload or download operations
 };
 }
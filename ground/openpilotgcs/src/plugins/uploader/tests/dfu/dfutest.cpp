@@ -0,0 +1,354 @@
+/**
+ ******************************************************************************
+ *
+ * @file       dfutest.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief DFUObject against the bootloader DFU protocol, without a board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include "op_dfu.h"
+#include "dfudevice.h"
+
+using namespace OP_DFU;
+
+// Number of images written for the throughput figures
+#define BENCH_UPLOADS 20
+#define DESCRIPTION_A "Description of the first build"
+#define DESCRIPTION_B "Description of the second build"
+
+/**
+ * DFUObject talking to the simulated bootloader instead of a USB device
+ */
+class DfuLink : public DFUObject {
+public:
+    DfuLink() : DFUObject(false), reports(0), statusPolls(0), dropPacket(-1), silentPolls(0), abortPolls(0), abortReply(false) {}
+
+    using DFUObject::StartUpload;
+    using DFUObject::WaitForStatus;
+    using DFUObject::WriteFirmware;
+    using DFUObject::UploadFirmwareT;
+
+    int reports;
+    int statusPolls;
+    // Data packet of the next upload that is lost
+    int dropPacket;
+    // Status requests the device does not answer, as while it erases, it
+    // never answers again if negative
+    int silentPolls;
+    // Status requests the device answers with abort
+    int abortPolls;
+
+protected:
+    virtual int sendData(void *data, int size)
+    {
+        const uint8_t *buf = (const uint8_t *)data;
+
+        reports++;
+        if (buf[1] == Status_Request) {
+            statusPolls++;
+            if (silentPolls > 0) {
+                silentPolls--;
+                return size;
+            }
+            if (silentPolls < 0) {
+                return size;
+            }
+            if (abortPolls > 0) {
+                abortPolls--;
+                abortReply = true;
+                return size;
+            }
+        }
+        if (buf[1] == Upload && (buf[2] << 24 | buf[3] << 16 | buf[4] << 8 | buf[5]) == dropPacket) {
+            dropPacket = -1;
+            return size;
+        }
+        dfudevice_send(buf);
+        return size;
+    }
+
+    virtual int receiveData(void *data, int size)
+    {
+        if (abortReply) {
+            uint8_t *buf = (uint8_t *)data;
+            memset(buf, 0, size);
+            buf[0]     = 0x01;
+            buf[1]     = Status_Rep;
+            buf[6]     = OP_DFU::abort;
+            abortReply = false;
+            return size;
+        }
+        return dfudevice_receive((uint8_t *)data);
+    }
+
+private:
+    bool abortReply;
+};
+
+class DfuTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void windowedUploadWritesImage();
+    void imageOfWholePackets();
+    void droppedPacketStopsAtWindow();
+    void wrongCrcFails();
+    void waitForStatusPollsThroughErase();
+    void waitForStatusTimesOut();
+    void waitForStatusReturnsAbort();
+    void verifyReadsImageBack();
+    void deltaSkipsUnchangedFirmware();
+    void deltaWritesFirmwareForNewDescription();
+    void throughput();
+
+private:
+    static QByteArray makeImage(int size, quint32 seed);
+    static quint32 crcOf(const QByteArray &image);
+    static QByteArray flashFirmware(int size);
+    static QByteArray flashDescription(int size);
+    static bool writeFile(QTemporaryFile &file, const QByteArray &image);
+    static int windowPolls(const QByteArray &image);
+
+    DfuLink *link;
+};
+
+QByteArray DfuTest::makeImage(int size, quint32 seed)
+{
+    QByteArray image(size, 0);
+
+    for (int i = 0; i < size; i++) {
+        seed     = seed * 1103515245 + 12345;
+        image[i] = (char)(seed >> 16);
+    }
+    return image;
+}
+
+quint32 DfuTest::crcOf(const QByteArray &image)
+{
+    return DFUObject::CRCFromQBArray(image, DFUDEVICE_FW_SIZE);
+}
+
+QByteArray DfuTest::flashFirmware(int size)
+{
+    return QByteArray((const char *)dfudevice_firmware(), size);
+}
+
+QByteArray DfuTest::flashDescription(int size)
+{
+    return QByteArray((const char *)dfudevice_description(), size);
+}
+
+bool DfuTest::writeFile(QTemporaryFile &file, const QByteArray &image)
+{
+    if (!file.open()) {
+        return false;
+    }
+    bool written = file.write(image) == image.size();
+    file.close();
+    return written;
+}
+
+// Status checks UploadData makes between the first and the last packet
+int DfuTest::windowPolls(const QByteArray &image)
+{
+    int packets = (image.size() + 55) / 56;
+
+    return (packets - 1) / UPLOAD_WINDOW;
+}
+
+void DfuTest::init()
+{
+    dfudevice_init();
+    link = new DfuLink();
+    QCOMPARE(link->StatusRequest(), DFUidle);
+    QVERIFY(link->findDevices());
+    QCOMPARE(link->devices.size(), 1);
+    QCOMPARE(link->devices[0].SizeOfCode, (quint32)DFUDEVICE_FW_SIZE);
+    link->reports     = 0;
+    link->statusPolls = 0;
+}
+
+void DfuTest::cleanup()
+{
+    delete link;
+}
+
+void DfuTest::windowedUploadWritesImage()
+{
+    QByteArray image = makeImage(100000, 1);
+    quint32 crc = crcOf(image);
+
+    QCOMPARE(link->WriteFirmware(image, crc), Last_operation_Success);
+    QCOMPARE(flashFirmware(image.size()), image);
+    QCOMPARE(dfudevice_erases(), 1u);
+
+    // One status check per window, the erase wait and the final status
+    QCOMPARE(link->statusPolls, windowPolls(image) + 2);
+
+    // What the delta upload compares to skip writing the same image again
+    QVERIFY(link->findDevices());
+    QCOMPARE(link->devices[0].FW_CRC, crc);
+}
+
+void DfuTest::imageOfWholePackets()
+{
+    QByteArray image = makeImage(56 * UPLOAD_WINDOW * 4, 2);
+
+    QCOMPARE(link->WriteFirmware(image, crcOf(image)), Last_operation_Success);
+    QCOMPARE(flashFirmware(image.size()), image);
+}
+
+void DfuTest::droppedPacketStopsAtWindow()
+{
+    QByteArray image = makeImage(100000, 3);
+
+    link->dropPacket = 40;
+    QCOMPARE(link->WriteFirmware(image, crcOf(image)), wrong_packet_received);
+
+    // Stopped at the end of the window the packet was lost in: start, erase
+    // wait, the packets of two windows, two window checks, status
+    QCOMPARE(link->reports, 1 + 1 + 2 * UPLOAD_WINDOW + 2 + 1);
+}
+
+void DfuTest::wrongCrcFails()
+{
+    QByteArray image = makeImage(100000, 4);
+
+    QCOMPARE(link->WriteFirmware(image, crcOf(image) ^ 1), CRC_Fail);
+}
+
+void DfuTest::waitForStatusPollsThroughErase()
+{
+    QByteArray image = makeImage(4000, 5);
+
+    link->silentPolls = 5;
+    QCOMPARE(link->WriteFirmware(image, crcOf(image)), Last_operation_Success);
+    QCOMPARE(link->statusPolls, 5 + windowPolls(image) + 2);
+    QCOMPARE(flashFirmware(image.size()), image);
+}
+
+void DfuTest::waitForStatusTimesOut()
+{
+    QElapsedTimer timer;
+
+    QVERIFY(link->StartUpload(4000, FW, 0));
+    link->silentPolls = -1;
+    timer.start();
+    QCOMPARE(link->WaitForStatus(100), OP_DFU::abort);
+    QVERIFY(timer.elapsed() >= 100);
+}
+
+void DfuTest::waitForStatusReturnsAbort()
+{
+    QElapsedTimer timer;
+
+    QVERIFY(link->StartUpload(4000, FW, 0));
+    link->silentPolls = 2;
+    link->abortPolls  = 1;
+    timer.start();
+    QCOMPARE(link->WaitForStatus(ERASE_TIMEOUT_MS), OP_DFU::abort);
+    QCOMPARE(link->statusPolls, 3);
+    QVERIFY(timer.elapsed() < 1000);
+}
+
+void DfuTest::verifyReadsImageBack()
+{
+    QByteArray image = makeImage(4000, 6);
+    QTemporaryFile file;
+
+    QVERIFY(writeFile(file, image));
+    QCOMPARE(link->UploadFirmwareT(file.fileName(), true, 0), Last_operation_Success);
+    QCOMPARE(flashFirmware(image.size()), image);
+}
+
+void DfuTest::deltaSkipsUnchangedFirmware()
+{
+    QByteArray image = makeImage(100000, 7);
+    QTemporaryFile file;
+
+    QVERIFY(writeFile(file, image));
+    link->setDeltaUpload(true);
+
+    // The board has another firmware, it is written
+    QCOMPARE(link->UploadFirmwareT(file.fileName(), false, 0), Last_operation_Success);
+    QCOMPARE(link->UploadDescription(QString(DESCRIPTION_A)), Last_operation_Success);
+    QCOMPARE(dfudevice_erases(), 1u);
+
+    // Same firmware and description, nothing is erased or written
+    QVERIFY(link->findDevices());
+    link->reports = 0;
+    QCOMPARE(link->UploadFirmwareT(file.fileName(), false, 0), Last_operation_Success);
+    QCOMPARE(link->reports, 0);
+    QCOMPARE(link->UploadDescription(QString(DESCRIPTION_A)), Last_operation_Success);
+    QCOMPARE(dfudevice_erases(), 1u);
+    QCOMPARE(flashFirmware(image.size()), image);
+    QCOMPARE(flashDescription(sizeof(DESCRIPTION_A) - 1), QByteArray(DESCRIPTION_A));
+}
+
+void DfuTest::deltaWritesFirmwareForNewDescription()
+{
+    QByteArray image = makeImage(100000, 8);
+    QTemporaryFile file;
+
+    QVERIFY(writeFile(file, image));
+    link->setDeltaUpload(true);
+    QCOMPARE(link->UploadFirmwareT(file.fileName(), false, 0), Last_operation_Success);
+    QCOMPARE(link->UploadDescription(QString(DESCRIPTION_A)), Last_operation_Success);
+
+    // The description can not be written over flash that is not erased, the
+    // skipped firmware is written again along with it
+    QVERIFY(link->findDevices());
+    QCOMPARE(link->UploadFirmwareT(file.fileName(), false, 0), Last_operation_Success);
+    QCOMPARE(dfudevice_erases(), 1u);
+    QCOMPARE(link->UploadDescription(QString(DESCRIPTION_B)), Last_operation_Success);
+    QCOMPARE(dfudevice_erases(), 2u);
+    QCOMPARE(flashFirmware(image.size()), image);
+    QCOMPARE(flashDescription(sizeof(DESCRIPTION_B) - 1), QByteArray(DESCRIPTION_B));
+
+    QVERIFY(link->findDevices());
+    QCOMPARE(link->devices[0].FW_CRC, crcOf(image));
+}
+
+void DfuTest::throughput()
+{
+    QByteArray image = makeImage(DFUDEVICE_FW_SIZE, 9);
+    quint32 crc = crcOf(image);
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < BENCH_UPLOADS; i++) {
+        QCOMPARE(link->WriteFirmware(image, crc), Last_operation_Success);
+    }
+    qint64 elapsed = qMax(timer.elapsed(), (qint64)1);
+
+    qDebug() << BENCH_UPLOADS << "uploads of" << image.size() << "bytes:"
+             << link->reports << "reports," << link->statusPolls << "status polls,"
+             << BENCH_UPLOADS * (double)image.size() / elapsed / 1000.0 << "MB/s";
+}
+
+QTEST_MAIN(DfuTest)
+
+#include "dfutest.moc"
@@ -0,0 +1,42 @@
+# -------------------------------------------------
+# Runs the uploader's DFUObject against the bootloader
+# DFU protocol, built for the host with a RAM flash,
+# and reports the upload throughput.
+# -------------------------------------------------
+QT -= gui
+QT += testlib serialport
+TARGET = dfutest
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../openpilotgcs.pri)
+
+FLIGHT = $$GCS_SOURCE_TREE/../../flight
+# The simulated bootloader is shared with the flight op_dfu unit test
+INCLUDEPATH += $$FLIGHT/tests/op_dfu \
+    ../.. \
+    ../../.. \
+    $$FLIGHT/libraries/inc \
+    $$FLIGHT/pios/inc \
+    $$FLIGHT/targets/boards/revolution/bootloader/inc
+
+# The bootloader is built with 8 bit enums, op_dfu.c relies on them
+QMAKE_CFLAGS += -std=gnu99 -fshort-enums
+
+SOURCES += dfutest.cpp \
+    $$FLIGHT/tests/op_dfu/dfudevice.c \
+    $$FLIGHT/libraries/op_dfu.c \
+    ../../op_dfu.cpp \
+    ../../delay.cpp \
+    ../../SSP/port.cpp \
+    ../../SSP/qssp.cpp \
+    ../../SSP/qsspt.cpp
+HEADERS += $$FLIGHT/tests/op_dfu/dfudevice.h \
+    ../../op_dfu.h \
+    ../../delay.h \
+    ../../SSP/port.h \
+    ../../SSP/qssp.h \
+    ../../SSP/qsspt.h
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot -l$$qtLibraryName(opHID)
@@ -694,6 +694,8 @@ bool UploaderGadgetWidget::autoUpdate()
         return false;
     }
     dfu->AbortOperation();
+    // Boards already running this firmware are not erased and written again
+    dfu->setDeltaUpload(true);
     if (!dfu->UploadFirmware(filename, false, 0)) {
         emit autoUpdateSignal(FAILURE, QVariant());
         return false;
@@ -181,15 +181,19 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                             "   bool changed = data.%2[%5] != value;\n"
                             "   data.%2[%5] = value;\n"
                             "   mutex->unlock();\n"
-                            "   if (changed) emit %2_%3Changed(value);\n"
+                            "   if (changed) {\n"
+                            "       notifiedData.%2[%5] = value;\n"
+                            "       emit %2_%3Changed(value);\n"
+                            "   }\n"
                             "}\n\n")
                     .arg(info->name).arg(field->name).arg(elementName).arg(type).arg(elementIndex);
                 propertyNotifications     +=
                     QString("    void %1_%2Changed(%3 value);\n")
                     .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                    QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                            "            emit %1_%3Changed(data.%1[%2]);\n")
+                    QString("    if (memcmp(&current.%1[%2], &notifiedData.%1[%2], sizeof(current.%1[%2])) != 0) {\n"
+                            "        emit %1_%3Changed(current.%1[%2]);\n"
+                            "    }\n")
                     .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -215,15 +219,19 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                         "   bool changed = data.%2 != value;\n"
                         "   data.%2 = value;\n"
                         "   mutex->unlock();\n"
-                        "   if (changed) emit %2Changed(value);\n"
+                        "   if (changed) {\n"
+                        "       notifiedData.%2 = value;\n"
+                        "       emit %2Changed(value);\n"
+                        "   }\n"
                         "}\n\n")
                 .arg(info->name).arg(field->name).arg(type);
             propertyNotifications     +=
                 QString("    void %1Changed(%2 value);\n")
                 .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                QString("        //if (data.%1 != oldData.%1)\n"
-                        "            emit %1Changed(data.%1);\n")
+                QString("    if (memcmp(&current.%1, &notifiedData.%1, sizeof(current.%1)) != 0) {\n"
+                        "        emit %1Changed(current.%1);\n"
+                        "    }\n")
                 .arg(field->name);
         }
     }
@@ -259,7 +267,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                              .arg(varOptionName)
                              .arg(options[m]));
             }
-            finit.append(QString("    fields.append( new UAVObjectField(QString(\"%1\"), QString(\"%2\"), UAVObjectField::ENUM, %3, %4, QString(\"%5\")));\n")
+            finit.append(QString("    descriptors.append( new UAVObjectFieldDescriptor(QString(\"%1\"), QString(\"%2\"), UAVObjectField::ENUM, %3, %4, QString(\"%5\")));\n")
                          .arg(info->fields[n]->name)
                          .arg(info->fields[n]->units)
                          .arg(varElemName)
@@ -268,7 +276,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
         }
         // For all other types
         else {
-            finit.append(QString("    fields.append( new UAVObjectField(QString(\"%1\"), QString(\"%2\"), UAVObjectField::%3, %4, QStringList(), QString(\"%5\")));\n")
+            finit.append(QString("    descriptors.append( new UAVObjectFieldDescriptor(QString(\"%1\"), QString(\"%2\"), UAVObjectField::%3, %4, QStringList(), QString(\"%5\")));\n")
                          .arg(info->fields[n]->name)
                          .arg(info->fields[n]->units)
                          .arg(fieldTypeStrCPPClass[info->fields[n]->type])
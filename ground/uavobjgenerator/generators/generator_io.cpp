@@ -28,6 +28,10 @@
 
 using namespace std;
 
+static QStringList templatesRead;
+static QStringList outputsGenerated;
+static QStringList outputsWritten;
+
 /**
  * Read a file and return its contents as a string
  */
@@ -53,32 +57,92 @@ QString readFile(QString name, bool do_warn)
  */
 QString readFile(QString name)
 {
+    templatesRead.append(QFileInfo(name).absoluteFilePath());
     return readFile(name, true);
 }
 
 /**
- * Write contents of string to file
+ * The bytes writeFile() puts in a file
  */
-bool writeFile(QString name, QString & str)
+static QByteArray encode(QString & str)
+{
+    QByteArray bytes;
+    QTextStream fileStr(&bytes, QIODevice::WriteOnly);
+
+    fileStr << str;
+    fileStr.flush();
+    return bytes;
+}
+
+static bool writeBytes(QString name, const QByteArray & bytes)
 {
     QFile file(name);
 
     if (!file.open(QFile::WriteOnly)) {
         return false;
     }
-    QTextStream fileStr(&file);
-    fileStr << str;
+    bool res = (file.write(bytes) == bytes.size());
     file.close();
-    return true;
+
+    outputsGenerated.append(QFileInfo(name).absoluteFilePath());
+    outputsWritten.append(QFileInfo(name).absoluteFilePath());
+    return res;
+}
+
+/**
+ * Write contents of string to file
+ */
+bool writeFile(QString name, QString & str)
+{
+    return writeBytes(name, encode(str));
 }
 
 /**
- * Write contents of string to file if the content changes
+ * Write contents of string to file if the content changes, files that
+ * are not touched do not trigger a rebuild of what depends on them
  */
 bool writeFileIfDiffrent(QString name, QString & str)
 {
-    if (str == readFile(name, false)) {
-        return true;
+    QByteArray bytes = encode(str);
+    QFile file(name);
+
+    if (file.open(QFile::ReadOnly)) {
+        if (file.size() == bytes.size() && file.readAll() == bytes) {
+            outputsGenerated.append(QFileInfo(name).absoluteFilePath());
+            return true;
+        }
+        file.close();
     }
-    return writeFile(name, str);
+    return writeBytes(name, bytes);
+}
+
+void startRecording()
+{
+    templatesRead.clear();
+    outputsGenerated.clear();
+    outputsWritten.clear();
+}
+
+QStringList recordedTemplates()
+{
+    QStringList templates = templatesRead;
+
+    templates.removeDuplicates();
+    return templates;
+}
+
+QStringList recordedOutputs()
+{
+    QStringList outputs = outputsGenerated;
+
+    outputs.removeDuplicates();
+    return outputs;
+}
+
+QStringList recordedChanges()
+{
+    QStringList changes = outputsWritten;
+
+    changes.removeDuplicates();
+    return changes;
 }
@@ -29,14 +29,21 @@
 #define GENERATORIO
 
 #include <QString>
+#include <QStringList>
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
 #include <iostream>
 
-QString readFile(QString name);
 QString readFile(QString name);
 bool writeFile(QString name, QString & str);
 bool writeFileIfDiffrent(QString name, QString & str);
 
+// The templates read and the files generated since startRecording(),
+// main() keeps them in the stamp of each language.
+void startRecording();
+QStringList recordedTemplates();
+QStringList recordedOutputs();
+QStringList recordedChanges(); // outputs actually written
+
 #endif
@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_stamp.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Content hashes of what a language was generated from
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "generator_stamp.h"
+#include <QFile>
+#include <QTextStream>
+#include <QCryptographicHash>
+
+GeneratorStamp::GeneratorStamp(const QString & fileName) : fileName(fileName)
+{
+    load();
+}
+
+/**
+ * Stamp file format, one entry per line:
+ *   input <hash>
+ *   template <hash> <path>
+ *   output <hash> <path>
+ */
+void GeneratorStamp::load()
+{
+    QFile file(fileName);
+
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        QString kind = line.section(' ', 0, 0);
+        if (kind == "input") {
+            stampedInputHash = line.section(' ', 1, 1).toLatin1();
+        } else if (kind == "template") {
+            templateHashes.insert(line.section(' ', 2), line.section(' ', 1, 1).toLatin1());
+        } else if (kind == "output") {
+            outputHashes.insert(line.section(' ', 2), line.section(' ', 1, 1).toLatin1());
+        }
+    }
+}
+
+bool GeneratorStamp::isUpToDate(const QByteArray & inputHash) const
+{
+    if (stampedInputHash.isEmpty() || stampedInputHash != inputHash) {
+        return false;
+    }
+    for (QMap<QString, QByteArray>::const_iterator i = templateHashes.constBegin(); i != templateHashes.constEnd(); ++i) {
+        if (fileHash(i.key()) != i.value()) {
+            return false;
+        }
+    }
+    for (QMap<QString, QByteArray>::const_iterator i = outputHashes.constBegin(); i != outputHashes.constEnd(); ++i) {
+        // an output that is gone has no hash, even if it had none when stamped
+        QByteArray hash = fileHash(i.key());
+        if (hash.isEmpty() || hash != i.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GeneratorStamp::update(const QByteArray & inputHash, const QStringList & templates, const QStringList & outputs)
+{
+    stampedInputHash = inputHash;
+    templateHashes.clear();
+    foreach(QString name, templates) {
+        templateHashes.insert(name, fileHash(name));
+    }
+    outputHashes.clear();
+    foreach(QString name, outputs) {
+        outputHashes.insert(name, fileHash(name));
+    }
+}
+
+bool GeneratorStamp::save() const
+{
+    QFile file(fileName);
+
+    if (!file.open(QFile::WriteOnly)) {
+        return false;
+    }
+    QTextStream stream(&file);
+    stream << "input " << stampedInputHash << "\n";
+    for (QMap<QString, QByteArray>::const_iterator i = templateHashes.constBegin(); i != templateHashes.constEnd(); ++i) {
+        stream << "template " << i.value() << " " << i.key() << "\n";
+    }
+    for (QMap<QString, QByteArray>::const_iterator i = outputHashes.constBegin(); i != outputHashes.constEnd(); ++i) {
+        stream << "output " << i.value() << " " << i.key() << "\n";
+    }
+    return true;
+}
+
+/**
+ * Hex SHA-1 of the content of a file, empty if it can not be read
+ */
+QByteArray GeneratorStamp::fileHash(const QString & name)
+{
+    QFile file(name);
+
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(file.readAll());
+    return hash.result().toHex();
+}
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_stamp.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Content hashes of what a language was generated from
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef GENERATORSTAMP_H
+#define GENERATORSTAMP_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMap>
+
+/**
+ * Remembers, in a file next to the outputs of one language, the hash of
+ * the inputs (definitions, generator, options), the hash of every template
+ * and the hash of every file generated. A language is up to date, and is
+ * not generated again, as long as none of these changed.
+ */
+class GeneratorStamp {
+public:
+    GeneratorStamp(const QString & fileName);
+
+    bool isUpToDate(const QByteArray & inputHash) const;
+    void update(const QByteArray & inputHash, const QStringList & templates, const QStringList & outputs);
+    bool save() const;
+
+    static QByteArray fileHash(const QString & name);
+
+private:
+    QString fileName;
+    QByteArray stampedInputHash;
+    QMap<QString, QByteArray> templateHashes;
+    QMap<QString, QByteArray> outputHashes;
+
+    void load();
+};
+
+#endif // GENERATORSTAMP_H
@@ -27,6 +27,9 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QCryptographicHash>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -35,6 +38,7 @@
 #include "generators/matlab/uavobjectgeneratormatlab.h"
 #include "generators/python/uavobjectgeneratorpython.h"
 #include "generators/wireshark/uavobjectgeneratorwireshark.h"
+#include "generators/generator_stamp.h"
 
 #define RETURN_ERR_USAGE 1
 #define RETURN_ERR_XML   2
@@ -47,7 +51,7 @@ using namespace std;
  */
 void usage()
 {
-    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
+    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-changed-only] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
     cout << "Languages: " << endl;
     cout << "\t-gcs           build groundstation code" << endl;
     cout << "\t-flight        build flight code" << endl;
@@ -58,6 +62,7 @@ void usage()
     cout << "\tIf no language is specified ( and not -none ) -> all are built." << endl;
     cout << "Misc: " << endl;
     cout << "\t-none          build no language - just parse xml's" << endl;
+    cout << "\t-changed-only  list the files written for each language in uavobjgenerator-<language>.changed" << endl;
     cout << "\t-h             this help" << endl;
     cout << "\t-v             verbose" << endl;
     cout << "\tinput_path     path to UAVObject definition (.xml) files." << endl;
@@ -65,6 +70,9 @@ void usage()
     cout << "\tUAVObjXY       name of a specific UAVObject to be built." << endl;
     cout << "\tIf any specific UAVObjects are given only these will be built." << endl;
     cout << "\tIf no UAVObject is specified -> all are built." << endl;
+    cout << "A language is only generated again when the definitions, the templates, the outputs," << endl;
+    cout << "the arguments or the generator changed since uavobjgenerator-<language>.stamp was written," << endl;
+    cout << "and only the files whose content differs are written." << endl;
 }
 
 /**
@@ -77,6 +85,71 @@ int usage_err()
     return RETURN_ERR_USAGE;
 }
 
+namespace {
+/**
+ * Reads and parses one definition file, the files are parsed in parallel
+ */
+class DefinitionParser : public QRunnable {
+public:
+    DefinitionParser(const QFileInfo & fileinfo) : fileinfo(fileinfo)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        QFile file(fileinfo.absoluteFilePath());
+
+        if (!file.open(QFile::ReadOnly)) {
+            error = QString("could not read %1").arg(fileinfo.absoluteFilePath());
+            return;
+        }
+        content = file.readAll();
+        QTextStream stream(content);
+        QString xml = stream.readAll();
+        QString filename = fileinfo.fileName();
+        error = parser.parseXML(xml, filename);
+    }
+
+    QFileInfo fileinfo;
+    QByteArray content;
+    QString error;
+    UAVObjectParser parser;
+};
+
+/**
+ * Generates one language unless its stamp says the outputs are up to date
+ */
+template<class Generator>
+void generateLanguage(const QString & language, UAVObjectParser *parser, const QString & templatepath,
+                      const QString & outputpath, const QByteArray & inputHash, bool changedOnly)
+{
+    GeneratorStamp stamp(outputpath + "uavobjgenerator-" + language + ".stamp");
+    QStringList changes;
+
+    if (stamp.isUpToDate(inputHash)) {
+        cout << language.toStdString() << " code is up to date" << endl;
+    } else {
+        cout << "generating " << language.toStdString() << " code" << endl;
+        startRecording();
+        Generator generator;
+        if (generator.generate(parser, templatepath, outputpath)) {
+            stamp.update(inputHash, recordedTemplates(), recordedOutputs());
+            stamp.save();
+        }
+        changes = recordedChanges();
+    }
+
+    if (changedOnly) {
+        QString list = changes.join("\n");
+        if (!list.isEmpty()) {
+            list.append("\n");
+        }
+        writeFile(outputpath + "uavobjgenerator-" + language + ".changed", list);
+    }
+}
+}
+
 /**
  * entrance
  */
@@ -110,6 +183,7 @@ int main(int argc, char *argv[])
     bool do_matlab     = (arguments_stringlist.removeAll("-matlab") > 0);
     bool do_wireshark  = (arguments_stringlist.removeAll("-wireshark") > 0);
     bool do_none       = (arguments_stringlist.removeAll("-none") > 0); //
+    bool changed_only  = (arguments_stringlist.removeAll("-changed-only") > 0);
 
     bool do_all        = ((do_gcs || do_flight || do_java || do_python || do_matlab) == false);
     bool do_allObjects = true;
@@ -145,8 +219,8 @@ int main(int argc, char *argv[])
     xmlPath.setNameFilters(filters);
     QFileInfoList xmlList   = xmlPath.entryInfoList();
 
-    // Read in each XML file and parse object(s) in them
-
+    // Read in and parse the XML files in parallel
+    QList<DefinitionParser *> definitions;
     for (int n = 0; n < xmlList.length(); ++n) {
         QFileInfo fileinfo = xmlList[n];
         if (!do_allObjects) {
@@ -160,18 +234,30 @@ int main(int argc, char *argv[])
         if (verbose) {
             cout << "Parsing XML file: " << fileinfo.fileName().toStdString() << endl;
         }
-        QString filename = fileinfo.fileName();
-        QString xmlstr   = readFile(fileinfo.absoluteFilePath());
-
-        QString res = parser->parseXML(xmlstr, filename);
-
-        if (!res.isNull()) {
+        definitions.append(new DefinitionParser(fileinfo));
+        QThreadPool::globalInstance()->start(definitions.last());
+    }
+    QThreadPool::globalInstance()->waitForDone();
+
+    // Collect the objects in file order, what is generated does not depend
+    // on the order the files were parsed in. Everything the outputs depend
+    // on goes into the input hash.
+    QCryptographicHash inputHash(QCryptographicHash::Sha1);
+    inputHash.addData(GeneratorStamp::fileHash(QCoreApplication::applicationFilePath()));
+    inputHash.addData(templatepath.toUtf8());
+    inputHash.addData(arguments_stringlist.join(" ").toUtf8());
+    foreach(DefinitionParser * definition, definitions) {
+        if (!definition->error.isNull()) {
             if (!verbose) {
-                cout << "Error in XML file: " << fileinfo.fileName().toStdString() << endl;
+                cout << "Error in XML file: " << definition->fileinfo.fileName().toStdString() << endl;
             }
-            cout << "Error parsing " << res.toStdString() << endl;
+            cout << "Error parsing " << definition->error.toStdString() << endl;
             return RETURN_ERR_XML;
         }
+        parser->takeObjects(&definition->parser);
+        inputHash.addData(definition->fileinfo.fileName().toUtf8());
+        inputHash.addData(definition->content);
+        delete definition;
     }
 
     if (objects_stringlist.length() > 0) {
@@ -209,46 +295,25 @@ int main(int argc, char *argv[])
         return RETURN_OK;
     }
 
-    // generate flight code if wanted
+    QByteArray hash = inputHash.result().toHex();
+
     if (do_flight | do_all) {
-        cout << "generating flight code" << endl;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorFlight>("flight", parser, templatepath, outputpath, hash, changed_only);
     }
-
-    // generate gcs code if wanted
     if (do_gcs | do_all) {
-        cout << "generating gcs code" << endl;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorGCS>("gcs", parser, templatepath, outputpath, hash, changed_only);
     }
-
-    // generate java code if wanted
     if (do_java | do_all) {
-        cout << "generating java code" << endl;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorJava>("java", parser, templatepath, outputpath, hash, changed_only);
     }
-
-    // generate python code if wanted
     if (do_python | do_all) {
-        cout << "generating python code" << endl;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorPython>("python", parser, templatepath, outputpath, hash, changed_only);
     }
-
-    // generate matlab code if wanted
     if (do_matlab | do_all) {
-        cout << "generating matlab code" << endl;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorMatlab>("matlab", parser, templatepath, outputpath, hash, changed_only);
     }
-
-    // generate wireshark plugin if wanted
     if (do_wireshark | do_all) {
-        cout << "generating wireshark code" << endl;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser, templatepath, outputpath);
+        generateLanguage<UAVObjectGeneratorWireshark>("wireshark", parser, templatepath, outputpath, hash, changed_only);
     }
 
     return RETURN_OK;
@@ -45,6 +45,17 @@ UAVObjectParser::UAVObjectParser()
     accessModeStrXML << "readwrite" << "readonly";
 }
 
+/**
+ * Move the objects parsed by another parser to the end of this one
+ */
+void UAVObjectParser::takeObjects(UAVObjectParser *other)
+{
+    objInfo.append(other->objInfo);
+    other->objInfo.clear();
+    all_units.append(other->all_units);
+    all_units.removeDuplicates();
+}
+
 /**
  * Get number of objects
  */
@@ -106,6 +106,7 @@ public:
     // Functions
     UAVObjectParser();
     QString parseXML(QString & xml, QString & filename);
+    void takeObjects(UAVObjectParser *other);
     int getNumObjects();
     QList<ObjectInfo *> getObjectInfo();
     QString getObjectName(int objIndex);
@@ -15,6 +15,7 @@ TEMPLATE = app
 SOURCES += main.cpp \
     uavobjectparser.cpp \
     generators/generator_io.cpp \
+    generators/generator_stamp.cpp \
     generators/java/uavobjectgeneratorjava.cpp \
     generators/flight/uavobjectgeneratorflight.cpp \
     generators/gcs/uavobjectgeneratorgcs.cpp \
@@ -24,6 +25,7 @@ SOURCES += main.cpp \
     generators/generator_common.cpp
 HEADERS += uavobjectparser.h \
     generators/generator_io.h \
+    generators/generator_stamp.h \
     generators/java/uavobjectgeneratorjava.h \
     generators/gcs/uavobjectgeneratorgcs.h \
     generators/matlab/uavobjectgeneratormatlab.h \
@@ -0,0 +1,161 @@
+#!/usr/bin/env python
+#
+# Stand-in for FlightGear in HITL runs: replays a recorded trajectory to
+# the GCS HITL plugin over UDP, in the text or the binary layout of the
+# opfgprotocol generic protocol, free running or in lock-step.
+#
+# (c) 2014, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+# A trajectory is what FlightGear sends with opfgprotocol.xml, one state
+# per line: 24 comma separated values and a counter.  Record one with
+#
+#   hitlreplay.py --record=flight.txt --listen-port=40100
+#
+# and FlightGear sending to that port, or replay a circle generated when
+# no trajectory is given.  In lock-step the next state is only sent once
+# the GCS answered with the number of the state the flight side
+# acknowledged, the run goes as fast as the flight side allows.  The
+# flight side keeps its own real-time clock, so two replays of the same
+# trajectory do not give the same outputs.
+#
+
+import optparse
+import socket
+import struct
+import math
+import time
+import sys
+
+STATE_FLOATS = 24
+STATE_BINARY = struct.Struct('!%dfi' % STATE_FLOATS)
+CONTROL_BINARY = struct.Struct('!4fi')
+RESEND_TIMEOUT = 1.0
+
+def circle(steps, rate):
+    """A level circle, 200m radius at 20m/s and 100m above ground"""
+    states = []
+    radius, speed, alt = 200.0, 20.0, 100.0
+    lat0, lon0 = 52.0, 4.0
+    omega = speed / radius
+    bank = math.degrees(math.atan(speed * omega / 9.81))
+    for i in range(steps):
+        t = i / float(rate)
+        a = omega * t
+        north, east = radius * math.sin(a), radius * (1 - math.cos(a))
+        heading = math.degrees(a) % 360
+        vn, ve = speed * math.cos(a), speed * math.sin(a)
+        state = [
+            0.0, 0.0, omega,                       # body rates (rad/s)
+            0.0, 0.0, -32.174,                     # accelerations (ft/s^2)
+            0.0, 0.0, bank, 0.0,                   # pitch, pitch rate, roll, roll rate
+            heading, math.degrees(omega),          # yaw, yaw rate
+            lat0 + north / 111111.0,
+            lon0 + east / (111111.0 * math.cos(math.radians(lat0))),
+            heading,
+            alt / 0.3048, alt / 0.3048,            # altitude msl, agl (ft)
+            speed / 0.514444, speed / 0.514444,    # groundspeed, airspeed (kt)
+            15.0, 29.92,                           # temperature (C), pressure (inHg)
+            0.0, ve / 0.3048, vn / 0.3048,         # velocity up, east, north (ft/s)
+        ]
+        states.append(state)
+    return states
+
+def load(path):
+    states = []
+    for line in open(path):
+        values = line.strip().split(',')
+        if len(values) <= STATE_FLOATS:
+            continue
+        states.append([float(v) for v in values[:STATE_FLOATS]])
+    return states
+
+def encode(state, counter, binary):
+    if binary:
+        return STATE_BINARY.pack(*(state + [counter]))
+    return (','.join('%f' % v for v in state) + ',%d\n' % counter).encode('ascii')
+
+def decode_control(data, binary):
+    """The counter of a control datagram, None if it is not one"""
+    try:
+        if binary:
+            if len(data) != CONTROL_BINARY.size:
+                return None
+            return CONTROL_BINARY.unpack(data)[4]
+        return int(data.decode('ascii').strip().split(',')[4])
+    except (ValueError, IndexError, UnicodeDecodeError):
+        return None
+
+def record(options):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((options.host, options.listen_port))
+    out = open(options.record, 'w')
+    count = 0
+    try:
+        while True:
+            data, _ = sock.recvfrom(4096)
+            out.write(data.decode('ascii').strip() + '\n')
+            count += 1
+    except KeyboardInterrupt:
+        pass
+    print('recorded %d states' % count)
+
+def replay(options, states):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((options.host, options.listen_port))
+    target = (options.host, options.port)
+    period = 1.0 / options.rate
+    resent = 0
+    start = time.time()
+
+    for i, state in enumerate(states):
+        step = i + 1
+        sock.sendto(encode(state, step, options.binary), target)
+        if options.lockstep:
+            # wait for the GCS to answer with this step, repeat it meanwhile
+            sock.settimeout(RESEND_TIMEOUT)
+            while True:
+                try:
+                    data, _ = sock.recvfrom(4096)
+                except socket.timeout:
+                    sock.sendto(encode(state, step, options.binary), target)
+                    resent += 1
+                    continue
+                if decode_control(data, options.binary) == step:
+                    break
+        else:
+            next_time = start + step * period
+            delay = next_time - time.time()
+            if delay > 0:
+                time.sleep(delay)
+
+    elapsed = time.time() - start
+    simulated = len(states) * period
+    print('%d states in %.2fs, %.1fx real time, %d resent' %
+          (len(states), elapsed, simulated / max(elapsed, 1e-6), resent))
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] [trajectory]')
+    parser.add_option('--host', default='127.0.0.1', help='address of the GCS')
+    parser.add_option('--port', type='int', default=40100, help='HITL input port of the GCS')
+    parser.add_option('--listen-port', type='int', default=40200, help='HITL output port of the GCS')
+    parser.add_option('--rate', type='float', default=20, help='states per second of simulated time')
+    parser.add_option('--steps', type='int', default=1200, help='length of the generated circle')
+    parser.add_option('--binary', action='store_true', help='opfgprotocol-binary datagrams')
+    parser.add_option('--lockstep', action='store_true', help='wait for each step to be acknowledged')
+    parser.add_option('--record', metavar='FILE', help='record the states sent to the listen port')
+    options, args = parser.parse_args()
+
+    if options.record:
+        record(options)
+        return 0
+
+    states = load(args[0]) if args else circle(options.steps, options.rate)
+    if not states:
+        print('no states to replay')
+        return 1
+    replay(options, states)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,273 @@
+#!/usr/bin/env python
+#
+# Drive the simposix performance harness: compile a scenario into the
+# script format the firmware replays, run the simulator on its virtual
+# clock and turn its report into JSON, optionally compared to a baseline.
+#
+# (c) 2014, The OpenPilot Team, http://www.openpilot.org
+# See also: The GNU Public License (GPL) Version 3
+#
+# Scenario lines:
+#
+#   <time_ms> <Object>[<instance>].<Field>[<element>] = <value>
+#   <start_ms>-<end_ms>/<period_ms> <Object>... = <value>
+#
+# The instance and the element are optional, the element is a name or an
+# index and enum values are given by option name.  The second form repeats
+# the update, sensors have to be fed at their rate.  '#' starts a comment.
+#
+#   0    FlightModeSettings.Arming = Always Armed
+#   500  GCSReceiver.Channel[2] = 1500
+#   0-10000/2 GyroSensor.x = 0.5
+#
+
+from subprocess import Popen, PIPE
+import xml.etree.ElementTree as ET
+import optparse
+import json
+import glob
+import os
+import re
+import sys
+
+TYPES = ['int8', 'int16', 'int32', 'uint8', 'uint16', 'uint32', 'float', 'enum']
+SIZES = [1, 2, 4, 1, 2, 4, 4, 1]
+
+class Field:
+    def __init__(self, name, type, elements, options):
+        self.name = name
+        self.type = type
+        self.elements = elements
+        self.options = options
+        self.offset = 0
+
+    def size(self):
+        return SIZES[TYPES.index(self.type)]
+
+class UAVObject:
+    """Object layout and ID, computed the same way as uavobjgenerator"""
+
+    def __init__(self, node):
+        self.name = node.get('name')
+        self.single = node.get('singleinstance').lower() == 'true'
+        self.settings = node.get('settings').lower() == 'true'
+        self.fields = []
+        for f in node.findall('field'):
+            clone = f.get('cloneof')
+            if clone:
+                parent = [p for p in self.fields if p.name == clone][0]
+                self.fields.append(Field(f.get('name'), parent.type, parent.elements, parent.options))
+                continue
+            if f.get('elementnames'):
+                elements = [e.strip() for e in f.get('elementnames').split(',') if e.strip()]
+            else:
+                elements = [e.text for e in f.findall('elementnames/elementname') if e.text]
+            if not elements:
+                elements = [str(n) for n in range(int(f.get('elements')))]
+            options = []
+            if f.get('type') == 'enum':
+                if f.get('options'):
+                    options = [o.strip() for o in f.get('options').split(',') if o.strip()]
+                else:
+                    options = [o.text for o in f.findall('options/option') if o.text]
+            self.fields.append(Field(f.get('name'), f.get('type'), elements, options))
+
+        # stable sort by size, largest first, that is the packed struct layout
+        self.fields.sort(key=lambda f: -f.size())
+        offset = 0
+        for f in self.fields:
+            f.offset = offset
+            offset += f.size() * len(f.elements)
+        self.size = offset
+        self.id = self.calculate_id()
+
+    def calculate_id(self):
+        def update(value, h):
+            return (h ^ ((h << 5) + (h >> 2) + value)) & 0xFFFFFFFF
+
+        def update_str(text, h):
+            for c in bytearray(text.encode('latin-1')):
+                # QByteArray hands out signed chars
+                h = update(c if c < 128 else c + 0xFFFFFF00, h)
+            return h
+
+        h = update_str(self.name, 0)
+        h = update(int(self.settings), h)
+        h = update(int(self.single), h)
+        for f in self.fields:
+            h = update_str(f.name, h)
+            h = update(len(f.elements), h)
+            h = update(TYPES.index(f.type), h)
+            for o in f.options:
+                h = update_str(o, h)
+        return h & 0xFFFFFFFE
+
+    def field(self, name):
+        for f in self.fields:
+            if f.name.lower() == name.lower():
+                return f
+        raise ValueError('%s has no field %s' % (self.name, name))
+
+def load_objects(xmldir):
+    objects = {}
+    for path in sorted(glob.glob(os.path.join(xmldir, '*.xml'))):
+        for node in ET.parse(path).getroot().findall('object'):
+            obj = UAVObject(node)
+            objects[obj.name.lower()] = obj
+    return objects
+
+SCENARIO_LINE = re.compile(r'^(\d+)(?:-(\d+)/(\d+))?\s+(\w+)(?:\[(\d+)\])?\.(\w+)(?:\[(\w+)\])?\s*=\s*(.+)$')
+
+def compile_scenario(path, objects):
+    """Turn a scenario into '<time> <id> <inst> <offset> <type> <value>' lines"""
+    lines = []
+    for number, text in enumerate(open(path), 1):
+        text = text.split('#')[0].strip()
+        if not text:
+            continue
+        m = SCENARIO_LINE.match(text)
+        if not m:
+            raise ValueError('%s:%d: malformed line' % (path, number))
+        start, end, period, objname, inst, fieldname, element, value = m.groups()
+        if objname.lower() not in objects:
+            raise ValueError('%s:%d: unknown object %s' % (path, number, objname))
+        obj = objects[objname.lower()]
+        field = obj.field(fieldname)
+
+        index = 0
+        if element is not None:
+            if element.isdigit():
+                index = int(element)
+            elif element in field.elements:
+                index = field.elements.index(element)
+            else:
+                raise ValueError('%s:%d: %s has no element %s' % (path, number, field.name, element))
+        if index >= len(field.elements):
+            raise ValueError('%s:%d: element out of range' % (path, number))
+
+        value = value.strip()
+        type = field.type
+        if type == 'enum':
+            if value not in field.options:
+                raise ValueError('%s:%d: %s has no option %s' % (path, number, field.name, value))
+            value = str(field.options.index(value))
+            type = 'uint8'
+        elif type == 'float':
+            value = repr(float(value))
+        else:
+            value = str(int(value, 0))
+
+        offset = field.offset + index * field.size()
+        times = [int(start)]
+        if period:
+            times = range(int(start), int(end) + 1, max(int(period), 1))
+        for time in times:
+            lines.append((time, '%d %08x %d %d %s %s' % (time, obj.id, int(inst or 0), offset, type, value)))
+
+    # stable, lines of the same time are applied in scenario order
+    lines.sort(key=lambda l: l[0])
+    return [l[1] for l in lines]
+
+def read_report(path, objects):
+    """Parse the 'key value' report, naming tasks and callbacks"""
+    report = {}
+    tasks = objects['taskinfo'].field('RunningTime').elements
+    callbacks = objects['callbackinfo'].field('RunningTime').elements
+    for line in open(path):
+        key, value = line.split()
+        value = int(value)
+        if key.startswith('task_cpu_pct.'):
+            report.setdefault('task_cpu_pct', {})[tasks[int(key.split('.')[1])]] = value
+        elif key.startswith('callback_runs.'):
+            report.setdefault('callback_runs', {})[callbacks[int(key.split('.')[1])]] = value
+        else:
+            report[key] = value
+    return report
+
+def git_commit(root):
+    try:
+        out = Popen(['git', 'rev-parse', '--short', 'HEAD'], stdout=PIPE, cwd=root).communicate()[0]
+        return out.decode().strip()
+    except OSError:
+        return None
+
+def flatten(report, prefix=''):
+    flat = {}
+    for key, value in report.items():
+        if isinstance(value, dict):
+            flat.update(flatten(value, prefix + key + '.'))
+        elif isinstance(value, int):
+            flat[prefix + key] = value
+    return flat
+
+def compare(report, baseline):
+    """Print the metrics that changed. On the virtual clock everything but the
+    host_* timings and the task_cpu_pct load, which counts host CPU time,
+    repeats exactly, so only those are expected to differ between runs of
+    the same firmware."""
+    new = flatten(report)
+    old = flatten(baseline)
+    print('%-40s %12s %12s %8s' % ('metric', 'baseline', 'current', 'change'))
+    for key in sorted(set(new) | set(old)):
+        a = old.get(key, 0)
+        b = new.get(key, 0)
+        if a == b:
+            continue
+        change = ('%+.1f%%' % (100.0 * (b - a) / a)) if a else 'new'
+        host = ' (host time)' if key.startswith('host_') or key.startswith('task_cpu_pct.') else ''
+        print('%-40s %12d %12d %8s%s' % (key, a, b, change, host))
+
+def main():
+    root = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+
+    parser = optparse.OptionParser(usage='%prog [options] scenario')
+    parser.add_option('--elf', default=os.path.join(root, 'build', 'firmware', 'fw_simposix', 'fw_simposix.elf'),
+                      help='simulator binary')
+    parser.add_option('--xml', default=os.path.join(root, 'shared', 'uavobjectdefinition'),
+                      help='UAVObject definitions the simulator was built from')
+    parser.add_option('--outdir', default=os.path.join(root, 'build', 'sim_harness'),
+                      help='where to put the compiled script and the results')
+    parser.add_option('--duration', type='int', default=10000,
+                      help='simulated run time in ms')
+    parser.add_option('--real-time', action='store_true', default=False,
+                      help='run on the host clock instead of the virtual clock')
+    parser.add_option('--compare', metavar='BASELINE',
+                      help='print the differences to an earlier result')
+    (options, args) = parser.parse_args()
+    if len(args) != 1:
+        parser.error('need exactly one scenario')
+
+    objects = load_objects(options.xml)
+    name = os.path.splitext(os.path.basename(args[0]))[0]
+    if not os.path.isdir(options.outdir):
+        os.makedirs(options.outdir)
+    script = os.path.join(options.outdir, name + '.script')
+    report = os.path.join(options.outdir, name + '.report')
+    result = os.path.join(options.outdir, name + '.json')
+
+    try:
+        lines = compile_scenario(args[0], objects)
+    except ValueError as e:
+        sys.exit(str(e))
+    with open(script, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+    command = [options.elf, '--script', script, '--duration', str(options.duration), '--report', report]
+    if not options.real_time:
+        command.append('--virtual-clock')
+    if Popen(command, cwd=options.outdir).wait() != 0:
+        sys.exit('simulator failed')
+
+    data = read_report(report, objects)
+    data['scenario'] = name
+    data['commit'] = git_commit(root)
+    with open(result, 'w') as f:
+        json.dump(data, f, indent=2, sort_keys=True)
+    print('%s: %d ms simulated in %.2f s, %d events, %d dropped' %
+          (name, data['sim_time_ms'], data['host_wall_us'] / 1e6, data['events_total'], data['events_dropped']))
+
+    if options.compare:
+        compare(data, json.load(open(options.compare)))
+
+if __name__ == '__main__':
+    main()